@@ -0,0 +1,571 @@
+/*! @file analyzer.c
+File with the analyzer of the game journal. The analyzer maps the segment files given on the command line,
+orders them by the run and the number of the segment, and reads every record once, in order. Without
+options it prints the statistics of the finished sessions by the board size. With -s it replays the session
+with the given number on the game engine as fast as the records are read, and checks every recorded result
+against the engine.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../engine/engine.h"
+#include "../shared/journal_format.h"
+#include "../shared/protocol.h"
+
+#define MAX_PRINTED_FIELD_SIZE 64
+
+/**
+ * @struct Segment
+ * @brief Structure for a mapped segment file.
+ *
+ * @param path Path of the file.
+ * @param data Mapping of the file, starts with the header of the segment.
+ * @param size Size of the file.
+ */
+typedef struct {
+    const char* path;
+    const uint8_t* data;
+    size_t size;
+} Segment;
+
+/**
+ * @struct SizeStatistics
+ * @brief Structure for the statistics of the finished sessions of one board size.
+ *
+ * @param games Number of finished sessions.
+ * @param won Number of won games.
+ * @param lost Number of lost games, including the timeouts.
+ * @param timeouts Number of games lost because the player was idle.
+ * @param closed Number of sessions closed before the end of the game.
+ * @param moves Number of moves of the sessions.
+ * @param max_moves Largest number of moves of a session.
+ * @param duration Total duration of the games in milliseconds.
+ */
+typedef struct {
+    uint64_t games;
+    uint64_t won;
+    uint64_t lost;
+    uint64_t timeouts;
+    uint64_t closed;
+    uint64_t moves;
+    uint64_t max_moves;
+    uint64_t duration;
+} SizeStatistics;
+
+/**
+ * @struct Statistics
+ * @brief Structure for the statistics of the journal.
+ *
+ * @param segments Number of read segments.
+ * @param records Number of read records.
+ * @param bytes Number of bytes of the read records.
+ * @param starts Number of started games.
+ * @param moves Number of moves.
+ * @param skipped Number of records that were not written completely.
+ * @param sizes Statistics of the finished sessions by the board size.
+ */
+typedef struct {
+    uint64_t segments;
+    uint64_t records;
+    uint64_t bytes;
+    uint64_t starts;
+    uint64_t moves;
+    uint64_t skipped;
+    SizeStatistics sizes[MAX_FIELD_SIZE + 1];
+} Statistics;
+
+/**
+ * @struct Replay
+ * @brief Structure for the replay of one session.
+ *
+ * @param session Number of the replayed session.
+ * @param run Run of the replayed session, 0 until its start is read.
+ * @param rules Rules of the replayed game.
+ * @param board Game board of the replayed game.
+ * @param game Replayed game.
+ * @param move Number of the last replayed move of the session.
+ * @param moves Number of replayed moves of all replayed sessions.
+ * @param mismatches Number of moves the engine answered differently than the journal.
+ * @param replays Number of replayed sessions, the number is unique only within a run.
+ */
+typedef struct {
+    uint32_t session;
+    uint64_t run;
+    GameRules rules;
+    GameBoard* board;
+    GameContext game;
+    uint32_t move;
+    uint64_t moves;
+    uint64_t mismatches;
+    int replays;
+} Replay;
+
+/**
+ * @brief Names of the reasons the sessions were finished.
+ */
+static const char* reason_names[] = {
+    [JOURNAL_END_GAME_OVER] = "game over",
+    [JOURNAL_END_TIMEOUT] = "timeout",
+    [JOURNAL_END_CLOSED] = "connection closed",
+};
+
+/**
+ * @brief Returns the monotonic time.
+ * @return Time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Maps the segment file and checks its header.
+ * @param segment Segment to fill.
+ * @param path Path of the file.
+ * @return true if the file is a segment of the journal, false otherwise.
+ */
+static bool open_segment(Segment* segment, const char* path) {
+    int file = open(path, O_RDONLY);
+    if (file < 0) {
+        perror("JOURNAL FILE ERROR");
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) < 0 || (size_t)status.st_size < sizeof(JournalSegmentHeader)) {
+        printf("ERROR: %s is not a journal file\n", path);
+        close(file);
+        return false;
+    }
+
+    void* data = mmap(NULL, status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+
+    if (data == MAP_FAILED) {
+        perror("MMAP ERROR");
+        return false;
+    }
+
+    const JournalSegmentHeader* header = (const JournalSegmentHeader*)data;
+    if (header->magic != JOURNAL_MAGIC || header->version != JOURNAL_VERSION ||
+        header->header_size < sizeof(JournalSegmentHeader) || header->header_size > status.st_size) {
+        printf("ERROR: %s is not a journal file\n", path);
+        munmap(data, status.st_size);
+        return false;
+    }
+
+    madvise(data, status.st_size, MADV_SEQUENTIAL);
+
+    segment->path = path;
+    segment->data = (const uint8_t*)data;
+    segment->size = status.st_size;
+
+    return true;
+}
+
+/**
+ * @brief Compares the segments by the run and the number of the segment.
+ * @param first First segment.
+ * @param second Second segment.
+ * @return Negative if the first segment was written earlier, positive if later, 0 otherwise.
+ */
+static int compare_segments(const void* first, const void* second) {
+    const JournalSegmentHeader* a = (const JournalSegmentHeader*)((const Segment*)first)->data;
+    const JournalSegmentHeader* b = (const JournalSegmentHeader*)((const Segment*)second)->data;
+
+    if (a->run != b->run) {
+        return a->run < b->run ? -1 : 1;
+    }
+
+    return a->segment < b->segment ? -1 : a->segment > b->segment;
+}
+
+/**
+ * @brief Counts the record in the statistics.
+ * @param statistics Statistics.
+ * @param record Record.
+ * @return void
+ */
+static void count_record(Statistics* statistics, const JournalRecord* record) {
+    statistics->records++;
+    statistics->bytes += record->length;
+
+    if (record->type == JOURNAL_START) {
+        statistics->starts++;
+    } else if (record->type == JOURNAL_MOVE) {
+        statistics->moves++;
+    } else if (record->type == JOURNAL_END) {
+        const JournalEnd* end = (const JournalEnd*)record;
+        if (end->field_size > MAX_FIELD_SIZE) {
+            return;
+        }
+
+        SizeStatistics* size = &statistics->sizes[end->field_size];
+        size->games++;
+        size->won += end->status == WIN;
+        size->lost += end->status == LOSE;
+        size->timeouts += end->reason == JOURNAL_END_TIMEOUT;
+        size->closed += end->reason == JOURNAL_END_CLOSED;
+        size->moves += end->moves;
+        size->max_moves = end->moves > size->max_moves ? end->moves : size->max_moves;
+        size->duration += end->duration;
+    }
+
+    return;
+}
+
+/**
+ * @brief Prints the game board. The columns are as wide as the label of the last column, and the boards
+ * larger than MAX_PRINTED_FIELD_SIZE are not printed.
+ * @param board Game board.
+ * @return void
+ */
+static void print_board(const GameBoard* board) {
+    char label[MAX_COLUMN_LETTERS + 1];
+
+    if (board->field_size > MAX_PRINTED_FIELD_SIZE) {
+        printf("Board %dx%d is too large to print\n", board->field_size, board->field_size);
+        return;
+    }
+
+    int width = format_column(label, board->field_size - 1);
+
+    printf("    ");
+    for (int x = 0; x < board->field_size; ++x) {
+        format_column(label, x);
+        printf(" %*s", width, label);
+    }
+    printf("\n");
+
+    for (int y = 0; y < board->field_size; ++y) {
+        printf("  %2d", y + 1);
+
+        for (int x = 0; x < board->field_size; ++x) {
+            printf(" %*c", width, board_cell_symbol(board_get_cell(board, x, y)));
+        }
+
+        printf("\n");
+    }
+
+    return;
+}
+
+/**
+ * @brief Marks the recorded cells on the board of the replay.
+ * @param board Game board.
+ * @param cells Recorded cells.
+ * @param count Number of the cells.
+ * @return true if all cells are on the board, false otherwise.
+ */
+static bool restore_cells(GameBoard* board, const uint32_t* cells, uint32_t count) {
+    uint32_t field_size = (uint32_t)board->field_size;
+
+    for (uint32_t i = 0; i < count; ++i) {
+        uint32_t cell = cells[i] & MARKED_CELL_MASK, state = cells[i] >> MARKED_CELL_STATE_SHIFT;
+        if (cell >= field_size * field_size) {
+            return false;
+        }
+
+        if (state == CELL_SHIP || state == CELL_HIT) {
+            board_set_ship(board, (int)(cell % field_size), (int)(cell / field_size));
+        }
+        if (state == CELL_MISS || state == CELL_HIT) {
+            board_set_shot(board, (int)(cell % field_size), (int)(cell / field_size));
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Starts the replay of the game: restores the board with the ships of the record. A board that did
+ * not fit into the record is placed again from its seed.
+ * @param replay Replay.
+ * @param start Record of the start of the game.
+ * @param run Run of the segment of the record.
+ * @return void
+ */
+static void replay_start(Replay* replay, const JournalStart* start, uint64_t run) {
+    size_t length = sizeof(JournalStart) + (size_t)start->cells * sizeof(uint32_t);
+    bool placed_again = start->cells == 0 && start->moves == 0 && start->seed != 0 ? true : false;
+
+    if (start->field_size > MAX_FIELD_SIZE || start->header.length < length ||
+        (start->cells == 0 && !placed_again)) {
+        printf("ERROR: session %u has an invalid board\n", replay->session);
+        return;
+    }
+
+    replay->rules.field_size = start->field_size;
+    replay->rules.number_of_ships = start->number_of_ships;
+    replay->rules.number_of_moves = start->number_of_moves;
+
+    destroy_game_board(replay->board);
+    replay->board = create_game_board(start->field_size, max_marked_cells(&replay->rules));
+    init_game_context(&replay->game, &replay->rules, replay->board);
+
+    if (placed_again) {
+        start_game(&replay->game, start->seed);
+    } else if (!restore_cells(replay->board, (const uint32_t*)(start + 1), start->cells)) {
+        printf("ERROR: session %u has an invalid board\n", replay->session);
+        return;
+    }
+
+    replay->run = run;
+    replay->move = start->moves;
+    replay->replays++;
+
+    start_prepared_game(&replay->game);
+    replay->game.number_of_ships = start->ships_left;
+    replay->game.number_of_moves = start->missed;
+
+    char name[JOURNAL_NAME_SIZE + 1] = {0};
+    memcpy(name, start->name, JOURNAL_NAME_SIZE);
+
+    printf("Session %u of run %llu, worker %u: player %s (%s), board %dx%d, %d ships, %d moves, seed %llu\n",
+           replay->session, (unsigned long long)run, start->header.worker, name,
+           start->protocol == PROTOCOL_BINARY ? "binary" : "ascii", start->field_size, start->field_size,
+           start->number_of_ships, start->number_of_moves, (unsigned long long)start->seed);
+
+    if (start->moves != 0) {
+        printf("Resumed after %u moves, ships left: %u, missed: %u\n", start->moves, start->ships_left,
+               start->missed);
+    }
+
+    return;
+}
+
+/**
+ * @brief Plays the recorded move on the engine and prints it with a note if the engine answered
+ * differently.
+ * @param replay Replay.
+ * @param move Record of the move.
+ * @return void
+ */
+static void replay_move(Replay* replay, const JournalMove* move) {
+    MoveResult result = process_player_move(&replay->game, move->x, move->y);
+    GameStatus status = check_game_status(&replay->game);
+
+    char text[BUF_MESSAGE_SIZE];
+    format_move(text, move->x, move->y);
+
+    replay->move++;
+    replay->moves++;
+    printf("  %4u. %s: %s", replay->move, text, move_result_message((MoveResult)move->result));
+
+    if (result != move->result || status != move->status) {
+        replay->mismatches++;
+        printf(" (MISMATCH: engine answered %s, status %d)", move_result_message(result), status);
+    }
+
+    printf("\n");
+
+    return;
+}
+
+/**
+ * @brief Finishes the replay of the session: prints the result of the game and the final board.
+ * @param replay Replay.
+ * @param end Record of the end of the session.
+ * @return void
+ */
+static void replay_end(Replay* replay, const JournalEnd* end) {
+    const char* result = end->status == WIN ? "won" : end->status == LOSE ? "lost" : "not finished";
+
+    printf("Result: %s after %u moves in %u ms (%s), ships left: %u, missed: %u\n", result, end->moves,
+           end->duration, end->reason <= JOURNAL_END_CLOSED ? reason_names[end->reason] : "unknown",
+           end->ships_left, end->missed);
+
+    if (end->reason != JOURNAL_END_TIMEOUT && end->status != check_game_status(&replay->game)) {
+        replay->mismatches++;
+        printf("MISMATCH: engine status %d\n", check_game_status(&replay->game));
+    }
+
+    print_board(replay->board);
+    replay->run = 0;
+
+    return;
+}
+
+/**
+ * @brief Passes the record of the replayed session to the replay.
+ * @param replay Replay.
+ * @param record Record.
+ * @param run Run of the segment of the record.
+ * @return void
+ */
+static void replay_record(Replay* replay, const JournalRecord* record, uint64_t run) {
+    if (record->session != replay->session) {
+        return;
+    }
+
+    if (record->type == JOURNAL_START) {
+        replay_start(replay, (const JournalStart*)record, run);
+    } else if (replay->run != run) {
+        return;
+    } else if (record->type == JOURNAL_MOVE) {
+        replay_move(replay, (const JournalMove*)record);
+    } else if (record->type == JOURNAL_END) {
+        replay_end(replay, (const JournalEnd*)record);
+    }
+
+    return;
+}
+
+/**
+ * @brief Reads the records of the segment in order. A record with the length 0 ends the segment, and a
+ * record with the type JOURNAL_SKIP, which was not written completely, is stepped over.
+ * @param segment Segment.
+ * @param statistics Statistics.
+ * @param replay Replay, NULL to only collect the statistics.
+ * @return void
+ */
+static void read_segment(const Segment* segment, Statistics* statistics, Replay* replay) {
+    const JournalSegmentHeader* header = (const JournalSegmentHeader*)segment->data;
+    size_t offset = header->header_size;
+
+    statistics->segments++;
+
+    while (offset + sizeof(JournalRecord) <= segment->size) {
+        const JournalRecord* record = (const JournalRecord*)(segment->data + offset);
+        if (record->length == 0) {
+            break;
+        }
+
+        if (record->length < sizeof(JournalRecord) || record->length > segment->size - offset) {
+            printf("ERROR: %s: invalid record at offset %zu\n", segment->path, offset);
+            break;
+        }
+
+        if (record->type == JOURNAL_SKIP) {
+            statistics->skipped++;
+            offset += record->length;
+            continue;
+        }
+
+        count_record(statistics, record);
+
+        if (replay != NULL) {
+            replay_record(replay, record, header->run);
+        }
+
+        offset += record->length;
+    }
+
+    return;
+}
+
+/**
+ * @brief Prints the statistics of the finished sessions by the board size.
+ * @param statistics Statistics.
+ * @param elapsed Time of reading the journal in nanoseconds.
+ * @return void
+ */
+static void print_statistics(const Statistics* statistics, uint64_t elapsed) {
+    double seconds = (double)elapsed / 1e9;
+
+    printf("Segments: %llu, records: %llu (%.1f MB), read in %.3f s (%.0f records/s)\n",
+           (unsigned long long)statistics->segments, (unsigned long long)statistics->records,
+           (double)statistics->bytes / 1e6, seconds, seconds > 0 ? (double)statistics->records / seconds : 0);
+    printf("Games started: %llu, moves: %llu, incomplete records: %llu\n\n",
+           (unsigned long long)statistics->starts, (unsigned long long)statistics->moves,
+           (unsigned long long)statistics->skipped);
+    printf("%5s %10s %10s %10s %10s %10s %9s %11s %10s %13s\n", "size", "sessions", "won", "lost", "timeouts",
+           "closed", "win rate", "moves/game", "max moves", "duration, ms");
+
+    for (int field_size = 1; field_size <= MAX_FIELD_SIZE; ++field_size) {
+        const SizeStatistics* size = &statistics->sizes[field_size];
+        if (size->games == 0) {
+            continue;
+        }
+
+        uint64_t decided = size->won + size->lost;
+
+        printf("%5d %10llu %10llu %10llu %10llu %10llu %8.1f%% %11.1f %10llu %13.1f\n", field_size,
+               (unsigned long long)size->games, (unsigned long long)size->won, (unsigned long long)size->lost,
+               (unsigned long long)size->timeouts, (unsigned long long)size->closed,
+               decided > 0 ? 100.0 * (double)size->won / (double)decided : 0.0,
+               (double)size->moves / (double)size->games, (unsigned long long)size->max_moves,
+               (double)size->duration / (double)size->games);
+    }
+
+    return;
+}
+
+/**
+ * @brief Main function of the analyzer. Reads the journal files given on the command line and prints the
+ * statistics or the replay of one session.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return EXIT_SUCCESS if the journal was read, EXIT_FAILURE otherwise.
+ */
+int main(int argc, char* argv[]) {
+    Replay replay = {0};
+    bool replaying = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "s:")) != -1) {
+        if (opt == 's') {
+            replay.session = (uint32_t)strtoul(optarg, NULL, 10);
+            replaying = true;
+        } else {
+            optind = argc;
+            break;
+        }
+    }
+
+    if (optind >= argc) {
+        printf("Usage: %s [-s <session>] <journal files>\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int count = argc - optind;
+    Segment* segments = (Segment*)calloc(count, sizeof(Segment));
+
+    for (int i = 0; i < count; ++i) {
+        if (!open_segment(&segments[i], argv[optind + i])) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    qsort(segments, count, sizeof(Segment), compare_segments);
+
+    static Statistics statistics;
+    uint64_t started = now_ns();
+
+    for (int i = 0; i < count; ++i) {
+        read_segment(&segments[i], &statistics, replaying ? &replay : NULL);
+    }
+
+    uint64_t elapsed = now_ns() - started;
+
+    if (!replaying) {
+        print_statistics(&statistics, elapsed);
+    } else if (replay.replays == 0) {
+        printf("ERROR: session %u not found\n", replay.session);
+        return EXIT_FAILURE;
+    } else {
+        printf("Replayed %llu moves with %llu mismatches, journal read in %.3f s\n",
+               (unsigned long long)replay.moves, (unsigned long long)replay.mismatches,
+               (double)elapsed / 1e9);
+    }
+
+    for (int i = 0; i < count; ++i) {
+        munmap((void*)segments[i].data, segments[i].size);
+    }
+
+    free(segments);
+    destroy_game_board(replay.board);
+
+    return replay.mismatches == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
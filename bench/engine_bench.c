@@ -0,0 +1,297 @@
+/*! @file engine_bench.c
+File with the micro-benchmarks of the game engine. The benchmarks call the engine directly, without
+sockets, and measure the ship placement, the processing of the moves, and full simulated games for every
+board size. On the large boards, which are sparse, only the ship placement is measured. The auto-solver of
+the client plays full games against the engine, and its decisions per second, moves per game and wins are
+measured for every board size. Every benchmark runs for BENCH_DURATION_NS nanoseconds.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../client/solver.h"
+#include "../engine/engine.h"
+
+#define BENCH_DURATION_NS 300000000ULL
+#define BENCH_BATCH 64
+#define SHOT_ORDERS 16
+
+/**
+ * @brief Sizes of the game board to measure.
+ */
+static const int field_sizes[] = {5, 8, 10, 12, 16, 20};
+
+/**
+ * @brief Sizes of the large game boards, only the ship placement is measured on them.
+ */
+static const int large_field_sizes[] = {100, 1000, 4000, MAX_FIELD_SIZE};
+
+/**
+ * @brief Number of ships and missed moves of the large game boards.
+ */
+#define LARGE_BOARD_SHIPS 1000
+#define LARGE_BOARD_MOVES 10000
+
+/**
+ * @brief Divisors of the maximum number of ships allowed by the server configuration check.
+ */
+static const int ship_densities[] = {4, 1};
+
+/**
+ * @brief Sink for the results of the engine, so the compiler keeps the measured calls.
+ */
+static volatile int sink;
+
+/**
+ * @brief Returns the monotonic time.
+ * @return Time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Returns the rules measured for the board size. The number of ships is a part of the maximum
+ * allowed by the server configuration check, and half of the cells can be missed before the game is lost.
+ * @param field_size Size of the game board.
+ * @param density Divisor of the maximum number of ships.
+ * @return Rules of the game.
+ */
+static GameRules bench_rules(int field_size, int density) {
+    int lattice = (field_size + 1) / 2;
+    int number_of_ships = lattice * lattice / density;
+
+    GameRules rules = {field_size, number_of_ships > 0 ? number_of_ships : 1, field_size * field_size / 2};
+    return rules;
+}
+
+/**
+ * @brief Measures the ship placement.
+ * @param game Game context.
+ * @return Number of placed boards per second.
+ */
+static double bench_placement(GameContext* game) {
+    uint64_t started = now_ns(), elapsed = 0, boards = 0, seed = 1;
+
+    while (elapsed < BENCH_DURATION_NS) {
+        for (int i = 0; i < BENCH_BATCH; ++i) {
+            start_game(game, seed++);
+        }
+
+        boards += BENCH_BATCH;
+        elapsed = now_ns() - started;
+    }
+
+    return (double)boards * 1e9 / (double)elapsed;
+}
+
+/**
+ * @brief Measures the processing of the moves. Every round restores the board with the placed ships and
+ * shoots at every cell once.
+ * @param game Game context.
+ * @return Number of processed moves per second.
+ */
+static double bench_moves(GameContext* game) {
+    int field_size = game->rules->field_size, cells = field_size * field_size;
+    size_t board_size = board_memory_size(game->board);
+
+    start_game(game, 1);
+
+    GameBoard* placed = (GameBoard*)malloc(board_size);
+    memcpy(placed, game->board, board_size);
+
+    uint64_t started = now_ns(), elapsed = 0, moves = 0;
+
+    while (elapsed < BENCH_DURATION_NS) {
+        for (int i = 0; i < BENCH_BATCH; ++i) {
+            memcpy(game->board, placed, board_size);
+            game->number_of_ships = game->rules->number_of_ships;
+            game->number_of_moves = 0;
+
+            for (int cell = 0; cell < cells; ++cell) {
+                sink += process_player_move(game, cell % field_size, cell / field_size);
+            }
+        }
+
+        moves += (uint64_t)BENCH_BATCH * cells;
+        elapsed = now_ns() - started;
+    }
+
+    free(placed);
+
+    return (double)moves * 1e9 / (double)elapsed;
+}
+
+/**
+ * @brief Measures full games. Every game places the ships and shoots in one of SHOT_ORDERS random orders
+ * until the game is over. The orders are prepared in advance, so only the engine is measured.
+ * @param game Game context.
+ * @return Number of games per second.
+ */
+static double bench_games(GameContext* game) {
+    int cells = game->rules->field_size * game->rules->field_size;
+    int* orders = (int*)malloc(SHOT_ORDERS * cells * sizeof(int));
+    unsigned int seed = 1;
+
+    for (int order = 0; order < SHOT_ORDERS; ++order) {
+        int* shots = orders + order * cells;
+
+        for (int cell = 0; cell < cells; ++cell) {
+            shots[cell] = cell;
+        }
+
+        for (int i = cells - 1; i > 0; --i) {
+            int j = rand_r(&seed) % (i + 1), shot = shots[i];
+            shots[i] = shots[j];
+            shots[j] = shot;
+        }
+    }
+
+    uint64_t started = now_ns(), elapsed = 0, games = 0, board_seed = 1;
+
+    while (elapsed < BENCH_DURATION_NS) {
+        for (int i = 0; i < BENCH_BATCH; ++i) {
+            const int* shots = orders + (games + i) % SHOT_ORDERS * cells;
+            start_game(game, board_seed++);
+
+            for (int shot = 0; shot < cells && check_game_status(game) == NEXT; ++shot) {
+                sink += process_player_move(game, shots[shot] % game->rules->field_size,
+                                            shots[shot] / game->rules->field_size);
+            }
+        }
+
+        games += BENCH_BATCH;
+        elapsed = now_ns() - started;
+    }
+
+    free(orders);
+
+    return (double)games * 1e9 / (double)elapsed;
+}
+
+/**
+ * @struct SolverResult
+ * @brief Structure for the results of the auto-solver on one board size.
+ *
+ * @param decisions Number of shots picked per second.
+ * @param moves Average number of moves of a game.
+ * @param wins Part of the games that were won.
+ */
+typedef struct {
+    double decisions;
+    double moves;
+    double wins;
+} SolverResult;
+
+/**
+ * @brief Measures the auto-solver. Every game places the ships and lets the solver shoot until the game is
+ * over, so the time of the engine is included, but it is small next to the time of the solver.
+ * @param game Game context.
+ * @return Results of the solver.
+ */
+static SolverResult bench_solver(GameContext* game) {
+    SolverResult result = {0, 0, 0};
+    Solver solver;
+    Rng rng;
+
+    if (!solver_init(&solver, game->rules->field_size)) {
+        return result;
+    }
+
+    rng_seed(&rng, 1);
+
+    uint64_t started = now_ns(), elapsed = 0, games = 0, moves = 0, wins = 0, board_seed = 1;
+
+    while (elapsed < BENCH_DURATION_NS) {
+        start_game(game, board_seed++);
+        solver_reset(&solver);
+
+        int x, y;
+        while (check_game_status(game) == NEXT && solver_next(&solver, &rng, &x, &y)) {
+            solver_mark(&solver, x, y, process_player_move(game, x, y));
+            moves++;
+        }
+
+        wins += check_game_status(game) == WIN ? 1 : 0;
+        games++;
+        elapsed = now_ns() - started;
+    }
+
+    solver_free(&solver);
+
+    result.decisions = (double)moves * 1e9 / (double)elapsed;
+    result.moves = (double)moves / (double)games;
+    result.wins = (double)wins * 100.0 / (double)games;
+
+    return result;
+}
+
+/**
+ * @brief Main function of the benchmark. Runs the benchmarks for every board size and prints a table of
+ * the results.
+ * @return EXIT_SUCCESS.
+ */
+int main(void) {
+    printf("%5s %5s %14s %14s %14s\n", "field", "ships", "placements/s", "moves/s", "games/s");
+
+    for (int d = 0; d < (int)(sizeof(ship_densities) / sizeof(ship_densities[0])); ++d) {
+        for (int i = 0; i < (int)(sizeof(field_sizes) / sizeof(field_sizes[0])); ++i) {
+            GameRules rules = bench_rules(field_sizes[i], ship_densities[d]);
+            GameBoard* board = create_game_board(rules.field_size, max_marked_cells(&rules));
+            GameContext game;
+
+            init_game_context(&game, &rules, board);
+
+            double placements = bench_placement(&game);
+            double moves = bench_moves(&game);
+            double games = bench_games(&game);
+
+            printf("%5d %5d %14.0f %14.0f %14.0f\n", rules.field_size, rules.number_of_ships, placements,
+                   moves, games);
+
+            destroy_game_board(board);
+        }
+    }
+
+    printf("\n%5s %5s %5s %14s %14s %8s\n", "field", "ships", "moves", "decisions/s", "moves/game", "won %");
+
+    for (int d = 0; d < (int)(sizeof(ship_densities) / sizeof(ship_densities[0])); ++d) {
+        for (int i = 0; i < (int)(sizeof(field_sizes) / sizeof(field_sizes[0])); ++i) {
+            GameRules rules = bench_rules(field_sizes[i], ship_densities[d]);
+            GameBoard* board = create_game_board(rules.field_size, max_marked_cells(&rules));
+            GameContext game;
+
+            init_game_context(&game, &rules, board);
+
+            SolverResult solver = bench_solver(&game);
+
+            printf("%5d %5d %5d %14.0f %14.1f %8.1f\n", rules.field_size, rules.number_of_ships,
+                   rules.number_of_moves, solver.decisions, solver.moves, solver.wins);
+
+            destroy_game_board(board);
+        }
+    }
+
+    printf("\n%5s %5s %14s %14s\n", "field", "ships", "placements/s", "board bytes");
+
+    for (int i = 0; i < (int)(sizeof(large_field_sizes) / sizeof(large_field_sizes[0])); ++i) {
+        GameRules rules = {large_field_sizes[i], LARGE_BOARD_SHIPS, LARGE_BOARD_MOVES};
+        GameBoard* board = create_game_board(rules.field_size, max_marked_cells(&rules));
+        GameContext game;
+
+        init_game_context(&game, &rules, board);
+
+        printf("%5d %5d %14.0f %14zu\n", rules.field_size, rules.number_of_ships, bench_placement(&game),
+               board_memory_size(board));
+
+        destroy_game_board(board);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -1,23 +1,60 @@
 /*! @file client.c
 File implementing the client side of the battleship game.
 The client connects to the server, sends the player's name, and then plays the game.
-The player is prompted to enter a move, which is then sent to the server.
-The game board is displayed after each move, showing the player's hits and misses.
+The player is prompted to enter a move, which is then sent to the server, or the auto-solver picks the
+moves.
+The game board is displayed after each move, showing the player's hits and misses; only the changed
+characters of the screen are written.
 The game continues until all ships have been sunk or the server disconnects.
+A spectator watches the game of another player instead of playing.
+A client on the same host connects to the local socket of the server and may offer a shared-memory channel,
+which then carries the frames instead of the socket.
 @author Gavrish A.A.
 @date 13.04.2024 */
 
 #include <arpa/inet.h>
 #include <ctype.h>
+#include <errno.h>
 #include <getopt.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <time.h>
 #include <unistd.h>
 
+#include "../shared/channel.h"
+#include "../shared/protocol.h"
 #include "../shared/shared.h"
+#include "loadgen.h"
+#include "render.h"
+#include "solver.h"
+
+#define MAX_PIPELINE_DEPTH 1024
+#define MAX_DISPLAYED_FIELD_SIZE 64
+#define MAX_FRAME_COLUMNS (3 + MAX_DISPLAYED_FIELD_SIZE * (MAX_COLUMN_LETTERS + 1))
+#define FRAME_INFO_ROWS 10
+
+/**
+ * @struct MovePipeline
+ * @brief Structure for the moves of the script that were sent and wait for their results, in the order they
+ * were sent, and for the sizes of their batch frames.
+ *
+ * @param moves The coordinates of the moves.
+ * @param texts The moves in the format of the legacy protocol.
+ * @param batches The number of moves of every batch frame.
+ * @param count The number of moves in flight.
+ * @param batch_count The number of batch frames in flight.
+ */
+typedef struct {
+    Move moves[MAX_PIPELINE_DEPTH];
+    char texts[MAX_PIPELINE_DEPTH][BUF_MESSAGE_SIZE];
+    int batches[MAX_PIPELINE_DEPTH];
+    int count;
+    int batch_count;
+} MovePipeline;
 
 /**
  * @brief Configuration structure for the client.
@@ -26,6 +63,12 @@ The game continues until all ships have been sunk or the server disconnects.
  */
 ClientConfig config;
 
+void parse_protocol(void* value, const char* str);
+void parse_strategy(void* value, const char* str);
+void parse_output_format(void* value, const char* str);
+void parse_token(void* value, const char* str);
+void parse_transport(void* value, const char* str);
+
 /**
  * @brief Configuration options for the client.
  *
@@ -35,14 +78,72 @@ ConfigOption options[] = {
     {"h", &config.server_address, parse_string},
     {"p", &config.server_port, parse_int},
     {"n", &config.client_name, parse_string},
+    {"m", &config.protocol, parse_protocol},
+    {"s", &config.move_script, parse_string},
+    {"d", &config.pipeline_depth, parse_int},
+    {"l", &config.load_connections, parse_int},
+    {"g", &config.load_games, parse_int},
+    {"S", &config.strategy, parse_strategy},
+    {"o", &config.output_format, parse_output_format},
+    {"r", &config.resume_token, parse_token},
+    {"a", &config.auto_games, parse_int},
+    {"w", &config.watched_player, parse_string},
+    {"u", &config.local_socket, parse_string},
+    {"x", &config.transport, parse_transport},
 };
 
-char** playing_field;
+GameBoard* playing_field;
+
+/**
+ * @brief Reader of the frames received from the server.
+ */
+FrameReader reader;
+
+/**
+ * @brief Resume token of the game, 0 if the game cannot be resumed.
+ */
+uint64_t game_token;
+
+/**
+ * @brief Whether the server can start the next game on the connection.
+ */
+bool keep_alive;
+
+/**
+ * @brief Number of ships of the current game. In the legacy protocol the game is won when all of them are hit.
+ */
+int game_ships;
+
+/**
+ * @brief Auto-solver of the game, its bitboards are NULL when the player enters the moves.
+ */
+Solver solver;
+
+/**
+ * @brief Shared-memory channel of the connection, its memory is NULL if the frames go through the socket.
+ */
+Channel channel;
 
-void display_game_status(char** playing_field, int field_size, char* prev_move, char* answer, int ships_left);
+void display_game_status(GameBoard* playing_field, int field_size, char* prev_move, char* answer, int ships_left);
 void init_configuration(int argc, char* argv[]);
 void send_player_name(int client_socket, char* name);
+bool receive_game_parameters(int client_socket, int* field_size, int* number_of_ships, int* max_marked);
+bool receive_game_state(int client_socket);
+void print_resume_hint(void);
+bool ask_for_rematch(void);
+bool start_rematch(int client_socket, int* field_size, int* number_of_ships, int* max_marked);
+bool run_auto_play(int client_socket, int* field_size, int* number_of_ships, int* max_marked);
+bool run_watch(int client_socket, int field_size, int number_of_ships);
+bool play_move(int client_socket, char* move, int x, int y, char* answer, GameStatus* game_status);
+bool run_move_script(int client_socket, GameStatus* game_status);
+int read_script_moves(FILE* script, Move* moves, char (*texts)[BUF_MESSAGE_SIZE], int depth);
+bool stream_move_script(int client_socket, FILE* script, GameStatus* game_status);
+bool send_move_batches(int client_socket, MovePipeline* pipeline, int first);
+bool receive_move_batch(int client_socket, MovePipeline* pipeline, GameStatus* game_status);
+void mark_move_result(int x, int y, MoveResult result);
+GameStatus parse_game_status(const char* message);
 void connect_to_server(int* client_socket);
+void open_channel(int client_socket);
 bool make_move(char* move);
 
 /**
@@ -53,46 +154,162 @@ bool make_move(char* move);
  * @return EXIT_SUCCESS if the program exits successfully, EXIT_FAILURE otherwise.
  */
 int main(int argc, char* argv[]) {
+    config.pipeline_depth = 1;
     init_configuration(argc, argv);
 
-    int client_socket = socket(AF_INET, SOCK_STREAM, 0);
+    if (config.pipeline_depth < 1 || config.pipeline_depth > MAX_PIPELINE_DEPTH) {
+        printf("ERROR: pipeline depth must be from 1 to %d\n", MAX_PIPELINE_DEPTH);
+        return EXIT_FAILURE;
+    }
+
+    if (config.auto_games < 0 || (config.auto_games > 0 && config.move_script[0] != '\0')) {
+        printf("ERROR: number of auto-played games must be positive and cannot be used with a script\n");
+        return EXIT_FAILURE;
+    }
+
+    if (config.load_connections < 0 || config.load_games < 0) {
+        printf("ERROR: number of connections and games must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    if (config.transport == TRANSPORT_CHANNEL &&
+        (config.local_socket[0] == '\0' || config.protocol != PROTOCOL_BINARY)) {
+        printf("ERROR: the shared-memory channel needs the local socket and the binary protocol\n");
+        return EXIT_FAILURE;
+    }
+
+    if (config.load_connections > 0) {
+        if (config.load_games == 0) {
+            config.load_games = config.load_connections;
+        }
+
+        return run_load_generator();
+    }
+
+    if (config.resume_token != 0 && config.protocol != PROTOCOL_BINARY) {
+        printf("ERROR: only the games of the binary protocol can be resumed\n");
+        return EXIT_FAILURE;
+    }
+
+    bool watching = config.watched_player[0] != '\0' ? true : false;
+    if (watching && (config.protocol != PROTOCOL_BINARY || config.resume_token != 0 ||
+                     config.move_script[0] != '\0' || config.auto_games > 0)) {
+        printf("ERROR: only the binary protocol can watch, without a token, a script or auto-play\n");
+        return EXIT_FAILURE;
+    }
+
+    int client_socket;
     connect_to_server(&client_socket);
 
     send_player_name(client_socket, config.client_name);
 
-    char buffer[BUF_MESSAGE_SIZE];
-    recv(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
+    int field_size, global_number_of_ships, max_marked;
+    if (!receive_game_parameters(client_socket, &field_size, &global_number_of_ships, &max_marked)) {
+        close(client_socket);
+        return EXIT_FAILURE;
+    }
 
-    int field_size, global_number_of_ships;
-    sscanf(buffer, "f=%d,n=%d", &field_size, &global_number_of_ships);
-    create_game_board(&playing_field, field_size);
+    playing_field = create_game_board(field_size, max_marked);
 
-    int local_numbers_of_ships = 0;
-    char prev_move[BUF_MESSAGE_SIZE], answer[BUF_MESSAGE_SIZE];
+    if (watching) {
+        bool watched = run_watch(client_socket, field_size, global_number_of_ships);
 
-    while (client_socket) {
-        display_game_status(playing_field, field_size, prev_move, answer,
-                            global_number_of_ships - local_numbers_of_ships);
+        destroy_game_board(playing_field);
+        close(client_socket);
 
-        if (make_move(buffer)) {
-            continue;
+        return watched ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (config.resume_token != 0 && !receive_game_state(client_socket)) {
+        destroy_game_board(playing_field);
+        close(client_socket);
+        return EXIT_FAILURE;
+    }
+
+    char buffer[BUF_MESSAGE_SIZE], prev_move[BUF_MESSAGE_SIZE] = "", answer[BUF_MESSAGE_SIZE] = "";
+    GameStatus game_status = NEXT;
+
+    if (config.move_script[0] != '\0') {
+        bool played = run_move_script(client_socket, &game_status);
+
+        if (game_status == NEXT) {
+            print_resume_hint();
         }
 
-        strcpy(prev_move, buffer);
-        send(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
+        destroy_game_board(playing_field);
+        shutdown(client_socket, SHUT_RDWR);
+        close(client_socket);
 
-        recv(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
-        strcpy(answer, buffer);
+        return played ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    if (config.auto_games > 0) {
+        bool played = run_auto_play(client_socket, &field_size, &global_number_of_ships, &max_marked);
 
-        if (strcmp(answer, "Miss") == 0) {
-            playing_field[atoi(&prev_move[1]) - 1][prev_move[0] - 'A'] = '.';
-        } else if (strcmp(answer, "Hit") == 0) {
-            playing_field[atoi(&prev_move[1]) - 1][prev_move[0] - 'A'] = 'X';
-            local_numbers_of_ships++;
+        if (played && keep_alive) {
+            send_all(client_socket, buffer, encode_empty(buffer, OP_QUIT));
         }
+
+        destroy_game_board(playing_field);
+        shutdown(client_socket, SHUT_RDWR);
+        close(client_socket);
+
+        return played ? EXIT_SUCCESS : EXIT_FAILURE;
     }
 
-    destroy_game_board(&playing_field, field_size);
+    int frame_rows = (field_size <= MAX_DISPLAYED_FIELD_SIZE ? field_size + 3 : 0) + FRAME_INFO_ROWS;
+    render_init(frame_rows, MAX_FRAME_COLUMNS);
+
+    while (true) {
+        while (game_status == NEXT) {
+            display_game_status(playing_field, field_size, prev_move, answer,
+                                global_number_of_ships - board_count_hits(playing_field));
+
+            if (make_move(buffer)) {
+                continue;
+            }
+
+            strcpy(prev_move, buffer);
+
+            int x, y;
+            if (!parse_move(buffer, &x, &y)) {
+                strcpy(answer, move_result_message(MOVE_INVALID));
+                continue;
+            }
+
+            if (!play_move(client_socket, buffer, x, y, answer, &game_status)) {
+                printf("\nERROR: connection to the server is lost\n");
+                print_resume_hint();
+                break;
+            }
+        }
+
+        if (game_status == NEXT) {
+            break;
+        }
+
+        display_game_status(playing_field, field_size, prev_move, answer,
+                            global_number_of_ships - board_count_hits(playing_field));
+        printf("\n%s\n", game_status == WIN ? "You win" : "You lose");
+
+        if (!keep_alive || !ask_for_rematch() ||
+            !start_rematch(client_socket, &field_size, &global_number_of_ships, &max_marked)) {
+            break;
+        }
+
+        prev_move[0] = '\0';
+        answer[0] = '\0';
+        game_status = NEXT;
+        render_reset();
+    }
+
+    if (keep_alive && game_status != NEXT) {
+        char frame[FRAME_HEADER_SIZE];
+        send_all(client_socket, frame, encode_empty(frame, OP_QUIT));
+    }
+
+    render_free();
+    destroy_game_board(playing_field);
     shutdown(client_socket, SHUT_RDWR);
     close(client_socket);
 
@@ -101,7 +318,9 @@ int main(int argc, char* argv[]) {
 
 /**
  * @brief Displays the current game status. This includes the game board, the last move, the result of the
- * last move, and the number of ships left.
+ * last move, and the number of ships left. The columns are as wide as the label of the last column, and
+ * the boards larger than MAX_DISPLAYED_FIELD_SIZE are not displayed. The status is composed in the frame
+ * of the renderer, which writes only the cells that changed since the previous move.
  * @param playing_field The game board.
  * @param field_size The size of the game board.
  * @param prev_move The last move made by the player.
@@ -109,56 +328,77 @@ int main(int argc, char* argv[]) {
  * @param ships_left The number of ships left on the game board.
  * @return void
  */
-void display_game_status(char** playing_field, int field_size, char* prev_move, char* answer,
+void display_game_status(GameBoard* playing_field, int field_size, char* prev_move, char* answer,
                          int ships_left) {
-    printf("\033[H\033[J");
+    render_clear();
 
-    int field_width = field_size * 2;
+    bool displayed = field_size <= MAX_DISPLAYED_FIELD_SIZE ? true : false;
+    char label[MAX_COLUMN_LETTERS + 1], line[MAX_FRAME_COLUMNS + 1];
+    int width = format_column(label, field_size - 1);
     int title_length = strlen("BATTLESHIP");
+    int field_width = displayed ? field_size * (width + 1) : title_length;
     int padding = (field_width - title_length) / 2;
+    int row = 0;
 
-    for (int i = 0; i < padding; i++) {
-        printf("=");
-    }
-
-    printf(" BATTLESHIP ");
+    memset(line, '=', padding);
+    snprintf(line + padding, sizeof(line) - padding, " BATTLESHIP ");
+    memset(line + padding + title_length + 2, '=', padding);
+    line[2 * padding + title_length + 2] = '\0';
+    render_text(row, 0, line);
+    row += 2;
 
-    for (int i = 0; i < padding; i++) {
-        printf("=");
-    }
-
-    printf("\n\n");
-    printf("   ");
+    if (displayed) {
+        for (int i = 0; i < field_size; ++i) {
+            format_column(label, i);
+            snprintf(line + i * (width + 1), sizeof(line) - i * (width + 1), "%*s ", width, label);
+        }
 
-    for (int i = 0; i < field_size; ++i) {
-        printf("%c ", 'A' + i);
-    }
+        render_text(row++, 3, line);
 
-    printf("\n");
+        for (int i = 0; i < field_size; ++i) {
+            int length = snprintf(line, sizeof(line), "%2d ", i + 1);
 
-    for (int i = 0; i < field_size; ++i) {
-        printf("%2d ", i + 1);
+            for (int j = 0; j < field_size; ++j) {
+                length += snprintf(line + length, sizeof(line) - length, "%*c ", width,
+                                   board_cell_symbol(board_get_cell(playing_field, j, i)));
+            }
 
-        for (int j = 0; j < field_size; ++j) {
-            printf("%c ", playing_field[i][j]);
+            render_text(row++, 0, line);
         }
 
-        printf("\n");
+        row++;
     }
 
-    printf("\n");
+    memset(line, '=', field_width + 2);
+    line[field_width + 2] = '\0';
+    render_text(row, 0, line);
+    row += 2;
 
-    for (int i = 0; i < field_size * 2 + 2; ++i) {
-        printf("=");
+    render_text(row++, 0, "| GAME INFO");
+    if (!displayed) {
+        format_column(label, field_size - 1);
+        snprintf(line, sizeof(line), "| Board: %dx%d, columns A-%s, rows 1-%d", field_size, field_size, label,
+                 field_size);
+        render_text(row++, 0, line);
     }
-    printf("\n\n");
-
-    printf("| GAME INFO\n");
     if (prev_move[0] != '\0' && answer[0] != '\0') {
-        printf("| Last move: %s - %s\n", prev_move, answer);
+        snprintf(line, sizeof(line), "| Last move: %s - %s", prev_move, answer);
+        render_text(row++, 0, line);
+    }
+    snprintf(line, sizeof(line), "| Ships left: %d", ships_left);
+    render_text(row++, 0, line);
+    if (game_token != 0) {
+        snprintf(line, sizeof(line), "| Resume token: %llx", (unsigned long long)game_token);
+        render_text(row++, 0, line);
+    }
+    if (config.watched_player[0] != '\0') {
+        snprintf(line, sizeof(line), "| Watching %s", config.watched_player);
+        render_text(row, 0, line);
+        render_flush(row, strlen(line));
+    } else {
+        render_text(row, 0, "| Enter your move: ");
+        render_flush(row, strlen("| Enter your move: "));
     }
-    printf("| Ships left: %d\n", ships_left);
-    printf("| Enter your move: ");
 
     return;
 }
@@ -173,7 +413,7 @@ void display_game_status(char** playing_field, int field_size, char* prev_move,
  */
 void init_configuration(int argc, char* argv[]) {
     int opt;
-    while ((opt = getopt(argc, argv, "h:p:n:")) != -1) {
+    while ((opt = getopt(argc, argv, "h:p:n:m:s:d:l:g:S:o:r:a:w:u:x:")) != -1) {
         for (int i = 0; i < (int)(sizeof(options) / sizeof(ConfigOption)); ++i) {
             if (options[i].key[0] == opt) {
                 options[i].parse(options[i].value, optarg);
@@ -186,23 +426,688 @@ void init_configuration(int argc, char* argv[]) {
 }
 
 /**
- * @brief Sends the player's name to the server. The player's name is sent as a message to the server.
+ * @brief Function to parse the protocol offered to the server. The protocol is "binary" or "ascii".
+ * @param value Pointer to the variable where the protocol will be stored.
+ * @param str String containing the protocol.
+ * @return void
+ * @see Protocol
+ */
+void parse_protocol(void* value, const char* str) {
+    if (strcmp(str, "binary") == 0) {
+        *(Protocol*)value = PROTOCOL_BINARY;
+    } else if (strcmp(str, "ascii") == 0) {
+        *(Protocol*)value = PROTOCOL_ASCII;
+    } else {
+        printf("ERROR: invalid protocol\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Function to parse the shot strategy of the load generator. The strategy is "sequential", "random",
+ * "parity" or "density".
+ * @param value Pointer to the variable where the strategy will be stored.
+ * @param str String containing the strategy.
+ * @return void
+ * @see ShotStrategy
+ */
+void parse_strategy(void* value, const char* str) {
+    if (strcmp(str, "sequential") == 0) {
+        *(ShotStrategy*)value = STRATEGY_SEQUENTIAL;
+    } else if (strcmp(str, "random") == 0) {
+        *(ShotStrategy*)value = STRATEGY_RANDOM;
+    } else if (strcmp(str, "parity") == 0) {
+        *(ShotStrategy*)value = STRATEGY_PARITY;
+    } else if (strcmp(str, "density") == 0) {
+        *(ShotStrategy*)value = STRATEGY_DENSITY;
+    } else {
+        printf("ERROR: invalid strategy\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Function to parse the format of the report of the load generator. The format is "text" or "json".
+ * @param value Pointer to the variable where the format will be stored.
+ * @param str String containing the format.
+ * @return void
+ * @see OutputFormat
+ */
+void parse_output_format(void* value, const char* str) {
+    if (strcmp(str, "text") == 0) {
+        *(OutputFormat*)value = OUTPUT_TEXT;
+    } else if (strcmp(str, "json") == 0) {
+        *(OutputFormat*)value = OUTPUT_JSON;
+    } else {
+        printf("ERROR: invalid output format\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Function to parse the resume token, printed by the client as a hexadecimal number.
+ * @param value Pointer to the variable where the token will be stored.
+ * @param str String containing the token.
+ * @return void
+ */
+void parse_token(void* value, const char* str) {
+    char* end;
+    *(uint64_t*)value = strtoull(str, &end, 16);
+
+    if (*str == '\0' || *end != '\0' || *(uint64_t*)value == 0) {
+        printf("ERROR: invalid resume token\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Function to parse the transport of the frames on the local socket. The transport is "socket" or
+ * "shm".
+ * @param value Pointer to the variable where the transport will be stored.
+ * @param str String containing the transport.
+ * @return void
+ * @see Transport
+ */
+void parse_transport(void* value, const char* str) {
+    if (strcmp(str, "socket") == 0) {
+        *(Transport*)value = TRANSPORT_SOCKET;
+    } else if (strcmp(str, "shm") == 0) {
+        *(Transport*)value = TRANSPORT_CHANNEL;
+    } else {
+        printf("ERROR: invalid transport\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Sends the player's name to the server. In the binary protocol the name is sent in the hello
+ * frame, in the legacy protocol the name is sent as a message. A resumed game sends the resume frame with
+ * the token instead of the name, and a spectator sends the watch frame with the name of the watched player.
  * @param client_socket The client's socket.
  * @param name The player's name.
  * @return void
  */
 void send_player_name(int client_socket, char* name) {
-    send(client_socket, name, BUF_MESSAGE_SIZE, 0);
+    char buffer[BUF_MESSAGE_SIZE] = {0};
+
+    if (config.resume_token != 0) {
+        encode_resume(buffer, config.resume_token);
+    } else if (config.watched_player[0] != '\0') {
+        encode_watch(buffer, config.watched_player);
+    } else if (config.protocol == PROTOCOL_BINARY) {
+        encode_hello(buffer, name);
+    } else {
+        strncpy(buffer, name, BUF_MESSAGE_SIZE - 1);
+    }
+
+    send_all(client_socket, buffer, BUF_MESSAGE_SIZE);
+    return;
+}
+
+/**
+ * @brief Receives the parameters of the game. The answer of the server also completes the negotiation of
+ * the protocol: a server that answers with a message of the legacy protocol does not speak the binary
+ * protocol, so the client continues with the legacy protocol.
+ * @param client_socket The client's socket.
+ * @param field_size The size of the game board.
+ * @param number_of_ships The number of ships.
+ * @param max_marked The maximum number of cells with a ship or a shot, 0 if the legacy protocol does not
+ * tell it.
+ * @return true if the game has started, false otherwise.
+ */
+bool receive_game_parameters(int client_socket, int* field_size, int* number_of_ships, int* max_marked) {
+    frame_reader_init(&reader);
+
+    if (frame_reader_fill(&reader, client_socket, 1) <= 0) {
+        printf("ERROR: connection to the server is lost\n");
+        return false;
+    }
+
+    if ((uint8_t)reader.buffer[0] == OP_PARAMS) {
+        Frame frame;
+        int version, number_of_moves;
+
+        if (read_frame(&reader, client_socket, &frame) <= 0 ||
+            !decode_params(&frame, &version, field_size, number_of_ships, &number_of_moves, &game_token)) {
+            printf("ERROR: invalid game parameters\n");
+            return false;
+        }
+
+        *max_marked = *number_of_ships + number_of_moves;
+        game_ships = *number_of_ships;
+        keep_alive = version >= KEEPALIVE_PROTOCOL_VERSION ? true : false;
+        config.protocol = PROTOCOL_BINARY;
+        return true;
+    }
+
+    char buffer[BUF_MESSAGE_SIZE];
+    if (read_message(&reader, client_socket, buffer) <= 0) {
+        printf("ERROR: connection to the server is lost\n");
+        return false;
+    }
+
+    if (strcmp(buffer, "Server busy") == 0) {
+        printf("ERROR: server is busy\n");
+        return false;
+    }
+
+    if (strcmp(buffer, "Unknown game") == 0) {
+        printf("ERROR: the game cannot be %s\n",
+               config.watched_player[0] != '\0' ? "watched on this server" : "resumed");
+        return false;
+    }
+
+    if (sscanf(buffer, "f=%d,n=%d", field_size, number_of_ships) != 2) {
+        printf("ERROR: invalid game parameters\n");
+        return false;
+    }
+
+    *max_marked = 0;
+    game_ships = *number_of_ships;
+    config.protocol = PROTOCOL_ASCII;
+    return true;
+}
+
+/**
+ * @brief Receives the state of the resumed game and marks its shots and hits on the game board.
+ * @param client_socket The client's socket.
+ * @return true if the state was received, false otherwise.
+ */
+bool receive_game_state(int client_socket) {
+    Frame frame;
+    int ships_left, missed;
+
+    if (read_frame(&reader, client_socket, &frame) <= 0 ||
+        !decode_state(&frame, &ships_left, &missed, playing_field)) {
+        printf("ERROR: invalid game state\n");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Prints how to resume the game after the connection was lost, if the server offered a token.
+ * @return void
+ */
+void print_resume_hint(void) {
+    if (game_token != 0) {
+        printf("The game can be resumed with -r %llx\n", (unsigned long long)game_token);
+    }
+
+    return;
+}
+
+/**
+ * @brief Asks the player whether to play the next game on the connection.
+ * @return true if the player wants to play again, false otherwise.
+ */
+bool ask_for_rematch(void) {
+    char reply[BUF_MESSAGE_SIZE];
+
+    printf("Play again? (y/n): ");
+    fflush(stdout);
+
+    if (scanf("%14s", reply) != 1) {
+        return false;
+    }
+
+    return reply[0] == 'y' || reply[0] == 'Y' ? true : false;
+}
+
+/**
+ * @brief Asks the server for the next game on the connection and receives its parameters. The game board
+ * is replaced by an empty one. A draining server closes the connection instead of starting the game.
+ * @param client_socket The client's socket.
+ * @param field_size The size of the game board.
+ * @param number_of_ships The number of ships.
+ * @param max_marked The maximum number of cells with a ship or a shot.
+ * @return true if the next game has started, false otherwise.
+ */
+bool start_rematch(int client_socket, int* field_size, int* number_of_ships, int* max_marked) {
+    char frame[FRAME_HEADER_SIZE];
+
+    if (send_all(client_socket, frame, encode_empty(frame, OP_REMATCH)) < 0 ||
+        !receive_game_parameters(client_socket, field_size, number_of_ships, max_marked)) {
+        return false;
+    }
+
+    destroy_game_board(playing_field);
+    playing_field = create_game_board(*field_size, *max_marked);
+
+    return true;
+}
+
+/**
+ * @brief Plays the games with the auto-solver instead of the prompt. Every game starts from the shots of
+ * the game board, so a resumed game goes on where it stopped, and the number of moves of every game is
+ * printed. The next game is played on the same connection while the server keeps it and games are left.
+ * @param client_socket The client's socket.
+ * @param field_size The size of the game board.
+ * @param number_of_ships The number of ships.
+ * @param max_marked The maximum number of cells with a ship or a shot.
+ * @return true if the games were played, false on error.
+ */
+bool run_auto_play(int client_socket, int* field_size, int* number_of_ships, int* max_marked) {
+    Rng rng;
+    rng_seed(&rng, (uint64_t)time(NULL) ^ (uint64_t)getpid() << 20);
+
+    for (int game = 1; game <= config.auto_games; ++game) {
+        if (game > 1 &&
+            (!keep_alive || !start_rematch(client_socket, field_size, number_of_ships, max_marked))) {
+            break;
+        }
+
+        if (!solver_init(&solver, *field_size)) {
+            printf("ERROR: auto-play supports boards of up to %d columns\n", SOLVER_MAX_FIELD_SIZE);
+            return false;
+        }
+
+        solver_load(&solver, playing_field);
+
+        GameStatus game_status = NEXT;
+        char move[BUF_MESSAGE_SIZE], answer[BUF_MESSAGE_SIZE];
+        int moves = 0, x, y;
+
+        while (game_status == NEXT && solver_next(&solver, &rng, &x, &y)) {
+            format_move(move, x, y);
+
+            if (!play_move(client_socket, move, x, y, answer, &game_status)) {
+                printf("ERROR: connection to the server is lost\n");
+                print_resume_hint();
+                solver_free(&solver);
+                return false;
+            }
+
+            moves += answer[0] != '\0' ? 1 : 0;
+        }
+
+        solver_free(&solver);
+
+        if (game_status == NEXT) {
+            printf("ERROR: the shots rule out every cell, but the game is not over\n");
+            return false;
+        }
+
+        printf("Game %d: %s in %d moves\n", game, game_status == WIN ? "You win" : "You lose", moves);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Shows the game of the watched player until the server closes the connection. Every move of the
+ * player arrives as an event frame. A new game of the player, and the current state of the game after the
+ * spectator fell behind, arrive as the game parameters followed by the state of the game.
+ * @param client_socket The client's socket.
+ * @param field_size The size of the game board.
+ * @param number_of_ships The number of ships.
+ * @return true if the game was watched until the end of the connection, false on an unexpected frame.
+ */
+bool run_watch(int client_socket, int field_size, int number_of_ships) {
+    char prev_move[BUF_MESSAGE_SIZE] = "", answer[BUF_MESSAGE_SIZE] = "";
+    int ships_left = number_of_ships, missed, version, number_of_moves;
+    Frame frame;
+    GameEvent event;
+
+    render_init((field_size <= MAX_DISPLAYED_FIELD_SIZE ? field_size + 3 : 0) + FRAME_INFO_ROWS,
+                MAX_FRAME_COLUMNS);
+
+    while (read_frame(&reader, client_socket, &frame) > 0) {
+        if (decode_event(&frame, &event)) {
+            mark_move_result(event.x, event.y, event.result);
+            format_move(prev_move, event.x, event.y);
+            snprintf(answer, BUF_MESSAGE_SIZE, "%s%s", move_result_message(event.result),
+                     event.status == NEXT ? "" : event.status == WIN ? ", won" : ", lost");
+            ships_left = event.ships_left;
+        } else if (decode_params(&frame, &version, &field_size, &number_of_ships, &number_of_moves,
+                                 &game_token)) {
+            destroy_game_board(playing_field);
+            playing_field = create_game_board(field_size, number_of_ships + number_of_moves);
+            render_free();
+            render_init((field_size <= MAX_DISPLAYED_FIELD_SIZE ? field_size + 3 : 0) + FRAME_INFO_ROWS,
+                        MAX_FRAME_COLUMNS);
+            prev_move[0] = '\0';
+            answer[0] = '\0';
+            ships_left = number_of_ships;
+            continue;
+        } else if (!decode_state(&frame, &ships_left, &missed, playing_field)) {
+            printf("\nERROR: invalid frame of the watched game\n");
+            render_free();
+            return false;
+        }
+
+        display_game_status(playing_field, field_size, prev_move, answer, ships_left);
+    }
+
+    printf("\nThe player left the game\n");
+    render_free();
+
+    return true;
+}
+
+/**
+ * @brief Sends the move to the server and receives the result. The result is marked on the game board.
+ * In the legacy protocol the status of the game is a separate message that the server sends right after
+ * the last answer. The client reads it after the hit on the last ship, and after any answer it has already
+ * received. The legacy protocol does not tell the number of moves, so the status of a lost game may arrive
+ * only after the next move was sent; it is then read instead of the result, the move is not played and its
+answer is empty.
+ * @param client_socket The client's socket.
+ * @param move The move in the format of the legacy protocol.
+ * @param x The column of the shot.
+ * @param y The row of the shot.
+ * @param answer The result of the move.
+ * @param game_status The status of the game after the move.
+ * @return true if the result was received, false if the connection was lost.
+ */
+bool play_move(int client_socket, char* move, int x, int y, char* answer, GameStatus* game_status) {
+    MoveResult result;
+
+    if (config.protocol == PROTOCOL_BINARY) {
+        char buffer[MAX_FRAME_SIZE];
+        Frame frame;
+
+        if (send_all(client_socket, buffer, encode_move(buffer, x, y)) < 0 ||
+            read_frame(&reader, client_socket, &frame) <= 0 || !decode_result(&frame, &result, game_status)) {
+            return false;
+        }
+    } else {
+        char buffer[BUF_MESSAGE_SIZE] = {0};
+        strncpy(buffer, move, BUF_MESSAGE_SIZE - 1);
+
+        if (send_all(client_socket, buffer, BUF_MESSAGE_SIZE) < 0 ||
+            read_message(&reader, client_socket, buffer) <= 0) {
+            return false;
+        }
+
+        *game_status = parse_game_status(buffer);
+        if (*game_status != NEXT) {
+            answer[0] = '\0';
+            return true;
+        }
+
+        result = parse_move_result(buffer);
+
+        bool won = result == MOVE_HIT && board_count_hits(playing_field) + 1 >= game_ships ? true : false;
+        bool pending = won || reader.length > reader.consumed ||
+                       recv(client_socket, buffer, 1, MSG_PEEK | MSG_DONTWAIT) > 0;
+        if (pending) {
+            if (read_message(&reader, client_socket, buffer) <= 0) {
+                return false;
+            }
+
+            *game_status = parse_game_status(buffer);
+        }
+    }
+
+    strcpy(answer, move_result_message(result));
+    mark_move_result(x, y, result);
+
+    return true;
+}
+
+/**
+ * @brief Marks the result of the move on the game board and for the auto-solver.
+ * @param x The column of the shot.
+ * @param y The row of the shot.
+ * @param result The result of the move.
+ * @return void
+ */
+void mark_move_result(int x, int y, MoveResult result) {
+    if (result == MOVE_MISS) {
+        board_set_shot(playing_field, x, y);
+    } else if (result == MOVE_HIT) {
+        board_set_ship(playing_field, x, y);
+        board_set_shot(playing_field, x, y);
+    }
+
+    if (solver.candidates != NULL) {
+        solver_mark(&solver, x, y, result);
+    }
+
     return;
 }
 
+/**
+ * @brief Plays the moves from the script instead of the prompt. The script is a file, or the standard input
+ * if the name of the script is "-", with one move per line. In the binary protocol up to pipeline_depth
+ * moves are in flight in batches, and the results of every batch arrive in one frame. In the legacy
+ * protocol the moves are sent one by one.
+ * @param client_socket The client's socket.
+ * @param game_status The status of the game after the last move.
+ * @return true if the script was played, false on error.
+ */
+bool run_move_script(int client_socket, GameStatus* game_status) {
+    FILE* script = strcmp(config.move_script, "-") == 0 ? stdin : fopen(config.move_script, "r");
+    if (script == NULL) {
+        printf("ERROR: move script not found\n");
+        return false;
+    }
+
+    Move moves[MAX_PIPELINE_DEPTH];
+    char texts[MAX_PIPELINE_DEPTH][BUF_MESSAGE_SIZE];
+    bool connected = true;
+
+    *game_status = NEXT;
+
+    if (config.protocol == PROTOCOL_BINARY) {
+        connected = stream_move_script(client_socket, script, game_status);
+    }
+
+    while (config.protocol != PROTOCOL_BINARY && connected && *game_status == NEXT) {
+        int count = read_script_moves(script, moves, texts, config.pipeline_depth);
+        if (count == 0) {
+            break;
+        }
+
+        for (int i = 0; i < count && connected && *game_status == NEXT; ++i) {
+            char answer[BUF_MESSAGE_SIZE];
+            connected = play_move(client_socket, texts[i], moves[i].x, moves[i].y, answer, game_status);
+
+            if (connected && answer[0] != '\0') {
+                printf("%s - %s\n", texts[i], answer);
+            }
+        }
+    }
+
+    if (script != stdin) {
+        fclose(script);
+    }
+
+    if (!connected) {
+        printf("ERROR: connection to the server is lost\n");
+        return false;
+    }
+
+    if (*game_status != NEXT) {
+        printf("%s\n", *game_status == WIN ? "You win" : "You lose");
+    }
+
+    return true;
+}
+
+/**
+ * @brief Reads the next moves from the script. The moves with an invalid format are reported and skipped.
+ * @param script The script.
+ * @param moves The coordinates of the moves.
+ * @param texts The moves in the format of the legacy protocol.
+ * @param depth The maximum number of moves to read.
+ * @return The number of moves read, 0 at the end of the script.
+ */
+int read_script_moves(FILE* script, Move* moves, char (*texts)[BUF_MESSAGE_SIZE], int depth) {
+    int count = 0;
+
+    while (count < depth && fscanf(script, "%14s", texts[count]) == 1) {
+        for (int i = 0; texts[count][i]; i++) {
+            texts[count][i] = toupper((unsigned char)texts[count][i]);
+        }
+
+        if (!parse_move(texts[count], &moves[count].x, &moves[count].y)) {
+            printf("%s - %s\n", texts[count], move_result_message(MOVE_INVALID));
+            continue;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Streams the moves of the script in the binary protocol. Up to pipeline_depth moves are in flight:
+ * the first moves are sent at once, and every frame of results makes room for the next moves of the script,
+ * which are sent before the next results are awaited. The server stops processing the moves at the end of
+ * the game and drops the rest, so the results of the moves in flight are not expected then.
+ * @param client_socket The client's socket.
+ * @param script The script.
+ * @param game_status The status of the game after the last processed move.
+ * @return true if the results were received, false if the connection was lost.
+ */
+bool stream_move_script(int client_socket, FILE* script, GameStatus* game_status) {
+    MovePipeline pipeline;
+    bool script_end = false;
+
+    pipeline.count = 0;
+    pipeline.batch_count = 0;
+
+    while (*game_status == NEXT) {
+        if (!script_end && pipeline.count < config.pipeline_depth) {
+            int first = pipeline.count;
+            int count = read_script_moves(script, pipeline.moves + first, pipeline.texts + first,
+                                          config.pipeline_depth - first);
+
+            script_end = count < config.pipeline_depth - first ? true : false;
+            pipeline.count += count;
+
+            if (count > 0 && !send_move_batches(client_socket, &pipeline, first)) {
+                return false;
+            }
+        }
+
+        if (pipeline.count == 0) {
+            break;
+        }
+
+        if (!receive_move_batch(client_socket, &pipeline, game_status)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Sends the new moves of the pipeline in batches of up to MAX_BATCH_MOVES moves with one write.
+ * @param client_socket The client's socket.
+ * @param pipeline The moves in flight.
+ * @param first The index of the first move that was not sent yet.
+ * @return true if the moves were sent, false if the connection was lost.
+ */
+bool send_move_batches(int client_socket, MovePipeline* pipeline, int first) {
+    char buffer[(MAX_PIPELINE_DEPTH / MAX_BATCH_MOVES + 1) * MAX_FRAME_SIZE];
+    size_t size = 0;
+
+    for (int offset = first; offset < pipeline->count; offset += MAX_BATCH_MOVES) {
+        int batch = pipeline->count - offset < MAX_BATCH_MOVES ? pipeline->count - offset : MAX_BATCH_MOVES;
+
+        size += encode_move_batch(buffer + size, pipeline->moves + offset, batch);
+        pipeline->batches[pipeline->batch_count++] = batch;
+    }
+
+    return send_all(client_socket, buffer, size) < 0 ? false : true;
+}
+
+/**
+ * @brief Receives the results of the oldest batch in flight, marks them, and removes its moves from the
+ * pipeline. After the end of the game the frame has the results of the processed moves only.
+ * @param client_socket The client's socket.
+ * @param pipeline The moves in flight.
+ * @param game_status The status of the game after the last processed move.
+ * @return true if the results were received, false if the connection was lost.
+ */
+bool receive_move_batch(int client_socket, MovePipeline* pipeline, GameStatus* game_status) {
+    Frame frame;
+    MoveResult results[MAX_BATCH_MOVES];
+    int batch = pipeline->batches[0];
+
+    if (read_frame(&reader, client_socket, &frame) <= 0) {
+        return false;
+    }
+
+    int processed = decode_result_batch(&frame, results, game_status);
+    if (processed < 0 || processed > batch) {
+        return false;
+    }
+
+    for (int i = 0; i < processed; ++i) {
+        mark_move_result(pipeline->moves[i].x, pipeline->moves[i].y, results[i]);
+        printf("%s - %s\n", pipeline->texts[i], move_result_message(results[i]));
+    }
+
+    pipeline->count -= batch;
+    pipeline->batch_count--;
+    memmove(pipeline->moves, pipeline->moves + batch, pipeline->count * sizeof(Move));
+    memmove(pipeline->texts, pipeline->texts + batch, pipeline->count * sizeof(pipeline->texts[0]));
+    memmove(pipeline->batches, pipeline->batches + 1, pipeline->batch_count * sizeof(int));
+
+    return true;
+}
+
+/**
+ * @brief Parses the status of the game from the message of the legacy protocol.
+ * @param message The message of the server.
+ * @return WIN or LOSE if the message is the result of the game, NEXT otherwise.
+ */
+GameStatus parse_game_status(const char* message) {
+    if (strcmp(message, "You win") == 0) {
+        return WIN;
+    }
+
+    if (strcmp(message, "You lose") == 0) {
+        return LOSE;
+    }
+
+    return NEXT;
+}
+
 /**
  * @brief Connects the client to the server. The client creates a socket and connects to the server using the
- * server's address and port number.
+ * server's address and port number, or to the local socket of the server if its path is given. With the
+ * channel transport the client then offers the shared-memory channel.
  * @param client_socket The client's socket.
  * @return void
  */
 void connect_to_server(int* client_socket) {
+    if (config.local_socket[0] != '\0') {
+        struct sockaddr_un local_address;
+        memset(&local_address, 0, sizeof(local_address));
+        local_address.sun_family = AF_UNIX;
+        snprintf(local_address.sun_path, sizeof(local_address.sun_path), "%s", config.local_socket);
+
+        *client_socket = socket(AF_UNIX, SOCK_STREAM, 0);
+        CHECK_LESS_THAN_ZERO(*client_socket, "SOCKET ERROR");
+
+        CHECK_LESS_THAN_ZERO(connect(*client_socket, (struct sockaddr*)&local_address, sizeof(local_address)),
+                             "CONNECT ERROR");
+
+        if (config.transport == TRANSPORT_CHANNEL) {
+            open_channel(*client_socket);
+        }
+
+        return;
+    }
+
     struct sockaddr_in server_address;
     server_address.sin_family = AF_INET;
     server_address.sin_addr.s_addr = inet_addr(config.server_address);
@@ -217,13 +1122,66 @@ void connect_to_server(int* client_socket) {
     return;
 }
 
+/**
+ * @brief Offers the shared-memory channel to the server and waits for the answer. The server accepts the
+ * channel with the transport frame in the channel, and the frames of the game then go through it. A server
+ * that refuses the channel answers on the socket, and the game is played on the socket. A busy server
+ * leaves its message on the socket for receive_game_parameters, and may close the connection before the
+ * channel frame is sent.
+ * @param client_socket The client's socket.
+ * @return void
+ */
+void open_channel(int client_socket) {
+    if (!channel_offer(&channel, client_socket)) {
+        return;
+    }
+
+    struct pollfd poll_fds[2] = {{.fd = channel.wakeup, .events = POLLIN},
+                                 {.fd = client_socket, .events = POLLIN}};
+    bool readable;
+
+    while (!(readable = channel_readable(&channel)) && poll_fds[1].revents == 0) {
+        if (poll(poll_fds, 2, -1) < 0 && errno != EINTR) {
+            perror("POLL ERROR");
+            exit(EXIT_FAILURE);
+        }
+
+        channel_woken(&channel, false);
+    }
+
+    if (!readable) {
+        char answer[FRAME_HEADER_SIZE + TRANSPORT_SIZE];
+
+        channel_close(&channel);
+        if (recv(client_socket, answer, 1, MSG_PEEK) == 1 && (uint8_t)answer[0] == OP_TRANSPORT) {
+            recv(client_socket, answer, sizeof(answer), MSG_WAITALL);
+        }
+
+        return;
+    }
+
+    Frame frame;
+    bool accepted = false;
+
+    channel_register(&channel);
+    frame_reader_init(&reader);
+
+    if (read_frame(&reader, client_socket, &frame) <= 0 || !decode_transport(&frame, &accepted) ||
+        !accepted) {
+        printf("ERROR: invalid answer to the shared-memory channel\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
 /**
  * @brief Prompts the player to enter a move. The player's move is read from the standard input.
  * @param move The player's move.
  * @return true if the player's move is invalid, false otherwise.
  */
 bool make_move(char* move) {
-    int scanf_result = scanf("%3s", move);
+    int scanf_result = scanf("%14s", move);
     if (scanf_result == EOF) {
         exit(EXIT_FAILURE);
     }
@@ -232,10 +1190,6 @@ bool make_move(char* move) {
         return true;
     }
 
-    if (strlen(move) > 3) {
-        return true;
-    }
-
     for (int i = 0; move[i]; i++) {
         move[i] = toupper((unsigned char)move[i]);
     }
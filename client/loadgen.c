@@ -0,0 +1,1055 @@
+/*! @file loadgen.c
+File with the implementation of the headless load generator of the client.
+The load generator keeps a fixed number of concurrent connections to the server with non-blocking sockets
+and epoll. Every connection plays full games with the configured order of the shots, or with the shots of
+the auto-solver, and a new game is started as soon as a game is over: on the same connection if the server
+keeps it, on a new one otherwise.
+The connections go to the local socket of the server instead of its address and port if one is
+configured, and with the channel transport every connection offers a shared-memory channel; its eventfd is
+registered edge-triggered next to the socket, which then only carries the refusal of the channel or tells
+that the server is gone.
+The latency of every move is measured from sending the move to receiving its result and is stored in a
+log-linear histogram. The report contains the rates of the connections and the moves and the percentiles
+of the latency.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "loadgen.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../shared/channel.h"
+#include "../shared/protocol.h"
+#include "solver.h"
+
+#define MAX_EVENTS 256
+#define MAX_PLANNED_CELLS (UINT16_MAX + 1)
+#define RESERVED_FILES 16
+#define BOT_BUFFER_SIZE (MAX_FRAME_SIZE * 2)
+
+#define LATENCY_SUB_BUCKET_BITS 5
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BUCKET_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BUCKET_BITS + 1) * LATENCY_SUB_BUCKETS)
+
+/**
+ * @brief Enumeration for the state of a connection of the load generator.
+ */
+typedef enum {
+    BOT_CONNECTING, /**< Waiting for the connection to be established */
+    BOT_TRANSPORT,  /**< Waiting for the answer to the offer of the shared-memory channel */
+    BOT_HANDSHAKE,  /**< Waiting for the parameters of the game */
+    BOT_PLAYING     /**< Waiting for the result of the move */
+} BotState;
+
+/**
+ * @brief Enumeration for the outcome of the processed input of a connection.
+ */
+typedef enum {
+    BOT_CONTINUE, /**< The game goes on */
+    BOT_WON,      /**< All ships were sunk */
+    BOT_LOST,     /**< The moves are over */
+    BOT_REFUSED,  /**< The server is busy */
+    BOT_FAILED    /**< The connection was lost or the server sent an unexpected answer */
+} BotOutcome;
+
+/**
+ * @struct Bot
+ * @brief Structure for a connection of the load generator.
+ *
+ * @param socket Socket of the connection, -1 if there is no game.
+ * @param state State of the connection.
+ * @param protocol Protocol of the game, the binary protocol falls back to the legacy one like the client.
+ * @param keep_alive Whether the server starts the next game on the connection.
+ * @param rematch Whether the connection waits for the parameters of its next game.
+ * @param input Received bytes that are not processed yet.
+ * @param input_length Number of bytes in the input.
+ * @param shots Cells in the order of the shots, the cell is y * field_size + x.
+ * @param shots_capacity Number of cells the shots array can hold.
+ * @param order_offset First index of the permutations of the shots of a large board, one per parity.
+ * @param order_step Step of the permutations of the shots of a large board, one per parity.
+ * @param next_shot Index of the next shot.
+ * @param last_shot Cell of the last shot of the auto-solver.
+ * @param field_size Size of the game board.
+ * @param move_ready Whether the next move should be sent after the input is processed.
+ * @param move_sent Time the last move was sent in nanoseconds.
+ * @param seed State of the random generator of the shots.
+ * @param solver Auto-solver of the density strategy, its bitboards are NULL for the other strategies.
+ * @param rng Random generator of the auto-solver.
+ * @param channel Shared-memory channel of the connection, its memory is NULL if the frames go through the
+ * socket.
+ */
+typedef struct {
+    int socket;
+    BotState state;
+    Protocol protocol;
+    bool keep_alive;
+    bool rematch;
+    char input[BOT_BUFFER_SIZE];
+    size_t input_length;
+    uint16_t* shots;
+    int shots_capacity;
+    uint32_t order_offset[2];
+    uint32_t order_step[2];
+    int next_shot;
+    int last_shot;
+    int field_size;
+    bool move_ready;
+    uint64_t move_sent;
+    unsigned int seed;
+    Solver solver;
+    Rng rng;
+    Channel channel;
+} Bot;
+
+/**
+ * @struct LoadStats
+ * @brief Structure for the counters of the load generator.
+ *
+ * @param connections Number of established connections.
+ * @param won Number of won games.
+ * @param lost Number of lost games.
+ * @param refused Number of games refused by the busy server.
+ * @param failed Number of games that were not finished.
+ * @param moves Number of moves with a result.
+ * @param game_moves Number of moves of the won and lost games.
+ * @param latency Histogram of the latency of the moves in nanoseconds.
+ */
+typedef struct {
+    uint64_t connections;
+    uint64_t won;
+    uint64_t lost;
+    uint64_t refused;
+    uint64_t failed;
+    uint64_t moves;
+    uint64_t game_moves;
+    uint64_t latency[LATENCY_BUCKETS];
+} LoadStats;
+
+/**
+ * @brief Names of the strategies in the report.
+ */
+static const char* strategy_names[] = {
+    [STRATEGY_SEQUENTIAL] = "sequential", [STRATEGY_RANDOM] = "random", [STRATEGY_PARITY] = "parity",
+    [STRATEGY_DENSITY] = "density"};
+
+/**
+ * @brief Counters of the load generator.
+ */
+static LoadStats stats;
+
+/**
+ * @brief Number of games started so far.
+ */
+static int games_started;
+
+/**
+ * @brief Number of connections with a game in progress.
+ */
+static int active_bots;
+
+/**
+ * @brief Address of the server, or of its local socket.
+ */
+static struct sockaddr_storage server_address;
+
+/**
+ * @brief Size of the address of the server.
+ */
+static socklen_t server_address_length;
+
+/**
+ * @brief Returns the monotonic time.
+ * @return Time in nanoseconds.
+ */
+static uint64_t now_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Returns the bucket of the latency histogram. Values below LATENCY_SUB_BUCKETS have their own
+ * buckets, larger values are split into LATENCY_SUB_BUCKETS buckets per power of two, so the relative
+ * error is below 1 / LATENCY_SUB_BUCKETS.
+ * @param value Latency in nanoseconds.
+ * @return Index of the bucket.
+ */
+static int latency_bucket(uint64_t value) {
+    if (value < LATENCY_SUB_BUCKETS) {
+        return (int)value;
+    }
+
+    int shift = 63 - __builtin_clzll(value) - LATENCY_SUB_BUCKET_BITS;
+    return (shift + 1) * LATENCY_SUB_BUCKETS + (int)((value >> shift) & (LATENCY_SUB_BUCKETS - 1));
+}
+
+/**
+ * @brief Returns the smallest latency of the bucket of the histogram.
+ * @param bucket Index of the bucket.
+ * @return Latency in nanoseconds.
+ */
+static uint64_t latency_bucket_value(int bucket) {
+    if (bucket < LATENCY_SUB_BUCKETS) {
+        return (uint64_t)bucket;
+    }
+
+    int shift = bucket / LATENCY_SUB_BUCKETS - 1;
+    return (uint64_t)(LATENCY_SUB_BUCKETS + bucket % LATENCY_SUB_BUCKETS) << shift;
+}
+
+/**
+ * @brief Returns the percentile of the latency of the moves.
+ * @param percentile Percentile from 0 to 1.
+ * @return Latency in microseconds, 0 if no move was made.
+ */
+static double latency_percentile(double percentile) {
+    if (stats.moves == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t)(percentile * (double)(stats.moves - 1));
+    uint64_t count = 0;
+
+    for (int bucket = 0; bucket < LATENCY_BUCKETS; ++bucket) {
+        count += stats.latency[bucket];
+        if (count > rank) {
+            return (double)latency_bucket_value(bucket) / 1000.0;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Shuffles the shots with the Fisher-Yates algorithm.
+ * @param shots Shots.
+ * @param count Number of shots.
+ * @param seed State of the random generator.
+ * @return void
+ */
+static void shuffle_shots(uint16_t* shots, int count, unsigned int* seed) {
+    for (int i = count - 1; i > 0; --i) {
+        int j = rand_r(seed) % (i + 1);
+        uint16_t shot = shots[i];
+        shots[i] = shots[j];
+        shots[j] = shot;
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the greatest common divisor.
+ * @param a First number.
+ * @param b Second number.
+ * @return Greatest common divisor.
+ */
+static uint32_t greatest_common_divisor(uint32_t a, uint32_t b) {
+    while (b != 0) {
+        uint32_t rest = a % b;
+        a = b;
+        b = rest;
+    }
+
+    return a;
+}
+
+/**
+ * @brief Checks if the shots of a large board are ordered by parity. The density strategy shoots by parity
+ * on the boards that are too large for the auto-solver.
+ * @return true if the cells of one parity are shot first, false otherwise.
+ */
+static bool shoots_by_parity(void) {
+    return config.strategy == STRATEGY_PARITY || config.strategy == STRATEGY_DENSITY ? true : false;
+}
+
+/**
+ * @brief Returns the number of cells of the parity on a large board. The first parity has the cells with
+ * an even sum of the column and the row.
+ * @param bot Connection.
+ * @param parity Parity, 0 or 1.
+ * @return Number of cells.
+ */
+static uint32_t parity_cells(const Bot* bot, int parity) {
+    uint32_t cells = (uint32_t)bot->field_size * bot->field_size;
+
+    return shoots_by_parity() ? (cells + 1 - parity) / 2 : (parity == 0 ? cells : 0);
+}
+
+/**
+ * @brief Plans the shots of a large board without an array of all cells: the shots of every parity visit
+ * its cells in the order of the permutation offset + index * step modulo the number of its cells, with a
+ * random offset and a random step coprime to the number. Every cell is shot once, only the order is less
+ * random than a shuffle.
+ * @param bot Connection.
+ * @return void
+ */
+static void plan_large_shots(Bot* bot) {
+    for (int parity = 0; parity < 2; ++parity) {
+        uint32_t count = parity_cells(bot, parity);
+
+        bot->order_offset[parity] = 0;
+        bot->order_step[parity] = 1;
+
+        if (config.strategy == STRATEGY_SEQUENTIAL || count < 2) {
+            continue;
+        }
+
+        uint32_t step = 1 + (uint32_t)rand_r(&bot->seed) % (count - 1);
+        while (greatest_common_divisor(step, count) != 1) {
+            step = step % (count - 1) + 1;
+        }
+
+        bot->order_offset[parity] = (uint32_t)rand_r(&bot->seed) % count;
+        bot->order_step[parity] = step;
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the cell of the shot of a large board.
+ * @param bot Connection.
+ * @param shot Index of the shot.
+ * @return Cell, y * field_size + x.
+ */
+static int large_board_shot(const Bot* bot, int shot) {
+    uint32_t field_size = (uint32_t)bot->field_size, index = (uint32_t)shot;
+    int parity = index < parity_cells(bot, 0) ? 0 : 1;
+
+    if (parity == 1) {
+        index -= parity_cells(bot, 0);
+    }
+
+    uint32_t count = parity_cells(bot, parity);
+    uint32_t k = (uint32_t)(((uint64_t)index * bot->order_step[parity] + bot->order_offset[parity]) % count);
+
+    if (!shoots_by_parity()) {
+        return (int)k;
+    }
+
+    if (field_size % 2 == 1) {
+        return (int)(2 * k + parity);
+    }
+
+    uint32_t y = k / (field_size / 2), x = 2 * (k % (field_size / 2)) + (y + parity) % 2;
+
+    return (int)(y * field_size + x);
+}
+
+/**
+ * @brief Plans the order of the shots of the game with the configured strategy. The shots of a board with
+ * more than MAX_PLANNED_CELLS cells are not planned in an array, see plan_large_shots. The density strategy
+ * plans no order, the auto-solver picks every shot from the results of the previous ones.
+ * @param bot Connection.
+ * @return true if the shots were planned, false if there is not enough memory.
+ */
+static bool plan_shots(Bot* bot) {
+    int cells = bot->field_size * bot->field_size;
+
+    bot->next_shot = 0;
+
+    if (cells > MAX_PLANNED_CELLS) {
+        plan_large_shots(bot);
+        return true;
+    }
+
+    if (config.strategy == STRATEGY_DENSITY) {
+        if (bot->solver.candidates != NULL && bot->solver.field_size == bot->field_size) {
+            solver_reset(&bot->solver);
+            return true;
+        }
+
+        solver_free(&bot->solver);
+        return solver_init(&bot->solver, bot->field_size);
+    }
+
+    if (cells > bot->shots_capacity) {
+        uint16_t* shots = (uint16_t*)realloc(bot->shots, cells * sizeof(uint16_t));
+        if (shots == NULL) {
+            return false;
+        }
+
+        bot->shots = shots;
+        bot->shots_capacity = cells;
+    }
+
+    int count = 0;
+
+    if (config.strategy == STRATEGY_PARITY) {
+        for (int parity = 0; parity < 2; ++parity) {
+            int first = count;
+
+            for (int cell = 0; cell < cells; ++cell) {
+                if ((cell / bot->field_size + cell % bot->field_size) % 2 == parity) {
+                    bot->shots[count++] = (uint16_t)cell;
+                }
+            }
+
+            shuffle_shots(bot->shots + first, count - first, &bot->seed);
+        }
+    } else {
+        for (int cell = 0; cell < cells; ++cell) {
+            bot->shots[count++] = (uint16_t)cell;
+        }
+
+        if (config.strategy == STRATEGY_RANDOM) {
+            shuffle_shots(bot->shots, count, &bot->seed);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Sends the bytes of the connection at once, through the channel if the connection has one. The
+ * frames of a bot are small, so a short send means that the connection is broken.
+ * @param bot Connection.
+ * @param data Bytes to send.
+ * @param size Number of bytes.
+ * @return true if all bytes were sent, false otherwise.
+ */
+static bool bot_send(Bot* bot, const char* data, size_t size) {
+    if (bot->channel.memory != NULL) {
+        struct iovec vector = {.iov_base = (void*)data, .iov_len = size};
+        return channel_write(&bot->channel, &vector, 1) == (ssize_t)size ? true : false;
+    }
+
+    return send(bot->socket, data, size, MSG_NOSIGNAL) == (ssize_t)size ? true : false;
+}
+
+/**
+ * @brief Receives the bytes of the connection. The bytes of a connection with a channel are taken from
+ * the channel. When its ring is empty at the first receive of an event, the event came from the socket, and
+ * the socket is read: it has the refusal of the channel, or it is closed because the server is gone.
+ * @param bot Connection.
+ * @param buffer Destination.
+ * @param size Size of the destination.
+ * @param first true for the first receive of the event.
+ * @return Number of received bytes, 0 if the server closed the connection, -1 on error.
+ * @note errno is EAGAIN if there is nothing to read, and the channel then waits for the next bytes.
+ */
+static ssize_t bot_receive(Bot* bot, char* buffer, size_t size, bool first) {
+    if (bot->channel.memory == NULL) {
+        return recv(bot->socket, buffer, size, 0);
+    }
+
+    ssize_t received = channel_read(&bot->channel, buffer, size);
+    if (received < 0 && errno == EAGAIN && first) {
+        return recv(bot->socket, buffer, size, 0);
+    }
+
+    return received;
+}
+
+/**
+ * @brief Removes the channel of the connection from the epoll instance and closes it. The eventfd is
+ * removed explicitly, because the server still has it open.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @return void
+ */
+static void bot_close_channel(int epoll_fd, Bot* bot) {
+    if (bot->channel.memory == NULL) {
+        return;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, bot->channel.wakeup, NULL);
+    channel_close(&bot->channel);
+
+    return;
+}
+
+/**
+ * @brief Sends the name of the player: the hello frame in the binary protocol or the name message in the
+ * legacy protocol.
+ * @param bot Connection.
+ * @return true if the name was sent, false otherwise.
+ */
+static bool bot_send_name(Bot* bot) {
+    char buffer[BUF_MESSAGE_SIZE] = {0};
+    const char* name = config.client_name[0] != '\0' ? config.client_name : "bot";
+
+    if (bot->protocol == PROTOCOL_BINARY) {
+        encode_hello(buffer, name);
+    } else {
+        strncpy(buffer, name, BUF_MESSAGE_SIZE - 1);
+    }
+
+    return bot_send(bot, buffer, BUF_MESSAGE_SIZE);
+}
+
+/**
+ * @brief Sends the next planned shot, or the shot picked by the auto-solver.
+ * @param bot Connection.
+ * @return true if the move was sent, false if the shots are over or the move was not sent.
+ */
+static bool bot_send_move(Bot* bot) {
+    int cells = bot->field_size * bot->field_size, x, y;
+
+    if (bot->next_shot == cells) {
+        return false;
+    }
+
+    if (config.strategy == STRATEGY_DENSITY && cells <= MAX_PLANNED_CELLS) {
+        if (!solver_next(&bot->solver, &bot->rng, &x, &y)) {
+            return false;
+        }
+
+        bot->last_shot = y * bot->field_size + x;
+    } else {
+        int cell = cells > MAX_PLANNED_CELLS ? large_board_shot(bot, bot->next_shot)
+                                             : bot->shots[bot->next_shot];
+        x = cell % bot->field_size;
+        y = cell / bot->field_size;
+    }
+
+    bot->next_shot++;
+
+    char buffer[MAX_FRAME_SIZE] = {0};
+    size_t size = BUF_MESSAGE_SIZE;
+
+    if (bot->protocol == PROTOCOL_BINARY) {
+        size = encode_move(buffer, x, y);
+    } else {
+        format_move(buffer, x, y);
+    }
+
+    bot->move_sent = now_ns();
+    bot->move_ready = false;
+
+    return bot_send(bot, buffer, size);
+}
+
+/**
+ * @brief Starts playing with the received parameters of the game.
+ * @param bot Connection.
+ * @param field_size Size of the game board.
+ * @return BOT_CONTINUE, or BOT_FAILED if the parameters are invalid.
+ */
+static BotOutcome bot_start_playing(Bot* bot, int field_size) {
+    if (field_size <= 0 || field_size > INT32_MAX / field_size) {
+        return BOT_FAILED;
+    }
+
+    bot->field_size = field_size;
+
+    if (!plan_shots(bot)) {
+        return BOT_FAILED;
+    }
+
+    bot->state = BOT_PLAYING;
+    bot->move_ready = true;
+
+    return BOT_CONTINUE;
+}
+
+/**
+ * @brief Records the result of the move and tells it to the auto-solver.
+ * @param bot Connection.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @return Outcome of the game.
+ */
+static BotOutcome bot_handle_result(Bot* bot, MoveResult result, GameStatus status) {
+    stats.latency[latency_bucket(now_ns() - bot->move_sent)]++;
+    stats.moves++;
+
+    if (config.strategy == STRATEGY_DENSITY && bot->field_size * bot->field_size <= MAX_PLANNED_CELLS) {
+        solver_mark(&bot->solver, bot->last_shot % bot->field_size, bot->last_shot / bot->field_size, result);
+    }
+
+    if (status != NEXT) {
+        return status == WIN ? BOT_WON : BOT_LOST;
+    }
+
+    bot->move_ready = true;
+
+    return BOT_CONTINUE;
+}
+
+/**
+ * @brief Processes the binary frame at the beginning of the data.
+ * @param bot Connection.
+ * @param data Unprocessed input.
+ * @param length Number of bytes of the unprocessed input.
+ * @param outcome Outcome of the game.
+ * @return Number of processed bytes, 0 if the frame is not complete yet.
+ */
+static size_t bot_process_frame(Bot* bot, const char* data, size_t length, BotOutcome* outcome) {
+    Frame frame;
+    int size = decode_frame(data, length, &frame);
+    if (size <= 0) {
+        *outcome = size < 0 ? BOT_FAILED : BOT_CONTINUE;
+        return 0;
+    }
+
+    int version, field_size, number_of_ships, number_of_moves;
+    MoveResult result;
+    GameStatus status;
+
+    if (bot->state == BOT_HANDSHAKE &&
+        decode_params(&frame, &version, &field_size, &number_of_ships, &number_of_moves, NULL)) {
+        bot->keep_alive = version >= KEEPALIVE_PROTOCOL_VERSION ? true : false;
+        bot->rematch = false;
+        *outcome = bot_start_playing(bot, field_size);
+    } else if (bot->state == BOT_PLAYING && decode_result(&frame, &result, &status)) {
+        *outcome = bot_handle_result(bot, result, status);
+    } else {
+        *outcome = BOT_FAILED;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Processes the message of the legacy protocol at the beginning of the data. The status of the game
+ * is a separate message after the last result.
+ * @param bot Connection.
+ * @param data Unprocessed input.
+ * @param length Number of bytes of the unprocessed input.
+ * @param outcome Outcome of the game.
+ * @return Number of processed bytes, 0 if the message is not complete yet.
+ */
+static size_t bot_process_message(Bot* bot, const char* data, size_t length, BotOutcome* outcome) {
+    if (length < BUF_MESSAGE_SIZE) {
+        return 0;
+    }
+
+    char message[BUF_MESSAGE_SIZE + 1];
+    memcpy(message, data, BUF_MESSAGE_SIZE);
+    message[BUF_MESSAGE_SIZE] = '\0';
+
+    int field_size, number_of_ships;
+
+    if (bot->state == BOT_HANDSHAKE && strcmp(message, "Server busy") == 0) {
+        *outcome = BOT_REFUSED;
+    } else if (bot->state == BOT_HANDSHAKE &&
+               sscanf(message, "f=%d,n=%d", &field_size, &number_of_ships) == 2) {
+        bot->protocol = PROTOCOL_ASCII;
+        *outcome = bot_start_playing(bot, field_size);
+    } else if (bot->state == BOT_PLAYING && strcmp(message, "You win") == 0) {
+        *outcome = BOT_WON;
+    } else if (bot->state == BOT_PLAYING && strcmp(message, "You lose") == 0) {
+        *outcome = BOT_LOST;
+    } else if (bot->state == BOT_PLAYING && parse_move_result(message) != MOVE_INVALID) {
+        *outcome = bot_handle_result(bot, parse_move_result(message), NEXT);
+    } else {
+        *outcome = BOT_FAILED;
+    }
+
+    return BUF_MESSAGE_SIZE;
+}
+
+/**
+ * @brief Processes the complete frames of the input. The next move is sent after all received frames are
+ * processed, so the status message of the legacy protocol that follows the last result ends the game
+ * before another move is sent.
+ * @param bot Connection.
+ * @return Outcome of the game.
+ */
+static BotOutcome bot_process_input(Bot* bot) {
+    BotOutcome outcome = BOT_CONTINUE;
+    size_t offset = 0;
+
+    while (outcome == BOT_CONTINUE) {
+        const char* data = bot->input + offset;
+        size_t length = bot->input_length - offset;
+        bool legacy = bot->protocol == PROTOCOL_ASCII ||
+                      (bot->state == BOT_HANDSHAKE && length > 0 && (uint8_t)data[0] != OP_PARAMS);
+
+        size_t size = legacy ? bot_process_message(bot, data, length, &outcome)
+                             : bot_process_frame(bot, data, length, &outcome);
+        if (size == 0) {
+            break;
+        }
+
+        offset += size;
+    }
+
+    memmove(bot->input, bot->input + offset, bot->input_length - offset);
+    bot->input_length -= offset;
+
+    if (outcome == BOT_CONTINUE && bot->move_ready && !bot_send_move(bot)) {
+        outcome = BOT_FAILED;
+    }
+
+    return outcome;
+}
+
+/**
+ * @brief Starts the next game on the connection while there are games left. The connection is established
+ * asynchronously, and a game that fails to connect right away is counted as failed.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @return void
+ */
+static void start_next_game(int epoll_fd, Bot* bot) {
+    while (games_started < config.load_games) {
+        games_started++;
+
+        bot->state = BOT_CONNECTING;
+        bot->protocol = config.protocol;
+        bot->keep_alive = false;
+        bot->rematch = false;
+        bot->input_length = 0;
+        bot->move_ready = false;
+
+        bot->socket = socket(server_address.ss_family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (bot->socket < 0) {
+            perror("SOCKET ERROR");
+            stats.failed++;
+            continue;
+        }
+
+        struct epoll_event event = {.events = EPOLLOUT, .data.ptr = bot};
+
+        if ((connect(bot->socket, (struct sockaddr*)&server_address, server_address_length) < 0 &&
+             errno != EINPROGRESS) ||
+            epoll_ctl(epoll_fd, EPOLL_CTL_ADD, bot->socket, &event) < 0) {
+            close(bot->socket);
+            bot->socket = -1;
+            stats.failed++;
+            continue;
+        }
+
+        active_bots++;
+        return;
+    }
+
+    return;
+}
+
+/**
+ * @brief Asks the server for the next game on the connection of the finished game.
+ * @param bot Connection.
+ * @return true if the request was sent, false otherwise.
+ */
+static bool bot_send_rematch(Bot* bot) {
+    char frame[FRAME_HEADER_SIZE];
+    size_t size = encode_empty(frame, OP_REMATCH);
+
+    return bot_send(bot, frame, size);
+}
+
+/**
+ * @brief Ends the game of the connection, counts its outcome, and starts the next game. The next game is
+ * played on the same connection if the server keeps it, and the connection is ended with the quit frame
+ * when there are no games left. A connection closed instead of the next game, as by a draining server, is
+ * not a failure: the game is started again on a new connection.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @param outcome Outcome of the game.
+ * @return void
+ */
+static void finish_game(int epoll_fd, Bot* bot, BotOutcome outcome) {
+    uint64_t* counters[] = {[BOT_WON] = &stats.won,
+                            [BOT_LOST] = &stats.lost,
+                            [BOT_REFUSED] = &stats.refused,
+                            [BOT_FAILED] = &stats.failed};
+
+    if (outcome == BOT_FAILED && bot->rematch) {
+        games_started--;
+    } else {
+        (*counters[outcome])++;
+    }
+
+    if (outcome == BOT_WON || outcome == BOT_LOST) {
+        stats.game_moves += (uint64_t)bot->next_shot;
+    }
+
+    if ((outcome == BOT_WON || outcome == BOT_LOST) && bot->keep_alive) {
+        if (games_started < config.load_games && bot_send_rematch(bot)) {
+            games_started++;
+            bot->state = BOT_HANDSHAKE;
+            bot->rematch = true;
+            return;
+        }
+
+        char frame[FRAME_HEADER_SIZE];
+        bot_send(bot, frame, encode_empty(frame, OP_QUIT));
+    }
+
+    bot_close_channel(epoll_fd, bot);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, bot->socket, NULL);
+    close(bot->socket);
+    bot->socket = -1;
+    active_bots--;
+
+    start_next_game(epoll_fd, bot);
+
+    return;
+}
+
+/**
+ * @brief Offers the shared-memory channel to the server and registers its eventfd. The channel then marks
+ * that it waits, so the server wakes the connection up with its answer.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @return true if the channel was offered, false otherwise.
+ */
+static bool bot_offer_channel(int epoll_fd, Bot* bot) {
+    if (!channel_offer(&bot->channel, bot->socket)) {
+        return false;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN | EPOLLET, .data.ptr = bot};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, bot->channel.wakeup, &event) < 0) {
+        channel_close(&bot->channel);
+        return false;
+    }
+
+    bot->state = BOT_TRANSPORT;
+
+    return true;
+}
+
+/**
+ * @brief Takes the answer to the offer of the channel and sends the name of the player, through the channel
+ * if the server accepted it and through the socket otherwise. A server that is busy answers with the
+ * message of the legacy protocol, which is processed as in the handshake.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @return Outcome of the game.
+ */
+static BotOutcome bot_take_transport(int epoll_fd, Bot* bot) {
+    Frame frame;
+    bool accepted;
+
+    if ((uint8_t)bot->input[0] != OP_TRANSPORT) {
+        bot->state = BOT_HANDSHAKE;
+        return bot_process_input(bot);
+    }
+
+    int size = decode_frame(bot->input, bot->input_length, &frame);
+    if (size == 0) {
+        return BOT_CONTINUE;
+    }
+
+    if (size < 0 || !decode_transport(&frame, &accepted)) {
+        return BOT_FAILED;
+    }
+
+    bot->input_length -= size;
+    memmove(bot->input, bot->input + size, bot->input_length);
+
+    if (!accepted) {
+        bot_close_channel(epoll_fd, bot);
+    }
+
+    bot->state = BOT_HANDSHAKE;
+
+    return bot_send_name(bot) ? BOT_CONTINUE : BOT_FAILED;
+}
+
+/**
+ * @brief Handles the readiness of the socket or the channel of the connection. Completes the connection and
+ * sends the name of the player or offers the channel, or receives and processes the answers of the server.
+ * A busy server may close the local socket before the first send, which then fails, and its message is
+ * received as the answer.
+ * The bytes of a channel are received until its ring is empty, also after the request of the next game,
+ * because the server wakes the connection up only after the channel marked that it waits.
+ * @param epoll_fd Epoll instance.
+ * @param bot Connection.
+ * @return void
+ */
+static void handle_bot_event(int epoll_fd, Bot* bot) {
+    if (bot->state == BOT_CONNECTING) {
+        int error = 0;
+        socklen_t length = sizeof(error);
+
+        if (getsockopt(bot->socket, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+            finish_game(epoll_fd, bot, BOT_FAILED);
+            return;
+        }
+
+        stats.connections++;
+
+        struct epoll_event event = {.events = EPOLLIN, .data.ptr = bot};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, bot->socket, &event) < 0) {
+            finish_game(epoll_fd, bot, BOT_FAILED);
+            return;
+        }
+
+        bool started =
+            config.transport == TRANSPORT_CHANNEL ? bot_offer_channel(epoll_fd, bot) : bot_send_name(bot);
+
+        if (started && bot->state == BOT_CONNECTING) {
+            bot->state = BOT_HANDSHAKE;
+            return;
+        }
+
+        if (started && !channel_readable(&bot->channel)) {
+            return;
+        }
+
+        if (!started) {
+            bot->state = BOT_HANDSHAKE;
+        }
+    }
+
+    for (bool first = true;; first = false) {
+        size_t space = BOT_BUFFER_SIZE - bot->input_length;
+        ssize_t received = bot_receive(bot, bot->input + bot->input_length, space, first);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+
+        if (received <= 0) {
+            finish_game(epoll_fd, bot, BOT_FAILED);
+            return;
+        }
+
+        bot->input_length += received;
+
+        BotOutcome outcome =
+            bot->state == BOT_TRANSPORT ? bot_take_transport(epoll_fd, bot) : bot_process_input(bot);
+        if (outcome != BOT_CONTINUE) {
+            finish_game(epoll_fd, bot, outcome);
+        }
+
+        if (bot->channel.memory == NULL || bot->state == BOT_CONNECTING) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Raises the limit of the open files to fit all connections.
+ * @return true if the connections fit, false otherwise.
+ */
+static bool raise_file_limit(void) {
+    struct rlimit limit;
+    rlim_t needed = (rlim_t)config.load_connections + RESERVED_FILES;
+
+    if (getrlimit(RLIMIT_NOFILE, &limit) < 0) {
+        return false;
+    }
+
+    if (limit.rlim_cur < needed) {
+        limit.rlim_cur = limit.rlim_max < needed ? limit.rlim_max : needed;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    return limit.rlim_cur >= needed;
+}
+
+/**
+ * @brief Prints the report of the load generator in the configured format.
+ * @param elapsed Duration of the run in seconds.
+ * @return void
+ */
+static void print_report(double elapsed) {
+    double connection_rate = elapsed > 0 ? (double)stats.connections / elapsed : 0;
+    double move_rate = elapsed > 0 ? (double)stats.moves / elapsed : 0;
+    uint64_t finished = stats.won + stats.lost;
+    double moves_per_game = finished > 0 ? (double)stats.game_moves / (double)finished : 0;
+
+    if (config.output_format == OUTPUT_JSON) {
+        printf("{\"connections\":%d,\"games\":%d,\"strategy\":\"%s\",\"elapsed_sec\":%.6f,"
+               "\"established\":%" PRIu64 ",\"connections_per_sec\":%.1f,"
+               "\"won\":%" PRIu64 ",\"lost\":%" PRIu64 ",\"refused\":%" PRIu64 ",\"failed\":%" PRIu64 ","
+               "\"moves\":%" PRIu64 ",\"moves_per_sec\":%.1f,\"moves_per_game\":%.1f,"
+               "\"latency_us\":{\"p50\":%.1f,\"p99\":%.1f,\"p999\":%.1f}}\n",
+               config.load_connections, config.load_games, strategy_names[config.strategy], elapsed,
+               stats.connections, connection_rate, stats.won, stats.lost, stats.refused, stats.failed,
+               stats.moves, move_rate, moves_per_game,
+               latency_percentile(0.5), latency_percentile(0.99), latency_percentile(0.999));
+        return;
+    }
+
+    printf("Elapsed: %.3f s\n", elapsed);
+    printf("Connections: %" PRIu64 " (%.1f/s)\n", stats.connections, connection_rate);
+    printf("Games: %" PRIu64 " won, %" PRIu64 " lost, %" PRIu64 " refused, %" PRIu64 " failed\n", stats.won,
+           stats.lost, stats.refused, stats.failed);
+    printf("Moves: %" PRIu64 " (%.1f/s, %.1f per finished game)\n", stats.moves, move_rate, moves_per_game);
+    printf("Move latency: p50 %.1f us, p99 %.1f us, p999 %.1f us\n", latency_percentile(0.5),
+           latency_percentile(0.99), latency_percentile(0.999));
+
+    return;
+}
+
+/**
+ * @brief Runs the load generator. Keeps load_connections games in progress until load_games games were
+ * started and finished, then prints the report.
+ * @return EXIT_SUCCESS if no game failed, EXIT_FAILURE otherwise.
+ */
+int run_load_generator(void) {
+    if (!raise_file_limit()) {
+        printf("ERROR: the limit of the open files is too low for %d connections\n", config.load_connections);
+        return EXIT_FAILURE;
+    }
+
+    if (config.local_socket[0] != '\0') {
+        struct sockaddr_un* address = (struct sockaddr_un*)&server_address;
+        address->sun_family = AF_UNIX;
+        snprintf(address->sun_path, sizeof(address->sun_path), "%s", config.local_socket);
+        server_address_length = sizeof(*address);
+    } else {
+        struct sockaddr_in* address = (struct sockaddr_in*)&server_address;
+        address->sin_family = AF_INET;
+        address->sin_addr.s_addr = inet_addr(config.server_address);
+        address->sin_port = htons(config.server_port);
+        server_address_length = sizeof(*address);
+    }
+
+    Bot* bots = (Bot*)calloc(config.load_connections, sizeof(Bot));
+    if (bots == NULL) {
+        printf("ERROR: not enough memory for the connections\n");
+        return EXIT_FAILURE;
+    }
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    CHECK_LESS_THAN_ZERO(epoll_fd, "EPOLL ERROR");
+
+    uint64_t started = now_ns();
+
+    for (int i = 0; i < config.load_connections; ++i) {
+        bots[i].socket = -1;
+        bots[i].seed = (unsigned int)(started ^ (uint64_t)i * 2654435761U);
+        rng_seed(&bots[i].rng, bots[i].seed);
+        start_next_game(epoll_fd, &bots[i]);
+    }
+
+    struct epoll_event events[MAX_EVENTS];
+
+    while (active_bots > 0) {
+        int ready = epoll_wait(epoll_fd, events, MAX_EVENTS, -1);
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            perror("EPOLL_WAIT ERROR");
+            exit(EXIT_FAILURE);
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            handle_bot_event(epoll_fd, (Bot*)events[i].data.ptr);
+        }
+    }
+
+    print_report((double)(now_ns() - started) / 1e9);
+
+    for (int i = 0; i < config.load_connections; ++i) {
+        free(bots[i].shots);
+        solver_free(&bots[i].solver);
+    }
+
+    free(bots);
+    close(epoll_fd);
+
+    return stats.failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,19 @@
+/*! @file loadgen.h
+File with the declaration of the headless load generator of the client.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef LOADGEN_H
+#define LOADGEN_H
+
+#include "../shared/shared.h"
+
+/**
+ * @brief Client configuration.
+ * @see ClientConfig
+ */
+extern ClientConfig config;
+
+int run_load_generator(void);
+
+#endif
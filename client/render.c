@@ -0,0 +1,302 @@
+/*! @file render.c
+File with the implementation of the terminal renderer of the client. The first frame clears the screen
+and is written whole. The next frames write only the runs of the changed characters, each after a cursor
+movement, and a short run of unchanged characters between two changes is written as well when that is
+cheaper than a cursor movement. The frame is written whole again when the terminal was resized, or when
+it is too short for the frame, since the newline typed after a move would scroll the screen and move the
+frame away from the positions of its characters. The output of a frame is collected in one buffer and
+written with one system call.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "render.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+
+#include "../shared/shared.h"
+
+#define CURSOR_MOVE_SIZE 10
+
+/**
+ * @struct Renderer
+ * @brief Structure for the state of the renderer.
+ *
+ * @param rows Number of rows of the frame.
+ * @param columns Number of columns of the frame.
+ * @param frame Characters of the composed frame, row by row.
+ * @param screen Characters of the frame on the terminal.
+ * @param drawn Whether the screen has a frame.
+ * @param terminal_rows Number of rows of the terminal when the last frame was written.
+ * @param terminal_columns Number of columns of the terminal when the last frame was written.
+ * @param output Output of the frame.
+ * @param output_length Number of bytes of the output.
+ * @param output_capacity Number of bytes the output can hold.
+ */
+typedef struct {
+    int rows;
+    int columns;
+    char* frame;
+    char* screen;
+    bool drawn;
+    int terminal_rows;
+    int terminal_columns;
+    char* output;
+    size_t output_length;
+    size_t output_capacity;
+} Renderer;
+
+/**
+ * @brief State of the renderer.
+ */
+static Renderer renderer;
+
+/**
+ * @brief Allocates the memory of the renderer or stops the client.
+ * @param size Number of bytes.
+ * @return Allocated memory.
+ */
+static void* allocate(size_t size) {
+    void* memory = malloc(size);
+    if (memory == NULL) {
+        printf("ERROR: not enough memory for the screen\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return memory;
+}
+
+/**
+ * @brief Initializes the renderer for frames of the given size. The frame starts empty.
+ * @param rows Number of rows of the frame.
+ * @param columns Number of columns of the frame.
+ * @return void
+ */
+void render_init(int rows, int columns) {
+    size_t size = (size_t)rows * columns;
+
+    renderer.rows = rows;
+    renderer.columns = columns;
+    renderer.frame = (char*)allocate(size);
+    renderer.screen = (char*)allocate(size);
+    renderer.drawn = false;
+    renderer.output_capacity = size * 2 + CURSOR_MOVE_SIZE * (size_t)rows;
+    renderer.output = (char*)allocate(renderer.output_capacity);
+    renderer.output_length = 0;
+
+    render_clear();
+
+    return;
+}
+
+/**
+ * @brief Fills the composed frame with spaces.
+ * @return void
+ */
+void render_clear(void) {
+    memset(renderer.frame, ' ', (size_t)renderer.rows * renderer.columns);
+
+    return;
+}
+
+/**
+ * @brief Writes the text into the composed frame. The text is cut at the end of the row.
+ * @param row Row of the first character, from 0.
+ * @param column Column of the first character, from 0.
+ * @param text Text without line breaks.
+ * @return void
+ */
+void render_text(int row, int column, const char* text) {
+    if (row < 0 || row >= renderer.rows) {
+        return;
+    }
+
+    char* line = renderer.frame + (size_t)row * renderer.columns;
+
+    for (int i = column; i < renderer.columns && *text != '\0'; ++i, ++text) {
+        line[i] = *text;
+    }
+
+    return;
+}
+
+/**
+ * @brief Appends the bytes to the output of the frame, the output grows when it is full.
+ * @param data Bytes.
+ * @param length Number of bytes.
+ * @return void
+ */
+static void append_output(const char* data, size_t length) {
+    if (renderer.output_length + length > renderer.output_capacity) {
+        size_t capacity = (renderer.output_length + length) * 2;
+        char* output = (char*)realloc(renderer.output, capacity);
+        if (output == NULL) {
+            printf("ERROR: not enough memory for the screen\n");
+            exit(EXIT_FAILURE);
+        }
+
+        renderer.output = output;
+        renderer.output_capacity = capacity;
+    }
+
+    memcpy(renderer.output + renderer.output_length, data, length);
+    renderer.output_length += length;
+
+    return;
+}
+
+/**
+ * @brief Appends the movement of the cursor to the output.
+ * @param row Row, from 0.
+ * @param column Column, from 0.
+ * @return void
+ */
+static void append_cursor_move(int row, int column) {
+    char move[32];
+    int length = snprintf(move, sizeof(move), "\033[%d;%dH", row + 1, column + 1);
+
+    append_output(move, (size_t)length);
+
+    return;
+}
+
+/**
+ * @brief Checks if the frame on the terminal can be updated in place: the terminal was not resized and has
+ * a row for the frame and one more for the newline typed after a move. When the size of the terminal is
+ * unknown, the output is not a terminal and every frame is written whole.
+ * @return true if only the changes can be written, false if the frame must be written whole.
+ */
+static bool can_update_in_place(void) {
+    struct winsize size;
+
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &size) < 0) {
+        return false;
+    }
+
+    bool resized = size.ws_row != renderer.terminal_rows || size.ws_col != renderer.terminal_columns;
+
+    renderer.terminal_rows = size.ws_row;
+    renderer.terminal_columns = size.ws_col;
+
+    return renderer.drawn && !resized && renderer.rows < size.ws_row ? true : false;
+}
+
+/**
+ * @brief Appends the whole frame to the output after clearing the screen. The spaces at the ends of the
+ * rows and the empty rows are not written, the cleared screen has them already.
+ * @return void
+ */
+static void append_whole_frame(void) {
+    append_output("\033[H\033[J", strlen("\033[H\033[J"));
+
+    for (int row = 0; row < renderer.rows; ++row) {
+        const char* line = renderer.frame + (size_t)row * renderer.columns;
+        int length = renderer.columns;
+
+        while (length > 0 && line[length - 1] == ' ') {
+            length--;
+        }
+
+        if (length > 0) {
+            append_cursor_move(row, 0);
+            append_output(line, (size_t)length);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Appends the changed characters of the frame to the output. A run of unchanged characters shorter
+ * than a cursor movement is written with the changes around it.
+ * @return void
+ */
+static void append_changes(void) {
+    for (int row = 0; row < renderer.rows; ++row) {
+        const char* line = renderer.frame + (size_t)row * renderer.columns;
+        const char* shown = renderer.screen + (size_t)row * renderer.columns;
+        int column = 0;
+
+        while (column < renderer.columns) {
+            if (line[column] == shown[column]) {
+                column++;
+                continue;
+            }
+
+            int first = column, last = column;
+
+            for (int next = column + 1; next < renderer.columns && next - last <= CURSOR_MOVE_SIZE; ++next) {
+                if (line[next] != shown[next]) {
+                    last = next;
+                }
+            }
+
+            append_cursor_move(row, first);
+            append_output(line + first, (size_t)(last - first + 1));
+            column = last + 1;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Writes the composed frame to the terminal with one write and leaves the cursor at the given
+ * position. The screen after the cursor is cleared, which removes the move typed at the prompt.
+ * @param cursor_row Row of the cursor, from 0.
+ * @param cursor_column Column of the cursor, from 0.
+ * @return void
+ */
+void render_flush(int cursor_row, int cursor_column) {
+    renderer.output_length = 0;
+
+    if (can_update_in_place()) {
+        append_changes();
+    } else {
+        append_whole_frame();
+    }
+
+    append_cursor_move(cursor_row, cursor_column);
+    append_output("\033[J", strlen("\033[J"));
+
+    fflush(stdout);
+
+    for (size_t written = 0; written < renderer.output_length;) {
+        ssize_t result = write(STDOUT_FILENO, renderer.output + written, renderer.output_length - written);
+        if (result <= 0) {
+            break;
+        }
+
+        written += (size_t)result;
+    }
+
+    memcpy(renderer.screen, renderer.frame, (size_t)renderer.rows * renderer.columns);
+    renderer.drawn = true;
+
+    return;
+}
+
+/**
+ * @brief Makes the next frame be written whole, after the client wrote to the terminal past the renderer.
+ * @return void
+ */
+void render_reset(void) {
+    renderer.drawn = false;
+
+    return;
+}
+
+/**
+ * @brief Frees the frames of the renderer.
+ * @return void
+ */
+void render_free(void) {
+    free(renderer.frame);
+    free(renderer.screen);
+    free(renderer.output);
+
+    return;
+}
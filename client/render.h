@@ -0,0 +1,18 @@
+/*! @file render.h
+File with the declaration of the terminal renderer of the client. The screen is composed in an off-screen
+frame of characters and compared with the frame that is on the terminal, so only the changed characters
+are written, with one write per frame.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef RENDER_H
+#define RENDER_H
+
+void render_init(int rows, int columns);
+void render_clear(void);
+void render_text(int row, int column, const char* text);
+void render_flush(int cursor_row, int cursor_column);
+void render_reset(void);
+void render_free(void);
+
+#endif
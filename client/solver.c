@@ -0,0 +1,285 @@
+/*! @file solver.c
+File with the implementation of the auto-solver of the client. The ships take one cell and no two ships
+touch, even at a corner, so a cell can hold a ship if it was not shot and no hit ship is around it. Every
+such candidate is a legal placement, and a ship there rules out the candidates around it. Of all boards
+that agree with the shots, a candidate with fewer candidates around it holds a ship on more of them, so the
+solver shoots a candidate with the fewest candidates in its 3x3 neighbourhood, the one with the highest
+ship density. The counts are computed with bit-sliced arithmetic on 64-bit words, 64 cells at once: the
+candidates of three neighbouring columns are added into two bit planes per row, and the sums of three
+rows into four bit planes of counts from 0 to 9.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "solver.h"
+
+#include <stdlib.h>
+
+#define SUM_PLANES 2
+#define COUNT_PLANES 4
+#define MAX_NEIGHBOURHOOD 9
+
+/**
+ * @brief Returns the bit plane of the scratch bitboards.
+ * @param solver Solver.
+ * @param plane Index of the plane: the row sums first, then the counts.
+ * @return Words of the plane.
+ */
+static uint64_t* solver_plane(const Solver* solver, int plane) {
+    return solver->planes + (size_t)plane * solver->field_size * solver->words_per_row;
+}
+
+/**
+ * @brief Returns the mask of the columns of the word that are on the board.
+ * @param solver Solver.
+ * @param word Index of the word in the row.
+ * @return Mask of the columns.
+ */
+static uint64_t word_mask(const Solver* solver, int word) {
+    int columns = solver->field_size - word * 64;
+
+    return columns >= 64 ? ~0ULL : (1ULL << columns) - 1;
+}
+
+/**
+ * @brief Allocates the bitboards of the solver for the board size and clears them.
+ * @param solver Solver.
+ * @param field_size Size of the game board, up to SOLVER_MAX_FIELD_SIZE.
+ * @return true if the solver is ready, false if the board is too large or there is not enough memory.
+ */
+bool solver_init(Solver* solver, int field_size) {
+    if (field_size <= 0 || field_size > SOLVER_MAX_FIELD_SIZE) {
+        return false;
+    }
+
+    int words_per_row = (field_size + 63) / 64;
+    size_t words = (size_t)field_size * words_per_row;
+
+    uint64_t* bitboards = (uint64_t*)malloc(words * (1 + SUM_PLANES + COUNT_PLANES) * sizeof(uint64_t));
+    if (bitboards == NULL) {
+        return false;
+    }
+
+    solver->field_size = field_size;
+    solver->words_per_row = words_per_row;
+    solver->candidates = bitboards;
+    solver->planes = bitboards + words;
+    solver_reset(solver);
+
+    return true;
+}
+
+/**
+ * @brief Forgets the shots, every cell of the board is a candidate again.
+ * @param solver Solver.
+ * @return void
+ */
+void solver_reset(Solver* solver) {
+    for (int y = 0; y < solver->field_size; ++y) {
+        for (int word = 0; word < solver->words_per_row; ++word) {
+            solver->candidates[y * solver->words_per_row + word] = word_mask(solver, word);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Marks the shots of the game board, as of a resumed game.
+ * @param solver Solver.
+ * @param board Game board with the shots of the player.
+ * @return void
+ */
+void solver_load(Solver* solver, const GameBoard* board) {
+    for (int y = 0; y < solver->field_size; ++y) {
+        for (int x = 0; x < solver->field_size; ++x) {
+            CellState state = board_get_cell(board, x, y);
+
+            if (state == CELL_MISS) {
+                solver_mark(solver, x, y, MOVE_MISS);
+            } else if (state == CELL_HIT) {
+                solver_mark(solver, x, y, MOVE_HIT);
+            }
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Removes the cell from the candidates if it is on the board.
+ * @param solver Solver.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return void
+ */
+static void clear_candidate(Solver* solver, int x, int y) {
+    if (x >= 0 && y >= 0 && x < solver->field_size && y < solver->field_size) {
+        solver->candidates[y * solver->words_per_row + x / 64] &= ~(1ULL << (x % 64));
+    }
+
+    return;
+}
+
+/**
+ * @brief Marks the result of the shot. A hit ship also rules out the cells around it.
+ * @param solver Solver.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param result Result of the shot.
+ * @return void
+ */
+void solver_mark(Solver* solver, int x, int y, MoveResult result) {
+    if (result != MOVE_HIT && result != MOVE_ALREADY_HIT) {
+        clear_candidate(solver, x, y);
+        return;
+    }
+
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            clear_candidate(solver, x + dx, y + dy);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Adds the candidates of every cell and its left and right neighbours into two bit planes.
+ * @param solver Solver.
+ * @return void
+ */
+static void sum_rows(Solver* solver) {
+    uint64_t *low = solver_plane(solver, 0), *high = solver_plane(solver, 1);
+    int words_per_row = solver->words_per_row;
+
+    for (int y = 0; y < solver->field_size; ++y) {
+        const uint64_t* row = solver->candidates + y * words_per_row;
+
+        for (int word = 0; word < words_per_row; ++word) {
+            uint64_t center = row[word];
+            uint64_t left = center << 1 | (word > 0 ? row[word - 1] >> 63 : 0);
+            uint64_t right = center >> 1 | (word + 1 < words_per_row ? row[word + 1] << 63 : 0);
+
+            low[y * words_per_row + word] = left ^ center ^ right;
+            high[y * words_per_row + word] = (left & center) | (right & (left ^ center));
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Adds the row sums of every row and the rows above and below it into four bit planes of the
+ * counts of the candidates in the 3x3 neighbourhoods.
+ * @param solver Solver.
+ * @return void
+ */
+static void sum_columns(Solver* solver) {
+    const uint64_t *low = solver_plane(solver, 0), *high = solver_plane(solver, 1);
+    uint64_t* counts[COUNT_PLANES];
+    int words_per_row = solver->words_per_row, words = solver->field_size * words_per_row;
+
+    for (int plane = 0; plane < COUNT_PLANES; ++plane) {
+        counts[plane] = solver_plane(solver, SUM_PLANES + plane);
+    }
+
+    for (int i = 0; i < words; ++i) {
+        uint64_t a0 = i >= words_per_row ? low[i - words_per_row] : 0;
+        uint64_t a1 = i >= words_per_row ? high[i - words_per_row] : 0;
+        uint64_t c0 = i + words_per_row < words ? low[i + words_per_row] : 0;
+        uint64_t c1 = i + words_per_row < words ? high[i + words_per_row] : 0;
+        uint64_t b0 = low[i], b1 = high[i];
+
+        uint64_t carry = (a0 & b0) | (c0 & (a0 ^ b0));
+        uint64_t twos = a1 ^ b1 ^ c1, fours = (a1 & b1) | (c1 & (a1 ^ b1));
+        uint64_t twos_carry = twos & carry;
+
+        counts[0][i] = a0 ^ b0 ^ c0;
+        counts[1][i] = twos ^ carry;
+        counts[2][i] = fours ^ twos_carry;
+        counts[3][i] = fours & twos_carry;
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the candidates of the word whose neighbourhood has the number of candidates.
+ * @param solver Solver.
+ * @param index Index of the word.
+ * @param count Number of candidates in the neighbourhood.
+ * @return Mask of the candidates.
+ */
+static uint64_t candidates_with_count(const Solver* solver, int index, int count) {
+    uint64_t matching = solver->candidates[index];
+
+    for (int plane = 0; plane < COUNT_PLANES; ++plane) {
+        uint64_t bits = solver_plane(solver, SUM_PLANES + plane)[index];
+        matching &= (count >> plane & 1) ? bits : ~bits;
+    }
+
+    return matching;
+}
+
+/**
+ * @brief Picks the next shot: a random one of the candidates with the fewest candidates around them.
+ * @param solver Solver.
+ * @param rng Random generator of the choice among the equal candidates.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return true if the shot was picked, false if no cell can hold a ship.
+ */
+bool solver_next(Solver* solver, Rng* rng, int* x, int* y) {
+    int words = solver->field_size * solver->words_per_row;
+
+    sum_rows(solver);
+    sum_columns(solver);
+
+    for (int count = 1; count <= MAX_NEIGHBOURHOOD; ++count) {
+        uint32_t total = 0;
+
+        for (int i = 0; i < words; ++i) {
+            total += (uint32_t)__builtin_popcountll(candidates_with_count(solver, i, count));
+        }
+
+        if (total == 0) {
+            continue;
+        }
+
+        uint32_t pick = rng_below(rng, total);
+
+        for (int i = 0; i < words; ++i) {
+            uint64_t matching = candidates_with_count(solver, i, count);
+            uint32_t found = (uint32_t)__builtin_popcountll(matching);
+
+            if (pick >= found) {
+                pick -= found;
+                continue;
+            }
+
+            while (pick-- > 0) {
+                matching &= matching - 1;
+            }
+
+            *x = i % solver->words_per_row * 64 + __builtin_ctzll(matching);
+            *y = i / solver->words_per_row;
+
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Frees the bitboards of the solver.
+ * @param solver Solver.
+ * @return void
+ */
+void solver_free(Solver* solver) {
+    free(solver->candidates);
+    solver->candidates = NULL;
+    solver->planes = NULL;
+
+    return;
+}
@@ -0,0 +1,42 @@
+/*! @file solver.h
+File with the declaration of the auto-solver of the client. The solver keeps the cells that can still hold
+a ship as a bitboard and picks every next shot from the ship density of the cells, so the client and the
+load generator can play without a prompt.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <stdint.h>
+
+#include "../shared/rng.h"
+#include "../shared/shared.h"
+
+#define SOLVER_MAX_FIELD_SIZE 256
+
+/**
+ * @struct Solver
+ * @brief Structure for the knowledge of the solver about one game board. Every bitboard has words_per_row
+ * words per row, the bit x % 64 of the word x / 64 is the column x.
+ *
+ * @param field_size Size of the game board.
+ * @param words_per_row Number of 64-bit words of a row.
+ * @param candidates Cells that are not shot and have no hit ship around them.
+ * @param planes Scratch bitboards: two planes of the row sums and four planes of the neighbourhood counts.
+ */
+typedef struct {
+    int field_size;
+    int words_per_row;
+    uint64_t* candidates;
+    uint64_t* planes;
+} Solver;
+
+bool solver_init(Solver* solver, int field_size);
+void solver_reset(Solver* solver);
+void solver_load(Solver* solver, const GameBoard* board);
+void solver_mark(Solver* solver, int x, int y, MoveResult result);
+bool solver_next(Solver* solver, Rng* rng, int* x, int* y);
+void solver_free(Solver* solver);
+
+#endif
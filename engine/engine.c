@@ -0,0 +1,401 @@
+/*! @file engine.c
+File with the implementation of the game engine. The functions only change the game context they get,
+the random generator of the ship placement is a part of the context as well.
+The ships are placed with a set of candidate cells once random draws start to miss: a cell stays in the
+set while a ship can be placed on it, and placing a ship removes the cell and its neighbors. Every draw
+from the set succeeds, so the placement takes time proportional to the number of cells even near the
+maximum density. The boards larger than MAX_CANDIDATE_FIELD_SIZE are never scanned: the ships are drawn
+at random, and on the lattice when the draws keep missing.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "engine.h"
+
+#define MAX_CANDIDATE_FIELD_SIZE 64
+#define MAX_CELLS (MAX_CANDIDATE_FIELD_SIZE * MAX_CANDIDATE_FIELD_SIZE)
+#define REMOVED_CELL UINT16_MAX
+#define PLACEMENT_ATTEMPTS 4
+#define REJECTION_ATTEMPTS 8
+#define PERMUTATION_ROUNDS 4
+
+/**
+ * @struct CandidateSet
+ * @brief Structure for the cells a ship can still be placed on. The cells are kept densely in an array,
+ * and the position of every cell in the array is kept as well, so a cell is removed by moving the last
+ * cell in its place.
+ *
+ * @param cells Candidate cells, the cell is y * field_size + x.
+ * @param positions Position of every cell in the cells array, REMOVED_CELL if the cell is not a candidate.
+ * @param count Number of candidate cells.
+ */
+typedef struct {
+    uint16_t cells[MAX_CELLS];
+    uint16_t positions[MAX_CELLS];
+    int count;
+} CandidateSet;
+
+/**
+ * @brief Returns the maximum number of cells with a ship or a shot in a game of the rules: every ship and
+ * every missed move marks one cell. The game boards are made for this number of cells.
+ * @param rules Rules of the game.
+ * @return Number of cells.
+ */
+int max_marked_cells(const GameRules* rules) {
+    return rules->number_of_ships + rules->number_of_moves;
+}
+
+/**
+ * @brief Initializes the game context. The game board must have the size of the rules.
+ * @param game Game context.
+ * @param rules Rules of the game.
+ * @param board Game board.
+ * @return void
+ */
+void init_game_context(GameContext* game, const GameRules* rules, GameBoard* board) {
+    game->rules = rules;
+    game->board = board;
+    game->number_of_moves = 0;
+    game->number_of_ships = 0;
+    rng_seed(&game->rng, 0);
+
+    return;
+}
+
+/**
+ * @brief Starts a new game. Clears the game board, places the ships, and resets the counters.
+ * @param game Game context.
+ * @param seed Seed of the random generator of the ship placement, the same seed gives the same board.
+ * @return void
+ */
+void start_game(GameContext* game, uint64_t seed) {
+    rng_seed(&game->rng, seed);
+
+    clear_game_board(game->board);
+    place_ships(game);
+
+    game->number_of_ships = game->rules->number_of_ships;
+    game->number_of_moves = 0;
+
+    return;
+}
+
+/**
+ * @brief Starts a new game on the board with the ships placed in advance. Resets the counters.
+ * @param game Game context.
+ * @return void
+ */
+void start_prepared_game(GameContext* game) {
+    game->number_of_ships = game->rules->number_of_ships;
+    game->number_of_moves = 0;
+
+    return;
+}
+
+/**
+ * @brief Removes the cell from the candidates.
+ * @param set Candidate cells.
+ * @param cell Cell.
+ * @return void
+ */
+static void remove_candidate(CandidateSet* set, int cell) {
+    uint16_t position = set->positions[cell];
+    if (position == REMOVED_CELL) {
+        return;
+    }
+
+    uint16_t last = set->cells[--set->count];
+    set->cells[position] = last;
+    set->positions[last] = position;
+    set->positions[cell] = REMOVED_CELL;
+
+    return;
+}
+
+/**
+ * @brief Removes the cell and its neighbors from the candidates.
+ * @param set Candidate cells.
+ * @param field_size Size of the game board.
+ * @param cell Cell of the ship.
+ * @return void
+ */
+static void remove_neighborhood(CandidateSet* set, int field_size, int cell) {
+    int x = cell % field_size, y = cell / field_size;
+
+    for (int row = y > 0 ? y - 1 : y; row <= y + 1 && row < field_size; ++row) {
+        for (int column = x > 0 ? x - 1 : x; column <= x + 1 && column < field_size; ++column) {
+            remove_candidate(set, row * field_size + column);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Places the ships on random valid cells. While the board is sparse, a random cell is drawn until
+ * it is valid, at most REJECTION_ATTEMPTS times per ship. Then the remaining ships are drawn from the set of
+ * the valid cells, so every draw succeeds. Both ways choose every valid cell with the same probability.
+ * A random sequence of ships can leave no valid cells before all ships are placed when the number of ships
+ * is close to the maximum.
+ * @param game Game context.
+ * @return true if all ships were placed, false if the valid cells ran out.
+ */
+static bool place_ships_randomly(GameContext* game) {
+    int field_size = game->rules->field_size, cells = field_size * field_size;
+    uint16_t ships[MAX_CELLS];
+    int placed = 0, attempts = 0;
+
+    while (placed < game->rules->number_of_ships && attempts < REJECTION_ATTEMPTS) {
+        int cell = (int)rng_below(&game->rng, (uint32_t)cells);
+
+        if (is_valid_position(game->board, cell % field_size, cell / field_size)) {
+            board_set_ship(game->board, cell % field_size, cell / field_size);
+            ships[placed++] = (uint16_t)cell;
+            attempts = 0;
+        } else {
+            attempts++;
+        }
+    }
+
+    if (placed == game->rules->number_of_ships) {
+        return true;
+    }
+
+    CandidateSet set;
+    set.count = cells;
+
+    for (int cell = 0; cell < cells; ++cell) {
+        set.cells[cell] = (uint16_t)cell;
+        set.positions[cell] = (uint16_t)cell;
+    }
+
+    for (int ship = 0; ship < placed; ++ship) {
+        remove_neighborhood(&set, field_size, ships[ship]);
+    }
+
+    for (; placed < game->rules->number_of_ships; ++placed) {
+        if (set.count == 0) {
+            return false;
+        }
+
+        int cell = set.cells[rng_below(&game->rng, (uint32_t)set.count)];
+
+        board_set_ship(game->board, cell % field_size, cell / field_size);
+        remove_neighborhood(&set, field_size, cell);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Places the ships on random cells of a lattice with the step of two cells. The lattice has
+ * ceil(field_size / 2)^2 cells, the maximum number of ships allowed by the server, so the placement always
+ * succeeds. On a board of an even size the lattice is shifted by a random offset.
+ * @param game Game context.
+ * @return void
+ */
+static void place_ships_on_lattice(GameContext* game) {
+    int field_size = game->rules->field_size;
+    int offset_x = field_size % 2 == 0 ? (int)rng_below(&game->rng, 2) : 0;
+    int offset_y = field_size % 2 == 0 ? (int)rng_below(&game->rng, 2) : 0;
+
+    uint16_t cells[MAX_CELLS];
+    int count = 0;
+
+    for (int y = offset_y; y < field_size; y += 2) {
+        for (int x = offset_x; x < field_size; x += 2) {
+            cells[count++] = (uint16_t)(y * field_size + x);
+        }
+    }
+
+    for (int ship = 0; ship < game->rules->number_of_ships && ship < count; ++ship) {
+        int chosen = ship + (int)rng_below(&game->rng, (uint32_t)(count - ship));
+        uint16_t cell = cells[chosen];
+
+        cells[chosen] = cells[ship];
+        cells[ship] = cell;
+
+        board_set_ship(game->board, cell % field_size, cell / field_size);
+    }
+
+    return;
+}
+
+/**
+ * @brief Maps the index to another index of [0, 2^bits) by a permutation chosen by the keys. Every round
+ * multiplies by an odd number, folds the high bits into the low bits and adds a key, and each of these
+ * steps maps [0, 2^bits) onto itself, so different indices always get different results.
+ * @param index Index below 2^bits.
+ * @param bits Number of bits of the indices, from 1 to 32.
+ * @param keys PERMUTATION_ROUNDS random keys.
+ * @return Permuted index.
+ */
+static uint32_t permute_index(uint32_t index, int bits, const uint32_t* keys) {
+    uint32_t mask = bits == 32 ? UINT32_MAX : (1u << bits) - 1;
+
+    for (int round = 0; round < PERMUTATION_ROUNDS; ++round) {
+        index = (index * (keys[round] | 1)) & mask;
+        index ^= index >> (bits / 2 + 1);
+        index = (index + (keys[round] >> 1)) & mask;
+    }
+
+    return index;
+}
+
+/**
+ * @brief Places the ships on a board too large for the set of candidate cells. A random cell is drawn until
+ * it is valid, at most REJECTION_ATTEMPTS times per ship. If the draws keep missing, the board is cleared
+ * and the ships are placed on the cells of a lattice with the step of two cells, shifted by a random
+ * offset on a board of an even size. The ships take the cells of the lattice numbered by a random
+ * permutation of the ship numbers, so every draw gives a new cell without storing the lattice: the
+ * permutation works on the next power of two, and an index that falls outside of the lattice is permuted
+ * again, which takes less than two steps on average.
+ * @param game Game context.
+ * @return void
+ */
+static void place_ships_sparsely(GameContext* game) {
+    int field_size = game->rules->field_size;
+    uint32_t cells = (uint32_t)field_size * field_size;
+    int placed = 0, attempts = 0;
+
+    while (placed < game->rules->number_of_ships && attempts < REJECTION_ATTEMPTS) {
+        uint32_t cell = rng_below(&game->rng, cells);
+        int x = (int)(cell % field_size), y = (int)(cell / field_size);
+
+        if (is_valid_position(game->board, x, y)) {
+            board_set_ship(game->board, x, y);
+            placed++;
+            attempts = 0;
+        } else {
+            attempts++;
+        }
+    }
+
+    if (placed == game->rules->number_of_ships) {
+        return;
+    }
+
+    clear_game_board(game->board);
+
+    int offset_x = field_size % 2 == 0 ? (int)rng_below(&game->rng, 2) : 0;
+    int offset_y = field_size % 2 == 0 ? (int)rng_below(&game->rng, 2) : 0;
+    uint32_t lattice_size = (uint32_t)(field_size + 1) / 2;
+    uint32_t lattice_cells = lattice_size * lattice_size;
+    uint32_t keys[PERMUTATION_ROUNDS];
+    int bits = 1;
+
+    while (bits < 32 && (1u << bits) < lattice_cells) {
+        bits++;
+    }
+
+    for (int round = 0; round < PERMUTATION_ROUNDS; ++round) {
+        keys[round] = (uint32_t)rng_next(&game->rng);
+    }
+
+    for (placed = 0; placed < game->rules->number_of_ships; ++placed) {
+        uint32_t index = (uint32_t)placed;
+
+        do {
+            index = permute_index(index, bits, keys);
+        } while (index >= lattice_cells);
+
+        board_set_ship(game->board, offset_x + 2 * (int)(index % lattice_size),
+                       offset_y + 2 * (int)(index / lattice_size));
+    }
+
+    return;
+}
+
+/**
+ * @brief Places ships on the game board. The ships are placed randomly on the board. The number of ships
+ * is specified in the rules. When the random placement runs out of candidates PLACEMENT_ATTEMPTS times,
+ * the ships are placed on the lattice.
+ * @note The ships are placed in a way that there are no ships around the ship. The number of ships must
+ * not exceed the number of the cells of the lattice, ceil(field_size / 2)^2.
+ * @param game Game context.
+ * @return void
+ */
+void place_ships(GameContext* game) {
+    if (game->rules->field_size > MAX_CANDIDATE_FIELD_SIZE) {
+        place_ships_sparsely(game);
+        return;
+    }
+
+    for (int attempt = 0; attempt < PLACEMENT_ATTEMPTS; ++attempt) {
+        if (place_ships_randomly(game)) {
+            return;
+        }
+
+        clear_game_board(game->board);
+    }
+
+    place_ships_on_lattice(game);
+
+    return;
+}
+
+/**
+ * @brief Checks if the position on the game board is valid. The position is valid if there are no ships
+ * around the position.
+ * @param board Game board.
+ * @param x X-coordinate.
+ * @param y Y-coordinate.
+ * @return true if the position is valid, false otherwise.
+ * @see bool
+ */
+bool is_valid_position(const GameBoard* board, int x, int y) {
+    return board_has_ship_around(board, x, y) ? false : true;
+}
+
+/**
+ * @brief Processes the player move. The function checks if the move is inside of the board and processes
+ * the move. The function updates the game board and the number of moves and ships.
+ * @param game Game context.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return Result of the move.
+ * @see MoveResult
+ */
+MoveResult process_player_move(GameContext* game, int x, int y) {
+    int field_size = game->rules->field_size;
+
+    if (y >= field_size || y < 0 || x >= field_size || x < 0) {
+        return MOVE_INVALID;
+    }
+
+    switch (board_get_cell(game->board, x, y)) {
+        case CELL_EMPTY:
+            board_set_shot(game->board, x, y);
+            game->number_of_moves++;
+
+            return MOVE_MISS;
+        case CELL_SHIP:
+            board_set_shot(game->board, x, y);
+            game->number_of_ships--;
+
+            return MOVE_HIT;
+        case CELL_HIT:
+            return MOVE_ALREADY_HIT;
+        default:
+            return MOVE_ALREADY_MISSED;
+    }
+}
+
+/**
+ * @brief Checks the game status. The game status is checked based on the number of moves and ships.
+ * The game is won if the number of moves is less than the maximum number of moves and the number of ships
+ * is zero. The game is lost if the number of moves is greater than the maximum number of moves.
+ * @param game Game context.
+ * @return GameStatus
+ * @see GameStatus
+ */
+GameStatus check_game_status(const GameContext* game) {
+    if (game->number_of_moves >= game->rules->number_of_moves) {
+        return LOSE;
+    }
+
+    if (game->number_of_ships == 0) {
+        return WIN;
+    }
+
+    return NEXT;
+}
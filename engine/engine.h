@@ -0,0 +1,61 @@
+/*! @file engine.h
+File with the declaration of the game engine. The engine implements the rules of the game: placing the
+ships, processing the moves, and checking the status of the game. The engine has no global state, every
+function works on the game context passed to it, so the engine can be used by any number of games in
+one process and without sockets. The work of the engine depends on the number of ships and moves, not on
+the size of the board, so the boards can have thousands of cells per side.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include "../shared/rng.h"
+#include "../shared/shared.h"
+
+#define MAX_FIELD_SIZE 9999
+#define MAX_NUMBER_OF_SHIPS UINT16_MAX
+#define MAX_NUMBER_OF_MOVES UINT16_MAX
+
+/**
+ * @struct GameRules
+ * @brief Structure for the rules of the game. The rules are shared by all games of the server.
+ *
+ * @param field_size Size of the game board.
+ * @param number_of_ships Number of ships on the game board.
+ * @param number_of_moves Number of missed moves that ends the game.
+ */
+typedef struct {
+    int field_size;
+    int number_of_ships;
+    int number_of_moves;
+} GameRules;
+
+/**
+ * @struct GameContext
+ * @brief Structure for the state of one game.
+ *
+ * @param rules Rules of the game.
+ * @param board Game board, owned by the caller.
+ * @param number_of_moves Number of missed moves.
+ * @param number_of_ships Number of ships left on the board.
+ * @param rng Random generator of the ship placement.
+ */
+typedef struct {
+    const GameRules* rules;
+    GameBoard* board;
+    int number_of_moves;
+    int number_of_ships;
+    Rng rng;
+} GameContext;
+
+int max_marked_cells(const GameRules* rules);
+void init_game_context(GameContext* game, const GameRules* rules, GameBoard* board);
+void start_game(GameContext* game, uint64_t seed);
+void start_prepared_game(GameContext* game);
+void place_ships(GameContext* game);
+bool is_valid_position(const GameBoard* board, int x, int y);
+MoveResult process_player_move(GameContext* game, int x, int y);
+GameStatus check_game_status(const GameContext* game);
+
+#endif
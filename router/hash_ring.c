@@ -0,0 +1,135 @@
+/*! @file hash_ring.c
+File with the implementation of the consistent hash ring of the router. The points of a backend are derived
+from the hash of its address, so every router that lists the same backends builds the same ring, and a
+backend keeps its points when other backends are added or removed.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "hash_ring.h"
+
+#include <stdlib.h>
+
+/**
+ * @brief Spreads the bits of the value, the finalizer of splitmix64.
+ * @param value Value.
+ * @return Mixed value.
+ */
+static uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Hashes the key with FNV-1a and mixes the result, so close keys like "p1" and "p2" land far apart on
+ * the ring.
+ * @param key Bytes of the key.
+ * @param length Number of bytes of the key.
+ * @return Hash of the key.
+ */
+uint64_t hash_key(const void* key, size_t length) {
+    const unsigned char* bytes = (const unsigned char*)key;
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (size_t i = 0; i < length; ++i) {
+        hash = (hash ^ bytes[i]) * 0x100000001B3ULL;
+    }
+
+    return mix(hash);
+}
+
+/**
+ * @brief Compares two points of the ring by their position.
+ * @param first First point.
+ * @param second Second point.
+ * @return Negative, zero or positive, like strcmp.
+ */
+static int compare_points(const void* first, const void* second) {
+    uint64_t a = ((const RingPoint*)first)->hash, b = ((const RingPoint*)second)->hash;
+
+    return a < b ? -1 : a > b ? 1 : 0;
+}
+
+/**
+ * @brief Builds the ring of the member backends. The previous points of the ring are freed.
+ * @param ring Ring.
+ * @param identities Hashes of the addresses of the backends.
+ * @param members true for the backends that own points of the ring.
+ * @param count Number of the backends.
+ * @return true if the ring was built, false if there is not enough memory.
+ */
+bool hash_ring_build(HashRing* ring, const uint64_t* identities, const bool* members, int count) {
+    int points = 0;
+
+    for (int backend = 0; backend < count; ++backend) {
+        points += members[backend] ? RING_POINTS_PER_BACKEND : 0;
+    }
+
+    RingPoint* built = (RingPoint*)malloc((points > 0 ? points : 1) * sizeof(RingPoint));
+    if (built == NULL) {
+        return false;
+    }
+
+    int index = 0;
+
+    for (int backend = 0; backend < count; ++backend) {
+        for (int i = 0; members[backend] && i < RING_POINTS_PER_BACKEND; ++i) {
+            built[index].hash = mix(identities[backend] + (uint64_t)i * 0x9E3779B97F4A7C15ULL);
+            built[index++].backend = backend;
+        }
+    }
+
+    qsort(built, points, sizeof(RingPoint), compare_points);
+
+    free(ring->points);
+    ring->points = built;
+    ring->count = points;
+
+    return true;
+}
+
+/**
+ * @brief Finds the backend of the hash: the backend of the first point at or after the hash, skipping the
+ * points of the backends that cannot take connections.
+ * @param ring Ring.
+ * @param hash Hash of the key.
+ * @param usable true for the backends that can take connections.
+ * @return Index of the backend, -1 if no backend can take the connection.
+ */
+int hash_ring_lookup(const HashRing* ring, uint64_t hash, const bool* usable) {
+    int low = 0, high = ring->count;
+
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+
+        if (ring->points[middle].hash < hash) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+
+    for (int i = 0; i < ring->count; ++i) {
+        int backend = ring->points[(low + i) % ring->count].backend;
+
+        if (usable[backend]) {
+            return backend;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Frees the points of the ring.
+ * @param ring Ring.
+ * @return void
+ */
+void hash_ring_free(HashRing* ring) {
+    free(ring->points);
+    ring->points = NULL;
+    ring->count = 0;
+
+    return;
+}
@@ -0,0 +1,48 @@
+/*! @file hash_ring.h
+File with the declaration of the consistent hash ring of the router. Every backend owns
+RING_POINTS_PER_BACKEND points of the ring, and a key belongs to the backend of the first point at or after
+the hash of the key. A backend that is down or removed moves only its own keys, to the backends of the
+following points.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef HASH_RING_H
+#define HASH_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../shared/shared.h"
+
+#define RING_POINTS_PER_BACKEND 64
+
+/**
+ * @struct RingPoint
+ * @brief Structure for a point of the ring.
+ *
+ * @param hash Position of the point.
+ * @param backend Index of the backend that owns the point.
+ */
+typedef struct {
+    uint64_t hash;
+    int backend;
+} RingPoint;
+
+/**
+ * @struct HashRing
+ * @brief Structure for the points of the ring sorted by their position.
+ *
+ * @param points Points of the ring.
+ * @param count Number of the points.
+ */
+typedef struct {
+    RingPoint* points;
+    int count;
+} HashRing;
+
+uint64_t hash_key(const void* key, size_t length);
+bool hash_ring_build(HashRing* ring, const uint64_t* identities, const bool* members, int count);
+int hash_ring_lookup(const HashRing* ring, uint64_t hash, const bool* usable);
+void hash_ring_free(HashRing* ring);
+
+#endif
@@ -0,0 +1,221 @@
+/*! @file relay.c
+File with the implementation of the relays of the router. A stream receives from its source only when
+everything received before was sent, so a slow target stops the reads of its source, and the pipe of
+splice never holds more than one chunk.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "relay.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Initializes the relay of the accepted client.
+ * @param relay Relay.
+ * @param client Client socket.
+ * @return void
+ */
+void relay_init(Relay* relay, int client) {
+    relay->state = RELAY_HANDSHAKE;
+    relay->client = client;
+    relay->backend_socket = -1;
+    relay->backend = -1;
+    relay->attempts = 0;
+    relay->key = 0;
+    relay->scanning = true;
+    relay->skip = 0;
+    relay->frame_length = 0;
+    relay->client_events = 0;
+    relay->backend_events = 0;
+    relay->deadline = 0;
+    relay->prev = NULL;
+    relay->next = NULL;
+
+    for (int i = 0; i < 2; ++i) {
+        relay->streams[i].pipe[0] = -1;
+        relay->streams[i].pipe[1] = -1;
+        relay->streams[i].buffer = NULL;
+        relay->streams[i].offset = 0;
+        relay->streams[i].pending = 0;
+        relay->streams[i].allowance = RELAY_UNLIMITED;
+        relay->streams[i].finished = false;
+    }
+
+    return;
+}
+
+/**
+ * @brief Starts to move the bytes after the backend was connected. Every stream gets a pipe, or a buffer if
+ * the process has no descriptors left for the pipe.
+ * @param relay Relay.
+ * @return true if the streams are ready, false if there is not enough memory.
+ */
+bool relay_start(Relay* relay) {
+    relay->streams[TO_BACKEND].source = relay->client;
+    relay->streams[TO_BACKEND].target = relay->backend_socket;
+    relay->streams[TO_CLIENT].source = relay->backend_socket;
+    relay->streams[TO_CLIENT].target = relay->client;
+
+    for (int i = 0; i < 2; ++i) {
+        RelayStream* stream = &relay->streams[i];
+
+        if (pipe2(stream->pipe, O_NONBLOCK | O_CLOEXEC) < 0) {
+            stream->pipe[0] = -1;
+            stream->pipe[1] = -1;
+
+            if ((stream->buffer = (char*)malloc(RELAY_BUFFER_SIZE)) == NULL) {
+                return false;
+            }
+        }
+    }
+
+    relay->state = RELAY_FORWARDING;
+
+    return true;
+}
+
+/**
+ * @brief Sends the pending bytes of the stream to its target.
+ * @param stream Stream.
+ * @return Number of sent bytes, -1 on error.
+ */
+static ssize_t stream_send(RelayStream* stream) {
+    if (stream->buffer == NULL) {
+        return splice(stream->pipe[0], NULL, stream->target, NULL, stream->pending,
+                      SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    }
+
+    return send(stream->target, stream->buffer + stream->offset, stream->pending, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief Receives the next bytes of the stream from its source, at most the allowance of the stream.
+ * @param stream Stream.
+ * @return Number of received bytes, 0 at the end of the source, -1 on error.
+ */
+static ssize_t stream_receive(RelayStream* stream) {
+    ssize_t received;
+
+    if (stream->buffer == NULL) {
+        received = splice(stream->source, NULL, stream->pipe[1], NULL,
+                          stream->allowance < RELAY_CHUNK_SIZE ? stream->allowance : RELAY_CHUNK_SIZE,
+                          SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+    } else {
+        received = recv(stream->source, stream->buffer,
+                        stream->allowance < RELAY_BUFFER_SIZE ? stream->allowance : RELAY_BUFFER_SIZE, 0);
+    }
+
+    if (received > 0 && stream->allowance != RELAY_UNLIMITED) {
+        stream->allowance -= (size_t)received;
+    }
+
+    return received;
+}
+
+/**
+ * @brief Moves the bytes of the stream until the source has nothing more, the target takes nothing more,
+ * or the allowance of the stream is used up. The end of the source is passed on by shutting the target
+ * down for writing.
+ * @param stream Stream.
+ * @return 0 on success, -1 if a socket failed.
+ */
+int relay_pump(RelayStream* stream) {
+    while (stream->pending > 0 || (!stream->finished && stream->allowance > 0)) {
+        ssize_t moved = stream->pending > 0 ? stream_send(stream) : stream_receive(stream);
+
+        if (moved < 0) {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR ? 0 : -1;
+        }
+
+        if (stream->pending > 0) {
+            stream->offset += moved;
+            stream->pending -= moved;
+        } else if (moved == 0) {
+            stream->finished = true;
+            shutdown(stream->target, SHUT_WR);
+        } else {
+            stream->offset = 0;
+            stream->pending = (size_t)moved;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Returns the events the socket of the relay waits for. During the handshake the client socket waits
+ * for new bytes only, because the first frame is peeked and stays in the socket until it is spliced.
+ * @param relay Relay.
+ * @param socket Client socket or backend socket.
+ * @return Epoll events.
+ */
+uint32_t relay_events(const Relay* relay, int socket) {
+    if (relay->state == RELAY_HANDSHAKE) {
+        return EPOLLIN | EPOLLET;
+    }
+
+    if (relay->state == RELAY_CONNECTING) {
+        return socket == relay->backend_socket ? EPOLLOUT : 0;
+    }
+
+    const RelayStream* outgoing = &relay->streams[socket == relay->client ? TO_BACKEND : TO_CLIENT];
+    const RelayStream* incoming = &relay->streams[socket == relay->client ? TO_CLIENT : TO_BACKEND];
+    uint32_t events = 0;
+
+    if (outgoing->pending == 0 && !outgoing->finished) {
+        events |= EPOLLIN;
+    }
+
+    if (incoming->pending > 0) {
+        events |= EPOLLOUT;
+    }
+
+    return events;
+}
+
+/**
+ * @brief Checks if both directions of the relay reached their end and were sent completely.
+ * @param relay Relay.
+ * @return true if the relay is done, false otherwise.
+ */
+bool relay_done(const Relay* relay) {
+    for (int i = 0; i < 2; ++i) {
+        if (!relay->streams[i].finished || relay->streams[i].pending > 0) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Closes the sockets and the pipes of the relay and frees its buffers.
+ * @param relay Relay.
+ * @return void
+ */
+void relay_close(Relay* relay) {
+    close(relay->client);
+
+    if (relay->backend_socket >= 0) {
+        close(relay->backend_socket);
+    }
+
+    for (int i = 0; i < 2; ++i) {
+        for (int end = 0; end < 2; ++end) {
+            if (relay->streams[i].pipe[end] >= 0) {
+                close(relay->streams[i].pipe[end]);
+            }
+        }
+
+        free(relay->streams[i].buffer);
+    }
+
+    return;
+}
@@ -0,0 +1,105 @@
+/*! @file relay.h
+File with the declaration of the relays of the router. A relay connects a client with its backend and moves
+the bytes of both directions between the sockets with splice through a pipe, so the bytes never enter the
+memory of the router. When there are no pipes left, the relay copies through a small buffer instead.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef RELAY_H
+#define RELAY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../shared/protocol.h"
+#include "../shared/shared.h"
+
+#define RELAY_CHUNK_SIZE 65536
+#define RELAY_BUFFER_SIZE 512
+#define RELAY_SCAN_SIZE 4096
+#define RELAY_UNLIMITED SIZE_MAX
+#define TO_BACKEND 0
+#define TO_CLIENT 1
+
+/**
+ * @brief Enumeration for the state of the relay.
+ */
+typedef enum {
+    RELAY_HANDSHAKE,  /**< Waiting for the first frame of the client, which names the player */
+    RELAY_CONNECTING, /**< Connecting to the backend of the player */
+    RELAY_FORWARDING  /**< Moving the bytes between the client and the backend */
+} RelayState;
+
+/**
+ * @struct RelayStream
+ * @brief Structure for one direction of the relay.
+ *
+ * @param source Socket the bytes are received from.
+ * @param target Socket the bytes are sent to.
+ * @param pipe Pipe of splice, -1 if the stream copies through the buffer.
+ * @param buffer Buffer of the copy, NULL if the stream splices.
+ * @param offset Number of sent bytes of the buffer.
+ * @param pending Number of bytes received but not sent yet.
+ * @param allowance Number of bytes the stream may still receive, RELAY_UNLIMITED without a limit.
+ * @param finished true if the source was shut down and the target was shut down for writing.
+ */
+typedef struct {
+    int source;
+    int target;
+    int pipe[2];
+    char* buffer;
+    size_t offset;
+    size_t pending;
+    size_t allowance;
+    bool finished;
+} RelayStream;
+
+/**
+ * @struct Relay
+ * @brief Structure for the connection of a client through the router.
+ *
+ * @param state State of the relay.
+ * @param client Client socket.
+ * @param backend_socket Socket of the connection to the backend, -1 before the connection.
+ * @param backend Index of the backend, -1 before the connection.
+ * @param attempts Number of the backends that were tried.
+ * @param key Hash of the name of the player, or of the resume token.
+ * @param scanning true while the frames of the backend are scanned for the resume tokens.
+ * @param skip Number of bytes of the current frame of the backend that are not scanned.
+ * @param frame Beginning of the current frame of the backend.
+ * @param frame_length Number of bytes of the current frame in frame.
+ * @param client_events Events the client socket waits for.
+ * @param backend_events Events the backend socket waits for.
+ * @param streams Directions of the relay, TO_BACKEND and TO_CLIENT.
+ * @param deadline Time in milliseconds of the monotonic clock the first frame must arrive by, 0 if the relay
+ * does not wait for it.
+ * @param prev Previous relay of the list of the relays waiting for the first frame.
+ * @param next Next relay of the list of the relays waiting for the first frame.
+ */
+typedef struct Relay {
+    RelayState state;
+    int client;
+    int backend_socket;
+    int backend;
+    int attempts;
+    uint64_t key;
+    bool scanning;
+    size_t skip;
+    char frame[FRAME_HEADER_SIZE + PARAMS_TOKEN_SIZE];
+    size_t frame_length;
+    uint32_t client_events;
+    uint32_t backend_events;
+    RelayStream streams[2];
+    uint64_t deadline;
+    struct Relay* prev;
+    struct Relay* next;
+} Relay;
+
+void relay_init(Relay* relay, int client);
+bool relay_start(Relay* relay);
+int relay_pump(RelayStream* stream);
+uint32_t relay_events(const Relay* relay, int socket);
+bool relay_done(const Relay* relay);
+void relay_close(Relay* relay);
+
+#endif
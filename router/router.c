@@ -0,0 +1,1180 @@
+/*! @file router.c
+File with the implementation of the router. One process serves all connections with non-blocking sockets
+and epoll. The first frame of a client is peeked to find the name of the player, the backend of the name
+is taken from the consistent hash ring, and the relay then moves the bytes of both directions with splice,
+the first frame included. A resume frame has no name, so the router scans the frames of the backends and
+remembers the backend of every resume token it issues, the tokens of the rematches included, and sends the
+resume there. The backends are checked with a TCP connection every health_interval seconds; a backend that
+is down, that answers the check with "Server busy", or that refuses a relay, takes no new players until a
+check succeeds again. A client that does not send its first frame within handshake_timeout seconds
+receives "Timeout" and is closed. SIGHUP reloads the list of the backends: a removed backend
+takes no new players and is forgotten after its last relay. SIGQUIT drains the router: it stops accepting
+connections and exits after the last relay.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "router.h"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../shared/protocol.h"
+#include "hash_ring.h"
+#include "relay.h"
+
+#define MAX_EVENTS 256
+#define TOKEN_ROUTES 4096
+
+/**
+ * @brief Enumeration for the sources of the epoll events. The source is stored in the low byte of the event
+ * data, the file descriptor or the index of the backend in the other bytes.
+ */
+typedef enum {
+    EVENT_LISTENER, /**< The router socket has connections to accept */
+    EVENT_RELAY,    /**< A socket of a relay is ready */
+    EVENT_PROBE     /**< The health check of a backend completed */
+} EventSource;
+
+/**
+ * @struct TokenRoute
+ * @brief Structure for the backend of a resume token.
+ *
+ * @param token Resume token, 0 if the entry is empty.
+ * @param backend Index of the backend that issued the token.
+ */
+typedef struct {
+    uint64_t token;
+    int backend;
+} TokenRoute;
+
+RouterConfig config;
+
+void parse_backend(void* value, const char* str);
+
+/**
+ * @brief Configuration options of the router.
+ * @see ConfigOption
+ */
+ConfigOption options[] = {
+    {"router_address", &config.router_address, parse_string},
+    {"router_port", &config.router_port, parse_int},
+    {"backend", &config, parse_backend},
+    {"health_interval", &config.health_interval, parse_int},
+    {"handshake_timeout", &config.handshake_timeout, parse_int},
+    {"listen_backlog", &config.listen_backlog, parse_int},
+};
+
+/**
+ * @brief Backends of the router, a removed backend keeps its slot until its last relay.
+ */
+static Backend backends[MAX_BACKENDS];
+
+/**
+ * @brief true for the backends that take new players.
+ */
+static bool usable[MAX_BACKENDS];
+
+/**
+ * @brief Consistent hash ring of the backends that are up or down.
+ */
+static HashRing ring;
+
+/**
+ * @brief Backends of the resume tokens, indexed by the hash of the token. A newer token takes the entry.
+ */
+static TokenRoute token_routes[TOKEN_ROUTES];
+
+/**
+ * @brief Table of the relays indexed by the file descriptors of their client and backend sockets.
+ */
+static Relay** relays;
+
+/**
+ * @brief Number of entries in the table of the relays.
+ */
+static int relays_capacity;
+
+/**
+ * @brief Number of the open relays.
+ */
+static int open_relays;
+
+/**
+ * @brief Epoll instance of the router.
+ */
+static int epoll_fd;
+
+/**
+ * @brief First relay of the list of the relays waiting for the first frame. The list is in the order of
+ * the deadlines, so the first relay expires first.
+ */
+static Relay* handshakes_head;
+
+/**
+ * @brief Last relay of the list of the relays waiting for the first frame.
+ */
+static Relay* handshakes_tail;
+
+/**
+ * @brief Set by SIGQUIT: the router stops accepting connections and exits after the last relay.
+ */
+static volatile sig_atomic_t draining;
+
+/**
+ * @brief Set by SIGHUP: the router reloads the list of the backends.
+ */
+static volatile sig_atomic_t reloading;
+
+/**
+ * @brief Signal mask of the wait of the router loop, the only place where SIGQUIT and SIGHUP are taken.
+ */
+static sigset_t wait_mask;
+
+bool read_configuration(void);
+void block_router_signals(void);
+void apply_backends(void);
+int create_router_socket(void);
+void run_router(int router_socket);
+
+/**
+ * @brief Main function of the router. Reads the configuration, opens the router socket, and routes the
+ * connections until the router is drained.
+ * @return EXIT_SUCCESS if the router was drained, EXIT_FAILURE on an invalid configuration.
+ */
+int main(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+
+    if (!read_configuration()) {
+        return EXIT_FAILURE;
+    }
+
+    block_router_signals();
+    apply_backends();
+    run_router(create_router_socket());
+    hash_ring_free(&ring);
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Makes the router drain on SIGQUIT.
+ * @param signal Signal number.
+ * @return void
+ */
+static void request_drain(int signal) {
+    (void)signal;
+    draining = 1;
+
+    return;
+}
+
+/**
+ * @brief Makes the router reload the backends on SIGHUP.
+ * @param signal Signal number.
+ * @return void
+ */
+static void request_reload(int signal) {
+    (void)signal;
+    reloading = 1;
+
+    return;
+}
+
+/**
+ * @brief Sets the handlers of SIGQUIT and SIGHUP and blocks both signals outside of the wait of the router
+ * loop. SIGPIPE is ignored, because splice cannot be told not to raise it.
+ * @return void
+ */
+void block_router_signals(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+
+    action.sa_handler = request_drain;
+    CHECK_LESS_THAN_ZERO(sigaction(SIGQUIT, &action, NULL), "SIGACTION ERROR");
+    action.sa_handler = request_reload;
+    CHECK_LESS_THAN_ZERO(sigaction(SIGHUP, &action, NULL), "SIGACTION ERROR");
+    action.sa_handler = SIG_IGN;
+    CHECK_LESS_THAN_ZERO(sigaction(SIGPIPE, &action, NULL), "SIGACTION ERROR");
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGQUIT);
+    sigaddset(&signals, SIGHUP);
+    CHECK_LESS_THAN_ZERO(sigprocmask(SIG_BLOCK, &signals, &wait_mask), "SIGPROCMASK ERROR");
+
+    return;
+}
+
+/**
+ * @brief Parses the address of a backend in the format "address:port".
+ * @param name Address of the backend.
+ * @param address Socket address of the backend.
+ * @return true if the address is valid, false otherwise.
+ */
+static bool parse_backend_address(const char* name, struct sockaddr_in* address) {
+    char host[BACKEND_ADDRESS_SIZE];
+    const char* colon = strrchr(name, ':');
+    int port;
+
+    if (colon == NULL || colon - name >= (long)sizeof(host) || sscanf(colon + 1, "%d", &port) != 1 ||
+        port <= 0 || port > 65535) {
+        return false;
+    }
+
+    memcpy(host, name, colon - name);
+    host[colon - name] = '\0';
+
+    memset(address, 0, sizeof(*address));
+    address->sin_family = AF_INET;
+    address->sin_port = htons(port);
+
+    return inet_pton(AF_INET, host, &address->sin_addr) == 1 ? true : false;
+}
+
+/**
+ * @brief Function to parse the address of a backend and add it to the configuration. An invalid address
+ * is reported and skipped, so a reload with a typo keeps the other backends.
+ *
+ * @param value Pointer to the configuration of the router.
+ * @param str String containing the address in the format "address:port".
+ * @return void
+ */
+void parse_backend(void* value, const char* str) {
+    RouterConfig* router_config = (RouterConfig*)value;
+    char name[BACKEND_ADDRESS_SIZE];
+    struct sockaddr_in address;
+
+    snprintf(name, sizeof(name), "%s", str);
+    name[strcspn(name, "\r\n")] = '\0';
+
+    if (!parse_backend_address(name, &address)) {
+        printf("ERROR: invalid backend address %s\n", name);
+        return;
+    }
+
+    if (router_config->number_of_backends == MAX_BACKENDS) {
+        printf("ERROR: more than %d backends\n", MAX_BACKENDS);
+        return;
+    }
+
+    strcpy(router_config->backends[router_config->number_of_backends++], name);
+
+    return;
+}
+
+/**
+ * @brief Reads the configuration of the router from ROUTER_CONFIG_FILE. The optional keys get their default
+ * values first. On a reload an invalid configuration is reported and the previous one is kept, as is a
+ * configuration with a line longer than the buffer, which is not parsed in pieces.
+ * @return true if the configuration is valid, false otherwise.
+ */
+bool read_configuration(void) {
+    FILE* file = fopen(ROUTER_CONFIG_FILE, "r");
+    if (file == NULL) {
+        printf("ERROR: router config file not found\n");
+        return false;
+    }
+
+    RouterConfig previous = config;
+    char *key, *value;
+    char buffer[BUF_CONFIG_SIZE];
+
+    memset(&config, 0, sizeof(config));
+    config.health_interval = DEFAULT_HEALTH_INTERVAL;
+    config.handshake_timeout = DEFAULT_HANDSHAKE_TIMEOUT;
+    config.listen_backlog = DEFAULT_LISTEN_BACKLOG;
+
+    while (fgets(buffer, BUF_CONFIG_SIZE, file) != NULL) {
+        if (strchr(buffer, '\n') == NULL && !feof(file)) {
+            printf("ERROR: router configuration line %.*s... is too long\n", MAX_CONFIG_KEY_LENGTH, buffer);
+            fclose(file);
+            config = previous;
+            return false;
+        }
+
+        key = strtok(buffer, "=");
+        value = strtok(NULL, "=");
+
+        for (int i = 0; value != NULL && i < (int)(sizeof(options) / sizeof(ConfigOption)); ++i) {
+            if (strcmp(key, options[i].key) == 0) {
+                options[i].parse(options[i].value, value);
+                break;
+            }
+        }
+    }
+
+    fclose(file);
+
+    if (config.router_port <= 0 || config.router_port > 65535 || config.number_of_backends == 0 ||
+        config.health_interval <= 0 || config.handshake_timeout <= 0 || config.listen_backlog <= 0) {
+        printf("ERROR: invalid router configuration\n");
+        config = previous;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Sets the state of the backend and reports the changes of its health.
+ * @param backend Index of the backend.
+ * @param state New state.
+ * @return void
+ */
+static void set_backend_state(int backend, BackendState state) {
+    BackendState previous = backends[backend].state;
+
+    backends[backend].state = state;
+    usable[backend] = state == BACKEND_UP ? true : false;
+
+    if (previous == BACKEND_UP && state == BACKEND_DOWN) {
+        printf("Backend %s is down\n", backends[backend].name);
+    } else if (previous == BACKEND_DOWN && state == BACKEND_UP) {
+        printf("Backend %s is up\n", backends[backend].name);
+    }
+
+    return;
+}
+
+/**
+ * @brief Stops the running health check of the backend.
+ * @param backend Index of the backend.
+ * @return void
+ */
+static void stop_probe(int backend) {
+    if (backends[backend].probe >= 0) {
+        close(backends[backend].probe);
+        backends[backend].probe = -1;
+    }
+
+    return;
+}
+
+/**
+ * @brief Forgets the removed backend after its last relay.
+ * @param backend Index of the backend.
+ * @return void
+ */
+static void release_backend(int backend) {
+    if (backends[backend].state == BACKEND_DRAINING && backends[backend].relays == 0) {
+        printf("Backend %s was removed\n", backends[backend].name);
+        set_backend_state(backend, BACKEND_UNUSED);
+    }
+
+    return;
+}
+
+/**
+ * @brief Applies the backends of the configuration. A new backend is taken as up until its first health
+ * check, a backend that is no longer listed drains, and the ring is built again from the listed backends.
+ * @return void
+ */
+void apply_backends(void) {
+    bool listed[MAX_BACKENDS] = {false};
+
+    for (int i = 0; i < config.number_of_backends; ++i) {
+        int free_slot = -1, found = -1;
+
+        for (int backend = 0; backend < MAX_BACKENDS && found < 0; ++backend) {
+            if (backends[backend].state == BACKEND_UNUSED) {
+                free_slot = free_slot < 0 ? backend : free_slot;
+            } else if (strcmp(backends[backend].name, config.backends[i]) == 0) {
+                found = backend;
+            }
+        }
+
+        if (found < 0 && free_slot < 0) {
+            printf("ERROR: no free slot for the backend %s\n", config.backends[i]);
+            continue;
+        }
+
+        if (found < 0) {
+            found = free_slot;
+            strcpy(backends[found].name, config.backends[i]);
+            parse_backend_address(backends[found].name, &backends[found].address);
+            backends[found].relays = 0;
+            backends[found].probe = -1;
+            set_backend_state(found, BACKEND_UP);
+        } else if (backends[found].state == BACKEND_DRAINING) {
+            set_backend_state(found, BACKEND_UP);
+        }
+
+        listed[found] = true;
+    }
+
+    uint64_t identities[MAX_BACKENDS];
+    bool members[MAX_BACKENDS];
+
+    for (int backend = 0; backend < MAX_BACKENDS; ++backend) {
+        BackendState state = backends[backend].state;
+
+        if (!listed[backend] && (state == BACKEND_UP || state == BACKEND_DOWN)) {
+            printf("Draining backend %s\n", backends[backend].name);
+            stop_probe(backend);
+            set_backend_state(backend, BACKEND_DRAINING);
+            release_backend(backend);
+        }
+
+        identities[backend] = hash_key(backends[backend].name, strlen(backends[backend].name));
+        members[backend] = listed[backend];
+    }
+
+    if (!hash_ring_build(&ring, identities, members, MAX_BACKENDS)) {
+        printf("ERROR: not enough memory for the hash ring\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Creates the router socket, binds it to the address and port, and listens for incoming
+ * connections.
+ * @return Router socket.
+ */
+int create_router_socket(void) {
+    int router_socket = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    CHECK_LESS_THAN_ZERO(router_socket, "SOCKET ERROR");
+
+    int enable = 1;
+    CHECK_LESS_THAN_ZERO(setsockopt(router_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)),
+                         "SETSOCKOPT ERROR");
+
+    struct sockaddr_in router_address;
+    memset(&router_address, 0, sizeof(router_address));
+    router_address.sin_family = AF_INET;
+    router_address.sin_addr.s_addr = inet_addr(config.router_address);
+    router_address.sin_port = htons(config.router_port);
+
+    CHECK_LESS_THAN_ZERO(bind(router_socket, (struct sockaddr*)(&router_address), sizeof(router_address)),
+                         "BIND ERROR");
+    CHECK_LESS_THAN_ZERO(listen(router_socket, config.listen_backlog), "LISTEN ERROR");
+
+    return router_socket;
+}
+
+/**
+ * @brief Returns the current time in milliseconds of the monotonic clock.
+ * @return Time in milliseconds.
+ */
+static uint64_t now_ms(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Returns the entry of the resume token in the table of the token routes.
+ * @param token Resume token.
+ * @return Entry of the token.
+ */
+static TokenRoute* token_route(uint64_t token) {
+    return &token_routes[hash_key(&token, sizeof(token)) % TOKEN_ROUTES];
+}
+
+/**
+ * @brief Adds the socket to the epoll instance with the events of the relay.
+ * @param relay Relay.
+ * @param socket Client socket or backend socket of the relay.
+ * @return true if the socket was added, false otherwise.
+ */
+static bool watch_socket(Relay* relay, int socket) {
+    uint32_t events = relay_events(relay, socket);
+    struct epoll_event event = {.events = events, .data.u64 = (uint64_t)socket << 8 | EVENT_RELAY};
+
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, socket, &event) < 0) {
+        perror("EPOLL_CTL ERROR");
+        return false;
+    }
+
+    relays[socket] = relay;
+    *(socket == relay->client ? &relay->client_events : &relay->backend_events) = events;
+
+    return true;
+}
+
+/**
+ * @brief Updates the events the sockets of the relay wait for.
+ * @param relay Relay.
+ * @return void
+ */
+static void update_relay_events(Relay* relay) {
+    int sockets[2] = {relay->client, relay->backend_socket};
+    uint32_t* current[2] = {&relay->client_events, &relay->backend_events};
+
+    for (int i = 0; i < 2; ++i) {
+        uint32_t events = sockets[i] >= 0 ? relay_events(relay, sockets[i]) : 0;
+        uint64_t data = (uint64_t)sockets[i] << 8 | EVENT_RELAY;
+
+        if (sockets[i] >= 0 && events != *current[i]) {
+            struct epoll_event event = {.events = events, .data.u64 = data};
+            epoll_ctl(epoll_fd, EPOLL_CTL_MOD, sockets[i], &event);
+            *current[i] = events;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Closes the connection of the relay to its backend. A removed backend is forgotten after its last
+ * relay.
+ * @param relay Relay.
+ * @return void
+ */
+static void detach_backend(Relay* relay) {
+    if (relay->backend_socket < 0) {
+        return;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, relay->backend_socket, NULL);
+    close(relay->backend_socket);
+    relays[relay->backend_socket] = NULL;
+    relay->backend_socket = -1;
+    relay->backend_events = 0;
+
+    backends[relay->backend].relays--;
+    release_backend(relay->backend);
+    relay->backend = -1;
+
+    return;
+}
+
+/**
+ * @brief Appends the relay to the list of the relays waiting for the first frame. The deadline is not
+ * earlier than the one of the last relay, so the list stays in order after a reload shortens the timeout.
+ * @param relay Relay.
+ * @param now Current time in milliseconds.
+ * @return void
+ */
+static void await_handshake(Relay* relay, uint64_t now) {
+    relay->deadline = now + (uint64_t)config.handshake_timeout * 1000;
+    if (handshakes_tail != NULL && handshakes_tail->deadline > relay->deadline) {
+        relay->deadline = handshakes_tail->deadline;
+    }
+
+    relay->prev = handshakes_tail;
+    relay->next = NULL;
+    *(handshakes_tail != NULL ? &handshakes_tail->next : &handshakes_head) = relay;
+    handshakes_tail = relay;
+
+    return;
+}
+
+/**
+ * @brief Removes the relay from the list of the relays waiting for the first frame, if it is there.
+ * @param relay Relay.
+ * @return void
+ */
+static void end_handshake(Relay* relay) {
+    if (relay->deadline == 0) {
+        return;
+    }
+
+    *(relay->prev != NULL ? &relay->prev->next : &handshakes_head) = relay->next;
+    *(relay->next != NULL ? &relay->next->prev : &handshakes_tail) = relay->prev;
+    relay->prev = NULL;
+    relay->next = NULL;
+    relay->deadline = 0;
+
+    return;
+}
+
+/**
+ * @brief Closes the relay and its sockets.
+ * @param relay Relay.
+ * @return void
+ */
+static void close_relay(Relay* relay) {
+    end_handshake(relay);
+    detach_backend(relay);
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, relay->client, NULL);
+    relays[relay->client] = NULL;
+
+    relay_close(relay);
+    free(relay);
+    open_relays--;
+
+    return;
+}
+
+/**
+ * @brief Refuses the client because no backend takes new players. The client receives the "Server busy"
+ * message, like from a full server.
+ * @param relay Relay.
+ * @return void
+ */
+static void refuse_relay(Relay* relay) {
+    char buffer[BUF_MESSAGE_SIZE] = "Server busy";
+    send(relay->client, buffer, BUF_MESSAGE_SIZE, MSG_NOSIGNAL);
+    close_relay(relay);
+
+    return;
+}
+
+static void connect_backend(Relay* relay, int backend);
+
+/**
+ * @brief Takes the backend that refused the connection as down, and connects the relay to the next backend
+ * of the ring.
+ * @param relay Relay.
+ * @return void
+ */
+static void retry_backend(Relay* relay) {
+    set_backend_state(relay->backend, BACKEND_DOWN);
+    detach_backend(relay);
+
+    if (relay->attempts < MAX_BACKENDS) {
+        connect_backend(relay, -1);
+    } else {
+        refuse_relay(relay);
+    }
+
+    return;
+}
+
+/**
+ * @brief Connects the relay to the backend. Without a chosen backend the backend of the key is taken from
+ * the ring. The connection completes in the background.
+ * @param relay Relay.
+ * @param backend Index of the backend, -1 to take it from the ring.
+ * @return void
+ */
+static void connect_backend(Relay* relay, int backend) {
+    if (backend < 0) {
+        backend = hash_ring_lookup(&ring, relay->key, usable);
+    }
+
+    int backend_socket = backend < 0 ? -1 : socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (backend_socket < 0 || backend_socket >= relays_capacity) {
+        if (backend_socket >= 0) {
+            close(backend_socket);
+        }
+
+        refuse_relay(relay);
+        return;
+    }
+
+    relay->backend_socket = backend_socket;
+    relay->backend = backend;
+    relay->attempts++;
+    relay->state = RELAY_CONNECTING;
+    backends[backend].relays++;
+
+    const struct sockaddr* address = (const struct sockaddr*)&backends[backend].address;
+
+    if (!watch_socket(relay, backend_socket)) {
+        detach_backend(relay);
+        refuse_relay(relay);
+        return;
+    }
+
+    if (connect(backend_socket, address, sizeof(struct sockaddr_in)) < 0 && errno != EINPROGRESS) {
+        retry_backend(relay);
+        return;
+    }
+
+    update_relay_events(relay);
+
+    return;
+}
+
+/**
+ * @brief Routes the client once its first frame has arrived. The frame is only peeked, so the backend
+ * receives it unchanged. The hello, watch and legacy name frames are routed by the name of the player, the
+ * resume frame to the backend that issued the token.
+ * @param relay Relay.
+ * @return void
+ */
+static void route_client(Relay* relay) {
+    char data[BUF_MESSAGE_SIZE + 1];
+    ssize_t peeked = recv(relay->client, data, BUF_MESSAGE_SIZE, MSG_PEEK);
+
+    if (peeked == 0 || (peeked < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+        close_relay(relay);
+        return;
+    }
+
+    if (peeked < BUF_MESSAGE_SIZE) {
+        return;
+    }
+
+    Frame frame;
+    int version, backend = -1;
+    char name[HELLO_NAME_SIZE];
+    uint64_t token;
+
+    data[BUF_MESSAGE_SIZE] = '\0';
+
+    if (decode_frame(data, BUF_MESSAGE_SIZE, &frame) > 0 &&
+        (decode_hello(&frame, &version, name) || decode_watch(&frame, &version, name))) {
+        relay->key = hash_key(name, strlen(name));
+    } else if (decode_frame(data, BUF_MESSAGE_SIZE, &frame) > 0 && decode_resume(&frame, &version, &token)) {
+        TokenRoute* route = token_route(token);
+        relay->key = hash_key(&token, sizeof(token));
+        backend = route->token == token && usable[route->backend] ? route->backend : -1;
+    } else {
+        relay->key = hash_key(data, strlen(data));
+    }
+
+    end_handshake(relay);
+    connect_backend(relay, backend);
+
+    return;
+}
+
+/**
+ * @brief Remembers the backend of the resume token of a complete parameters frame.
+ * @param relay Relay.
+ * @return void
+ */
+static void learn_token(Relay* relay) {
+    Frame frame;
+    int version, field_size, number_of_ships, number_of_moves;
+    uint64_t token;
+
+    if (decode_frame(relay->frame, relay->frame_length, &frame) > 0 &&
+        decode_params(&frame, &version, &field_size, &number_of_ships, &number_of_moves, &token) &&
+        token != 0) {
+        TokenRoute* route = token_route(token);
+        route->token = token;
+        route->backend = relay->backend;
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the length of the payload of the current frame of the backend.
+ * @param relay Relay, its current frame has a complete header.
+ * @return Length of the payload.
+ */
+static size_t frame_payload(const Relay* relay) {
+    return (size_t)(uint8_t)relay->frame[1] << 8 | (uint8_t)relay->frame[2];
+}
+
+/**
+ * @brief Scans the bytes the backend sent to the client frame by frame, and learns the resume token of every
+ * parameters frame. A frame may be split between the calls. The scan stops at the first byte that does not
+ * start a frame, such as a message of the legacy protocol, and the rest of the connection is not scanned.
+ * @param relay Relay.
+ * @param data Bytes of the backend in the order they were sent.
+ * @param length Number of bytes.
+ * @return void
+ */
+static void scan_answers(Relay* relay, const char* data, size_t length) {
+    while (length > 0 && relay->scanning) {
+        size_t taken;
+
+        if (relay->skip > 0) {
+            taken = relay->skip < length ? relay->skip : length;
+            relay->skip -= taken;
+        } else {
+            bool header = relay->frame_length < FRAME_HEADER_SIZE ? true : false;
+            size_t wanted = header ? FRAME_HEADER_SIZE : FRAME_HEADER_SIZE + frame_payload(relay);
+
+            taken = wanted - relay->frame_length < length ? wanted - relay->frame_length : length;
+            memcpy(relay->frame + relay->frame_length, data, taken);
+            relay->frame_length += taken;
+
+            uint8_t opcode = (uint8_t)relay->frame[0];
+
+            if (header && relay->frame_length == FRAME_HEADER_SIZE) {
+                if (opcode < OP_PARAMS || opcode > OP_TRANSPORT || frame_payload(relay) > MAX_FRAME_PAYLOAD) {
+                    relay->scanning = false;
+                } else if (opcode != OP_PARAMS || frame_payload(relay) > PARAMS_TOKEN_SIZE) {
+                    relay->skip = frame_payload(relay);
+                    relay->frame_length = 0;
+                }
+            }
+
+            if (relay->scanning && relay->frame_length >= FRAME_HEADER_SIZE &&
+                relay->frame_length == FRAME_HEADER_SIZE + frame_payload(relay)) {
+                learn_token(relay);
+                relay->frame_length = 0;
+            }
+        }
+
+        data += taken;
+        length -= taken;
+    }
+
+    return;
+}
+
+/**
+ * @brief Moves the bytes of both directions of the relay, and closes the relay when both are done or a
+ * socket failed. While the answers of the backend are scanned, they are peeked first, and the stream to the
+ * client takes only the peeked bytes, so every byte that reaches the client was scanned before the next
+ * event of the router.
+ * @param relay Relay.
+ * @return void
+ */
+static void forward(Relay* relay) {
+    RelayStream* answers = &relay->streams[TO_CLIENT];
+    char data[RELAY_SCAN_SIZE];
+    ssize_t peeked = 0;
+
+    if (relay->scanning && answers->pending == 0 && !answers->finished) {
+        peeked = recv(relay->backend_socket, data, sizeof(data), MSG_PEEK);
+        answers->allowance = peeked > 0 ? (size_t)peeked
+                             : peeked < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR) ? 0
+                                                                                                          : 1;
+    } else if (relay->scanning) {
+        answers->allowance = 0;
+    }
+
+    size_t allowed = answers->allowance;
+
+    if (relay_pump(&relay->streams[TO_BACKEND]) < 0 || relay_pump(answers) < 0) {
+        close_relay(relay);
+        return;
+    }
+
+    if (relay->scanning && peeked > 0) {
+        scan_answers(relay, data, allowed - answers->allowance);
+    }
+
+    answers->allowance = relay->scanning ? 0 : RELAY_UNLIMITED;
+
+    if (relay_done(relay)) {
+        close_relay(relay);
+        return;
+    }
+
+    update_relay_events(relay);
+
+    return;
+}
+
+/**
+ * @brief Completes the connection to the backend. A backend that refuses the connection is taken as down,
+ * and the relay tries the next backend of the ring.
+ * @param relay Relay.
+ * @return void
+ */
+static void finish_connect(Relay* relay) {
+    int error = 0, enable = 1;
+    socklen_t length = sizeof(error);
+
+    if (getsockopt(relay->backend_socket, SOL_SOCKET, SO_ERROR, &error, &length) < 0 || error != 0) {
+        retry_backend(relay);
+        return;
+    }
+
+    setsockopt(relay->backend_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    if (!relay_start(relay)) {
+        close_relay(relay);
+        return;
+    }
+
+    forward(relay);
+
+    return;
+}
+
+/**
+ * @brief Handles the readiness of a socket of the relay.
+ * @param relay Relay.
+ * @return void
+ */
+static void handle_relay_event(Relay* relay) {
+    switch (relay->state) {
+        case RELAY_HANDSHAKE:
+            route_client(relay);
+            break;
+        case RELAY_CONNECTING:
+            finish_connect(relay);
+            break;
+        default:
+            forward(relay);
+            break;
+    }
+
+    return;
+}
+
+/**
+ * @brief Accepts all pending connections. Every connection gets a relay in the handshake state, which waits
+ * for the first frame until its deadline.
+ * @param router_socket Router socket.
+ * @return void
+ */
+static void accept_clients(int router_socket) {
+    while (true) {
+        int client_socket = accept4(router_socket, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("ACCEPT ERROR");
+            }
+
+            return;
+        }
+
+        Relay* relay = client_socket < relays_capacity ? (Relay*)malloc(sizeof(Relay)) : NULL;
+        if (relay == NULL) {
+            close(client_socket);
+            continue;
+        }
+
+        int enable = 1;
+        setsockopt(client_socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        relay_init(relay, client_socket);
+        open_relays++;
+
+        if (!watch_socket(relay, client_socket)) {
+            relay_close(relay);
+            free(relay);
+            open_relays--;
+            continue;
+        }
+
+        await_handshake(relay, now_ms());
+    }
+}
+
+/**
+ * @brief Records the result of the health check of the backend.
+ * @param backend Index of the backend.
+ * @param healthy true if the backend accepted the connection and did not refuse it.
+ * @return void
+ */
+static void finish_probe(int backend, bool healthy) {
+    stop_probe(backend);
+
+    if (backends[backend].state == BACKEND_UP || backends[backend].state == BACKEND_DOWN) {
+        set_backend_state(backend, healthy ? BACKEND_UP : BACKEND_DOWN);
+    }
+
+    return;
+}
+
+/**
+ * @brief Ends the connected health check for writing and waits for the answer of the backend. A full
+ * backend answers with "Server busy", a backend that takes the player sees the end of the connection before
+ * the first frame and closes it without an answer, so the check holds the session for one round trip only.
+ * @param backend Index of the backend.
+ * @param operation EPOLL_CTL_ADD if the check is not watched yet, EPOLL_CTL_MOD if it waits for the connection.
+ * @return void
+ */
+static void await_probe_answer(int backend, int operation) {
+    struct epoll_event event = {.events = EPOLLIN, .data.u64 = (uint64_t)backend << 8 | EVENT_PROBE};
+
+    backends[backend].probe_connected = true;
+
+    if (shutdown(backends[backend].probe, SHUT_WR) < 0 || epoll_ctl(epoll_fd, operation, backends[backend].probe, &event) < 0) {
+        finish_probe(backend, false);
+    }
+
+    return;
+}
+
+/**
+ * @brief Handles the health check of the backend: completes the connection, or reads the answer. The
+ * backend is healthy if it closes the connection without refusing it.
+ * @param backend Index of the backend.
+ * @return void
+ */
+static void handle_probe_event(int backend) {
+    Backend* checked = &backends[backend];
+    int error = 0;
+    socklen_t length = sizeof(error);
+
+    if (checked->probe < 0) {
+        return;
+    }
+
+    if (checked->probe_connected) {
+        char answer[BUF_MESSAGE_SIZE + 1] = {0};
+        ssize_t received = recv(checked->probe, answer, BUF_MESSAGE_SIZE, MSG_DONTWAIT);
+
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)) {
+            return;
+        }
+
+        finish_probe(backend, received >= 0 && strcmp(answer, "Server busy") != 0 ? true : false);
+        return;
+    }
+
+    if (getsockopt(checked->probe, SOL_SOCKET, SO_ERROR, &error, &length) < 0) {
+        error = errno;
+    }
+
+    if (error != 0) {
+        finish_probe(backend, false);
+        return;
+    }
+
+    await_probe_answer(backend, EPOLL_CTL_MOD);
+
+    return;
+}
+
+/**
+ * @brief Starts the health checks of the listed backends. A check that did not complete since the previous
+ * round counts as failed.
+ * @return void
+ */
+static void check_backends(void) {
+    for (int backend = 0; backend < MAX_BACKENDS; ++backend) {
+        Backend* checked = &backends[backend];
+
+        if (checked->state != BACKEND_UP && checked->state != BACKEND_DOWN) {
+            continue;
+        }
+
+        if (checked->probe >= 0) {
+            finish_probe(backend, false);
+        }
+
+        checked->probe = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        checked->probe_connected = false;
+        if (checked->probe < 0) {
+            continue;
+        }
+
+        const struct sockaddr* address = (const struct sockaddr*)&checked->address;
+        int connected = connect(checked->probe, address, sizeof(struct sockaddr_in));
+        struct epoll_event event = {.events = EPOLLOUT, .data.u64 = (uint64_t)backend << 8 | EVENT_PROBE};
+
+        if (connected == 0) {
+            await_probe_answer(backend, EPOLL_CTL_ADD);
+        } else if (errno != EINPROGRESS || epoll_ctl(epoll_fd, EPOLL_CTL_ADD, checked->probe, &event) < 0) {
+            finish_probe(backend, false);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Closes the relays whose first frame did not arrive by their deadline. The client receives the
+ * "Timeout" message, like from a server whose handshake_timeout expired.
+ * @param now Current time in milliseconds.
+ * @return void
+ */
+static void expire_handshakes(uint64_t now) {
+    while (handshakes_head != NULL && handshakes_head->deadline <= now) {
+        char buffer[BUF_MESSAGE_SIZE] = "Timeout";
+        send(handshakes_head->client, buffer, BUF_MESSAGE_SIZE, MSG_NOSIGNAL);
+        close_relay(handshakes_head);
+    }
+
+    return;
+}
+
+/**
+ * @brief Runs the router loop. The router socket and the sockets of the relays are non-blocking and are
+ * served by one epoll instance. The health checks and the deadlines of the handshakes run between the
+ * waits, and a wait ends by the next of them. When the router drains, the router socket is closed, and the
+ * function returns after the last relay.
+ * @param router_socket Router socket.
+ * @return void
+ */
+void run_router(int router_socket) {
+    struct rlimit limit;
+    CHECK_LESS_THAN_ZERO(getrlimit(RLIMIT_NOFILE, &limit), "GETRLIMIT ERROR");
+
+    relays_capacity = (int)limit.rlim_cur;
+    relays = (Relay**)calloc(relays_capacity, sizeof(Relay*));
+    if (relays == NULL) {
+        printf("ERROR: not enough memory for the relays\n");
+        exit(EXIT_FAILURE);
+    }
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    CHECK_LESS_THAN_ZERO(epoll_fd, "EPOLL ERROR");
+
+    struct epoll_event event = {.events = EPOLLIN, .data.u64 = (uint64_t)router_socket << 8 | EVENT_LISTENER};
+    CHECK_LESS_THAN_ZERO(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, router_socket, &event), "EPOLL_CTL ERROR");
+
+    struct epoll_event events[MAX_EVENTS];
+    uint64_t next_check = now_ms();
+    bool accepting = true;
+
+    while (accepting || open_relays > 0) {
+        uint64_t now = now_ms();
+
+        if (now >= next_check) {
+            check_backends();
+            next_check = now + (uint64_t)config.health_interval * 1000;
+        }
+
+        expire_handshakes(now);
+
+        uint64_t wake = next_check;
+        if (handshakes_head != NULL && handshakes_head->deadline < wake) {
+            wake = handshakes_head->deadline;
+        }
+
+        int ready = epoll_pwait(epoll_fd, events, MAX_EVENTS, (int)(wake - now), &wait_mask);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                perror("EPOLL_WAIT ERROR");
+                exit(EXIT_FAILURE);
+            }
+
+            ready = 0;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int target = (int)(events[i].data.u64 >> 8);
+
+            switch ((EventSource)(events[i].data.u64 & 0xFF)) {
+                case EVENT_LISTENER:
+                    accept_clients(router_socket);
+                    break;
+                case EVENT_PROBE:
+                    handle_probe_event(target);
+                    break;
+                default:
+                    if (relays[target] != NULL) {
+                        handle_relay_event(relays[target]);
+                    }
+                    break;
+            }
+        }
+
+        if (reloading) {
+            reloading = 0;
+
+            if (read_configuration()) {
+                apply_backends();
+                printf("Reloaded %d backends\n", config.number_of_backends);
+            }
+        }
+
+        if (draining && accepting) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, router_socket, NULL);
+            close(router_socket);
+            accepting = false;
+            printf("Stopped accepting connections, finishing %d relays\n", open_relays);
+        }
+    }
+
+    close(epoll_fd);
+    free(relays);
+
+    return;
+}
@@ -0,0 +1,79 @@
+/*! @file router.h
+File with the declarations of the router. The router accepts the connections of the players, reads the
+name of the player from the first frame without consuming it, and connects the player to a backend server
+chosen by the consistent hash of the name, so the games of a player always land on the same backend while
+it is up. The configuration is read from ROUTER_CONFIG_FILE.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef ROUTER_H
+#define ROUTER_H
+
+#include <netinet/in.h>
+#include <sys/un.h>
+
+#include "../shared/shared.h"
+
+#define ROUTER_CONFIG_FILE "router.cfg"
+
+#define MAX_CONFIG_KEY_LENGTH 15
+#define BUF_CONFIG_SIZE (MAX_CONFIG_KEY_LENGTH + sizeof(((struct sockaddr_un*)NULL)->sun_path) + 2)
+#define MAX_BACKENDS 32
+#define BACKEND_ADDRESS_SIZE 22
+#define DEFAULT_HEALTH_INTERVAL 1
+#define DEFAULT_HANDSHAKE_TIMEOUT 10
+#define DEFAULT_LISTEN_BACKLOG 128
+
+/**
+ * @struct RouterConfig
+ * @brief Structure for storing router configuration.
+ *
+ * @param router_address IP address of the router.
+ * @param router_port Port number for the router.
+ * @param backends Addresses of the backend servers in the format "address:port".
+ * @param number_of_backends Number of the backend servers.
+ * @param health_interval Seconds between the health checks of the backends.
+ * @param handshake_timeout Seconds to wait for the first frame of a client.
+ * @param listen_backlog Maximum number of connections waiting to be accepted.
+ */
+typedef struct {
+    char router_address[16];
+    int router_port;
+    char backends[MAX_BACKENDS][BACKEND_ADDRESS_SIZE];
+    int number_of_backends;
+    int health_interval;
+    int handshake_timeout;
+    int listen_backlog;
+} RouterConfig;
+
+/**
+ * @brief Enumeration for the state of a backend.
+ */
+typedef enum {
+    BACKEND_UNUSED,  /**< The slot has no backend */
+    BACKEND_UP,      /**< The backend takes new players */
+    BACKEND_DOWN,    /**< The last health check or connection failed, the players go to the next backend */
+    BACKEND_DRAINING /**< The backend was removed from the configuration and finishes its connections */
+} BackendState;
+
+/**
+ * @struct Backend
+ * @brief Structure for a backend server.
+ *
+ * @param state State of the backend.
+ * @param name Address of the backend in the format "address:port".
+ * @param address Socket address of the backend.
+ * @param relays Number of the relays connected to the backend.
+ * @param probe Socket of the running health check, -1 if there is none.
+ * @param probe_connected true if the health check is connected and waits for the answer of the backend.
+ */
+typedef struct {
+    BackendState state;
+    char name[BACKEND_ADDRESS_SIZE];
+    struct sockaddr_in address;
+    int relays;
+    int probe;
+    bool probe_connected;
+} Backend;
+
+#endif
@@ -0,0 +1,143 @@
+/*! @file board_queue.c
+File with the implementation of the queue of prepared boards. The queue is filled by a producer thread of
+the process that accepts the connections, and the boards are taken by the same process: in the fork mode
+the board is copied into the session before the child process is created.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "board_queue.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "server.h"
+
+BoardQueue board_queue;
+
+/**
+ * @brief Returns the board of the slot.
+ * @param queue Queue.
+ * @param position Position in the queue.
+ * @return Board of the slot.
+ */
+static GameBoard* slot_board(BoardQueue* queue, uint64_t position) {
+    return (GameBoard*)(queue->boards + (size_t)(position % (uint64_t)queue->capacity) * queue->board_size);
+}
+
+/**
+ * @brief Places the ships on the boards of the free slots and publishes them with their seeds. Sleeps while
+ * the queue is full.
+ * @param argument Queue.
+ * @return NULL, the thread runs until the process exits.
+ */
+static void* produce_boards(void* argument) {
+    BoardQueue* queue = (BoardQueue*)argument;
+    GameContext game;
+
+    while (true) {
+        while (sem_wait(&queue->free_slots) != 0) {
+        }
+
+        uint64_t tail = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+        uint64_t seed = next_game_seed();
+
+        init_game_context(&game, queue->rules, slot_board(queue, tail));
+        start_game(&game, seed);
+        queue->seeds[tail % (uint64_t)queue->capacity] = seed;
+
+        __atomic_store_n(&queue->tail, tail + 1, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Initializes the queue, allocates the slots, and starts the producer thread.
+ * @param queue Queue.
+ * @param capacity Number of slots.
+ * @param rules Rules of the games.
+ * @return void
+ */
+void board_queue_init(BoardQueue* queue, int capacity, const GameRules* rules) {
+    queue->head = 0;
+    queue->tail = 0;
+    queue->board_size = (game_board_size(rules->field_size, max_marked_cells(rules)) + CACHE_LINE_SIZE - 1) /
+                        CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    queue->capacity = capacity;
+    queue->rules = rules;
+    queue->taken = 0;
+    queue->dry = 0;
+    queue->boards = (char*)aligned_alloc(CACHE_LINE_SIZE, queue->board_size * capacity);
+    queue->seeds = (uint64_t*)calloc(capacity, sizeof(uint64_t));
+
+    if (queue->boards == NULL || queue->seeds == NULL) {
+        printf("ERROR: not enough memory for the prepared boards\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < capacity; ++i) {
+        init_game_board(queue->boards + (size_t)i * queue->board_size, rules->field_size,
+                        max_marked_cells(rules));
+    }
+
+    CHECK_LESS_THAN_ZERO(sem_init(&queue->free_slots, 0, capacity), "SEM_INIT ERROR");
+
+    int error = pthread_create(&queue->producer, NULL, produce_boards, queue);
+    if (error != 0) {
+        printf("ERROR: cannot start the board producer: %s\n", strerror(error));
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_detach(queue->producer);
+
+    return;
+}
+
+/**
+ * @brief Takes the prepared board from the queue. The board is copied, so the slot is given back to the
+ * producer at once.
+ * @param queue Queue.
+ * @param board Board of the session, it must have the field size of the queue.
+ * @param seed Seed the ships of the board were placed with.
+ * @return true if the board was copied, false if the queue is empty.
+ */
+bool board_queue_pop(BoardQueue* queue, GameBoard* board, uint64_t* seed) {
+    uint64_t head = queue->head;
+
+    if (head == __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE)) {
+        queue->dry++;
+        return false;
+    }
+
+    memcpy(board, slot_board(queue, head), board_memory_size(board));
+    *seed = queue->seeds[head % (uint64_t)queue->capacity];
+    __atomic_store_n(&queue->head, head + 1, __ATOMIC_RELEASE);
+    sem_post(&queue->free_slots);
+
+    queue->taken++;
+
+    return true;
+}
+
+/**
+ * @brief Returns the number of prepared boards in the queue.
+ * @param queue Queue.
+ * @return Number of boards.
+ */
+int board_queue_depth(BoardQueue* queue) {
+    return (int)(__atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE) - queue->head);
+}
+
+/**
+ * @brief Empties the copy of the queue in a child process. The producer does not run in the child, and the
+ * boards of the copy are handed out by the parent as well, so the child places the ships of its next games
+ * itself.
+ * @param queue Queue.
+ * @return void
+ */
+void board_queue_detach(BoardQueue* queue) {
+    queue->head = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+
+    return;
+}
@@ -0,0 +1,63 @@
+/*! @file board_queue.h
+File with the declaration of the queue of prepared boards. A producer thread places the ships on boards in
+advance and keeps the queue full, so a new session takes a ready board instead of placing the ships on the
+accept path.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef BOARD_QUEUE_H
+#define BOARD_QUEUE_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "../engine/engine.h"
+
+#define CACHE_LINE_SIZE 64
+
+/**
+ * @struct BoardQueue
+ * @brief Structure for the lock-free ring of prepared boards with one producer and one consumer. The
+ * producer fills the slot at the tail and then publishes the tail, the consumer copies the board at the
+ * head and then publishes the head. The producer sleeps on the semaphore of the free slots while the
+ * queue is full.
+ *
+ * @param head Number of boards taken by the consumer.
+ * @param tail Number of boards published by the producer.
+ * @param boards Memory of the slots.
+ * @param seeds Seeds of the boards of the slots.
+ * @param board_size Size of one slot in bytes.
+ * @param capacity Number of slots.
+ * @param rules Rules of the games.
+ * @param free_slots Semaphore of the free slots.
+ * @param producer Producer thread.
+ * @param taken Number of boards taken from the queue.
+ * @param dry Number of times the queue was empty.
+ */
+typedef struct {
+    _Alignas(CACHE_LINE_SIZE) uint64_t head;
+    _Alignas(CACHE_LINE_SIZE) uint64_t tail;
+    _Alignas(CACHE_LINE_SIZE) char* boards;
+    uint64_t* seeds;
+    size_t board_size;
+    int capacity;
+    const GameRules* rules;
+    sem_t free_slots;
+    pthread_t producer;
+    uint64_t taken;
+    uint64_t dry;
+} BoardQueue;
+
+/**
+ * @brief Queue of prepared boards of the current process.
+ */
+extern BoardQueue board_queue;
+
+void board_queue_init(BoardQueue* queue, int capacity, const GameRules* rules);
+bool board_queue_pop(BoardQueue* queue, GameBoard* board, uint64_t* seed);
+int board_queue_depth(BoardQueue* queue);
+void board_queue_detach(BoardQueue* queue);
+
+#endif
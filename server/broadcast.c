@@ -0,0 +1,464 @@
+/*! @file broadcast.c
+File with the implementation of the broadcast of the games to the spectators. The players of the process
+that can be watched are kept in a list, and every player keeps the list of its spectators. An event is
+taken from a list of free events and returns to it when the last queue has sent it. The spectators that
+got new output are kept in a list for the server loop, which sends their output after the player was
+served. A spectator that falls behind skips the queued events that are not being sent, and gets the
+parameters and the state of the game instead; a spectator whose whole queue is being sent is dropped.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "broadcast.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "logger.h"
+#include "metrics.h"
+#include "session.h"
+
+/**
+ * @brief Players of the process that can be watched, the newest first.
+ */
+static Session* players;
+
+/**
+ * @brief Spectators with new output.
+ */
+static Session* pending;
+
+/**
+ * @brief Events that are not used by any queue.
+ */
+static BroadcastEvent* free_events;
+
+/**
+ * @brief Initializes the broadcast state of the new session.
+ * @param session Session.
+ * @return void
+ */
+void broadcast_init(Session* session) {
+    memset(&session->broadcast, 0, sizeof(session->broadcast));
+
+    return;
+}
+
+/**
+ * @brief Takes a free event, or allocates one. The publisher holds the only reference.
+ * @return Event, NULL if there is not enough memory.
+ */
+static BroadcastEvent* event_acquire(void) {
+    BroadcastEvent* event = free_events;
+
+    if (event != NULL) {
+        free_events = event->next_free;
+    } else if ((event = (BroadcastEvent*)malloc(sizeof(BroadcastEvent))) == NULL) {
+        return NULL;
+    }
+
+    event->references = 1;
+    event->size = 0;
+
+    return event;
+}
+
+/**
+ * @brief Drops a reference to the event. The event is free when the last reference is dropped.
+ * @param event Event.
+ * @return void
+ */
+static void event_release(BroadcastEvent* event) {
+    if (event != NULL && --event->references == 0) {
+        event->next_free = free_events;
+        free_events = event;
+    }
+
+    return;
+}
+
+/**
+ * @brief Encodes the parameters and the state of the game of the player, so a spectator can show the game
+ * from that moment on.
+ * @param player Session of the player.
+ * @param buffer Destination of BROADCAST_EVENT_SIZE bytes.
+ * @return Size of the frames.
+ */
+static size_t encode_snapshot(const Session* player, char* buffer) {
+    const GameRules* rules = player->game.rules;
+    size_t size = encode_params(buffer, rules->field_size, rules->number_of_ships, rules->number_of_moves, 0);
+
+    return size + encode_state(buffer + size, player->game.number_of_ships, player->game.number_of_moves,
+                               player->game.board);
+}
+
+/**
+ * @brief Adds the spectator to the list of the spectators with new output.
+ * @param spectator Session of the spectator.
+ * @return void
+ */
+static void mark_pending(Session* spectator) {
+    if (!spectator->broadcast.pending) {
+        spectator->broadcast.pending = true;
+        spectator->broadcast.next_pending = pending;
+        pending = spectator;
+    }
+
+    return;
+}
+
+/**
+ * @brief Drops the events of the queue of the spectator from the index on.
+ * @param spectator Session of the spectator.
+ * @param kept Number of the first events that are kept.
+ * @return void
+ */
+static void truncate_queue(Session* spectator, uint32_t kept) {
+    Broadcast* queue = &spectator->broadcast;
+
+    for (uint32_t i = kept; i < queue->event_count; ++i) {
+        event_release(queue->events[(queue->first_event + i) % SPECTATOR_BACKLOG]);
+    }
+
+    queue->event_count = kept;
+
+    return;
+}
+
+/**
+ * @brief Removes the spectator from the list of the spectators of the player.
+ * @param spectator Session of the spectator.
+ * @return void
+ */
+static void unsubscribe(Session* spectator) {
+    Session** link = &spectator->broadcast.watched->broadcast.spectators;
+
+    while (*link != spectator) {
+        link = &(*link)->broadcast.next_spectator;
+    }
+
+    *link = spectator->broadcast.next_spectator;
+    spectator->broadcast.watched = NULL;
+
+    return;
+}
+
+/**
+ * @brief Finishes the spectator. The events that are not being sent are dropped, so the connection is
+ * closed as soon as the message being sent completes.
+ * @param spectator Session of the spectator.
+ * @return void
+ */
+static void finish_spectator(Session* spectator) {
+    Broadcast* queue = &spectator->broadcast;
+
+    if (queue->events_in_flight == 0) {
+        spectator->output_length = 0;
+    }
+
+    truncate_queue(spectator, queue->events_in_flight);
+    spectator->state = SESSION_FINISHED;
+    mark_pending(spectator);
+
+    return;
+}
+
+/**
+ * @brief Appends the event to the queue of the spectator. A full queue skips to the snapshot of the game:
+ * the events that are not being sent are dropped, and the snapshot is queued instead of the event. The
+ * snapshot is encoded once for all spectators that skip on the same move.
+ * @param spectator Session of the spectator.
+ * @param event Event.
+ * @param snapshot Snapshot of the game after the move, NULL until a spectator needs it.
+ * @return void
+ */
+static void enqueue(Session* spectator, BroadcastEvent* event, BroadcastEvent** snapshot) {
+    Broadcast* queue = &spectator->broadcast;
+
+    if (queue->event_count == SPECTATOR_BACKLOG) {
+        uint32_t kept = queue->events_in_flight;
+
+        if (kept == 0 && queue->event_offset > 0) {
+            kept = 1;
+        }
+
+        if (*snapshot == NULL && (*snapshot = event_acquire()) != NULL) {
+            (*snapshot)->size = (uint32_t)encode_snapshot(queue->watched, (*snapshot)->data);
+        }
+
+        if (kept == SPECTATOR_BACKLOG || *snapshot == NULL) {
+            metrics_add(METRIC_SPECTATORS_DROPPED, 1);
+            unsubscribe(spectator);
+            finish_spectator(spectator);
+            return;
+        }
+
+        truncate_queue(spectator, kept);
+        metrics_add(METRIC_SPECTATOR_SKIPS, 1);
+        event = *snapshot;
+    }
+
+    event->references++;
+    queue->events[(queue->first_event + queue->event_count) % SPECTATOR_BACKLOG] = event;
+    queue->event_count++;
+    mark_pending(spectator);
+
+    return;
+}
+
+/**
+ * @brief Publishes the encoded frames to all spectators of the player.
+ * @param player Session of the player.
+ * @param event Event with the encoded frames, the reference of the publisher is dropped.
+ * @return void
+ */
+static void publish(Session* player, BroadcastEvent* event) {
+    BroadcastEvent* snapshot = NULL;
+    Session* spectator = player->broadcast.spectators;
+
+    while (spectator != NULL) {
+        Session* next = spectator->broadcast.next_spectator;
+        enqueue(spectator, event, &snapshot);
+        spectator = next;
+    }
+
+    event_release(event);
+    event_release(snapshot);
+
+    return;
+}
+
+/**
+ * @brief Makes the game of the player visible to the spectators. The player joins the list of the players
+ * that can be watched, and its spectators get the parameters and the state of the new game.
+ * @param player Session of the player.
+ * @return void
+ */
+void broadcast_game_started(Session* player) {
+    Broadcast* broadcast = &player->broadcast;
+
+    if (!broadcast->registered) {
+        broadcast->registered = true;
+        broadcast->previous_player = NULL;
+        broadcast->next_player = players;
+
+        if (players != NULL) {
+            players->broadcast.previous_player = player;
+        }
+
+        players = player;
+    }
+
+    if (broadcast->spectators == NULL) {
+        return;
+    }
+
+    BroadcastEvent* event = event_acquire();
+    if (event != NULL) {
+        event->size = (uint32_t)encode_snapshot(player, event->data);
+        publish(player, event);
+    }
+
+    return;
+}
+
+/**
+ * @brief Publishes the move of the player to its spectators. The event is encoded once, only if the game is
+ * watched.
+ * @param player Session of the player.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @return void
+ */
+void broadcast_move(Session* player, int x, int y, MoveResult result, GameStatus status) {
+    if (player->broadcast.spectators == NULL) {
+        return;
+    }
+
+    BroadcastEvent* event = event_acquire();
+    if (event == NULL) {
+        return;
+    }
+
+    GameEvent move = {x, y, result, status, player->game.number_of_ships, player->game.number_of_moves};
+    event->size = (uint32_t)encode_event(event->data, &move);
+    publish(player, event);
+
+    return;
+}
+
+/**
+ * @brief Makes the session a spectator of the newest game of the player with the name. The parameters and
+ * the state of the game are written to the output of the spectator, which is empty during the handshake.
+ * @param spectator Session of the spectator.
+ * @param name Name of the player.
+ * @return true if the game is watched, false if the process plays no game of the player.
+ */
+bool broadcast_watch(Session* spectator, const char* name) {
+    Session* player = players;
+
+    while (player != NULL && (strcmp(player->name, name) != 0 ||
+                              (player->state != SESSION_PLAYING && player->state != SESSION_OVER))) {
+        player = player->broadcast.next_player;
+    }
+
+    if (player == NULL) {
+        return false;
+    }
+
+    spectator->broadcast.watched = player;
+    spectator->broadcast.next_spectator = player->broadcast.spectators;
+    player->broadcast.spectators = spectator;
+    spectator->output_length += encode_snapshot(player, spectator->output + spectator->output_length);
+
+    metrics_add(METRIC_SPECTATORS, 1);
+
+    LogRecord* record = log_begin(LOG_EVENT_WATCH);
+    if (record != NULL) {
+        log_text(record, player->name);
+        log_commit();
+    }
+
+    return true;
+}
+
+/**
+ * @brief Removes the session that is closed from the broadcast. A player leaves the list of the players
+ * and finishes its spectators, a spectator leaves the spectators of its player. The queued events are
+ * released, the connection has no message being sent when it is closed.
+ * @param session Session.
+ * @return void
+ */
+void broadcast_leave(Session* session) {
+    Broadcast* broadcast = &session->broadcast;
+
+    if (broadcast->watched != NULL) {
+        unsubscribe(session);
+    }
+
+    while (broadcast->spectators != NULL) {
+        Session* spectator = broadcast->spectators;
+        broadcast->spectators = spectator->broadcast.next_spectator;
+        spectator->broadcast.watched = NULL;
+        finish_spectator(spectator);
+    }
+
+    if (broadcast->registered) {
+        if (broadcast->previous_player != NULL) {
+            broadcast->previous_player->broadcast.next_player = broadcast->next_player;
+        } else {
+            players = broadcast->next_player;
+        }
+
+        if (broadcast->next_player != NULL) {
+            broadcast->next_player->broadcast.previous_player = broadcast->previous_player;
+        }
+
+        broadcast->registered = false;
+    }
+
+    if (broadcast->pending) {
+        Session** link = &pending;
+
+        while (*link != session) {
+            link = &(*link)->broadcast.next_pending;
+        }
+
+        *link = broadcast->next_pending;
+        broadcast->pending = false;
+    }
+
+    broadcast->events_in_flight = 0;
+    truncate_queue(session, 0);
+
+    return;
+}
+
+/**
+ * @brief Takes the next spectator with new output. The server loop sends its output, or closes it if it
+ * is finished.
+ * @return Session of the spectator, NULL if there is none.
+ */
+Session* broadcast_next_pending(void) {
+    Session* spectator = pending;
+
+    if (spectator != NULL) {
+        pending = spectator->broadcast.next_pending;
+        spectator->broadcast.pending = false;
+    }
+
+    return spectator;
+}
+
+/**
+ * @brief Checks if the spectator has queued events.
+ * @param session Session.
+ * @return true if there are queued events, false otherwise.
+ */
+bool broadcast_has_output(const Session* session) {
+    return session->broadcast.event_count > 0 ? true : false;
+}
+
+/**
+ * @brief Gathers the output buffer of the session and its queued events into one message. The events
+ * of the message are kept until the message is consumed, even if the spectator skips meanwhile.
+ * @param session Session.
+ * @return Message to send.
+ */
+struct msghdr* broadcast_message(Session* session) {
+    Broadcast* queue = &session->broadcast;
+    int parts = 0;
+
+    if (session->output_length > 0) {
+        queue->vector[parts].iov_base = session->output;
+        queue->vector[parts++].iov_len = session->output_length;
+    }
+
+    for (uint32_t i = 0; i < queue->event_count; ++i) {
+        BroadcastEvent* event = queue->events[(queue->first_event + i) % SPECTATOR_BACKLOG];
+        size_t offset = i == 0 ? queue->event_offset : 0;
+
+        queue->vector[parts].iov_base = event->data + offset;
+        queue->vector[parts++].iov_len = event->size - offset;
+    }
+
+    memset(&queue->message, 0, sizeof(queue->message));
+    queue->message.msg_iov = queue->vector;
+    queue->message.msg_iovlen = parts;
+    queue->events_in_flight = queue->event_count;
+
+    return &queue->message;
+}
+
+/**
+ * @brief Removes the sent bytes of the queued events, after the output buffer of the session was consumed.
+ * The events that were sent completely are released.
+ * @param session Session.
+ * @param size Number of sent bytes of the events.
+ * @return void
+ */
+void broadcast_consume(Session* session, size_t size) {
+    Broadcast* queue = &session->broadcast;
+
+    while (size > 0 && queue->event_count > 0) {
+        BroadcastEvent* event = queue->events[queue->first_event];
+        size_t left = event->size - queue->event_offset;
+
+        if (size < left) {
+            queue->event_offset += size;
+            break;
+        }
+
+        size -= left;
+        queue->event_offset = 0;
+        queue->first_event = (queue->first_event + 1) % SPECTATOR_BACKLOG;
+        queue->event_count--;
+        event_release(event);
+    }
+
+    queue->events_in_flight = 0;
+
+    return;
+}
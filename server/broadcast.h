@@ -0,0 +1,92 @@
+/*! @file broadcast.h
+File with the declaration of the broadcast of the games to the spectators. A spectator is a connection that
+starts with the watch frame and the name of a player instead of the hello frame. It receives the state of
+the game of the player and then every move of the game. Every move is encoded once into a reference-counted
+event, and the queues of all spectators point to the same event, so the output of a spectator is gathered
+from the shared events by one sendmsg and never copied per spectator. The player never waits for its
+spectators: a spectator that is SPECTATOR_BACKLOG events behind skips to the current state of the game.
+The spectators are served by the process that plays the game.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef BROADCAST_H
+#define BROADCAST_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "../shared/protocol.h"
+
+#define SPECTATOR_BACKLOG 32
+#define BROADCAST_EVENT_SIZE (2 * MAX_FRAME_SIZE)
+
+struct Session;
+
+/**
+ * @struct BroadcastEvent
+ * @brief Structure for an encoded event shared by the queues of the spectators.
+ *
+ * @param references Number of the queues and the publisher that hold the event.
+ * @param size Size of the encoded frames.
+ * @param next_free Next event of the list of the free events.
+ * @param data Encoded frames: an event frame, or the parameters and the state of the game.
+ */
+typedef struct BroadcastEvent {
+    uint32_t references;
+    uint32_t size;
+    struct BroadcastEvent* next_free;
+    char data[BROADCAST_EVENT_SIZE];
+} BroadcastEvent;
+
+/**
+ * @struct Broadcast
+ * @brief Structure for the broadcast state of a session: the spectators of a player, or the queue of the
+ * events of a spectator.
+ *
+ * @param watched Session of the watched player, NULL if the session is not a spectator.
+ * @param spectators First spectator of the player.
+ * @param next_spectator Next spectator of the same player.
+ * @param previous_player Previous player of the list of the players that can be watched.
+ * @param next_player Next player of the list of the players that can be watched.
+ * @param registered true if the player is in the list of the players that can be watched.
+ * @param pending true if the spectator is in the list of the spectators with new output.
+ * @param next_pending Next spectator of the list of the spectators with new output.
+ * @param events Queue of the events of the spectator.
+ * @param first_event Index of the first event of the queue.
+ * @param event_count Number of the events of the queue.
+ * @param events_in_flight Number of the events of the queue gathered into the message being sent.
+ * @param event_offset Number of sent bytes of the first event.
+ * @param message Message that gathers the output of the spectator.
+ * @param vector Parts of the message: the output buffer of the session and the queued events.
+ */
+typedef struct {
+    struct Session* watched;
+    struct Session* spectators;
+    struct Session* next_spectator;
+    struct Session* previous_player;
+    struct Session* next_player;
+    bool registered;
+    bool pending;
+    struct Session* next_pending;
+    BroadcastEvent* events[SPECTATOR_BACKLOG];
+    uint32_t first_event;
+    uint32_t event_count;
+    uint32_t events_in_flight;
+    size_t event_offset;
+    struct msghdr message;
+    struct iovec vector[SPECTATOR_BACKLOG + 1];
+} Broadcast;
+
+void broadcast_init(struct Session* session);
+void broadcast_game_started(struct Session* player);
+void broadcast_move(struct Session* player, int x, int y, MoveResult result, GameStatus status);
+bool broadcast_watch(struct Session* spectator, const char* name);
+void broadcast_leave(struct Session* session);
+struct Session* broadcast_next_pending(void);
+bool broadcast_has_output(const struct Session* session);
+struct msghdr* broadcast_message(struct Session* session);
+void broadcast_consume(struct Session* session, size_t size);
+
+#endif
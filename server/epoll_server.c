@@ -0,0 +1,446 @@
+/*! @file epoll_server.c
+File with the implementation of the event-driven server mode. A single process serves all players with
+non-blocking sockets and epoll. Every connection has a session, and the sessions are stored in a table
+indexed by the file descriptor of the client socket. A session with a shared-memory channel is also stored
+at the eventfd of the channel, which is registered edge-triggered: the player writes it only after the
+session marked that it waits, and the session serves the channel until it marks that again.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "epoll_server.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "server.h"
+#include "session.h"
+#include "session_pool.h"
+#include "timer_wheel.h"
+#include "trace.h"
+
+#define MAX_EVENTS 256
+
+/**
+ * @brief Table of the sessions indexed by the file descriptor of the client socket and of the eventfd of
+ * the channel.
+ */
+static Session** sessions;
+
+/**
+ * @brief Number of entries in the table of the sessions.
+ */
+static int sessions_capacity;
+
+/**
+ * @brief Timers of the idle timeouts of the sessions.
+ */
+static TimerWheel timers;
+
+/**
+ * @brief Closes the connection of the player and releases the session.
+ * @param epoll_fd Epoll instance.
+ * @param session Session to close.
+ * @return void
+ */
+static void close_session(int epoll_fd, Session* session) {
+    timer_cancel(&timers, &session->timer);
+
+    if (session->channel.memory != NULL && sessions[session->channel.wakeup] == session) {
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session->channel.wakeup, NULL);
+        sessions[session->channel.wakeup] = NULL;
+    }
+
+    epoll_ctl(epoll_fd, EPOLL_CTL_DEL, session->socket, NULL);
+    shutdown(session->socket, SHUT_RDWR);
+    close(session->socket);
+
+    sessions[session->socket] = NULL;
+    session_finish(session);
+    session_pool_release(&session_pool, session);
+
+    return;
+}
+
+/**
+ * @brief Updates the events the session waits for. The session waits for input while the game is not
+ * over and there is space in the input buffer, and for output while there are pending bytes. A session
+ * with a channel keeps waiting for input on the socket, which only tells that the player is gone.
+ * @param epoll_fd Epoll instance.
+ * @param session Session.
+ * @return void
+ */
+static void update_session_events(int epoll_fd, Session* session) {
+    uint32_t events = 0;
+
+    if (session->channel.memory != NULL) {
+        return;
+    }
+
+    if (session->state != SESSION_FINISHED && session->input_length < SESSION_BUFFER_SIZE) {
+        events |= EPOLLIN;
+    }
+
+    if (session_has_output(session)) {
+        events |= EPOLLOUT;
+    }
+
+    if (events != session->events) {
+        struct epoll_event event = {.events = events, .data.fd = session->socket};
+        epoll_ctl(epoll_fd, EPOLL_CTL_MOD, session->socket, &event);
+        session->events = events;
+    }
+
+    return;
+}
+
+/**
+ * @brief Arms the timer of the session at its deadline, or cancels it if the session has no deadline.
+ * @param session Session.
+ * @return void
+ */
+static void update_session_timer(Session* session) {
+    uint64_t deadline = session_deadline(session);
+
+    if (deadline == 0) {
+        timer_cancel(&timers, &session->timer);
+    } else {
+        timer_arm(&timers, &session->timer, deadline);
+    }
+
+    return;
+}
+
+/**
+ * @brief Finishes the session of the expired timer. The answer is sent if the socket takes it at once,
+ * and the connection is closed.
+ * @param timer Timer of the session.
+ * @param context Epoll instance.
+ * @return void
+ */
+static void expire_session(TimerNode* timer, void* context) {
+    Session* session = (Session*)((char*)timer - offsetof(Session, timer));
+
+    session_expire(session);
+    session_write_output(session);
+    close_session(*(int*)context, session);
+
+    return;
+}
+
+/**
+ * @brief Accepts all pending connections. Every connection gets a session from the session pool in the
+ * handshake state. The connection is refused if all sessions are in use.
+ * @param epoll_fd Epoll instance.
+ * @param listener Server socket or listener of the local socket.
+ * @return void
+ */
+static void accept_connections(int epoll_fd, int listener) {
+    while (true) {
+        int client_socket = accept4(listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_socket < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                perror("ACCEPT ERROR");
+            }
+
+            return;
+        }
+
+        metrics_add(METRIC_CONNECTIONS_ACCEPTED, 1);
+
+        if (client_socket >= sessions_capacity) {
+            metrics_add(METRIC_CONNECTIONS_CLOSED, 1);
+            close(client_socket);
+            continue;
+        }
+
+        Session* session = session_pool_acquire(&session_pool);
+        if (session == NULL) {
+            refuse_client(client_socket);
+            continue;
+        }
+
+        session_init(session, client_socket);
+        session->events = EPOLLIN;
+
+        struct epoll_event event = {.events = EPOLLIN, .data.fd = client_socket};
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0) {
+            perror("EPOLL_CTL ERROR");
+            session_finish(session);
+            session_pool_release(&session_pool, session);
+            close(client_socket);
+            continue;
+        }
+
+        sessions[client_socket] = session;
+        update_session_timer(session);
+    }
+}
+
+/**
+ * @brief Registers the eventfd of the channel the player attached during the handshake. The session is then
+ * served by handle_channel_event.
+ * @param epoll_fd Epoll instance.
+ * @param session Session.
+ * @return true if the eventfd was registered, false otherwise.
+ */
+static bool register_channel(int epoll_fd, Session* session) {
+    int wakeup = session->channel.wakeup;
+
+    if (wakeup >= sessions_capacity) {
+        return false;
+    }
+
+    struct epoll_event event = {.events = EPOLLIN | EPOLLET, .data.fd = wakeup};
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wakeup, &event) < 0) {
+        perror("EPOLL_CTL ERROR");
+        return false;
+    }
+
+    sessions[wakeup] = session;
+
+    return true;
+}
+
+/**
+ * @brief Serves the session of a channel. Receives the frames, processes them, and sends the answers until
+ * the input ring is empty or the output ring is full. Either way the session has marked that it waits, so
+ * the player writes the eventfd on its next update of the ring. An event of the socket means that the
+ * player is gone; the frames left in the ring are still served.
+ * @param epoll_fd Epoll instance.
+ * @param session Session.
+ * @param socket_ready true if the event came from the socket.
+ * @return void
+ */
+static void handle_channel_event(int epoll_fd, Session* session, bool socket_ready) {
+    if (socket_ready) {
+        session->channel.closed = true;
+    }
+
+    while (true) {
+        ssize_t received = session_read_input(session);
+        if (received == 0 || (received < 0 && errno != EAGAIN)) {
+            close_session(epoll_fd, session);
+            return;
+        }
+
+        while (true) {
+            int processed = session_process_input(session);
+
+            if (session_write_output(session) < 0) {
+                close_session(epoll_fd, session);
+                return;
+            }
+
+            if (processed == 0 || session_has_output(session)) {
+                break;
+            }
+        }
+
+        if (received < 0 || session_has_output(session) || session->state == SESSION_FINISHED) {
+            break;
+        }
+    }
+
+    if (session->state == SESSION_FINISHED && !session_has_output(session)) {
+        close_session(epoll_fd, session);
+        return;
+    }
+
+    update_session_timer(session);
+
+    return;
+}
+
+/**
+ * @brief Handles the readiness of the client socket. Receives the frames, processes them, and sends the
+ * answers. The session is closed when the player disconnects or when the result was sent. The session
+ * of a channel is served by handle_channel_event, also when the channel was attached by this event.
+ * @param epoll_fd Epoll instance.
+ * @param session Session.
+ * @param fd Ready file descriptor, the client socket or the eventfd of the channel.
+ * @param events Ready events.
+ * @return void
+ */
+static void handle_session_event(int epoll_fd, Session* session, int fd, uint32_t events) {
+    if (session->channel.memory != NULL) {
+        handle_channel_event(epoll_fd, session, fd == session->socket ? true : false);
+        return;
+    }
+
+    if (events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        ssize_t received = session_read_input(session);
+        if (received == 0 || (received < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) {
+            close_session(epoll_fd, session);
+            return;
+        }
+
+        if (session->channel.memory != NULL) {
+            if (!register_channel(epoll_fd, session)) {
+                close_session(epoll_fd, session);
+                return;
+            }
+
+            handle_channel_event(epoll_fd, session, false);
+            return;
+        }
+    }
+
+    while (true) {
+        int processed = session_process_input(session);
+
+        if (session_write_output(session) < 0) {
+            close_session(epoll_fd, session);
+            return;
+        }
+
+        if (processed == 0 || session_has_output(session)) {
+            break;
+        }
+    }
+
+    if (session->state == SESSION_FINISHED && !session_has_output(session)) {
+        close_session(epoll_fd, session);
+        return;
+    }
+
+    update_session_events(epoll_fd, session);
+    update_session_timer(session);
+
+    return;
+}
+
+/**
+ * @brief Sends the new output of the spectators after the players were served, so a spectator never delays
+ * the moves of the player. A spectator that was finished is closed when its output was sent.
+ * @param epoll_fd Epoll instance.
+ * @return void
+ */
+static void serve_spectators(int epoll_fd) {
+    Session* session;
+
+    while ((session = broadcast_next_pending()) != NULL) {
+        if (session_write_output(session) < 0 ||
+            (session->state == SESSION_FINISHED && !session_has_output(session))) {
+            close_session(epoll_fd, session);
+            continue;
+        }
+
+        update_session_events(epoll_fd, session);
+        update_session_timer(session);
+    }
+
+    return;
+}
+
+/**
+ * @brief Runs the event-driven server. The server socket, the listener of the local socket, and the client
+ * sockets are non-blocking and are served by one epoll instance in the current process. When the server
+ * drains, the listeners are removed and the function returns after the last session.
+ * @param server_socket Server socket.
+ * @return void
+ */
+void run_epoll_server(int server_socket) {
+    struct rlimit limit;
+    CHECK_LESS_THAN_ZERO(getrlimit(RLIMIT_NOFILE, &limit), "GETRLIMIT ERROR");
+
+    sessions_capacity = (int)limit.rlim_cur;
+    sessions = (Session**)calloc(sessions_capacity, sizeof(Session*));
+    if (sessions == NULL) {
+        printf("ERROR: not enough memory for the sessions\n");
+        exit(EXIT_FAILURE);
+    }
+
+    CHECK_LESS_THAN_ZERO(fcntl(server_socket, F_SETFL, fcntl(server_socket, F_GETFL) | O_NONBLOCK),
+                         "FCNTL ERROR");
+
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    CHECK_LESS_THAN_ZERO(epoll_fd, "EPOLL ERROR");
+
+    struct epoll_event event = {.events = EPOLLIN, .data.fd = server_socket};
+    CHECK_LESS_THAN_ZERO(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, server_socket, &event), "EPOLL_CTL ERROR");
+
+    if (local_listener >= 0) {
+        CHECK_LESS_THAN_ZERO(fcntl(local_listener, F_SETFL, fcntl(local_listener, F_GETFL) | O_NONBLOCK),
+                             "FCNTL ERROR");
+
+        event.data.fd = local_listener;
+        CHECK_LESS_THAN_ZERO(epoll_ctl(epoll_fd, EPOLL_CTL_ADD, local_listener, &event), "EPOLL_CTL ERROR");
+    }
+
+    timer_wheel_init(&timers, timer_now());
+
+    struct epoll_event events[MAX_EVENTS];
+    bool accepting = true;
+
+    while (accepting || session_pool_used(&session_pool) > 0) {
+        TRACE_DUMP_IF_REQUESTED();
+
+        int ready = epoll_pwait(epoll_fd, events, MAX_EVENTS, timers.count > 0 ? TIMER_TICK_MS : -1,
+                                &drain_wait_mask);
+        if (ready < 0) {
+            if (errno != EINTR) {
+                perror("EPOLL_WAIT ERROR");
+                exit(EXIT_FAILURE);
+            }
+
+            ready = 0;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == server_socket || fd == local_listener) {
+                accept_connections(epoll_fd, fd);
+            } else if (sessions[fd] != NULL) {
+                handle_session_event(epoll_fd, sessions[fd], fd, events[i].events);
+            }
+        }
+
+        timer_wheel_advance(&timers, timer_now(), expire_session, &epoll_fd);
+
+        if (draining && accepting) {
+            epoll_ctl(epoll_fd, EPOLL_CTL_DEL, server_socket, NULL);
+            if (local_listener >= 0) {
+                epoll_ctl(epoll_fd, EPOLL_CTL_DEL, local_listener, NULL);
+            }
+
+            stop_accepting(server_socket);
+            accepting = false;
+
+            for (int fd = 0; fd < sessions_capacity; ++fd) {
+                Session* session = sessions[fd];
+
+                if (session == NULL || !session_drain(session)) {
+                    continue;
+                }
+
+                if (session_write_output(session) < 0 || !session_has_output(session)) {
+                    close_session(epoll_fd, session);
+                } else {
+                    update_session_events(epoll_fd, session);
+                }
+            }
+        }
+
+        serve_spectators(epoll_fd);
+    }
+
+    close(epoll_fd);
+    free(sessions);
+
+    return;
+}
@@ -0,0 +1,11 @@
+/*! @file epoll_server.h
+File with the declaration of the event-driven server mode.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef EPOLL_SERVER_H
+#define EPOLL_SERVER_H
+
+void run_epoll_server(int server_socket);
+
+#endif
@@ -0,0 +1,241 @@
+/*! @file handoff.c
+File with the implementation of the handoff of the server sockets. The sockets are sent in one message:
+its data is the number of the server sockets and its control message carries the descriptors, followed by
+the listener of the local socket if the server has one. The new server confirms with one byte when it has
+taken the sockets, and only then the old server starts to drain, so a failed start of the new binary leaves
+the old server running. Only a process of the same user may take the sockets.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "handoff.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "../shared/shared.h"
+#include "logger.h"
+
+#define HANDOFF_BACKLOG 4
+#define HANDOFF_TIMEOUT 10
+
+/**
+ * @brief UNIX socket the successor connects to.
+ */
+static int handoff_listener;
+
+/**
+ * @brief Server sockets handed over to the successor, followed by the listener of the local socket.
+ */
+static int handoff_sockets[MAX_HANDOFF_SOCKETS + 1];
+
+/**
+ * @brief Number of the server sockets.
+ */
+static int handoff_count;
+
+/**
+ * @brief true if the listener of the local socket follows the server sockets.
+ */
+static bool handoff_local;
+
+/**
+ * @brief Fills the UNIX socket address of the path.
+ * @param address Address.
+ * @param path Path of the UNIX socket.
+ * @return void
+ */
+static void set_handoff_address(struct sockaddr_un* address, const char* path) {
+    memset(address, 0, sizeof(*address));
+    address->sun_family = AF_UNIX;
+
+    if (strlen(path) >= sizeof(address->sun_path)) {
+        printf("ERROR: handoff socket path is too long\n");
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(address->sun_path, path);
+
+    return;
+}
+
+/**
+ * @brief Checks that the connected process belongs to the user of the server.
+ * @param client Connected socket.
+ * @return true if the process may take the sockets, false otherwise.
+ */
+static bool is_trusted_peer(int client) {
+    struct ucred credentials;
+    socklen_t length = sizeof(credentials);
+
+    if (getsockopt(client, SOL_SOCKET, SO_PEERCRED, &credentials, &length) < 0) {
+        return false;
+    }
+
+    return credentials.uid == geteuid() ? true : false;
+}
+
+/**
+ * @brief Sends the server sockets to the successor and waits for its confirmation.
+ * @param client Connected socket of the successor.
+ * @return true if the successor has taken the sockets, false otherwise.
+ */
+static bool send_sockets(int client) {
+    uint32_t count = (uint32_t)handoff_count;
+
+    if (send_descriptors(client, &count, sizeof(count), handoff_sockets, handoff_count + handoff_local) < 0) {
+        return false;
+    }
+
+    struct timeval timeout = {.tv_sec = HANDOFF_TIMEOUT, .tv_usec = 0};
+    setsockopt(client, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    char confirmation;
+    return recv(client, &confirmation, 1, 0) == 1 ? true : false;
+}
+
+/**
+ * @brief Waits for the successor and hands the server sockets over to it. Then the server is told to
+ * drain with SIGQUIT, which the waits of the server loops accept.
+ * @param argument Not used.
+ * @return NULL
+ */
+static void* serve_handoff(void* argument) {
+    (void)argument;
+
+    while (true) {
+        int client = accept(handoff_listener, NULL, NULL);
+        if (client < 0) {
+            if (errno != EINTR) {
+                perror("HANDOFF ACCEPT ERROR");
+            }
+
+            continue;
+        }
+
+        bool handed = is_trusted_peer(client) && send_sockets(client);
+        close(client);
+
+        if (handed) {
+            break;
+        }
+    }
+
+    close(handoff_listener);
+
+    LogRecord* record = log_begin(LOG_EVENT_HANDOFF);
+    if (record != NULL) {
+        record->arguments[0] = handoff_count;
+        log_commit();
+    }
+
+    logger_release();
+    kill(getpid(), SIGQUIT);
+
+    return NULL;
+}
+
+/**
+ * @brief Starts waiting for the successor on the UNIX socket. A stale socket file is replaced, and the
+ * socket is accessible to the user of the server only.
+ * @param path Path of the UNIX socket.
+ * @param sockets Server sockets.
+ * @param count Number of the server sockets.
+ * @param local_listener Listener of the local socket, -1 if the server has none.
+ * @return void
+ */
+void handoff_serve(const char* path, const int* sockets, int count, int local_listener) {
+    struct sockaddr_un address;
+    set_handoff_address(&address, path);
+    unlink(path);
+
+    handoff_count = count;
+    memcpy(handoff_sockets, sockets, sizeof(int) * count);
+
+    if (local_listener >= 0) {
+        handoff_sockets[count] = local_listener;
+        handoff_local = true;
+    }
+
+    handoff_listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CHECK_LESS_THAN_ZERO(handoff_listener, "HANDOFF SOCKET ERROR");
+
+    mode_t mask = umask(0077);
+    int bound = bind(handoff_listener, (struct sockaddr*)&address, sizeof(address));
+    umask(mask);
+
+    CHECK_LESS_THAN_ZERO(bound, "HANDOFF BIND ERROR");
+    CHECK_LESS_THAN_ZERO(listen(handoff_listener, HANDOFF_BACKLOG), "HANDOFF LISTEN ERROR");
+
+    pthread_t thread;
+    int error = pthread_create(&thread, NULL, serve_handoff, NULL);
+    if (error != 0) {
+        printf("ERROR: cannot start the handoff thread: %s\n", strerror(error));
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_detach(thread);
+
+    return;
+}
+
+/**
+ * @brief Takes the server sockets of the running server. The sockets beyond the capacity are closed, the
+ * running server keeps serving them until it exits.
+ * @param path Path of the UNIX socket of the running server.
+ * @param sockets Taken server sockets.
+ * @param capacity Maximum number of the sockets to take.
+ * @param local_listener Taken listener of the local socket, -1 if the running server has none.
+ * @return Number of the taken sockets.
+ */
+int handoff_take(const char* path, int* sockets, int capacity, int* local_listener) {
+    struct sockaddr_un address;
+    set_handoff_address(&address, path);
+
+    int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CHECK_LESS_THAN_ZERO(connection, "HANDOFF SOCKET ERROR");
+    CHECK_LESS_THAN_ZERO(connect(connection, (struct sockaddr*)&address, sizeof(address)),
+                         "HANDOFF CONNECT ERROR");
+
+    uint32_t count = 0;
+    int descriptors[MAX_HANDOFF_SOCKETS + 1];
+    int passed, taken = 0;
+
+    ssize_t received = receive_descriptors(connection, &count, sizeof(count), descriptors,
+                                           MAX_HANDOFF_SOCKETS + 1, &passed, 0);
+    if (received != sizeof(count) || passed == 0) {
+        printf("ERROR: the running server did not hand over its sockets\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (passed != (int)count && passed != (int)count + 1) {
+        printf("ERROR: the running server sent %d sockets instead of %u\n", passed, count);
+        exit(EXIT_FAILURE);
+    }
+
+    *local_listener = passed > (int)count ? descriptors[count] : -1;
+
+    for (int i = 0; i < (int)count; ++i) {
+        if (taken < capacity) {
+            sockets[taken++] = descriptors[i];
+        } else {
+            close(descriptors[i]);
+        }
+    }
+
+    CHECK_LESS_THAN_ZERO(send(connection, "", 1, MSG_NOSIGNAL), "HANDOFF SEND ERROR");
+    close(connection);
+
+    return taken;
+}
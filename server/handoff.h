@@ -0,0 +1,20 @@
+/*! @file handoff.h
+File with the declaration of the handoff of the server sockets. A running server listens on a UNIX socket
+for its successor: a new binary started with the takeover option connects to it and receives the open
+server sockets with SCM_RIGHTS, so the sockets and their queues of connections are never closed. The old
+server then stops accepting connections, finishes the current games and exits. The listener of the local
+socket is handed over with the server sockets.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include "../shared/descriptors.h"
+
+#define MAX_HANDOFF_SOCKETS (MAX_PASSED_DESCRIPTORS - 1)
+
+void handoff_serve(const char* path, const int* sockets, int count, int local_listener);
+int handoff_take(const char* path, int* sockets, int capacity, int* local_listener);
+
+#endif
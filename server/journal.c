@@ -0,0 +1,424 @@
+/*! @file journal.c
+File with the implementation of the game journal. The position of the next record is the number of the
+segment in the high 32 bits and the offset in the segment in the low 32 bits, so a record is placed with one
+compare-and-swap. Every process maps the segment of its last record and maps the next one when the
+position moves there; in the fork mode a child inherits the mapping of its worker. The segment files are
+named <prefix>-<run>-<segment>.bin, where the run is the start time of the server.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "journal.h"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "workers.h"
+
+#define JOURNAL_PREFIX_SIZE 108
+#define JOURNAL_PATH_SIZE (JOURNAL_PREFIX_SIZE + 48)
+#define JOURNAL_INTERVAL_NS 10000000
+#define SEGMENT_NUMBER(position) ((uint32_t)((position) >> 32))
+#define SEGMENT_OFFSET(position) ((uint32_t)(position))
+
+/**
+ * @struct JournalControl
+ * @brief Structure for the state of the journal shared by all processes of the server.
+ *
+ * @param position Segment and offset of the next record.
+ * @param ready Number of the last segment file created by the journal thread.
+ * @param next_session Number of the next session.
+ * @param dropped Number of records dropped because the next segment was not ready or could not be mapped.
+ */
+typedef struct {
+    _Alignas(64) uint64_t position;
+    _Alignas(64) uint32_t ready;
+    _Alignas(64) uint32_t next_session;
+    _Alignas(64) uint64_t dropped;
+} JournalControl;
+
+/**
+ * @brief Shared state of the journal, NULL if the journal is disabled.
+ */
+static JournalControl* control;
+
+/**
+ * @brief Prefix of the paths of the segment files.
+ */
+static char path_prefix[JOURNAL_PREFIX_SIZE];
+
+/**
+ * @brief Start time of the server in seconds since the epoch.
+ */
+static uint64_t run;
+
+/**
+ * @brief Size of a segment file in bytes.
+ */
+static uint32_t segment_size;
+
+/**
+ * @brief Mapping of the segment of the last record of the process, NULL before the first record.
+ */
+static char* segment;
+
+/**
+ * @brief Number of the mapped segment.
+ */
+static uint32_t segment_number;
+
+/**
+ * @brief Returns the path of the segment file.
+ * @param path Buffer of JOURNAL_PATH_SIZE bytes for the path.
+ * @param number Number of the segment.
+ * @return void
+ */
+static void segment_path(char* path, uint32_t number) {
+    snprintf(path, JOURNAL_PATH_SIZE, "%s-%llu-%06u.bin", path_prefix, (unsigned long long)run, number);
+
+    return;
+}
+
+/**
+ * @brief Creates the segment file of the full size with its header. The pages of the file are allocated
+ * when the records are written.
+ * @param number Number of the segment.
+ * @return true if the file was created, false otherwise.
+ */
+static bool create_segment(uint32_t number) {
+    char path[JOURNAL_PATH_SIZE];
+    segment_path(path, number);
+
+    int file = open(path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (file < 0) {
+        perror("JOURNAL FILE ERROR");
+        return false;
+    }
+
+    JournalSegmentHeader header = {
+        .magic = JOURNAL_MAGIC,
+        .version = JOURNAL_VERSION,
+        .header_size = sizeof(JournalSegmentHeader),
+        .segment = number,
+        .run = run,
+        .size = segment_size,
+    };
+
+    bool created = true;
+
+    if (ftruncate(file, segment_size) < 0 || pwrite(file, &header, sizeof(header), 0) != sizeof(header)) {
+        perror("JOURNAL FILE ERROR");
+        created = false;
+    }
+
+    close(file);
+
+    return created;
+}
+
+/**
+ * @brief Maps the segment file in place of the mapped segment.
+ * @param number Number of the segment.
+ * @return true if the segment was mapped, false otherwise.
+ */
+static bool map_segment(uint32_t number) {
+    char path[JOURNAL_PATH_SIZE];
+    segment_path(path, number);
+
+    int file = open(path, O_RDWR | O_CLOEXEC);
+    if (file < 0) {
+        return false;
+    }
+
+    char* mapping = (char*)mmap(NULL, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    if (segment != NULL) {
+        munmap(segment, segment_size);
+    }
+
+    segment = mapping;
+    segment_number = number;
+
+    return true;
+}
+
+/**
+ * @brief Counts the dropped record.
+ * @return NULL, so the caller does not fill the record.
+ */
+static JournalRecord* drop_record(void) {
+    __atomic_fetch_add(&control->dropped, 1, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+/**
+ * @brief Takes the place of the record. The segment of the position is mapped before the place is taken,
+ * so a record is either dropped or has its length written right after its place is taken; a record that
+ * is never committed keeps the type 0 and is stepped over by the readers. When the record does not fit
+ * into the current segment, the position moves to the next segment if the journal thread has created it,
+ * otherwise the record is dropped. The end of the full segment is left zero, which ends the segment for
+ * the readers.
+ * @param session Number of the session.
+ * @param length Size of the record without padding.
+ * @return Record to fill, NULL if the record was dropped.
+ */
+static JournalRecord* journal_begin(uint32_t session, size_t length) {
+    uint64_t position = __atomic_load_n(&control->position, __ATOMIC_RELAXED);
+    uint32_t size = (uint32_t)JOURNAL_ALIGN(length);
+
+    while (true) {
+        uint32_t number = SEGMENT_NUMBER(position);
+
+        if (SEGMENT_OFFSET(position) + size <= segment_size) {
+            if ((segment == NULL || segment_number != number) && !map_segment(number)) {
+                return drop_record();
+            }
+
+            if (__atomic_compare_exchange_n(&control->position, &position, position + size, true,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (__atomic_load_n(&control->ready, __ATOMIC_ACQUIRE) > number) {
+            uint64_t next = ((uint64_t)(number + 1) << 32) | sizeof(JournalSegmentHeader);
+
+            if (__atomic_compare_exchange_n(&control->position, &position, next, false, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED)) {
+                position = next;
+            }
+        } else {
+            return drop_record();
+        }
+    }
+
+    JournalRecord* record = (JournalRecord*)(segment + SEGMENT_OFFSET(position));
+    __atomic_store_n(&record->length, (uint16_t)size, __ATOMIC_RELAXED);
+    record->worker = (uint8_t)worker_id;
+    record->session = session;
+
+    return record;
+}
+
+/**
+ * @brief Publishes the record by writing its type.
+ * @param record Record started by journal_begin.
+ * @param type Type of the record.
+ * @return void
+ */
+static void journal_commit(JournalRecord* record, JournalType type) {
+    __atomic_store_n(&record->type, (uint8_t)type, __ATOMIC_RELEASE);
+
+    return;
+}
+
+/**
+ * @brief Returns the current time in milliseconds since the epoch.
+ * @return Time in milliseconds.
+ */
+static uint64_t current_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Writes the record of the start of the game with the ships and the shots of its board. The marked
+ * cells are listed without visiting the empty parts of the board.
+ * @param game Game that was started.
+ * @param name Name of the player.
+ * @param seed Seed of the board.
+ * @param protocol Wire protocol of the player.
+ * @param moves Number of moves played before, not 0 for a resumed game.
+ * @return Number of the session for the next records, 0 if the journal is disabled or the record was dropped.
+ */
+uint32_t journal_start(const GameContext* game, const char* name, uint64_t seed, Protocol protocol,
+                       uint32_t moves) {
+    if (control == NULL) {
+        return 0;
+    }
+
+    int field_size = game->rules->field_size;
+    int cells = board_marked_cells(game->board, NULL, 0);
+
+    if (sizeof(JournalStart) + (size_t)cells * sizeof(uint32_t) > JOURNAL_MAX_RECORD_SIZE) {
+        cells = 0;
+    }
+
+    size_t length = sizeof(JournalStart) + (size_t)cells * sizeof(uint32_t);
+    uint32_t session = __atomic_add_fetch(&control->next_session, 1, __ATOMIC_RELAXED);
+
+    JournalStart* start = (JournalStart*)journal_begin(session, length);
+    if (start == NULL) {
+        return 0;
+    }
+
+    start->seed = seed;
+    start->time = current_time();
+    start->field_size = (uint16_t)field_size;
+    start->number_of_ships = (uint16_t)game->rules->number_of_ships;
+    start->number_of_moves = (uint16_t)game->rules->number_of_moves;
+    start->protocol = (uint16_t)protocol;
+    start->ships_left = (uint16_t)game->number_of_ships;
+    start->missed = (uint16_t)game->number_of_moves;
+    start->moves = moves;
+    start->cells = (uint32_t)cells;
+    start->reserved = 0;
+    memset(start->name, 0, JOURNAL_NAME_SIZE);
+    memcpy(start->name, name, strnlen(name, JOURNAL_NAME_SIZE - 1));
+
+    board_marked_cells(game->board, (uint32_t*)(start + 1), cells);
+
+    journal_commit(&start->header, JOURNAL_START);
+
+    return session;
+}
+
+/**
+ * @brief Writes the record of the move.
+ * @param session Number of the session, nothing is written if it is 0.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @return void
+ */
+void journal_move(uint32_t session, int x, int y, MoveResult result, GameStatus status) {
+    if (session == 0) {
+        return;
+    }
+
+    JournalMove* move = (JournalMove*)journal_begin(session, sizeof(JournalMove));
+    if (move == NULL) {
+        return;
+    }
+
+    move->x = (uint16_t)x;
+    move->y = (uint16_t)y;
+    move->result = (uint8_t)result;
+    move->status = (uint8_t)status;
+    move->reserved = 0;
+    journal_commit(&move->header, JOURNAL_MOVE);
+
+    return;
+}
+
+/**
+ * @brief Writes the record of the end of the session.
+ * @param session Number of the session, nothing is written if it is 0.
+ * @param game Game of the session.
+ * @param status Final status of the game.
+ * @param reason Reason the session was finished.
+ * @param moves Number of moves played.
+ * @param duration Duration of the game in milliseconds.
+ * @return void
+ */
+void journal_end(uint32_t session, const GameContext* game, GameStatus status, JournalEndReason reason,
+                 uint32_t moves, uint32_t duration) {
+    if (session == 0) {
+        return;
+    }
+
+    JournalEnd* end = (JournalEnd*)journal_begin(session, sizeof(JournalEnd));
+    if (end == NULL) {
+        return;
+    }
+
+    end->field_size = (uint16_t)game->rules->field_size;
+    end->status = (uint8_t)status;
+    end->reason = (uint8_t)reason;
+    end->ships_left = (uint16_t)game->number_of_ships;
+    end->missed = (uint16_t)game->number_of_moves;
+    end->moves = moves;
+    end->duration = duration;
+    journal_commit(&end->header, JOURNAL_END);
+
+    return;
+}
+
+/**
+ * @brief Creates the segment after the one the writers use, so they never wait for a file, and logs when
+ * the writers move to a new segment.
+ * @param argument Not used.
+ * @return NULL, the thread runs until the process exits.
+ */
+static void* prepare_segments(void* argument) {
+    struct timespec interval = {.tv_sec = 0, .tv_nsec = JOURNAL_INTERVAL_NS};
+    uint32_t current = 0;
+
+    (void)argument;
+
+    while (true) {
+        uint32_t number = SEGMENT_NUMBER(__atomic_load_n(&control->position, __ATOMIC_RELAXED));
+
+        if (number != current) {
+            current = number;
+
+            LogRecord* record = log_begin(LOG_EVENT_JOURNAL_SEGMENT);
+            if (record != NULL) {
+                record->arguments[0] = (int32_t)current;
+                record->arguments[1] = (int32_t)__atomic_load_n(&control->dropped, __ATOMIC_RELAXED);
+                log_commit();
+            }
+        }
+
+        if (__atomic_load_n(&control->ready, __ATOMIC_RELAXED) <= current && create_segment(current + 1)) {
+            __atomic_store_n(&control->ready, current + 1, __ATOMIC_RELEASE);
+        }
+
+        nanosleep(&interval, NULL);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Allocates the shared state of the journal, creates the first segment, and starts the journal
+ * thread. Must be called before the workers are created.
+ * @param prefix Prefix of the paths of the segment files.
+ * @param size Size of a segment file in megabytes.
+ * @return void
+ */
+void journal_init(const char* prefix, int size) {
+    control = (JournalControl*)mmap(NULL, sizeof(JournalControl), PROT_READ | PROT_WRITE,
+                                    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (control == MAP_FAILED) {
+        perror("MMAP ERROR");
+        exit(EXIT_FAILURE);
+    }
+
+    snprintf(path_prefix, sizeof(path_prefix), "%s", prefix);
+    run = (uint64_t)time(NULL);
+    segment_size = (uint32_t)size << 20;
+    control->position = sizeof(JournalSegmentHeader);
+
+    if (!create_segment(0)) {
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_t thread;
+    int error = pthread_create(&thread, NULL, prepare_segments, NULL);
+
+    if (error != 0) {
+        printf("ERROR: cannot start the journal thread: %s\n", strerror(error));
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_detach(thread);
+
+    return;
+}
@@ -0,0 +1,29 @@
+/*! @file journal.h
+File with the declaration of the game journal. The processes of the server append the records of the games
+directly to a memory-mapped segment file: a record takes its place with one atomic operation on a position
+shared by all processes, and is then copied into the mapping without system calls. A thread of the main
+process creates the next segment in advance, so the writers roll over to it when the current one is full.
+The format of the journal is described in journal_format.h.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+
+#include "../engine/engine.h"
+#include "../shared/journal_format.h"
+#include "../shared/shared.h"
+
+#define DEFAULT_JOURNAL_SIZE 64
+#define MAX_JOURNAL_SIZE 4095
+
+void journal_init(const char* prefix, int size);
+uint32_t journal_start(const GameContext* game, const char* name, uint64_t seed, Protocol protocol,
+                       uint32_t moves);
+void journal_move(uint32_t session, int x, int y, MoveResult result, GameStatus status);
+void journal_end(uint32_t session, const GameContext* game, GameStatus status, JournalEndReason reason,
+                 uint32_t moves, uint32_t duration);
+
+#endif
@@ -0,0 +1,581 @@
+/*! @file logger.c
+File with the implementation of the asynchronous logger. The rings are allocated in shared anonymous
+memory by the main process before the workers are created, so the workers and their child processes in
+the fork mode log into the same memory. A thread claims a free ring on its first record and keeps it until
+it releases the ring or exits. The logger thread of the main process updates the cached time, drains the
+rings, and frees the rings of the exited threads.
+The level of the log is shared as well and is changed at runtime with SIGUSR2.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "logger.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../shared/protocol.h"
+#include "workers.h"
+
+#define LOG_BUFFER_SIZE 65536
+#define LOG_LINE_SIZE 160
+#define LOG_INTERVAL_NS 1000000
+#define OWNER_CHECK_INTERVAL_MS 1000
+#define LOG_FLUSH_ATTEMPTS 100
+
+_Static_assert(sizeof(LogRecord) == 64, "a log record must take one cache line");
+
+/**
+ * @struct Logger
+ * @brief Structure for the state of the logger shared by all processes of the server.
+ *
+ * @param now Cached time in milliseconds since the epoch, updated by the logger thread.
+ * @param level Most detailed level of the events that are logged.
+ * @param dropped Number of records dropped because the ring was full or there was no free ring.
+ * @param rings Rings of the producers.
+ */
+typedef struct {
+    _Alignas(64) uint64_t now;
+    LogLevel level;
+    _Alignas(64) uint64_t dropped;
+    LogRing rings[LOG_RINGS];
+} Logger;
+
+/**
+ * @struct LogOutput
+ * @brief Structure for the formatted lines that were not written yet.
+ *
+ * @param data Formatted lines.
+ * @param length Number of bytes of the lines.
+ */
+typedef struct {
+    char data[LOG_BUFFER_SIZE];
+    size_t length;
+} LogOutput;
+
+/**
+ * @brief Shared state of the logger.
+ */
+static Logger* logger;
+
+/**
+ * @brief true if the records show the index of the worker.
+ */
+static bool show_worker;
+
+/**
+ * @brief Ring of the current thread, NULL until the first record.
+ */
+static __thread LogRing* local_ring;
+
+/**
+ * @brief Names of the levels of the log.
+ */
+static const char* level_names[] = {
+    [LOG_ERROR] = "error",
+    [LOG_WARNING] = "warning",
+    [LOG_INFO] = "info",
+    [LOG_DEBUG] = "debug",
+};
+
+/**
+ * @brief Phases of the session in the message of the timeout, indexed by the argument of the event.
+ */
+static const char* timeout_phases[] = {"game", "handshake", "after the game"};
+
+/**
+ * @brief Levels of the events of the log.
+ */
+static const LogLevel event_levels[LOG_EVENT_COUNT] = {
+    [LOG_EVENT_CONNECTED] = LOG_INFO,
+    [LOG_EVENT_REFUSED] = LOG_WARNING,
+    [LOG_EVENT_MOVE] = LOG_DEBUG,
+    [LOG_EVENT_GAME_OVER] = LOG_INFO,
+    [LOG_EVENT_WORKER_RESTARTED] = LOG_ERROR,
+    [LOG_EVENT_TRACE_WRITTEN] = LOG_INFO,
+    [LOG_EVENT_TIMEOUT] = LOG_INFO,
+    [LOG_EVENT_JOURNAL_SEGMENT] = LOG_INFO,
+    [LOG_EVENT_RESUMED] = LOG_INFO,
+    [LOG_EVENT_HANDOFF] = LOG_WARNING,
+    [LOG_EVENT_TAKEOVER] = LOG_WARNING,
+    [LOG_EVENT_DRAINING] = LOG_INFO,
+    [LOG_EVENT_REMATCH] = LOG_INFO,
+    [LOG_EVENT_WATCH] = LOG_INFO,
+};
+
+/**
+ * @brief Returns the current time in milliseconds since the epoch.
+ * @return Time in milliseconds.
+ */
+static uint64_t current_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Returns the name of the level of the log.
+ * @param level Level of the log.
+ * @return Name of the level.
+ */
+const char* log_level_name(LogLevel level) {
+    return level_names[level];
+}
+
+/**
+ * @brief Makes the log more detailed by one level, the most detailed level is followed by the errors only.
+ * @param signal Signal number.
+ * @return void
+ */
+static void cycle_level(int signal) {
+    (void)signal;
+
+    LogLevel level = __atomic_load_n(&logger->level, __ATOMIC_RELAXED);
+    __atomic_store_n(&logger->level, level == LOG_DEBUG ? LOG_ERROR : level + 1, __ATOMIC_RELAXED);
+
+    return;
+}
+
+/**
+ * @brief Forgets the ring of the parent in the child process. The ring stays owned by the parent.
+ * @return void
+ */
+static void forget_ring(void) {
+    local_ring = NULL;
+
+    return;
+}
+
+/**
+ * @brief Counts the dropped record.
+ * @return NULL, so the caller does not fill the record.
+ */
+static LogRecord* drop_record(void) {
+    __atomic_fetch_add(&logger->dropped, 1, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+/**
+ * @brief Claims a free ring for the current thread. The search starts at a ring chosen by the thread ID,
+ * so the threads rarely race for the same ring.
+ * @return true if a ring was claimed, false if all rings are owned.
+ */
+static bool claim_ring(void) {
+    pid_t thread = gettid();
+
+    for (int i = 0; i < LOG_RINGS; ++i) {
+        LogRing* ring = &logger->rings[(thread + i) % LOG_RINGS];
+        pid_t free_owner = 0;
+
+        if (__atomic_load_n(&ring->owner, __ATOMIC_RELAXED) == 0 &&
+            __atomic_compare_exchange_n(&ring->owner, &free_owner, thread, false, __ATOMIC_ACQUIRE,
+                                        __ATOMIC_RELAXED)) {
+            local_ring = ring;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Starts the record of the event in the ring of the current thread. The record is published by
+ * log_commit.
+ * @param event Event of the record.
+ * @return Record to fill, NULL if the level of the event is not logged or the record was dropped.
+ */
+LogRecord* log_begin(LogEvent event) {
+    if (event_levels[event] > __atomic_load_n(&logger->level, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    if (local_ring == NULL && !claim_ring()) {
+        return drop_record();
+    }
+
+    uint64_t tail = local_ring->tail;
+    if (tail - __atomic_load_n(&local_ring->head, __ATOMIC_ACQUIRE) >= LOG_RING_SIZE) {
+        return drop_record();
+    }
+
+    LogRecord* record = &local_ring->records[tail % LOG_RING_SIZE];
+    record->time = __atomic_load_n(&logger->now, __ATOMIC_RELAXED);
+    record->event = (uint16_t)event;
+    record->worker = (uint16_t)worker_id;
+    record->text[0] = '\0';
+
+    return record;
+}
+
+/**
+ * @brief Copies the text argument into the record. A long text is truncated.
+ * @param record Record.
+ * @param text Text.
+ * @return void
+ */
+void log_text(LogRecord* record, const char* text) {
+    size_t length = strnlen(text, LOG_TEXT_SIZE - 1);
+
+    memcpy(record->text, text, length);
+    record->text[length] = '\0';
+
+    return;
+}
+
+/**
+ * @brief Publishes the record started by log_begin.
+ * @return void
+ */
+void log_commit(void) {
+    __atomic_store_n(&local_ring->tail, local_ring->tail + 1, __ATOMIC_RELEASE);
+
+    return;
+}
+
+/**
+ * @brief Releases the ring of the current thread. The records of the ring are still formatted. Must be
+ * called before a process exits, otherwise the ring is freed by the logger thread later.
+ * @return void
+ */
+void logger_release(void) {
+    if (local_ring != NULL) {
+        __atomic_store_n(&local_ring->owner, 0, __ATOMIC_RELEASE);
+        local_ring = NULL;
+    }
+
+    return;
+}
+
+/**
+ * @brief Waits until the logger thread has written the published records, so they are not lost when the
+ * process exits. The wait is bounded in case the output is blocked.
+ * @return void
+ */
+void logger_flush(void) {
+    struct timespec interval = {.tv_sec = 0, .tv_nsec = LOG_INTERVAL_NS};
+
+    for (int attempt = 0; attempt < LOG_FLUSH_ATTEMPTS; ++attempt) {
+        bool pending = false;
+
+        for (int i = 0; i < LOG_RINGS; ++i) {
+            LogRing* ring = &logger->rings[i];
+            uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+            if (__atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) != tail) {
+                pending = true;
+            }
+        }
+
+        nanosleep(&interval, NULL);
+
+        if (!pending) {
+            break;
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Writes the formatted lines to the standard output.
+ * @param output Formatted lines.
+ * @return void
+ */
+static void flush_output(LogOutput* output) {
+    size_t offset = 0;
+
+    while (offset < output->length) {
+        ssize_t written = write(STDOUT_FILENO, output->data + offset, output->length - offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            break;
+        }
+
+        offset += written;
+    }
+
+    output->length = 0;
+
+    return;
+}
+
+/**
+ * @brief Appends the time and the worker of the line to the output. The time of the current second is
+ * formatted once.
+ * @param output Formatted lines.
+ * @param time Time in milliseconds since the epoch.
+ * @param worker Index of the worker, -1 for the lines of the logger itself.
+ * @return void
+ */
+static void append_prefix(LogOutput* output, uint64_t time, int worker) {
+    static time_t cached_second = -1;
+    static char cached_prefix[16];
+
+    time_t second = (time_t)(time / 1000);
+    if (second != cached_second) {
+        struct tm local;
+        localtime_r(&second, &local);
+        strftime(cached_prefix, sizeof(cached_prefix), "[%H:%M:%S", &local);
+        cached_second = second;
+    }
+
+    char* line = output->data + output->length;
+    size_t space = LOG_BUFFER_SIZE - output->length;
+
+    if (show_worker && worker >= 0) {
+        output->length += snprintf(line, space, "%s.%03d] [worker %d] ", cached_prefix, (int)(time % 1000),
+                                   worker);
+    } else {
+        output->length += snprintf(line, space, "%s.%03d] ", cached_prefix, (int)(time % 1000));
+    }
+
+    return;
+}
+
+/**
+ * @brief Formats the record as one line of the output.
+ * @param output Formatted lines, there must be LOG_LINE_SIZE free bytes.
+ * @param record Record.
+ * @return void
+ */
+static void format_record(LogOutput* output, const LogRecord* record) {
+    const int32_t* arguments = record->arguments;
+
+    append_prefix(output, record->time, record->worker);
+
+    char* line = output->data + output->length;
+    size_t space = LOG_BUFFER_SIZE - output->length;
+    int length = 0;
+    char move[BUF_MESSAGE_SIZE];
+
+    switch (record->event) {
+        case LOG_EVENT_CONNECTED:
+            length = snprintf(line, space, "Client %s connected (sessions: %d/%d, boards: %d/%d, dry: %d)\n",
+                              record->text, arguments[0], arguments[1], arguments[2], arguments[3],
+                              arguments[4]);
+            break;
+        case LOG_EVENT_REFUSED:
+            length = snprintf(line, space, "Server busy, connection refused (sessions: %d/%d)\n",
+                              arguments[0], arguments[1]);
+            break;
+        case LOG_EVENT_MOVE:
+            format_move(move, arguments[0], arguments[1]);
+            length = snprintf(line, space, "Client %s shot %s: %s (ships: %d, moves: %d)\n", record->text,
+                              move, move_result_message((MoveResult)arguments[2]), arguments[3],
+                              arguments[4]);
+            break;
+        case LOG_EVENT_GAME_OVER:
+            length = snprintf(line, space, "Client %s %s (moves: %d)\n", record->text,
+                              arguments[0] == WIN ? "won" : "lost", arguments[1]);
+            break;
+        case LOG_EVENT_TIMEOUT:
+            length = snprintf(line, space, "Client %s timed out (%s)\n", record->text[0] ? record->text : "-",
+                              timeout_phases[arguments[0] < 3 ? arguments[0] : 0]);
+            break;
+        case LOG_EVENT_JOURNAL_SEGMENT:
+            length = snprintf(line, space, "Journal segment %d started (dropped records: %d)\n", arguments[0],
+                              arguments[1]);
+            break;
+        case LOG_EVENT_RESUMED:
+            length = snprintf(line, space, "Client %s resumed the game (ships: %d, moves: %d)\n",
+                              record->text, arguments[0], arguments[1]);
+            break;
+        case LOG_EVENT_REMATCH:
+            length = snprintf(line, space, "Client %s started game %d on the connection\n", record->text,
+                              arguments[0]);
+            break;
+        case LOG_EVENT_WATCH:
+            length = snprintf(line, space, "A spectator joined the game of %s\n", record->text);
+            break;
+        case LOG_EVENT_HANDOFF:
+            length = snprintf(line, space, "Handed %d server sockets over to the new server\n", arguments[0]);
+            break;
+        case LOG_EVENT_TAKEOVER:
+            length = snprintf(line, space, "Took over %d of %d server sockets from the running server\n",
+                              arguments[0], arguments[1]);
+            break;
+        case LOG_EVENT_DRAINING:
+            length = snprintf(line, space, "Stopped accepting connections, finishing %d sessions\n",
+                              arguments[0]);
+            break;
+        case LOG_EVENT_TRACE_WRITTEN:
+            length = snprintf(line, space, "Trace of %d spans written to %s\n", arguments[0], record->text);
+            break;
+        default:
+            length = snprintf(line, space, "ERROR: worker %d exited, restarting\n", arguments[0]);
+            break;
+    }
+
+    output->length += length < (int)space ? length : (int)space - 1;
+
+    return;
+}
+
+/**
+ * @brief Appends a line of the logger itself to the output.
+ * @param output Formatted lines.
+ * @param message Message of the line.
+ * @return void
+ */
+static void append_line(LogOutput* output, const char* message) {
+    if (LOG_BUFFER_SIZE - output->length < LOG_LINE_SIZE) {
+        flush_output(output);
+    }
+
+    append_prefix(output, __atomic_load_n(&logger->now, __ATOMIC_RELAXED), -1);
+    output->length += snprintf(output->data + output->length, LOG_BUFFER_SIZE - output->length, "%s\n",
+                               message);
+
+    return;
+}
+
+/**
+ * @brief Formats the published records of the ring and gives their space back to the producer.
+ * @param ring Ring.
+ * @param output Formatted lines.
+ * @return Number of formatted records.
+ */
+static int drain_ring(LogRing* ring, LogOutput* output) {
+    uint64_t head = ring->head;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    for (uint64_t position = head; position < tail; ++position) {
+        if (LOG_BUFFER_SIZE - output->length < LOG_LINE_SIZE) {
+            flush_output(output);
+        }
+
+        format_record(output, &ring->records[position % LOG_RING_SIZE]);
+    }
+
+    __atomic_store_n(&ring->head, tail, __ATOMIC_RELEASE);
+
+    return (int)(tail - head);
+}
+
+/**
+ * @brief Frees the rings of the threads that exited without releasing them.
+ * @return void
+ */
+static void free_abandoned_rings(void) {
+    for (int i = 0; i < LOG_RINGS; ++i) {
+        pid_t owner = __atomic_load_n(&logger->rings[i].owner, __ATOMIC_RELAXED);
+
+        if (owner != 0 && kill(owner, 0) < 0 && errno == ESRCH) {
+            __atomic_compare_exchange_n(&logger->rings[i].owner, &owner, 0, false, __ATOMIC_RELEASE,
+                                        __ATOMIC_RELAXED);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Updates the cached time, formats the records of all rings, and writes them in one batch. Sleeps
+ * for a short time when there were no records. Reports the changes of the level and the dropped records.
+ * @param argument Not used.
+ * @return NULL, the thread runs until the process exits.
+ */
+static void* consume_records(void* argument) {
+    static LogOutput output;
+    struct timespec interval = {.tv_sec = 0, .tv_nsec = LOG_INTERVAL_NS};
+    LogLevel level = __atomic_load_n(&logger->level, __ATOMIC_RELAXED);
+    uint64_t dropped = 0, last_check = 0;
+    char message[LOG_LINE_SIZE];
+
+    (void)argument;
+
+    while (true) {
+        uint64_t now = current_time();
+        __atomic_store_n(&logger->now, now, __ATOMIC_RELAXED);
+
+        int formatted = 0;
+        for (int i = 0; i < LOG_RINGS; ++i) {
+            formatted += drain_ring(&logger->rings[i], &output);
+        }
+
+        LogLevel current_level = __atomic_load_n(&logger->level, __ATOMIC_RELAXED);
+        if (current_level != level) {
+            level = current_level;
+            snprintf(message, sizeof(message), "Log level: %s", log_level_name(level));
+            append_line(&output, message);
+        }
+
+        uint64_t current_dropped = __atomic_load_n(&logger->dropped, __ATOMIC_RELAXED);
+        if (current_dropped != dropped) {
+            snprintf(message, sizeof(message), "WARNING: %llu log records dropped (total: %llu)",
+                     (unsigned long long)(current_dropped - dropped), (unsigned long long)current_dropped);
+            append_line(&output, message);
+            dropped = current_dropped;
+        }
+
+        flush_output(&output);
+
+        if (now - last_check >= OWNER_CHECK_INTERVAL_MS) {
+            free_abandoned_rings();
+            last_check = now;
+        }
+
+        if (formatted == 0) {
+            nanosleep(&interval, NULL);
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Allocates the shared state of the logger, starts the logger thread, and changes the level on
+ * SIGUSR2. Must be called before the workers are created.
+ * @param level Most detailed level of the events that are logged.
+ * @param number_of_workers Number of workers, the records show the worker when there are several.
+ * @return void
+ */
+void logger_init(LogLevel level, int number_of_workers) {
+    logger = (Logger*)mmap(NULL, sizeof(Logger), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (logger == MAP_FAILED) {
+        perror("MMAP ERROR");
+        exit(EXIT_FAILURE);
+    }
+
+    logger->now = current_time();
+    logger->level = level;
+    show_worker = number_of_workers > 1 ? true : false;
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = cycle_level;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    CHECK_LESS_THAN_ZERO(sigaction(SIGUSR2, &action, NULL), "SIGACTION ERROR");
+
+    int error = pthread_atfork(NULL, NULL, forget_ring);
+    if (error == 0) {
+        pthread_t thread;
+        error = pthread_create(&thread, NULL, consume_records, NULL);
+
+        if (error == 0) {
+            pthread_detach(thread);
+        }
+    }
+
+    if (error != 0) {
+        printf("ERROR: cannot start the logger thread: %s\n", strerror(error));
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
@@ -0,0 +1,90 @@
+/*! @file logger.h
+File with the declaration of the asynchronous logger. The producers write fixed-size binary records into
+their own rings in memory shared by all processes of the server, without locks and without system calls.
+A thread of the main process formats the records and writes them to the standard output in batches.
+When a ring is full, the record is dropped and counted instead of blocking the producer.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "../shared/shared.h"
+
+#define LOG_RINGS 256
+#define LOG_RING_SIZE 512
+#define LOG_ARGUMENTS 5
+#define LOG_TEXT_SIZE 32
+
+/**
+ * @brief Enumeration for the events of the log. Every event has its level and its message format.
+ */
+typedef enum {
+    LOG_EVENT_CONNECTED,        /**< The player sent the name, the text is the name */
+    LOG_EVENT_REFUSED,          /**< The connection was refused because all sessions were in use */
+    LOG_EVENT_MOVE,             /**< The move was played, the text is the name of the player */
+    LOG_EVENT_GAME_OVER,        /**< The game was won or lost, the text is the name of the player */
+    LOG_EVENT_WORKER_RESTARTED, /**< The worker exited and was restarted */
+    LOG_EVENT_TRACE_WRITTEN,    /**< The spans of the sessions were written, the text is the file */
+    LOG_EVENT_TIMEOUT,          /**< The player was idle for too long, the text is the name, the argument is
+                                     1 during the handshake, 2 after the game */
+    LOG_EVENT_JOURNAL_SEGMENT,  /**< The journal moved to the next segment file */
+    LOG_EVENT_RESUMED,          /**< The player resumed the game, the text is the name of the player */
+    LOG_EVENT_HANDOFF,          /**< The server sockets were handed over to a new server */
+    LOG_EVENT_TAKEOVER,         /**< The server sockets were taken over from the running server */
+    LOG_EVENT_DRAINING,         /**< The process stopped accepting connections and finishes its games */
+    LOG_EVENT_REMATCH,          /**< The player started the next game on the connection, the text is the
+                                     name, the argument is the number of the game */
+    LOG_EVENT_WATCH,            /**< A spectator joined the game, the text is the name of the player */
+    LOG_EVENT_COUNT             /**< Number of the events */
+} LogEvent;
+
+/**
+ * @struct LogRecord
+ * @brief Structure for one record of the log. The record takes one cache line, the message is formatted
+ * by the logger thread from the event, the arguments, and the text.
+ *
+ * @param time Time of the record in milliseconds since the epoch, taken from the cached time.
+ * @param event Event of the record.
+ * @param worker Index of the worker of the producer.
+ * @param arguments Integer arguments of the event.
+ * @param text Text argument of the event.
+ */
+typedef struct {
+    uint64_t time;
+    uint16_t event;
+    uint16_t worker;
+    int32_t arguments[LOG_ARGUMENTS];
+    char text[LOG_TEXT_SIZE];
+} LogRecord;
+
+/**
+ * @struct LogRing
+ * @brief Structure for the ring of records of one producer. The producer fills the record at the tail and
+ * then publishes the tail, the logger thread formats the record at the head and then publishes the head.
+ * The ring is owned by the thread that claimed it, the owner is 0 when the ring is free.
+ *
+ * @param head Number of records formatted by the logger thread.
+ * @param tail Number of records published by the producer.
+ * @param owner Thread ID of the producer.
+ * @param records Records of the ring.
+ */
+typedef struct {
+    _Alignas(64) uint64_t head;
+    _Alignas(64) uint64_t tail;
+    _Alignas(64) pid_t owner;
+    _Alignas(64) LogRecord records[LOG_RING_SIZE];
+} LogRing;
+
+void logger_init(LogLevel level, int number_of_workers);
+LogRecord* log_begin(LogEvent event);
+void log_text(LogRecord* record, const char* text);
+void log_commit(void);
+void logger_release(void);
+void logger_flush(void);
+const char* log_level_name(LogLevel level);
+
+#endif
@@ -0,0 +1,370 @@
+/*! @file metrics.c
+File with the implementation of the server metrics. The slots of the workers are allocated in shared
+anonymous memory by the main process before the workers are created, so the workers and their child
+processes in the fork mode write to the same memory. The metrics are served by a thread of the main
+process: every connection to the UNIX socket gets the totals in the Prometheus text format, with the HTTP
+headers if the connection sent an HTTP request.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "metrics.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../shared/protocol.h"
+#include "workers.h"
+
+#define MOVE_TIME_BASE 64
+#define SESSION_DURATION_BASE 1000000
+#define METRICS_BACKLOG 16
+#define REQUEST_TIMEOUT_MS 100
+#define MAX_REQUEST_SIZE 1024
+
+/**
+ * @brief Slots of the metrics of the workers.
+ */
+static MetricsSlot* metrics_slots;
+
+/**
+ * @brief Number of the slots.
+ */
+static int number_of_slots;
+
+/**
+ * @brief Names and descriptions of the counters in the Prometheus format.
+ */
+static const char* counter_names[METRIC_COUNT][2] = {
+    [METRIC_CONNECTIONS_ACCEPTED] = {"battleship_connections_accepted_total", "Accepted connections."},
+    [METRIC_CONNECTIONS_CLOSED] = {"battleship_connections_closed_total", "Closed connections."},
+    [METRIC_CONNECTIONS_REFUSED] = {"battleship_connections_refused_total", "Connections refused as busy."},
+    [METRIC_SESSIONS_STARTED] = {"battleship_sessions_started_total", "Started sessions."},
+    [METRIC_SESSIONS_FINISHED] = {"battleship_sessions_finished_total", "Finished sessions."},
+    [METRIC_MOVES] = {"battleship_moves_total", "Processed moves."},
+    [METRIC_HITS] = {"battleship_hits_total", "Moves that hit a ship."},
+    [METRIC_MISSES] = {"battleship_misses_total", "Moves that missed."},
+    [METRIC_INVALID_MOVES] = {"battleship_invalid_moves_total", "Invalid moves."},
+    [METRIC_DUPLICATE_SHOTS] = {"battleship_duplicate_shots_total", "Moves at a cell that was already shot."},
+    [METRIC_GAMES_WON] = {"battleship_games_won_total", "Games won by the players."},
+    [METRIC_GAMES_LOST] = {"battleship_games_lost_total", "Games lost by the players."},
+    [METRIC_TIMEOUTS] = {"battleship_timeouts_total", "Sessions finished because the player was idle."},
+    [METRIC_SESSIONS_RESUMED] = {"battleship_sessions_resumed_total", "Games resumed with a resume token."},
+    [METRIC_REMATCHES] = {"battleship_rematches_total", "Games started after a game on the same connection."},
+    [METRIC_SPECTATORS] = {"battleship_spectators_total", "Spectators that joined a game."},
+    [METRIC_SPECTATOR_SKIPS] = {"battleship_spectator_skips_total",
+                                "Skips of slow spectators to the current state of the game."},
+    [METRIC_SPECTATORS_DROPPED] = {"battleship_spectators_dropped_total",
+                                   "Slow spectators that were dropped."},
+    [METRIC_CHANNELS] = {"battleship_channels_total", "Shared-memory channels attached by local players."},
+};
+
+/**
+ * @brief Returns the slot of the current worker.
+ * @return Slot of the metrics.
+ */
+static inline MetricsSlot* local_slot(void) {
+    return &metrics_slots[worker_id];
+}
+
+/**
+ * @brief Adds the observation to the histogram.
+ * @param histogram Histogram.
+ * @param base Upper bound of the first bucket in nanoseconds.
+ * @param value Observation in nanoseconds.
+ * @return void
+ */
+static void histogram_observe(Histogram* histogram, uint64_t base, uint64_t value) {
+    uint64_t quotient = (value + base - 1) / base;
+    int bucket = quotient <= 1 ? 0 : 64 - __builtin_clzll(quotient - 1);
+
+    if (bucket > HISTOGRAM_BUCKETS) {
+        bucket = HISTOGRAM_BUCKETS;
+    }
+
+    __atomic_fetch_add(&histogram->buckets[bucket], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&histogram->sum, value, __ATOMIC_RELAXED);
+
+    return;
+}
+
+/**
+ * @brief Allocates the slots of the metrics. Must be called before the workers are created.
+ * @param number_of_workers Number of workers.
+ * @return void
+ */
+void metrics_init(int number_of_workers) {
+    number_of_slots = number_of_workers;
+    metrics_slots = (MetricsSlot*)mmap(NULL, sizeof(MetricsSlot) * number_of_workers, PROT_READ | PROT_WRITE,
+                                       MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+
+    if (metrics_slots == MAP_FAILED) {
+        perror("MMAP ERROR");
+        exit(EXIT_FAILURE);
+    }
+
+    return;
+}
+
+/**
+ * @brief Adds the value to the counter of the current worker.
+ * @param metric Counter.
+ * @param value Value to add.
+ * @return void
+ */
+void metrics_add(Metric metric, uint64_t value) {
+    __atomic_fetch_add(&local_slot()->counters[metric], value, __ATOMIC_RELAXED);
+
+    return;
+}
+
+/**
+ * @brief Counts the processed move and its result.
+ * @param result Result of the move.
+ * @return void
+ */
+void metrics_count_move(MoveResult result) {
+    static const Metric result_metrics[] = {
+        [MOVE_MISS] = METRIC_MISSES,
+        [MOVE_HIT] = METRIC_HITS,
+        [MOVE_ALREADY_HIT] = METRIC_DUPLICATE_SHOTS,
+        [MOVE_ALREADY_MISSED] = METRIC_DUPLICATE_SHOTS,
+        [MOVE_INVALID] = METRIC_INVALID_MOVES,
+    };
+
+    metrics_add(METRIC_MOVES, 1);
+    metrics_add(result_metrics[result], 1);
+
+    return;
+}
+
+/**
+ * @brief Counts the finished game.
+ * @param status Status of the game.
+ * @return void
+ */
+void metrics_count_game(GameStatus status) {
+    if (status != NEXT) {
+        metrics_add(status == WIN ? METRIC_GAMES_WON : METRIC_GAMES_LOST, 1);
+    }
+
+    return;
+}
+
+/**
+ * @brief Adds the time to process a move to the histogram of the current worker.
+ * @param nanoseconds Time in nanoseconds.
+ * @return void
+ */
+void metrics_observe_move_time(uint64_t nanoseconds) {
+    histogram_observe(&local_slot()->move_time, MOVE_TIME_BASE, nanoseconds);
+
+    return;
+}
+
+/**
+ * @brief Adds the duration of a session to the histogram of the current worker.
+ * @param nanoseconds Duration in nanoseconds.
+ * @return void
+ */
+void metrics_observe_session_duration(uint64_t nanoseconds) {
+    histogram_observe(&local_slot()->session_duration, SESSION_DURATION_BASE, nanoseconds);
+
+    return;
+}
+
+/**
+ * @brief Returns the monotonic time for the measurements.
+ * @return Time in nanoseconds.
+ */
+uint64_t metrics_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Returns the total of the counter over all workers.
+ * @param metric Counter.
+ * @return Total.
+ */
+static uint64_t counter_total(Metric metric) {
+    uint64_t total = 0;
+
+    for (int i = 0; i < number_of_slots; ++i) {
+        total += __atomic_load_n(&metrics_slots[i].counters[metric], __ATOMIC_RELAXED);
+    }
+
+    return total;
+}
+
+/**
+ * @brief Writes the total histogram of all workers in the Prometheus format. The values are in seconds.
+ * @param output Output stream.
+ * @param name Name of the histogram.
+ * @param help Description of the histogram.
+ * @param offset Offset of the histogram in the slot.
+ * @param base Upper bound of the first bucket in nanoseconds.
+ * @return void
+ */
+static void write_histogram(FILE* output, const char* name, const char* help, size_t offset, uint64_t base) {
+    uint64_t count = 0, sum = 0;
+
+    fprintf(output, "# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+
+    for (int bucket = 0; bucket <= HISTOGRAM_BUCKETS; ++bucket) {
+        for (int i = 0; i < number_of_slots; ++i) {
+            const Histogram* histogram = (const Histogram*)((const char*)&metrics_slots[i] + offset);
+            count += __atomic_load_n(&histogram->buckets[bucket], __ATOMIC_RELAXED);
+        }
+
+        if (bucket < HISTOGRAM_BUCKETS) {
+            fprintf(output, "%s_bucket{le=\"%g\"} %llu\n", name, (double)(base << bucket) / 1e9,
+                    (unsigned long long)count);
+        } else {
+            fprintf(output, "%s_bucket{le=\"+Inf\"} %llu\n", name, (unsigned long long)count);
+        }
+    }
+
+    for (int i = 0; i < number_of_slots; ++i) {
+        const Histogram* histogram = (const Histogram*)((const char*)&metrics_slots[i] + offset);
+        sum += __atomic_load_n(&histogram->sum, __ATOMIC_RELAXED);
+    }
+
+    fprintf(output, "%s_sum %.9f\n%s_count %llu\n", name, (double)sum / 1e9, name, (unsigned long long)count);
+
+    return;
+}
+
+/**
+ * @brief Writes the totals of all metrics in the Prometheus text format. The finished sessions are read
+ * before the started ones, and the active sessions are clamped at 0, since a session can start and finish
+ * between the reads of the unsynchronized counters of the workers.
+ * @param output Output stream.
+ * @return void
+ */
+static void write_metrics(FILE* output) {
+    for (int metric = 0; metric < METRIC_COUNT; ++metric) {
+        fprintf(output, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", counter_names[metric][0],
+                counter_names[metric][1], counter_names[metric][0], counter_names[metric][0],
+                (unsigned long long)counter_total(metric));
+    }
+
+    fprintf(output, "# HELP battleship_sessions_active Sessions in progress.\n");
+    fprintf(output, "# TYPE battleship_sessions_active gauge\n");
+    uint64_t finished = counter_total(METRIC_SESSIONS_FINISHED);
+    uint64_t started = counter_total(METRIC_SESSIONS_STARTED);
+    uint64_t active = started > finished ? started - finished : 0;
+    fprintf(output, "battleship_sessions_active %llu\n", (unsigned long long)active);
+
+    write_histogram(output, "battleship_move_processing_seconds", "Time to process a move.",
+                    offsetof(MetricsSlot, move_time), MOVE_TIME_BASE);
+    write_histogram(output, "battleship_session_duration_seconds", "Duration of a session.",
+                    offsetof(MetricsSlot, session_duration), SESSION_DURATION_BASE);
+
+    return;
+}
+
+/**
+ * @brief Answers the connection to the metrics socket. The request is read for a short time, and the
+ * answer is an HTTP response if the request is an HTTP GET, otherwise the plain text.
+ * @param client Client socket.
+ * @return void
+ */
+static void answer_metrics_request(int client) {
+    char request[MAX_REQUEST_SIZE];
+    struct pollfd poll_fd = {.fd = client, .events = POLLIN};
+    bool http = false;
+
+    if (poll(&poll_fd, 1, REQUEST_TIMEOUT_MS) > 0) {
+        ssize_t received = recv(client, request, sizeof(request), 0);
+        http = received >= 3 && strncmp(request, "GET", 3) == 0;
+    }
+
+    char* text = NULL;
+    size_t size = 0;
+    FILE* output = open_memstream(&text, &size);
+    if (output == NULL) {
+        return;
+    }
+
+    if (http) {
+        fprintf(output, "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n\r\n");
+    }
+
+    write_metrics(output);
+    fclose(output);
+
+    send_all(client, text, size);
+    free(text);
+
+    return;
+}
+
+/**
+ * @brief Accepts the connections to the metrics socket and answers them one by one.
+ * @param argument Listening socket.
+ * @return NULL, the thread runs until the process exits.
+ */
+static void* serve_metrics(void* argument) {
+    int listener = (int)(intptr_t)argument;
+
+    while (true) {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            if (errno != EINTR) {
+                perror("METRICS ACCEPT ERROR");
+            }
+
+            continue;
+        }
+
+        answer_metrics_request(client);
+        close(client);
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Starts serving the metrics on the UNIX socket. A stale socket file is replaced.
+ * @param path Path of the UNIX socket.
+ * @return void
+ */
+void metrics_serve(const char* path) {
+    struct sockaddr_un address = {.sun_family = AF_UNIX};
+
+    if (strlen(path) >= sizeof(address.sun_path)) {
+        printf("ERROR: metrics socket path is too long\n");
+        exit(EXIT_FAILURE);
+    }
+
+    strcpy(address.sun_path, path);
+    unlink(path);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CHECK_LESS_THAN_ZERO(listener, "METRICS SOCKET ERROR");
+    CHECK_LESS_THAN_ZERO(bind(listener, (struct sockaddr*)&address, sizeof(address)), "METRICS BIND ERROR");
+    CHECK_LESS_THAN_ZERO(listen(listener, METRICS_BACKLOG), "METRICS LISTEN ERROR");
+
+    pthread_t thread;
+    int error = pthread_create(&thread, NULL, serve_metrics, (void*)(intptr_t)listener);
+    if (error != 0) {
+        printf("ERROR: cannot start the metrics thread: %s\n", strerror(error));
+        exit(EXIT_FAILURE);
+    }
+
+    pthread_detach(thread);
+
+    return;
+}
@@ -0,0 +1,81 @@
+/*! @file metrics.h
+File with the declaration of the server metrics. Every worker has its own slot of counters and histograms
+in memory shared by all processes of the server, the processes of a worker update the slot with atomic
+additions and without locks. The totals of all workers are served in the Prometheus text format on a
+UNIX socket.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+
+#include "../shared/shared.h"
+
+#define HISTOGRAM_BUCKETS 24
+
+/**
+ * @brief Enumeration for the counters of the server.
+ */
+typedef enum {
+    METRIC_CONNECTIONS_ACCEPTED, /**< Accepted connections */
+    METRIC_CONNECTIONS_CLOSED,   /**< Closed connections, including the refused ones */
+    METRIC_CONNECTIONS_REFUSED,  /**< Connections refused as busy: no free session or draining */
+    METRIC_SESSIONS_STARTED,     /**< Sessions taken from the session pool */
+    METRIC_SESSIONS_FINISHED,    /**< Sessions returned to the session pool */
+    METRIC_MOVES,                /**< Processed moves */
+    METRIC_HITS,                 /**< Moves that hit a ship */
+    METRIC_MISSES,               /**< Moves that missed */
+    METRIC_INVALID_MOVES,        /**< Moves outside of the board or with an invalid format */
+    METRIC_DUPLICATE_SHOTS,      /**< Moves at a cell that was already shot */
+    METRIC_GAMES_WON,            /**< Games won by the player */
+    METRIC_GAMES_LOST,           /**< Games lost by the player */
+    METRIC_TIMEOUTS,             /**< Sessions finished because the player was idle for too long */
+    METRIC_SESSIONS_RESUMED,     /**< Games resumed with a resume token */
+    METRIC_REMATCHES,            /**< Games started on the connection of a finished game */
+    METRIC_SPECTATORS,           /**< Spectators that joined a game */
+    METRIC_SPECTATOR_SKIPS,      /**< Skips of slow spectators to the current state of the game */
+    METRIC_SPECTATORS_DROPPED,   /**< Slow spectators that were dropped */
+    METRIC_CHANNELS,             /**< Shared-memory channels attached by local players */
+    METRIC_COUNT                 /**< Number of the counters */
+} Metric;
+
+/**
+ * @struct Histogram
+ * @brief Structure for a histogram with buckets of doubling size. The upper bound of the bucket i is
+ * base << i nanoseconds, the last bucket has no upper bound.
+ *
+ * @param buckets Number of observations of every bucket.
+ * @param sum Sum of the observations in nanoseconds.
+ */
+typedef struct {
+    uint64_t buckets[HISTOGRAM_BUCKETS + 1];
+    uint64_t sum;
+} Histogram;
+
+/**
+ * @struct MetricsSlot
+ * @brief Structure for the metrics of one worker. The slots are aligned to the cache line, so the workers
+ * do not write to the same cache line.
+ *
+ * @param counters Counters of the worker.
+ * @param move_time Histogram of the time to process a move.
+ * @param session_duration Histogram of the duration of a session.
+ */
+typedef struct {
+    _Alignas(64) uint64_t counters[METRIC_COUNT];
+    Histogram move_time;
+    Histogram session_duration;
+} MetricsSlot;
+
+void metrics_init(int number_of_workers);
+void metrics_add(Metric metric, uint64_t value);
+void metrics_count_move(MoveResult result);
+void metrics_count_game(GameStatus status);
+void metrics_observe_move_time(uint64_t nanoseconds);
+void metrics_observe_session_duration(uint64_t nanoseconds);
+uint64_t metrics_now(void);
+void metrics_serve(const char* path);
+
+#endif
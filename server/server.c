@@ -1,34 +1,70 @@
 /*! @file server.c
 File with the implementation of the server. The server creates a socket, binds it to the address and port,
-listens for incoming connections, and handles the connections. The server creates a child process to handle
-the client connection. The child process creates the game board, places the ships, and handles the game
-process.
+listens for incoming connections, and handles the connections. In the fork mode the server creates a child
+process to handle the client connection. The child process creates the game board, places the ships, and
+handles the game process. In the epoll and io_uring modes all the connections are served by one process.
 @author Gavrish A.A.
 @date 13.04.2024 */
 
+#define _GNU_SOURCE
+
 #include <arpa/inet.h>
-#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <getopt.h>
 #include <math.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/random.h>
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
 #include <time.h>
 #include <unistd.h>
 
-#include "../shared/shared.h"
+#include "board_queue.h"
+#include "epoll_server.h"
+#include "handoff.h"
+#include "journal.h"
+#include "logger.h"
+#include "metrics.h"
+#include "server.h"
+#include "session.h"
+#include "session_pool.h"
+#include "session_store.h"
+#include "trace.h"
+#include "uring_server.h"
+#include "workers.h"
+
+#define GAME_SEED_PROCESS_SHIFT 20
 
-#define CONFIG_FILE "config.cfg"
+ServerConfig config;
+GameRules game_rules;
+volatile sig_atomic_t draining;
+sigset_t drain_wait_mask;
+int local_listener = -1;
 
-#define MAX_CONNECTIONS 10
-#define MAX_FIELD_SIZE 20
-#define BUF_CONFIG_SIZE 50
+/**
+ * @brief Seed of the board of the next game.
+ */
+static uint64_t game_seed;
 
 /**
- * @brief Server configuration.
- * @see ServerConfig
+ * @brief Makes the server drain on SIGQUIT.
+ * @param signal Signal number.
+ * @return void
  */
-ServerConfig config;
+static void request_drain(int signal) {
+    (void)signal;
+    draining = 1;
+
+    return;
+}
+
+void parse_server_mode(void* value, const char* str);
+void parse_log_level(void* value, const char* str);
 
 /**
  * @brief Configuration option.
@@ -40,31 +76,66 @@ ConfigOption options[] = {
     {"number_of_ships", &config.number_of_ships, parse_int},
     {"server_port", &config.server_port, parse_int},
     {"server_address", &config.server_address, parse_string},
+    {"server_mode", &config.server_mode, parse_server_mode},
+    {"number_of_workers", &config.number_of_workers, parse_int},
+    {"max_sessions", &config.max_sessions, parse_int},
+    {"seed", &config.seed, parse_int},
+    {"prepared_boards", &config.prepared_boards, parse_int},
+    {"metrics_socket", &config.metrics_socket, parse_string},
+    {"log_level", &config.log_level, parse_log_level},
+    {"listen_backlog", &config.listen_backlog, parse_int},
+    {"handshake_timeout", &config.handshake_timeout, parse_int},
+    {"move_timeout", &config.move_timeout, parse_int},
+    {"game_timeout", &config.game_timeout, parse_int},
+    {"journal", &config.journal, parse_string},
+    {"journal_size", &config.journal_size, parse_int},
+    {"session_store", &config.session_store, parse_string},
+    {"handoff_socket", &config.handoff_socket, parse_string},
+    {"local_socket", &config.local_socket, parse_string},
 };
 
-char** playing_field;
-
 void init_configuration(FILE* file);
+uint64_t initial_game_seed(void);
+void set_default_configuration(void);
+void run_fork_server(int server_socket);
+void reap_children(void);
+void wait_for_children(void);
 void handle_client(int client_socket, int server_socket);
-void place_ships(char*** playing_field, int number_of_ships);
-void logging(char* message);
-void process_player_move(char* move, char* answer, int* number_of_moves, int* number_of_ships);
-bool is_valid_position(char** playing_field, int x, int y);
+bool wait_for_input(Session* session);
+int flush_output(Session* session);
 bool check_configuration(ServerConfig config);
-GameStatus check_game_status(int number_of_moves, int number_of_ships);
+void block_drain_signals(void);
+int* open_server_sockets(bool takeover);
 
 /**
  * @brief Main function of the server. Initializes the configuration, creates the server socket, binds it to
- * the address and port, listens for incoming connections, and handles them.
+ * the address and port, listens for incoming connections, and handles them. When the configuration has
+ * several workers, every worker is a separate process with its own server socket. With the -t option the
+ * server sockets are taken over from the running server, which then finishes its games and exits.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
  * @return EXIT_SUCCESS if the programm was executed successfully, EXIT_FAILURE otherwise.
  */
-int main(void) {
+int main(int argc, char* argv[]) {
+    bool takeover = false;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "t")) != -1) {
+        if (opt != 't') {
+            printf("ERROR: usage: %s [-t]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+
+        takeover = true;
+    }
+
     FILE* config_file = fopen(CONFIG_FILE, "r");
     if (config_file == NULL) {
         printf("ERROR: config file not found\n");
         return EXIT_FAILURE;
     }
 
+    set_default_configuration();
     init_configuration(config_file);
     fclose(config_file);
 
@@ -73,9 +144,134 @@ int main(void) {
         return EXIT_FAILURE;
     }
 
+    if (takeover && config.handoff_socket[0] == '\0') {
+        printf("ERROR: the takeover needs the handoff_socket key\n");
+        return EXIT_FAILURE;
+    }
+
+    game_rules.field_size = config.field_size;
+    game_rules.number_of_ships = config.number_of_ships;
+    game_rules.number_of_moves = config.number_of_moves;
+
+    block_drain_signals();
+
+    metrics_init(config.number_of_workers);
+    logger_init(config.log_level, config.number_of_workers);
+    TRACE_INIT();
+
+    if (config.metrics_socket[0] != '\0') {
+        metrics_serve(config.metrics_socket);
+    }
+
+    if (config.journal[0] != '\0') {
+        journal_init(config.journal, config.journal_size);
+    }
+
+    if (config.session_store[0] != '\0') {
+        session_store_init(config.session_store, 2 * config.max_sessions * config.number_of_workers,
+                           &game_rules, takeover ? false : true);
+    }
+
+    int* server_sockets = open_server_sockets(takeover);
+
+    if (config.handoff_socket[0] != '\0') {
+        handoff_serve(config.handoff_socket, server_sockets, config.number_of_workers, local_listener);
+    }
+
+    if (config.number_of_workers > 1) {
+        run_workers(config.number_of_workers, server_sockets);
+    } else {
+        serve(server_sockets[0]);
+    }
+
+    free(server_sockets);
+    logger_flush();
+
+    return EXIT_SUCCESS;
+}
+
+/**
+ * @brief Sets the handler of SIGQUIT, which makes the server drain, and blocks SIGQUIT and SIGCHLD. The
+ * server loops take the signals only while they wait, with drain_wait_mask. Must be called before any
+ * thread is started, so all threads block the signals.
+ * @return void
+ */
+void block_drain_signals(void) {
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_drain;
+    sigemptyset(&action.sa_mask);
+    CHECK_LESS_THAN_ZERO(sigaction(SIGQUIT, &action, NULL), "SIGACTION ERROR");
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGQUIT);
+    sigaddset(&signals, SIGCHLD);
+    CHECK_LESS_THAN_ZERO(sigprocmask(SIG_BLOCK, &signals, &drain_wait_mask), "SIGPROCMASK ERROR");
+
+    return;
+}
+
+/**
+ * @brief Opens the server sockets, one for every worker, and the listener of the local socket. With the
+ * takeover the sockets of the running server are taken first, and only the missing ones are created. The
+ * listener of the local socket is taken as well; it is closed if the new configuration has no local socket.
+ * @param takeover true to take the sockets of the running server.
+ * @return Server sockets.
+ */
+int* open_server_sockets(bool takeover) {
+    int* sockets = (int*)malloc(config.number_of_workers * sizeof(int));
+    if (sockets == NULL) {
+        printf("ERROR: not enough memory for the server sockets\n");
+        exit(EXIT_FAILURE);
+    }
+
+    int count = 0;
+
+    if (takeover) {
+        count = handoff_take(config.handoff_socket, sockets, config.number_of_workers, &local_listener);
+
+        LogRecord* record = log_begin(LOG_EVENT_TAKEOVER);
+        if (record != NULL) {
+            record->arguments[0] = count;
+            record->arguments[1] = config.number_of_workers;
+            log_commit();
+        }
+    }
+
+    for (; count < config.number_of_workers; ++count) {
+        sockets[count] = create_server_socket();
+    }
+
+    if (local_listener >= 0 && config.local_socket[0] == '\0') {
+        close(local_listener);
+        local_listener = -1;
+    } else if (local_listener < 0 && config.local_socket[0] != '\0') {
+        local_listener = create_local_socket();
+    }
+
+    return sockets;
+}
+
+/**
+ * @brief Creates the server socket, binds it to the address and port, and listens for incoming
+ * connections. When there are several workers, every worker creates its own socket on the same address
+ * and port with SO_REUSEPORT, and the kernel distributes the connections between them.
+ * @return Server socket.
+ */
+int create_server_socket(void) {
     int server_socket = socket(AF_INET, SOCK_STREAM, 0);
     CHECK_LESS_THAN_ZERO(server_socket, "SOCKET ERROR");
 
+    int enable = 1;
+    CHECK_LESS_THAN_ZERO(setsockopt(server_socket, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable)),
+                         "SETSOCKOPT ERROR");
+
+    if (config.number_of_workers > 1 || config.handoff_socket[0] != '\0') {
+        CHECK_LESS_THAN_ZERO(setsockopt(server_socket, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)),
+                             "SETSOCKOPT ERROR");
+    }
+
     struct sockaddr_in server_address;
     server_address.sin_family = AF_INET;
     server_address.sin_addr.s_addr = inet_addr(config.server_address);
@@ -83,31 +279,139 @@ int main(void) {
 
     CHECK_LESS_THAN_ZERO(bind(server_socket, (struct sockaddr*)(&server_address), sizeof(server_address)),
                          "BIND ERROR");
-    CHECK_LESS_THAN_ZERO(listen(server_socket, MAX_CONNECTIONS), "LISTEN ERROR");
+    CHECK_LESS_THAN_ZERO(listen(server_socket, config.listen_backlog), "LISTEN ERROR");
 
-    struct sockaddr_in client_address;
-    socklen_t client_len = sizeof(client_address);
+    return server_socket;
+}
 
-    while (true) {
-        int client_socket = accept(server_socket, (struct sockaddr*)(&client_address), &client_len);
-        CHECK_LESS_THAN_ZERO(client_socket, "ACCEPT ERROR");
+/**
+ * @brief Creates the listener of the local socket for the clients on the same host. A stale socket file of
+ * a previous server is removed first. The listener is shared by all workers, and its clients may offer the
+ * shared-memory channel.
+ * @return Listener of the local socket.
+ */
+int create_local_socket(void) {
+    struct sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    snprintf(address.sun_path, sizeof(address.sun_path), "%s", config.local_socket);
 
-        handle_client(client_socket, server_socket);
+    unlink(config.local_socket);
+
+    int listener = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    CHECK_LESS_THAN_ZERO(listener, "SOCKET ERROR");
+    CHECK_LESS_THAN_ZERO(bind(listener, (struct sockaddr*)(&address), sizeof(address)), "BIND ERROR");
+    CHECK_LESS_THAN_ZERO(listen(listener, config.listen_backlog), "LISTEN ERROR");
+
+    return listener;
+}
+
+/**
+ * @brief Serves the clients in the configured mode. Handles the incoming connections of the server socket
+ * until the server is drained or the process is terminated.
+ * @param server_socket Server socket.
+ * @return void
+ * @see ServerMode
+ */
+void serve(int server_socket) {
+    session_pool_init(&session_pool, config.max_sessions, &game_rules);
+    game_seed = initial_game_seed();
+    board_queue_init(&board_queue, config.prepared_boards, &game_rules);
+
+    switch (config.server_mode) {
+        case URING_MODE:
+            if (!run_uring_server(server_socket)) {
+                run_epoll_server(server_socket);
+            }
+            break;
+        case EPOLL_MODE:
+            run_epoll_server(server_socket);
+            break;
+        default:
+            run_fork_server(server_socket);
+            break;
     }
 
-    shutdown(server_socket, SHUT_RDWR);
-    fclose(config_file);
-    destroy_game_board(&playing_field, config.field_size);
+    return;
+}
 
-    return EXIT_SUCCESS;
+/**
+ * @brief Stops accepting the connections when the server drains. The server socket and the listener of the
+ * local socket are closed in this process only, their connections are accepted by the processes that still
+ * have them.
+ * @param server_socket Server socket.
+ * @return void
+ */
+void stop_accepting(int server_socket) {
+    close(server_socket);
+
+    if (local_listener >= 0) {
+        close(local_listener);
+        local_listener = -1;
+    }
+
+    LogRecord* record = log_begin(LOG_EVENT_DRAINING);
+    if (record != NULL) {
+        record->arguments[0] = session_pool_used(&session_pool);
+        log_commit();
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the seed of the board of the first game of the worker. With the seed in the configuration
+ * the boards are reproducible, and the workers use distant seeds. Otherwise the seed is random.
+ * @return Seed.
+ */
+uint64_t initial_game_seed(void) {
+    uint64_t seed;
+
+    if (config.seed != 0) {
+        return (uint64_t)(uint32_t)config.seed + ((uint64_t)worker_id << 40);
+    }
+
+    if (getrandom(&seed, sizeof(seed), 0) != sizeof(seed)) {
+        seed = (uint64_t)time(NULL) ^ ((uint64_t)getpid() << 32);
+    }
+
+    return seed;
+}
+
+/**
+ * @brief Returns the seed of the board of the next game. Every game gets its own seed, and the random
+ * generator spreads close seeds, so consecutive games have unrelated boards. The seeds are taken by the
+ * accepting thread and by the board producer.
+ * @return Seed.
+ */
+uint64_t next_game_seed(void) {
+    return __atomic_fetch_add(&game_seed, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief Sets the default values of the optional configuration keys. The values are overwritten by the
+ * configuration file.
+ * @return void
+ */
+void set_default_configuration(void) {
+    config.number_of_workers = 1;
+    config.max_sessions = DEFAULT_MAX_SESSIONS;
+    config.prepared_boards = DEFAULT_PREPARED_BOARDS;
+    config.log_level = LOG_INFO;
+    config.listen_backlog = DEFAULT_LISTEN_BACKLOG;
+    config.journal_size = DEFAULT_JOURNAL_SIZE;
+
+    return;
 }
 
 /**
  * @brief Initializes the configuration of the server. Reads the configuration file and sets the values
- * of the configuration. The configuration file must be in the format "key=value".
+ * of the configuration. The configuration file must be in the format "key=value". A line is read whole:
+ * a line longer than the longest key with a socket path, or a value that does not fit a socket path, is
+ * rejected.
  * @note The configuration file must contain the following keys: "field_size", "number_of_moves",
- * @param file Configuration file.
  * "number_of_ships", "server_port", "server_address".
+ * @param file Configuration file.
  * @return void
  */
 void init_configuration(FILE* file) {
@@ -115,9 +419,19 @@ void init_configuration(FILE* file) {
     char buffer[BUF_CONFIG_SIZE];
 
     while (fgets(buffer, BUF_CONFIG_SIZE, file) != NULL) {
+        if (strchr(buffer, '\n') == NULL && !feof(file)) {
+            printf("ERROR: configuration line %.*s... is too long\n", MAX_CONFIG_KEY_LENGTH, buffer);
+            exit(EXIT_FAILURE);
+        }
+
         key = strtok(buffer, "=");
         value = strtok(NULL, "=");
 
+        if (value != NULL && strcspn(value, "\n") >= CONFIG_PATH_SIZE) {
+            printf("ERROR: value of %s is too long\n", key);
+            exit(EXIT_FAILURE);
+        }
+
         for (int i = 0; i < (int)(sizeof(options) / sizeof(ConfigOption)); ++i) {
             if (strcmp(key, options[i].key) == 0) {
                 options[i].parse(options[i].value, value);
@@ -130,229 +444,376 @@ void init_configuration(FILE* file) {
 }
 
 /**
- * @brief Handles the client connection. Creates a child process to handle the client. The child process
- * creates the game board, places the ships, and handles the game process.
- * @note The child process is terminated after the game is finished.
- * @param client_socket Client socket.
- * @param server_socket Server socket.
+ * @brief Function to parse the server mode. The mode is "fork", "epoll", or "uring".
+ *
+ * @param value Pointer to the variable where the mode will be stored.
+ * @param str String containing the mode.
  * @return void
+ * @see ServerMode
  */
-void handle_client(int client_socket, int server_socket) {
-    pid_t pid = fork();
-
-    if (pid < 0) {
-        perror("FORK ERROR");
+void parse_server_mode(void* value, const char* str) {
+    if (strncmp(str, "fork", strlen("fork")) == 0) {
+        *(ServerMode*)value = FORK_MODE;
+    } else if (strncmp(str, "epoll", strlen("epoll")) == 0) {
+        *(ServerMode*)value = EPOLL_MODE;
+    } else if (strncmp(str, "uring", strlen("uring")) == 0) {
+        *(ServerMode*)value = URING_MODE;
+    } else {
+        printf("ERROR: invalid server mode\n");
         exit(EXIT_FAILURE);
-    } else if (pid == 0) {
-        close(server_socket);
+    }
 
-        char buffer[BUF_MESSAGE_SIZE];
-        recv(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
-        logging(buffer);
+    return;
+}
 
-        create_game_board(&playing_field, config.field_size);
-        place_ships(&playing_field, config.number_of_ships);
+/**
+ * @brief Function to parse the level of the log. The level is "error", "warning", "info", or "debug".
+ *
+ * @param value Pointer to the variable where the level will be stored.
+ * @param str String containing the level.
+ * @return void
+ * @see LogLevel
+ */
+void parse_log_level(void* value, const char* str) {
+    for (LogLevel level = LOG_ERROR; level <= LOG_DEBUG; ++level) {
+        const char* name = log_level_name(level);
 
-        int number_of_ships = config.number_of_ships, number_of_moves = 0;
+        if (strncmp(str, name, strlen(name)) == 0) {
+            *(LogLevel*)value = level;
+            return;
+        }
+    }
 
-        sprintf(buffer, "f=%d,n=%d", config.field_size, number_of_ships);
-        send(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
+    printf("ERROR: invalid log level\n");
+    exit(EXIT_FAILURE);
+}
 
-        GameStatus game_status = NEXT;
+/**
+ * @brief Runs the server in the fork mode. Accepts the connections of the server socket and of the local
+ * socket and creates a child process for every client. The listeners are non-blocking, because they may be
+ * shared with another server that takes the connection first. When the server drains, the children are told
+ * to drain as well, and the function returns after the games of all children.
+ * @param server_socket Server socket.
+ * @return void
+ */
+void run_fork_server(int server_socket) {
+    struct pollfd listeners[2] = {{.fd = server_socket, .events = POLLIN},
+                                  {.fd = local_listener, .events = POLLIN}};
 
-        while ((game_status = check_game_status(number_of_moves, number_of_ships)) == NEXT) {
-            recv(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
-            char answer[BUF_MESSAGE_SIZE];
-            process_player_move(buffer, answer, &number_of_moves, &number_of_ships);
+    CHECK_LESS_THAN_ZERO(fcntl(server_socket, F_SETFL, fcntl(server_socket, F_GETFL) | O_NONBLOCK),
+                         "FCNTL ERROR");
 
-            send(client_socket, answer, BUF_MESSAGE_SIZE, 0);
-        }
+    if (local_listener >= 0) {
+        CHECK_LESS_THAN_ZERO(fcntl(local_listener, F_SETFL, fcntl(local_listener, F_GETFL) | O_NONBLOCK),
+                             "FCNTL ERROR");
+    }
 
-        switch (game_status) {
-            case WIN:
-                strcpy(buffer, "You win");
-                break;
-            default:
-                strcpy(buffer, "You lose");
-                break;
+    while (!draining) {
+        if (ppoll(listeners, 2, NULL, &drain_wait_mask) < 0) {
+            if (errno != EINTR) {
+                perror("POLL ERROR");
+                exit(EXIT_FAILURE);
+            }
+
+            continue;
         }
 
-        send(client_socket, buffer, BUF_MESSAGE_SIZE, 0);
+        for (int i = 0; i < 2; ++i) {
+            if (listeners[i].revents == 0) {
+                continue;
+            }
 
-        shutdown(client_socket, SHUT_RDWR);
-        close(client_socket);
-        exit(EXIT_SUCCESS);
+            int client_socket = accept(listeners[i].fd, NULL, NULL);
+            if (client_socket < 0) {
+                if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR || errno == ECONNABORTED) {
+                    continue;
+                }
+
+                perror("ACCEPT ERROR");
+                exit(EXIT_FAILURE);
+            }
+
+            metrics_add(METRIC_CONNECTIONS_ACCEPTED, 1);
+
+            reap_children();
+            handle_client(client_socket, server_socket);
+        }
     }
 
-    close(client_socket);
+    stop_accepting(server_socket);
+    session_pool_signal_owners(&session_pool, SIGQUIT);
+    wait_for_children();
 
     return;
 }
 
 /**
- * @brief Places ships on the game board. The ships are placed randomly on the board. The number of ships
- * is specified in the configuration.
- * @note The ships are placed randomly on the board. The ships are placed in a way that there are no ships
- * around the ship.
- * @param playing_field Game board.
- * @param number_of_ships Number of ships.
+ * @brief Collects the exited child processes and returns their sessions to the session pool.
  * @return void
  */
-void place_ships(char*** playing_field, int number_of_ships) {
-    srand(time(NULL));
+void reap_children(void) {
+    pid_t pid;
+    int status;
 
-    int ships_placed = 0;
-    while (ships_placed < number_of_ships) {
-        int x = rand() % config.field_size;
-        int y = rand() % config.field_size;
-
-        if (is_valid_position(*playing_field, x, y)) {
-            (*playing_field)[x][y] = 'S';
-            ships_placed++;
-        }
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+        session_pool_release_owner(&session_pool, pid);
     }
 
     return;
 }
 
 /**
- * @brief Checks if the position on the game board is valid. The position is valid if there are no ships
- * around the position.
- * @note The position is valid if there are no ships around the position.
- * @param playing_field Game board.
- * @param x X-coordinate.
- * @param y Y-coordinate.
- * @return true if the position is valid, false otherwise.
- * @see bool
+ * @brief Waits for all child processes and returns their sessions to the session pool.
+ * @return void
  */
-bool is_valid_position(char** playing_field, int x, int y) {
-    for (int dx = -1; dx <= 1; ++dx) {
-        for (int dy = -1; dy <= 1; ++dy) {
-            if (x + dx < 0 || x + dx >= config.field_size) {
+void wait_for_children(void) {
+    while (session_pool_used(&session_pool) > 0) {
+        int status;
+        pid_t pid = wait(&status);
+
+        if (pid < 0) {
+            if (errno == EINTR) {
                 continue;
             }
 
-            if (y + dy < 0 || y + dy >= config.field_size) {
-                continue;
+            break;
+        }
+
+        session_pool_release_owner(&session_pool, pid);
+    }
+
+    return;
+}
+
+/**
+ * @brief Handles the client connection. Takes a session from the session pool and creates a child process
+ * to handle the client. The child process prepares the game board, places the ships, and handles the game
+ * process. The connection is refused if all sessions are in use. The board of the first game is taken
+ * before the child is created, because the child has no queue of prepared boards. The next games on the
+ * connection are played by the child with its own seeds, so the children do not repeat the boards of each
+ * other.
+ * @note The child process is terminated when the connection is closed, and the session is returned to the
+ * pool when the child is collected.
+ * @param client_socket Client socket.
+ * @param server_socket Server socket.
+ * @return void
+ */
+void handle_client(int client_socket, int server_socket) {
+    Session* session = session_pool_acquire(&session_pool);
+    if (session == NULL) {
+        refuse_client(client_socket);
+        return;
+    }
+
+    session_init(session, client_socket);
+    session_take_board(session);
+
+    pid_t pid = fork();
+
+    if (pid < 0) {
+        perror("FORK ERROR");
+        exit(EXIT_FAILURE);
+    } else if (pid == 0) {
+        close(server_socket);
+        if (local_listener >= 0) {
+            close(local_listener);
+        }
+
+        board_queue_detach(&board_queue);
+        game_seed = initial_game_seed() ^ (uint64_t)getpid() << GAME_SEED_PROCESS_SHIFT;
+
+        while (session->state != SESSION_FINISHED) {
+            if (session_process_input(session) == 0) {
+                if (!wait_for_input(session)) {
+                    session_expire(session);
+                    session_write_output(session);
+                    break;
+                }
+
+                if (session->state == SESSION_FINISHED) {
+                    flush_output(session);
+                    break;
+                }
+
+                ssize_t received = session_read_input(session);
+                if (received == 0 || (received < 0 && (session->channel.memory == NULL || errno != EAGAIN))) {
+                    break;
+                }
             }
 
-            if (playing_field[x + dx][y + dy] == 'S') {
-                return false;
+            if (flush_output(session) < 0) {
+                break;
             }
+
+            TRACE_DUMP_IF_REQUESTED();
         }
+
+        TRACE_DUMP_IF_REQUESTED();
+        session_finish(session);
+        shutdown(client_socket, SHUT_RDWR);
+        close(client_socket);
+        logger_release();
+        exit(EXIT_SUCCESS);
     }
 
-    return true;
+    session_pool_set_owner(&session_pool, session, pid);
+    close(client_socket);
+
+    return;
 }
 
 /**
- * @brief Checks the configuration of the server. The configuration is invalid if the field size is greater
- * than the maximum field size or the number of ships is greater than the maximum number of ships.
- * @note The configuration is invalid if the field size is greater than the maximum field size or the number
- * of ships is greater than the maximum number of ships.
- * @param config Server configuration.
- * @return true if the configuration is invalid, false otherwise.
- * @see ServerConfig, bool
+ * @brief Waits until the player sends data, the deadline of the session passes, or the server drains while
+ * the session plays no game: during the handshake or while it waits for the next game. SIGQUIT of the
+ * draining parent is only taken during the wait. A session with a channel sleeps on its eventfd, and its
+ * socket only tells that the player is gone.
+ * @param session Session.
+ * @return true if there is data or the session was finished by the drain, false if the deadline passed.
  */
-bool check_configuration(ServerConfig config) {
-    if (config.field_size > MAX_FIELD_SIZE) {
-        return true;
-    }
+bool wait_for_input(Session* session) {
+    Channel* channel = session->channel.memory != NULL ? &session->channel : NULL;
+    struct pollfd poll_fds[2] = {{.fd = session->socket, .events = POLLIN},
+                                 {.fd = channel != NULL ? channel->wakeup : -1, .events = POLLIN}};
+
+    while (!session_drain(session)) {
+        uint64_t deadline = session_deadline(session);
+        uint64_t now = timer_now();
+        if (deadline != 0 && now >= deadline) {
+            return false;
+        }
 
-    double max_ships = (double)config.field_size / 2;
+        if (channel != NULL && channel_readable(channel)) {
+            return true;
+        }
 
-    if (config.number_of_ships > ceil(max_ships) * ceil(max_ships)) {
-        return true;
+        struct timespec timeout = {.tv_sec = (time_t)((deadline - now) / 1000),
+                                   .tv_nsec = (long)((deadline - now) % 1000 * 1000000)};
+        int ready = ppoll(poll_fds, 2, deadline != 0 ? &timeout : NULL, &drain_wait_mask);
+        if (ready > 0 && channel != NULL) {
+            channel_woken(channel, poll_fds[0].revents != 0 ? true : false);
+        }
+
+        if (ready != 0 && !(ready < 0 && errno == EINTR)) {
+            return true;
+        }
+
+        TRACE_DUMP_IF_REQUESTED();
     }
 
-    return false;
+    return true;
 }
 
 /**
- * @brief Logs the connection of the client. The function logs the time of the connection.
- * @param message Message to log.
+ * @brief Sends all pending bytes of the session of a child. The socket of the child is blocking, so only
+ * the channel can leave bytes behind when its ring is full; the child then sleeps until the player frees
+ * space in the ring.
+ * @param session Session.
+ * @return 0 on success, -1 if the player disconnected or an error occurred.
+ */
+int flush_output(Session* session) {
+    while (true) {
+        if (session_write_output(session) < 0) {
+            return -1;
+        }
+
+        if (!session_has_output(session) || session->channel.memory == NULL) {
+            return 0;
+        }
+
+        if (!channel_wait(&session->channel)) {
+            return -1;
+        }
+    }
+}
+
+/**
+ * @brief Refuses the connection because all sessions are in use. The client receives the "Server busy"
+ * message instead of waiting in the queue.
+ * @param client_socket Client socket.
  * @return void
  */
-void logging(char* message) {
-    time_t now = time(NULL);
-    struct tm* t = localtime(&now);
+void refuse_client(int client_socket) {
+    char buffer[BUF_MESSAGE_SIZE] = "Server busy";
+    send(client_socket, buffer, BUF_MESSAGE_SIZE, MSG_NOSIGNAL);
+
+    metrics_add(METRIC_CONNECTIONS_REFUSED, 1);
+    metrics_add(METRIC_CONNECTIONS_CLOSED, 1);
+
+    LogRecord* record = log_begin(LOG_EVENT_REFUSED);
+    if (record != NULL) {
+        record->arguments[0] = session_pool_used(&session_pool);
+        record->arguments[1] = session_pool.capacity;
+        log_commit();
+    }
 
-    char buf[80];
-    strftime(buf, sizeof(buf), "[%H:%M:%S]", t);
-    printf("%s Client %s connected\n", buf, message);
+    shutdown(client_socket, SHUT_RDWR);
+    close(client_socket);
 
     return;
 }
 
 /**
- * @brief Processes the player move. The function checks if the move is valid and processes the move.
- * The function updates the game board and the number of moves and ships.
- * @param move Player move.
- * @param answer Answer to the player move.
- * @param number_of_moves Number of moves.
- * @param number_of_ships Number of ships.
- * @return void
+ * @brief Checks the configuration of the server. The configuration is invalid if the field size is greater
+ * than the maximum field size or the number of ships is greater than the maximum number of ships.
+ * @note The configuration is invalid if the field size is greater than the maximum field size or the number
+ * of ships is greater than the maximum number of ships. The numbers of ships and moves are also limited,
+ * so they fit into the journal and the parameters of the legacy protocol.
+ * @param config Server configuration.
+ * @return true if the configuration is invalid, false otherwise.
+ * @see ServerConfig, bool
  */
-void process_player_move(char* move, char* answer, int* number_of_moves, int* number_of_ships) {
-    if (isalpha(move[0]) == 0 || isdigit(move[1]) == 0) {
-        strcpy(answer, "Invalid move");
-        return;
+bool check_configuration(ServerConfig config) {
+    if (config.field_size > MAX_FIELD_SIZE || config.number_of_ships > MAX_NUMBER_OF_SHIPS ||
+        config.number_of_moves > MAX_NUMBER_OF_MOVES) {
+        return true;
     }
 
-    if (move[0] < 'A' || move[0] > 'A' + config.field_size) {
-        strcpy(answer, "Invalid move");
-        return;
+    if (config.number_of_workers < 1 || config.max_sessions < 1 || config.prepared_boards < 1) {
+        return true;
     }
 
-    int x = move[0] - 'A';
-    int y = atoi(&move[1]) - 1;
+    if (config.listen_backlog < 1 || config.handshake_timeout < 0 || config.move_timeout < 0 ||
+        config.game_timeout < 0) {
+        return true;
+    }
 
-    if (y >= config.field_size || y < 0 || x >= config.field_size || x < 0) {
-        strcpy(answer, "Invalid move");
-        return;
+    if (config.journal_size < 1 || config.journal_size > MAX_JOURNAL_SIZE) {
+        return true;
     }
 
-    switch (playing_field[x][y]) {
-        case '*':
-            strcpy(answer, "Miss");
-            playing_field[x][y] = '.';
+    if (config.handoff_socket[0] != '\0' && config.number_of_workers > MAX_HANDOFF_SOCKETS) {
+        return true;
+    }
 
-            (*number_of_moves)++;
-            break;
-        case 'S':
-            strcpy(answer, "Hit");
-            playing_field[x][y] = 'X';
+    double max_ships = (double)config.field_size / 2;
 
-            (*number_of_ships)--;
-            break;
-        case 'X':
-            strcpy(answer, "Already hit");
-            break;
-        case '.':
-            strcpy(answer, "Already missed");
-            break;
+    if (config.number_of_ships > ceil(max_ships) * ceil(max_ships)) {
+        return true;
     }
 
-    return;
+    return false;
 }
 
 /**
- * @brief Checks the game status. The game status is checked based on the number of moves and ships.
- * The game is won if the number of moves is less than the maximum number of moves and the number of ships
- * is zero. The game is lost if the number of moves is greater than the maximum number of moves.
- * @param number_of_moves Number of moves.
- * @param number_of_ships Number of ships.
- * @return GameStatus
- * @see GameStatus
+ * @brief Logs the connection of the client. The record has the usage of the session pool, the number of
+ * prepared boards, and how many times the prepared boards ran out. The record is formatted by the logger
+ * thread.
+ * @param message Name of the client.
+ * @return void
  */
-GameStatus check_game_status(int number_of_moves, int number_of_ships) {
-    if (number_of_moves >= config.number_of_moves) {
-        return LOSE;
+void logging(char* message) {
+    LogRecord* record = log_begin(LOG_EVENT_CONNECTED);
+    if (record == NULL) {
+        return;
     }
 
-    if (number_of_ships == 0) {
-        return WIN;
-    }
+    log_text(record, message);
+    record->arguments[0] = session_pool_used(&session_pool);
+    record->arguments[1] = session_pool.capacity;
+    record->arguments[2] = board_queue_depth(&board_queue);
+    record->arguments[3] = board_queue.capacity;
+    record->arguments[4] = (int32_t)board_queue.dry;
+    log_commit();
 
-    return NEXT;
-}
\ No newline at end of file
+    return;
+}
@@ -0,0 +1,61 @@
+/*! @file server.h
+File with the declarations shared by the server modules. The server configuration is read once in
+server.c and is used by the session state machine and by every connection handling mode.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <signal.h>
+#include <sys/un.h>
+
+#include "../engine/engine.h"
+#include "../shared/shared.h"
+
+#define CONFIG_FILE "config.cfg"
+
+#define MAX_CONFIG_KEY_LENGTH 17
+#define CONFIG_PATH_SIZE sizeof(((struct sockaddr_un*)NULL)->sun_path)
+#define BUF_CONFIG_SIZE (MAX_CONFIG_KEY_LENGTH + CONFIG_PATH_SIZE + 2)
+#define DEFAULT_MAX_SESSIONS 1024
+#define DEFAULT_PREPARED_BOARDS 64
+#define DEFAULT_LISTEN_BACKLOG 128
+
+/**
+ * @brief Server configuration.
+ * @see ServerConfig
+ */
+extern ServerConfig config;
+
+/**
+ * @brief Rules of the games, taken from the server configuration.
+ * @see GameRules
+ */
+extern GameRules game_rules;
+
+/**
+ * @brief Set by SIGQUIT: the server stops accepting connections, finishes the current games and exits.
+ */
+extern volatile sig_atomic_t draining;
+
+/**
+ * @brief Signal mask of the waits of the server loops. SIGQUIT is blocked everywhere else, so it is only
+ * taken while a loop waits and the loop never misses it.
+ */
+extern sigset_t drain_wait_mask;
+
+/**
+ * @brief Listener of the local socket, shared by all workers, -1 if the local socket is not configured.
+ */
+extern int local_listener;
+
+int create_server_socket(void);
+int create_local_socket(void);
+void serve(int server_socket);
+void stop_accepting(int server_socket);
+void refuse_client(int client_socket);
+uint64_t next_game_seed(void);
+void logging(char* message);
+
+#endif
@@ -0,0 +1,884 @@
+/*! @file session.c
+File with the implementation of the game session. The session receives the player name, prepares the
+game board, places the ships, and then answers every move of the player until the game is over. The
+session speaks the binary protocol or the legacy ASCII protocol, depending on the first frame of the player.
+A binary player that announced KEEPALIVE_PROTOCOL_VERSION keeps the connection after the game and may ask
+for the next game, which is played on the same board memory without a new handshake.
+Frames are processed only when there is enough space for the answers, so a player cannot make the
+server buffer an unlimited amount of data. A player on the local socket may offer a shared-memory channel
+with the first frame; the session then reads and writes the same frames through the rings of the channel.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "session.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "../shared/descriptors.h"
+#include "../shared/protocol.h"
+#include "board_queue.h"
+#include "journal.h"
+#include "logger.h"
+#include "metrics.h"
+#include "server.h"
+
+/**
+ * @brief Maximum number of bytes produced by one player frame. The largest answer is the frame with the
+ * results of a batch of moves, a legacy move produces at most two messages.
+ */
+#define MAX_OUTPUT_PER_INPUT MAX_RESULT_BATCH_SIZE
+
+/**
+ * @brief Initializes the session of the newly connected player. The game of the session is not changed,
+ * the memory of its board is reused by the next game. No board is taken here: the connections that watch,
+ * resume or probe never start a game, so the board is taken by the hello that starts one.
+ * @param session Session.
+ * @param socket Client socket.
+ * @return void
+ */
+void session_init(Session* session, int socket) {
+    session->socket = socket;
+    session->state = SESSION_HANDSHAKE;
+    session->protocol = PROTOCOL_ASCII;
+    session->keep_alive = false;
+    session->games = 0;
+    session->events = 0;
+    session->prepared = false;
+    session->seed = 0;
+    session->started = metrics_now();
+    session->journal_session = 0;
+    session->moves = 0;
+    session->stored = NULL;
+
+    metrics_add(METRIC_SESSIONS_STARTED, 1);
+    session->name[0] = '\0';
+    session->input_length = 0;
+    session->output_length = 0;
+    broadcast_init(session);
+    session->channel.memory = NULL;
+    timer_init(&session->timer);
+    TRACE_RESET(&session->trace);
+
+    return;
+}
+
+/**
+ * @brief Takes the board of the next game: a prepared board is copied into the board of the session, or a
+ * seed is taken and the ships are placed on it at the start of the game.
+ * @param session Session.
+ * @return void
+ */
+void session_take_board(Session* session) {
+    session->prepared = board_queue_pop(&board_queue, session->game.board, &session->seed);
+    if (!session->prepared) {
+        session->seed = next_game_seed();
+    }
+
+    return;
+}
+
+/**
+ * @brief Appends the message to the output buffer. The message is padded with zeros to the size of
+ * the frame.
+ * @param session Session.
+ * @param message Message to send.
+ * @return void
+ */
+static void session_send_message(Session* session, const char* message) {
+    char* frame = session->output + session->output_length;
+
+    memset(frame, 0, BUF_MESSAGE_SIZE);
+    snprintf(frame, BUF_MESSAGE_SIZE, "%s", message);
+    session->output_length += BUF_MESSAGE_SIZE;
+
+    return;
+}
+
+/**
+ * @brief Appends the binary frame to the output buffer.
+ * @param session Session.
+ * @param frame Encoded frame.
+ * @param size Size of the frame.
+ * @return void
+ */
+static void session_send_frame(Session* session, const char* frame, size_t size) {
+    memcpy(session->output + session->output_length, frame, size);
+    session->output_length += size;
+
+    return;
+}
+
+/**
+ * @brief Starts the game. Places the ships, unless the board was prepared, and sends the game parameters
+ * in the protocol of the player. A resumable game is copied into a record of the session store and played
+ * on the board of the record, and its parameters carry the resume token.
+ * @param session Session.
+ * @param resumable true if the player can resume the game with a token.
+ * @return void
+ */
+static void session_new_game(Session* session, bool resumable) {
+    if (session->prepared) {
+        start_prepared_game(&session->game);
+    } else {
+        start_game(&session->game, session->seed);
+    }
+
+    const GameRules* rules = session->game.rules;
+    uint64_t token = 0;
+
+    if (resumable) {
+        session->stored = session_store_claim(&session->game, session->name, session->seed);
+    }
+
+    if (session->stored != NULL) {
+        session->game.board = session_store_board(session->stored);
+        token = session->stored->token;
+    }
+
+    if (session->protocol == PROTOCOL_BINARY) {
+        char frame[MAX_FRAME_SIZE];
+        size_t size = encode_params(frame, rules->field_size, rules->number_of_ships, rules->number_of_moves,
+                                    token);
+        session_send_frame(session, frame, size);
+    } else {
+        char buffer[BUF_MESSAGE_SIZE];
+        snprintf(buffer, BUF_MESSAGE_SIZE, "f=%d,n=%d", rules->field_size, rules->number_of_ships);
+        session_send_message(session, buffer);
+    }
+
+    session->state = SESSION_PLAYING;
+    session->games++;
+    session->moves = 0;
+    session->game_started = timer_now();
+    session->last_move = session->game_started;
+    session->journal_session = journal_start(&session->game, session->name, session->seed, session->protocol,
+                                             0);
+    broadcast_game_started(session);
+
+    return;
+}
+
+/**
+ * @brief Starts the first game of the connection with the name of the player. The board is taken here,
+ * unless the accepting process of the fork mode has taken it before the child was created.
+ * @param session Session.
+ * @param name Name of the player.
+ * @param resumable true if the player can resume the game with a token.
+ * @return void
+ */
+static void session_start_game(Session* session, char* name, bool resumable) {
+    strncpy(session->name, name, BUF_MESSAGE_SIZE - 1);
+    session->name[BUF_MESSAGE_SIZE - 1] = '\0';
+    logging(session->name);
+
+    if (!session->prepared) {
+        session_take_board(session);
+    }
+
+    session_new_game(session, resumable);
+
+    return;
+}
+
+/**
+ * @brief Starts the next game on the connection of the finished game. The board of the slot is reused: a
+ * prepared board is copied into it, or the ships are placed on it with a new seed. The server that drains
+ * starts no new games, it ends the connection instead, and the player continues on the new server.
+ * @param session Session.
+ * @return void
+ */
+static void session_rematch(Session* session) {
+    if (draining) {
+        session->state = SESSION_FINISHED;
+        return;
+    }
+
+    session_take_board(session);
+    metrics_add(METRIC_REMATCHES, 1);
+
+    LogRecord* record = log_begin(LOG_EVENT_REMATCH);
+    if (record != NULL) {
+        log_text(record, session->name);
+        record->arguments[0] = (int32_t)session->games + 1;
+        log_commit();
+    }
+
+    session_new_game(session, true);
+
+    return;
+}
+
+/**
+ * @brief Ends the game of the session. A player with keep-alive keeps the connection for the next game,
+ * unless the server drains; the connection of any other player is closed.
+ * @param session Session.
+ * @return void
+ */
+static void session_end_game(Session* session) {
+    session->state = session->keep_alive && !draining ? SESSION_OVER : SESSION_FINISHED;
+
+    return;
+}
+
+/**
+ * @brief Resumes the game of the token and sends the game parameters with the token, followed by the state
+ * of the game. The game continues on the board of its record with its counters and its time. When the game
+ * cannot be resumed, the player receives "Unknown game" and the session is finished. The answers fit into
+ * the output buffer, because it is empty during the handshake.
+ * @param session Session.
+ * @param token Resume token.
+ * @return void
+ */
+static void session_resume_game(Session* session, uint64_t token) {
+    StoredSession* stored = session_store_resume(token);
+    if (stored == NULL) {
+        session_send_message(session, "Unknown game");
+        session->state = SESSION_FINISHED;
+        return;
+    }
+
+    session->stored = stored;
+    session->game.board = session_store_board(stored);
+    session->game.number_of_ships = stored->number_of_ships;
+    session->game.number_of_moves = stored->number_of_moves;
+    session->seed = stored->seed;
+    session->moves = stored->moves;
+    snprintf(session->name, BUF_MESSAGE_SIZE, "%s", stored->name);
+    metrics_add(METRIC_SESSIONS_RESUMED, 1);
+
+    LogRecord* record = log_begin(LOG_EVENT_RESUMED);
+    if (record != NULL) {
+        log_text(record, session->name);
+        record->arguments[0] = session->game.number_of_ships;
+        record->arguments[1] = (int32_t)session->moves;
+        log_commit();
+    }
+
+    const GameRules* rules = session->game.rules;
+    char frame[MAX_FRAME_SIZE];
+
+    size_t size = encode_params(frame, rules->field_size, rules->number_of_ships, rules->number_of_moves,
+                                token);
+    session_send_frame(session, frame, size);
+    size = encode_state(frame, session->game.number_of_ships, session->game.number_of_moves,
+                        session->game.board);
+    session_send_frame(session, frame, size);
+
+    uint64_t now = timer_now();
+    uint64_t elapsed = session_store_elapsed(stored);
+
+    session->state = SESSION_PLAYING;
+    session->games++;
+    session->game_started = elapsed < now ? now - elapsed : 0;
+    session->last_move = now;
+    session->journal_session = journal_start(&session->game, session->name, session->seed, session->protocol,
+                                             session->moves);
+    broadcast_game_started(session);
+
+    return;
+}
+
+/**
+ * @brief Leaves the record of the game in the session store and returns the game to the board of the slot.
+ * The record is freed when the game is over, and kept for the player to resume the game otherwise.
+ * @param session Session.
+ * @param over true if the game is over.
+ * @return void
+ */
+static void session_leave_store(Session* session, bool over) {
+    if (session->stored == NULL) {
+        return;
+    }
+
+    if (over) {
+        session_store_release(session->stored);
+    } else {
+        session_store_detach(session->stored);
+    }
+
+    session->stored = NULL;
+    session->game.board = session->slot_board;
+
+    return;
+}
+
+/**
+ * @brief Writes the end of the session to the journal once.
+ * @param session Session.
+ * @param status Final status of the game.
+ * @param reason Reason the session was finished.
+ * @return void
+ */
+static void session_journal_end(Session* session, GameStatus status, JournalEndReason reason) {
+    journal_end(session->journal_session, &session->game, status, reason, session->moves,
+                (uint32_t)(timer_now() - session->game_started));
+    session->journal_session = 0;
+
+    return;
+}
+
+/**
+ * @brief Makes the session a spectator of the game of the player. The spectator receives the parameters and
+ * the state of the game, or "Unknown game" if this process plays no game of the player.
+ * @param session Session.
+ * @param name Name of the player.
+ * @return void
+ */
+static void session_watch_game(Session* session, const char* name) {
+    if (!broadcast_watch(session, name)) {
+        session_send_message(session, "Unknown game");
+        session->state = SESSION_FINISHED;
+        return;
+    }
+
+    session->state = SESSION_WATCHING;
+
+    return;
+}
+
+/**
+ * @brief Plays the move in the game of the session, updates the metrics of the moves and the games, and
+ * logs and journals the move and the end of the game.
+ * @param session Session.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param status Status of the game after the move.
+ * @return Result of the move.
+ */
+static MoveResult session_play_move(Session* session, int x, int y, GameStatus* status) {
+    uint64_t started = metrics_now();
+
+    TRACE_BEGIN(move_start);
+    MoveResult result = process_player_move(&session->game, x, y);
+    TRACE_END(&session->trace, TRACE_MOVE, move_start);
+
+    TRACE_BEGIN(status_start);
+    *status = check_game_status(&session->game);
+    TRACE_END(&session->trace, TRACE_STATUS, status_start);
+
+    metrics_observe_move_time(metrics_now() - started);
+    metrics_count_move(result);
+    metrics_count_game(*status);
+
+    if (session->broadcast.spectators != NULL) {
+        broadcast_move(session, x, y, result, *status);
+    }
+
+    session->moves++;
+    journal_move(session->journal_session, x, y, result, *status);
+
+    if (session->stored != NULL) {
+        session_store_update(session->stored, &session->game, session->moves);
+    }
+
+    if (*status != NEXT) {
+        session_journal_end(session, *status, JOURNAL_END_GAME_OVER);
+        session_leave_store(session, true);
+    }
+
+    LogRecord* record = log_begin(LOG_EVENT_MOVE);
+    if (record != NULL) {
+        log_text(record, session->name);
+        record->arguments[0] = x;
+        record->arguments[1] = y;
+        record->arguments[2] = result;
+        record->arguments[3] = session->game.number_of_ships;
+        record->arguments[4] = session->game.number_of_moves;
+        log_commit();
+    }
+
+    if (*status != NEXT && (record = log_begin(LOG_EVENT_GAME_OVER)) != NULL) {
+        log_text(record, session->name);
+        record->arguments[0] = *status;
+        record->arguments[1] = session->game.number_of_moves;
+        log_commit();
+    }
+
+    return result;
+}
+
+/**
+ * @brief Processes the move of the player and sends the answer. When the game is over, the result of
+ * the game is sent as well and the session is finished.
+ * @param session Session.
+ * @param valid true if the move has a valid format.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return void
+ */
+static void session_handle_move(Session* session, bool valid, int x, int y) {
+    GameStatus status = NEXT;
+    MoveResult result = MOVE_INVALID;
+
+    session->last_move = timer_now();
+
+    if (valid) {
+        result = session_play_move(session, x, y, &status);
+    } else {
+        metrics_count_move(MOVE_INVALID);
+    }
+
+    if (session->protocol == PROTOCOL_BINARY) {
+        char frame[MAX_FRAME_SIZE];
+        session_send_frame(session, frame, encode_result(frame, result, status));
+    } else {
+        session_send_message(session, move_result_message(result));
+
+        if (status != NEXT) {
+            session_send_message(session, status == WIN ? "You win" : "You lose");
+        }
+    }
+
+    if (status != NEXT) {
+        session_end_game(session);
+    }
+
+    return;
+}
+
+/**
+ * @brief Processes the batch of moves in order and sends all results in one frame. The moves after the end
+ * of the game are not processed.
+ * @param session Session.
+ * @param moves Moves of the player.
+ * @param count Number of moves.
+ * @return void
+ */
+static void session_handle_batch(Session* session, const Move* moves, int count) {
+    MoveResult results[MAX_BATCH_MOVES];
+    GameStatus status = NEXT;
+    int processed = 0;
+
+    session->last_move = timer_now();
+
+    while (processed < count && status == NEXT) {
+        results[processed] = session_play_move(session, moves[processed].x, moves[processed].y, &status);
+        processed++;
+    }
+
+    char frame[MAX_RESULT_BATCH_SIZE];
+    session_send_frame(session, frame, encode_result_batch(frame, results, processed, status));
+
+    if (status != NEXT) {
+        session_end_game(session);
+    }
+
+    return;
+}
+
+/**
+ * @brief Processes the frame of the legacy protocol at the beginning of the data.
+ * @param session Session.
+ * @param data Unprocessed input.
+ * @param length Number of bytes of the unprocessed input.
+ * @return Number of processed bytes, 0 if the frame is not complete yet.
+ */
+static size_t session_process_message(Session* session, const char* data, size_t length) {
+    if (length < BUF_MESSAGE_SIZE) {
+        return 0;
+    }
+
+    char message[BUF_MESSAGE_SIZE + 1];
+    memcpy(message, data, BUF_MESSAGE_SIZE);
+    message[BUF_MESSAGE_SIZE] = '\0';
+
+    if (session->state == SESSION_HANDSHAKE) {
+        session_start_game(session, message, false);
+    } else {
+        int x = 0, y = 0;
+        bool valid = parse_move(message, &x, &y);
+        session_handle_move(session, valid, x, y);
+    }
+
+    return BUF_MESSAGE_SIZE;
+}
+
+/**
+ * @brief Processes the binary frame at the beginning of the data. A malformed frame or a frame that is
+ * not expected in the current state finishes the session. The moves that arrive after the end of the game
+ * were sent before the player got the result, so they are dropped.
+ * @param session Session.
+ * @param data Unprocessed input.
+ * @param length Number of bytes of the unprocessed input.
+ * @return Number of processed bytes, 0 if the frame is not complete yet.
+ */
+static size_t session_process_frame(Session* session, const char* data, size_t length) {
+    Frame frame;
+    int size = decode_frame(data, length, &frame);
+    if (size == 0) {
+        return 0;
+    }
+
+    int version, x, y, count;
+    uint64_t token;
+    char name[HELLO_NAME_SIZE];
+    Move moves[MAX_BATCH_MOVES];
+
+    if (size > 0 && session->state == SESSION_HANDSHAKE && decode_hello(&frame, &version, name)) {
+        session->keep_alive = version >= KEEPALIVE_PROTOCOL_VERSION ? true : false;
+        session_start_game(session, name, version >= TOKEN_PROTOCOL_VERSION ? true : false);
+    } else if (size > 0 && session->state == SESSION_HANDSHAKE && decode_resume(&frame, &version, &token)) {
+        session->keep_alive = version >= KEEPALIVE_PROTOCOL_VERSION ? true : false;
+        session_resume_game(session, token);
+    } else if (size > 0 && session->state == SESSION_HANDSHAKE && decode_watch(&frame, &version, name)) {
+        session_watch_game(session, name);
+    } else if (size > 0 && session->state == SESSION_HANDSHAKE && decode_empty(&frame, OP_CHANNEL)) {
+        char answer[FRAME_HEADER_SIZE + TRANSPORT_SIZE];
+        session_send_frame(session, answer, encode_transport(answer, session->channel.memory != NULL));
+    } else if (size > 0 && session->state == SESSION_PLAYING && decode_move(&frame, &x, &y)) {
+        session_handle_move(session, true, x, y);
+    } else if (size > 0 && session->state == SESSION_PLAYING &&
+               (count = decode_move_batch(&frame, moves)) > 0) {
+        session_handle_batch(session, moves, count);
+    } else if (size > 0 && session->state == SESSION_OVER && decode_empty(&frame, OP_REMATCH)) {
+        session_rematch(session);
+    } else if (size > 0 && session->state == SESSION_OVER && decode_empty(&frame, OP_QUIT)) {
+        session->state = SESSION_FINISHED;
+    } else if (size < 0 || session->state != SESSION_OVER ||
+               (!decode_move(&frame, &x, &y) && decode_move_batch(&frame, moves) <= 0)) {
+        session->state = SESSION_FINISHED;
+        return length;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Finishes the session when its connection is closed. Updates the metrics of the sessions and the
+ * connections, journals the end of a game that was not over, and keeps such a game in the session store.
+ * @param session Session.
+ * @return void
+ */
+void session_finish(Session* session) {
+    if (session->journal_session != 0) {
+        session_journal_end(session, NEXT, JOURNAL_END_CLOSED);
+    }
+
+    session_leave_store(session, false);
+    broadcast_leave(session);
+    channel_close(&session->channel);
+
+    metrics_add(METRIC_SESSIONS_FINISHED, 1);
+    metrics_add(METRIC_CONNECTIONS_CLOSED, 1);
+    metrics_observe_session_duration(metrics_now() - session->started);
+
+    return;
+}
+
+/**
+ * @brief Ends the session that plays no game when the server drains, so an idle connection does not keep
+ * the draining server running and no new game starts on it. A session in the handshake receives "Server
+ * busy", like a refused connection, and the player connects again to the new server. A game in progress is
+ * finished first.
+ * @param session Session.
+ * @return true if the session is finished, false otherwise.
+ */
+bool session_drain(Session* session) {
+    if (draining && session->state == SESSION_HANDSHAKE) {
+        if (SESSION_BUFFER_SIZE - session->output_length >= BUF_MESSAGE_SIZE) {
+            session_send_message(session, "Server busy");
+        }
+
+        metrics_add(METRIC_CONNECTIONS_REFUSED, 1);
+        session->state = SESSION_FINISHED;
+    } else if (draining && session->state == SESSION_OVER) {
+        session->state = SESSION_FINISHED;
+    }
+
+    return session->state == SESSION_FINISHED ? true : false;
+}
+
+/**
+ * @brief Returns the time the player must send the next frame by. During the handshake it is the end of the
+ * handshake timeout, during the game the end of the move timeout or of the game timeout, whichever is
+ * earlier. After the game the player has the handshake timeout from the last move to start the next game.
+ * @param session Session.
+ * @return Time in milliseconds of the monotonic clock, 0 if the session does not wait for the player.
+ */
+uint64_t session_deadline(const Session* session) {
+    uint64_t deadline = 0;
+
+    if (session->state == SESSION_HANDSHAKE && config.handshake_timeout > 0) {
+        deadline = session->started / 1000000 + (uint64_t)config.handshake_timeout * 1000;
+    } else if (session->state == SESSION_OVER && config.handshake_timeout > 0) {
+        deadline = session->last_move + (uint64_t)config.handshake_timeout * 1000;
+    } else if (session->state == SESSION_PLAYING) {
+        if (config.move_timeout > 0) {
+            deadline = session->last_move + (uint64_t)config.move_timeout * 1000;
+        }
+
+        if (config.game_timeout > 0) {
+            uint64_t game_end = session->game_started + (uint64_t)config.game_timeout * 1000;
+            deadline = deadline == 0 || game_end < deadline ? game_end : deadline;
+        }
+    }
+
+    return deadline;
+}
+
+/**
+ * @brief Finishes the session because the player was idle for too long. During the handshake the player
+ * receives "Timeout", during the game the game is lost, and after the game the connection is closed without
+ * an answer. The answer is appended to the output buffer if there is space for it.
+ * @param session Session.
+ * @return void
+ */
+void session_expire(Session* session) {
+    metrics_add(METRIC_TIMEOUTS, 1);
+
+    LogRecord* record = log_begin(LOG_EVENT_TIMEOUT);
+    if (record != NULL) {
+        log_text(record, session->name);
+        record->arguments[0] = session->state == SESSION_PLAYING ? 0 : session->state == SESSION_OVER ? 2 : 1;
+        log_commit();
+    }
+
+    if (session->state == SESSION_OVER) {
+        session->state = SESSION_FINISHED;
+        return;
+    }
+
+    if (session->state == SESSION_PLAYING) {
+        metrics_count_game(LOSE);
+        session_journal_end(session, LOSE, JOURNAL_END_TIMEOUT);
+        session_leave_store(session, true);
+    }
+
+    if (SESSION_BUFFER_SIZE - session->output_length < MAX_OUTPUT_PER_INPUT) {
+        session->state = SESSION_FINISHED;
+        return;
+    }
+
+    if (session->state == SESSION_PLAYING && session->protocol == PROTOCOL_BINARY) {
+        char frame[MAX_FRAME_SIZE];
+        session_send_frame(session, frame, encode_result(frame, MOVE_INVALID, LOSE));
+    } else {
+        session_send_message(session, session->state == SESSION_PLAYING ? "You lose" : "Timeout");
+    }
+
+    session->state = SESSION_FINISHED;
+
+    return;
+}
+
+/**
+ * @brief Processes the complete frames of the input buffer. The protocol of the session is chosen by the
+ * first byte sent by the player. The processing stops when the game is over or when there is not enough
+ * space in the output buffer for the answers. The session that plays no game is ended first if the server
+ * drains, so a late first frame does not start a game on the draining server.
+ * @param session Session.
+ * @return Number of processed frames.
+ */
+int session_process_input(Session* session) {
+    size_t offset = 0;
+    int processed = 0;
+    TRACE_BEGIN(process_start);
+
+    if (session_drain(session)) {
+        return 0;
+    }
+
+    if (session->state == SESSION_HANDSHAKE && session->input_length > 0) {
+        uint8_t opcode = (uint8_t)session->input[0];
+        bool binary = opcode == OP_HELLO || opcode == OP_RESUME || opcode == OP_WATCH || opcode == OP_CHANNEL
+                          ? true
+                          : false;
+        session->protocol = binary ? PROTOCOL_BINARY : PROTOCOL_ASCII;
+    }
+
+    while (session->state != SESSION_FINISHED &&
+           SESSION_BUFFER_SIZE - session->output_length >= MAX_OUTPUT_PER_INPUT) {
+        const char* data = session->input + offset;
+        size_t length = session->input_length - offset;
+
+        size_t size = session->protocol == PROTOCOL_BINARY ? session_process_frame(session, data, length)
+                                                           : session_process_message(session, data, length);
+        if (size == 0) {
+            break;
+        }
+
+        offset += size;
+        processed++;
+    }
+
+    session->input_length -= offset;
+    memmove(session->input, session->input + offset, session->input_length);
+
+    if (processed > 0) {
+        TRACE_END(&session->trace, TRACE_PROCESS, process_start);
+    }
+
+    return processed;
+}
+
+/**
+ * @brief Receives the first bytes of the player, which may be the channel frame with the descriptors of a
+ * shared-memory channel. The channel is attached if the frame carries all its descriptors; any other
+ * passed descriptors are closed, and the frame is answered by session_process_frame.
+ * @param session Session.
+ * @param buffer Free space of the input buffer.
+ * @param space Size of the free space.
+ * @return Number of received bytes, 0 if the player disconnected, -1 on error.
+ */
+static ssize_t session_receive_first(Session* session, char* buffer, size_t space) {
+    int descriptors[CHANNEL_DESCRIPTORS];
+    int count;
+
+    ssize_t received = receive_descriptors(session->socket, buffer, space, descriptors, CHANNEL_DESCRIPTORS,
+                                           &count, 0);
+    if (count == 0) {
+        return received;
+    }
+
+    if (count < CHANNEL_DESCRIPTORS || received <= 0 || (uint8_t)buffer[0] != OP_CHANNEL) {
+        for (int i = 0; i < count; ++i) {
+            close(descriptors[i]);
+        }
+
+        return received;
+    }
+
+    if (channel_attach(&session->channel, session->socket, descriptors)) {
+        metrics_add(METRIC_CHANNELS, 1);
+    }
+
+    return received;
+}
+
+/**
+ * @brief Receives the bytes from the client socket, or from the channel of a local player, into the free
+ * space of the input buffer.
+ * @param session Session.
+ * @return Number of received bytes, 0 if the player disconnected, -1 on error.
+ * @note errno is EAGAIN if the socket is non-blocking or the session has a channel and there is nothing to
+ * read.
+ */
+ssize_t session_read_input(Session* session) {
+    size_t space = SESSION_BUFFER_SIZE - session->input_length;
+    if (space == 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    char* buffer = session->input + session->input_length;
+    ssize_t received;
+    TRACE_BEGIN(recv_start);
+
+    if (session->channel.memory != NULL) {
+        received = channel_read(&session->channel, buffer, space);
+    } else if (session->state == SESSION_HANDSHAKE && session->input_length == 0) {
+        received = session_receive_first(session, buffer, space);
+    } else {
+        received = recv(session->socket, buffer, space, 0);
+    }
+    TRACE_END(&session->trace, TRACE_RECV, recv_start);
+    if (received > 0) {
+        session->input_length += received;
+    }
+
+    return received;
+}
+
+/**
+ * @brief Copies the received bytes into the free space of the input buffer. Used when the bytes are
+ * received by the caller instead of session_read_input.
+ * @param session Session.
+ * @param data Received bytes.
+ * @param size Number of received bytes.
+ * @return Number of copied bytes, less than size if the input buffer is full.
+ */
+size_t session_append_input(Session* session, const char* data, size_t size) {
+    size_t space = SESSION_BUFFER_SIZE - session->input_length;
+    size_t copied = size < space ? size : space;
+
+    memcpy(session->input + session->input_length, data, copied);
+    session->input_length += copied;
+
+    return copied;
+}
+
+/**
+ * @brief Removes the sent bytes from the beginning of the output buffer, and then from the queued events of
+ * a spectator.
+ * @param session Session.
+ * @param size Number of sent bytes.
+ * @return void
+ */
+void session_consume_output(Session* session, size_t size) {
+    size_t consumed = size < session->output_length ? size : session->output_length;
+
+    session->output_length -= consumed;
+    memmove(session->output, session->output + consumed, session->output_length);
+    broadcast_consume(session, size - consumed);
+
+    return;
+}
+
+/**
+ * @brief Sends the pending bytes once, through the channel of a local player or through the socket.
+ * @param session Session.
+ * @return Number of sent bytes, -1 on error.
+ */
+static ssize_t session_send_pending(Session* session) {
+    struct msghdr* message = broadcast_has_output(session) ? broadcast_message(session) : NULL;
+
+    if (session->channel.memory != NULL) {
+        struct iovec vector = {.iov_base = session->output, .iov_len = session->output_length};
+        return message != NULL ? channel_write(&session->channel, message->msg_iov, (int)message->msg_iovlen)
+                               : channel_write(&session->channel, &vector, 1);
+    }
+
+    return message != NULL ? sendmsg(session->socket, message, MSG_NOSIGNAL)
+                           : send(session->socket, session->output, session->output_length, MSG_NOSIGNAL);
+}
+
+/**
+ * @brief Sends the pending bytes of the output buffer. The output buffer of a spectator and its queued events
+ * are gathered into one sendmsg. The function stops when everything is sent or when the socket would block,
+ * or the ring of the channel is full.
+ * @param session Session.
+ * @return 0 on success, -1 if the player disconnected or an error occurred.
+ */
+int session_write_output(Session* session) {
+    size_t offset = 0;
+    TRACE_BEGIN(send_start);
+
+    while (session_has_output(session)) {
+        ssize_t sent = session_send_pending(session);
+        if (sent < 0) {
+            broadcast_consume(session, 0);
+
+            if (errno == EINTR) {
+                continue;
+            }
+
+            if (errno == EAGAIN || errno == EWOULDBLOCK) {
+                break;
+            }
+
+            return -1;
+        }
+
+        session_consume_output(session, (size_t)sent);
+        offset += sent;
+    }
+
+    if (offset > 0) {
+        TRACE_END(&session->trace, TRACE_SEND, send_start);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Checks if the session has bytes that were not sent yet.
+ * @param session Session.
+ * @return true if there are pending bytes, false otherwise.
+ */
+bool session_has_output(Session* session) {
+    return session->output_length > 0 || broadcast_has_output(session) ? true : false;
+}
@@ -0,0 +1,113 @@
+/*! @file session.h
+File with the declaration of the game session. A session is a small state machine that consumes the
+frames received from a player and produces the answers for the player. The session does not block and
+does not know how the bytes are delivered, so it is shared by all connection handling modes.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef SESSION_H
+#define SESSION_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "../engine/engine.h"
+#include "../shared/channel.h"
+#include "../shared/shared.h"
+#include "broadcast.h"
+#include "session_store.h"
+#include "timer_wheel.h"
+#include "trace.h"
+
+#define SESSION_BUFFER_SIZE 512
+
+/**
+ * @brief Enumeration for the session state.
+ * The session starts with the handshake, then the player makes moves, then the result is sent. A player of
+ * KEEPALIVE_PROTOCOL_VERSION can then start a new game on the same connection. A spectator watches the game
+ * of a player after the handshake until the player leaves.
+ */
+typedef enum {
+    SESSION_HANDSHAKE, /**< Waiting for the player name */
+    SESSION_PLAYING,   /**< Waiting for the next move */
+    SESSION_OVER,      /**< The game is over, waiting for a new game or the end of the connection */
+    SESSION_WATCHING,  /**< The spectator receives the moves of the watched game */
+    SESSION_FINISHED   /**< The result was produced, the session must be closed */
+} SessionState;
+
+/**
+ * @struct Session
+ * @brief Structure for storing the state of one game.
+ *
+ * @param socket Client socket.
+ * @param state Current state of the session.
+ * @param protocol Wire protocol of the player.
+ * @param keep_alive true if the player can start a new game on the connection after the end of the game.
+ * @param games Number of games started on the connection.
+ * @param events Events the session is registered for in the event loop.
+ * @param game Game of the session, its board is the board of the slot or of the record in the session store.
+ * @param seed Seed of the board of the game.
+ * @param prepared true if the board was taken from the queue of prepared boards.
+ * @param started Time the session was started in nanoseconds.
+ * @param game_started Time the game was started in milliseconds.
+ * @param last_move Time of the last move in milliseconds.
+ * @param timer Timer of the idle timeouts, used by the event loops.
+ * @param journal_session Number of the session in the journal, 0 if the session is not journaled.
+ * @param moves Number of moves played in the game.
+ * @param stored Record of the game in the session store, NULL if the game cannot be resumed.
+ * @param slot_board Game board stored in the slot of the session pool.
+ * @param name Name of the player.
+ * @param input Received bytes that were not processed yet.
+ * @param input_length Number of bytes in the input buffer.
+ * @param output Bytes that must be sent to the player.
+ * @param output_length Number of bytes in the output buffer.
+ * @param broadcast Spectators of the player, or the queue of the events of the spectator.
+ * @param channel Shared-memory channel of a local player, its memory is NULL if the frames go through the
+ * socket.
+ * @param trace Last spans of the session, only with the TRACE flag.
+ */
+typedef struct Session {
+    int socket;
+    SessionState state;
+    Protocol protocol;
+    bool keep_alive;
+    uint32_t games;
+    uint32_t events;
+    GameContext game;
+    uint64_t seed;
+    bool prepared;
+    uint64_t started;
+    uint64_t game_started;
+    uint64_t last_move;
+    TimerNode timer;
+    uint32_t journal_session;
+    uint32_t moves;
+    StoredSession* stored;
+    GameBoard* slot_board;
+    char name[BUF_MESSAGE_SIZE];
+    char input[SESSION_BUFFER_SIZE];
+    size_t input_length;
+    char output[SESSION_BUFFER_SIZE];
+    size_t output_length;
+    Broadcast broadcast;
+    Channel channel;
+#ifdef TRACE
+    TraceRing trace;
+#endif
+} Session;
+
+void session_init(Session* session, int socket);
+void session_take_board(Session* session);
+void session_finish(Session* session);
+bool session_drain(Session* session);
+uint64_t session_deadline(const Session* session);
+void session_expire(Session* session);
+int session_process_input(Session* session);
+ssize_t session_read_input(Session* session);
+int session_write_output(Session* session);
+size_t session_append_input(Session* session, const char* data, size_t size);
+void session_consume_output(Session* session, size_t size);
+bool session_has_output(Session* session);
+
+#endif
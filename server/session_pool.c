@@ -0,0 +1,175 @@
+/*! @file session_pool.c
+File with the implementation of the session pool. The slots are allocated in one block when the server
+starts. The size of a slot depends on the field size, because the game board of the session is stored in
+the slot right after the session.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "session_pool.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @brief Alignment of the slots, so two sessions never share a cache line.
+ */
+#define SLOT_ALIGNMENT 64
+
+SessionPool session_pool;
+
+/**
+ * @brief Rounds the size up to the alignment of the slots.
+ * @param size Size in bytes.
+ * @return Aligned size in bytes.
+ */
+static size_t align_size(size_t size) {
+    return (size + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+/**
+ * @brief Returns the session of the slot.
+ * @param pool Session pool.
+ * @param index Index of the slot.
+ * @return Session of the slot.
+ */
+static Session* slot_session(SessionPool* pool, int index) {
+    return (Session*)(pool->slots + (size_t)index * pool->slot_size);
+}
+
+/**
+ * @brief Returns the session of the slot. The session may be free.
+ * @param pool Session pool.
+ * @param index Index of the slot.
+ * @return Session of the slot.
+ */
+Session* session_pool_session(SessionPool* pool, int index) {
+    return slot_session(pool, index);
+}
+
+/**
+ * @brief Returns the index of the slot of the session.
+ * @param pool Session pool.
+ * @param session Session from the pool.
+ * @return Index of the slot.
+ */
+static int slot_index(SessionPool* pool, Session* session) {
+    return (int)(((char*)session - pool->slots) / pool->slot_size);
+}
+
+/**
+ * @brief Initializes the session pool. Allocates all slots and initializes the game context and the game
+ * board of every slot.
+ * @param pool Session pool.
+ * @param capacity Maximum number of sessions.
+ * @param rules Rules of the games.
+ * @return void
+ */
+void session_pool_init(SessionPool* pool, int capacity, const GameRules* rules) {
+    int field_size = rules->field_size, max_marked = max_marked_cells(rules);
+    size_t session_size = align_size(sizeof(Session));
+
+    pool->slot_size = session_size + align_size(game_board_size(field_size, max_marked));
+    pool->capacity = capacity;
+    pool->free_count = capacity;
+    pool->slots = (char*)aligned_alloc(SLOT_ALIGNMENT, pool->slot_size * capacity);
+    pool->free_slots = (int*)malloc(capacity * sizeof(int));
+    pool->owners = (pid_t*)calloc(capacity, sizeof(pid_t));
+
+    if (pool->slots == NULL || pool->free_slots == NULL || pool->owners == NULL) {
+        printf("ERROR: not enough memory for the session pool\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < capacity; ++i) {
+        Session* session = slot_session(pool, i);
+        session->slot_board = init_game_board((char*)session + session_size, field_size, max_marked);
+        init_game_context(&session->game, rules, session->slot_board);
+
+        pool->free_slots[i] = capacity - 1 - i;
+    }
+
+    return;
+}
+
+/**
+ * @brief Takes a free session from the pool.
+ * @param pool Session pool.
+ * @return Session, or NULL if all sessions are in use.
+ */
+Session* session_pool_acquire(SessionPool* pool) {
+    if (pool->free_count == 0) {
+        return NULL;
+    }
+
+    return slot_session(pool, pool->free_slots[--pool->free_count]);
+}
+
+/**
+ * @brief Returns the session to the pool.
+ * @param pool Session pool.
+ * @param session Session from the pool.
+ * @return void
+ */
+void session_pool_release(SessionPool* pool, Session* session) {
+    int index = slot_index(pool, session);
+
+    pool->owners[index] = 0;
+    pool->free_slots[pool->free_count++] = index;
+
+    return;
+}
+
+/**
+ * @brief Remembers the process that serves the session. In the fork mode the session is served by the
+ * child process, and the slot is released when the child exits.
+ * @param pool Session pool.
+ * @param session Session from the pool.
+ * @param owner Process ID of the child.
+ * @return void
+ */
+void session_pool_set_owner(SessionPool* pool, Session* session, pid_t owner) {
+    pool->owners[slot_index(pool, session)] = owner;
+
+    return;
+}
+
+/**
+ * @brief Returns the session served by the process to the pool.
+ * @param pool Session pool.
+ * @param owner Process ID of the child that exited.
+ * @return void
+ */
+void session_pool_release_owner(SessionPool* pool, pid_t owner) {
+    for (int i = 0; i < pool->capacity; ++i) {
+        if (pool->owners[i] == owner) {
+            session_pool_release(pool, slot_session(pool, i));
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Sends the signal to the processes that serve the sessions.
+ * @param pool Session pool.
+ * @param signal Signal number.
+ * @return void
+ */
+void session_pool_signal_owners(SessionPool* pool, int signal) {
+    for (int i = 0; i < pool->capacity; ++i) {
+        if (pool->owners[i] > 0) {
+            kill(pool->owners[i], signal);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Returns the number of sessions in use.
+ * @param pool Session pool.
+ * @return Number of sessions in use.
+ */
+int session_pool_used(SessionPool* pool) {
+    return pool->capacity - pool->free_count;
+}
@@ -0,0 +1,50 @@
+/*! @file session_pool.h
+File with the declaration of the session pool. The pool is a slab of sessions allocated once at the start
+of the server, so starting or finishing a game does not allocate memory.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include <sys/types.h>
+
+#include "session.h"
+
+/**
+ * @struct SessionPool
+ * @brief Structure for storing the slab of sessions.
+ * Every slot of the slab contains a session followed by the memory of its game board. The indices of the
+ * free slots are kept in a stack.
+ *
+ * @param slots Memory of the slots.
+ * @param slot_size Size of one slot in bytes.
+ * @param capacity Number of slots.
+ * @param free_slots Stack of the indices of the free slots.
+ * @param free_count Number of free slots.
+ * @param owners Process that serves the session of the slot, used in the fork mode.
+ */
+typedef struct {
+    char* slots;
+    size_t slot_size;
+    int capacity;
+    int* free_slots;
+    int free_count;
+    pid_t* owners;
+} SessionPool;
+
+/**
+ * @brief Session pool of the current process.
+ */
+extern SessionPool session_pool;
+
+void session_pool_init(SessionPool* pool, int capacity, const GameRules* rules);
+Session* session_pool_acquire(SessionPool* pool);
+void session_pool_release(SessionPool* pool, Session* session);
+void session_pool_set_owner(SessionPool* pool, Session* session, pid_t owner);
+void session_pool_release_owner(SessionPool* pool, pid_t owner);
+void session_pool_signal_owners(SessionPool* pool, int signal);
+int session_pool_used(SessionPool* pool);
+Session* session_pool_session(SessionPool* pool, int index);
+
+#endif
@@ -0,0 +1,365 @@
+/*! @file session_store.c
+File with the implementation of the session store. The file starts with a header page followed by the
+records. The state of a record and its owner share one 64-bit word, so a record is claimed with one
+compare-and-swap by any process: a free record for a new game, and a detached record, or a record whose
+owner has exited, for a resumed game. The resume token is the index of the record in the high bits and a
+random secret in the low bits. The store is kept as long as its size and the size of the boards do not
+change.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "session_store.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define STORE_MAGIC 0x45524f54
+#define STORE_VERSION 2
+#define STORE_HEADER_SIZE 4096
+#define RECORD_ALIGNMENT 64
+#define TOKEN_INDEX_SHIFT 40
+#define TOKEN_SECRET_MASK ((1ULL << TOKEN_INDEX_SHIFT) - 1)
+
+#define LOCK(state, owner) ((uint64_t)(state) << 32 | (uint32_t)(owner))
+#define LOCK_STATE(lock) ((RecordState)((lock) >> 32))
+#define LOCK_OWNER(lock) ((pid_t)(uint32_t)(lock))
+
+/**
+ * @brief Enumeration for the state of a record.
+ */
+typedef enum {
+    RECORD_FREE,    /**< The record can be taken by a new game */
+    RECORD_ACTIVE,  /**< The game is served by the owner of the record */
+    RECORD_DETACHED /**< The player disconnected, the game waits to be resumed */
+} RecordState;
+
+/**
+ * @struct StoreHeader
+ * @brief Structure for the header of the store file.
+ *
+ * @param magic STORE_MAGIC.
+ * @param version STORE_VERSION.
+ * @param field_size Size of the game boards of the records.
+ * @param capacity Number of records.
+ * @param record_size Size of a record with its game board.
+ * @param cursor Position of the search for a free record.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t field_size;
+    int32_t capacity;
+    uint64_t record_size;
+    _Alignas(64) uint32_t cursor;
+} StoreHeader;
+
+/**
+ * @brief Mapping of the store file, NULL if the store is disabled.
+ */
+static char* store;
+
+/**
+ * @brief Offset of the game board in a record.
+ */
+static size_t board_offset;
+
+/**
+ * @brief Size of a game board.
+ */
+static size_t board_size;
+
+/**
+ * @brief Rounds the size up to the alignment of the records.
+ * @param size Size in bytes.
+ * @return Aligned size in bytes.
+ */
+static size_t align_size(size_t size) {
+    return (size + RECORD_ALIGNMENT - 1) / RECORD_ALIGNMENT * RECORD_ALIGNMENT;
+}
+
+/**
+ * @brief Returns the header of the store.
+ * @return Header.
+ */
+static StoreHeader* store_header(void) {
+    return (StoreHeader*)store;
+}
+
+/**
+ * @brief Returns the record of the store.
+ * @param index Index of the record.
+ * @return Record.
+ */
+static StoredSession* store_record(uint32_t index) {
+    return (StoredSession*)(store + STORE_HEADER_SIZE + (size_t)index * store_header()->record_size);
+}
+
+/**
+ * @brief Returns the current time in milliseconds since the epoch.
+ * @return Time in milliseconds.
+ */
+static uint64_t current_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Checks if the store file was made for the same records.
+ * @param found Header of the file.
+ * @param expected Header for the configuration.
+ * @return true if the records of the file can be used, false otherwise.
+ */
+static bool header_matches(const StoreHeader* found, const StoreHeader* expected) {
+    if (found->magic != expected->magic || found->version != expected->version ||
+        found->field_size != expected->field_size || found->capacity != expected->capacity ||
+        found->record_size != expected->record_size) {
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Maps the store file. The file is created, or replaced by a new file if it was made for another
+ * size or other boards, so a server that still maps the old file is not affected. Otherwise its records are
+ * kept, and on recovery the games that were played by the previous run of the server are detached, so they
+ * can be resumed at once even if its processes were not collected yet.
+ * @param path Path of the store file.
+ * @param capacity Number of records.
+ * @param rules Rules of the games, the game boards are made for them.
+ * @param recover true if the previous server has exited, false if it still finishes its games.
+ * @return void
+ */
+void session_store_init(const char* path, int capacity, const GameRules* rules, bool recover) {
+    board_offset = align_size(sizeof(StoredSession));
+    board_size = game_board_size(rules->field_size, max_marked_cells(rules));
+
+    StoreHeader expected = {
+        .magic = STORE_MAGIC,
+        .version = STORE_VERSION,
+        .field_size = rules->field_size,
+        .capacity = capacity,
+        .record_size = board_offset + align_size(board_size),
+    };
+    size_t size = STORE_HEADER_SIZE + (size_t)capacity * expected.record_size;
+
+    int file = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    CHECK_LESS_THAN_ZERO(file, "SESSION STORE ERROR");
+
+    StoreHeader found;
+    struct stat status;
+    bool kept = false;
+
+    if (fstat(file, &status) == 0 && (size_t)status.st_size == size &&
+        pread(file, &found, sizeof(found), 0) == sizeof(found)) {
+        kept = header_matches(&found, &expected);
+    }
+
+    if (!kept) {
+        close(file);
+        unlink(path);
+
+        file = open(path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        CHECK_LESS_THAN_ZERO(file, "SESSION STORE ERROR");
+        CHECK_LESS_THAN_ZERO(ftruncate(file, size), "SESSION STORE ERROR");
+    }
+
+    store = (char*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+    close(file);
+
+    if (store == MAP_FAILED) {
+        perror("MMAP ERROR");
+        exit(EXIT_FAILURE);
+    }
+
+    if (!kept) {
+        memcpy(store, &expected, sizeof(expected));
+        return;
+    }
+
+    if (!recover) {
+        return;
+    }
+
+    for (int i = 0; i < capacity; ++i) {
+        StoredSession* stored = store_record((uint32_t)i);
+
+        if (LOCK_STATE(stored->lock) == RECORD_ACTIVE) {
+            stored->lock = LOCK(RECORD_DETACHED, 0);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Checks if the game of the record can be taken over: the player disconnected, or the process that
+ * served the game has exited.
+ * @param lock Lock of the record.
+ * @return true if the record is detached or abandoned, false otherwise.
+ */
+static bool is_abandoned(uint64_t lock) {
+    if (LOCK_STATE(lock) == RECORD_DETACHED) {
+        return true;
+    }
+
+    if (LOCK_STATE(lock) != RECORD_ACTIVE) {
+        return false;
+    }
+
+    return kill(LOCK_OWNER(lock), 0) < 0 && errno == ESRCH ? true : false;
+}
+
+/**
+ * @brief Returns a new resume token for the record. The secret part is random, so a token cannot be
+ * guessed from the tokens of the other games.
+ * @param index Index of the record.
+ * @return Token, never 0.
+ */
+static uint64_t new_token(uint32_t index) {
+    uint64_t secret;
+
+    if (getrandom(&secret, sizeof(secret), 0) != sizeof(secret)) {
+        secret = current_time() ^ ((uint64_t)getpid() << 20);
+    }
+
+    return (uint64_t)index << TOKEN_INDEX_SHIFT | (secret & TOKEN_SECRET_MASK) | 1;
+}
+
+/**
+ * @brief Takes a record for the new game and copies the game into it. The search prefers the free
+ * records, and takes over the detached and abandoned ones only when there are no free records.
+ * @param game Game that was started.
+ * @param name Name of the player.
+ * @param seed Seed of the board of the game.
+ * @return Record owned by the current process, NULL if the store is disabled or full.
+ */
+StoredSession* session_store_claim(const GameContext* game, const char* name, uint64_t seed) {
+    if (store == NULL) {
+        return NULL;
+    }
+
+    StoreHeader* header = store_header();
+    uint64_t owned = LOCK(RECORD_ACTIVE, getpid());
+
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < header->capacity; ++i) {
+            uint32_t index = __atomic_fetch_add(&header->cursor, 1, __ATOMIC_RELAXED) % header->capacity;
+            StoredSession* stored = store_record(index);
+            uint64_t lock = __atomic_load_n(&stored->lock, __ATOMIC_RELAXED);
+
+            if ((lock == LOCK(RECORD_FREE, 0) || (pass == 1 && is_abandoned(lock))) &&
+                __atomic_compare_exchange_n(&stored->lock, &lock, owned, false, __ATOMIC_ACQUIRE,
+                                            __ATOMIC_RELAXED)) {
+                stored->token = new_token(index);
+                stored->seed = seed;
+                stored->started = current_time();
+                snprintf(stored->name, sizeof(stored->name), "%s", name);
+                memcpy(session_store_board(stored), game->board, board_size);
+                session_store_update(stored, game, 0);
+
+                return stored;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+/**
+ * @brief Takes the record of the game of the token if the game can be resumed.
+ * @param token Resume token.
+ * @return Record owned by the current process, NULL if there is no such game or it is still played.
+ */
+StoredSession* session_store_resume(uint64_t token) {
+    if (store == NULL || (token >> TOKEN_INDEX_SHIFT) >= (uint64_t)store_header()->capacity) {
+        return NULL;
+    }
+
+    StoredSession* stored = store_record((uint32_t)(token >> TOKEN_INDEX_SHIFT));
+    uint64_t lock = __atomic_load_n(&stored->lock, __ATOMIC_ACQUIRE);
+
+    if (stored->token != token || !is_abandoned(lock) ||
+        !__atomic_compare_exchange_n(&stored->lock, &lock, LOCK(RECORD_ACTIVE, getpid()), false,
+                                     __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+        return NULL;
+    }
+
+    if (stored->token != token) {
+        __atomic_store_n(&stored->lock, lock, __ATOMIC_RELEASE);
+        return NULL;
+    }
+
+    return stored;
+}
+
+/**
+ * @brief Returns the game board of the record.
+ * @param stored Record.
+ * @return Game board.
+ */
+GameBoard* session_store_board(StoredSession* stored) {
+    return (GameBoard*)((char*)stored + board_offset);
+}
+
+/**
+ * @brief Copies the counters of the game into the record. The board is not copied, the game plays on the
+ * board of the record.
+ * @param stored Record.
+ * @param game Game of the record.
+ * @param moves Number of moves played.
+ * @return void
+ */
+void session_store_update(StoredSession* stored, const GameContext* game, uint32_t moves) {
+    stored->moves = moves;
+    stored->number_of_ships = game->number_of_ships;
+    stored->number_of_moves = game->number_of_moves;
+
+    return;
+}
+
+/**
+ * @brief Returns the time since the start of the game of the record. The start time is taken from the
+ * real-time clock, so it stays valid after a restart of the server.
+ * @param stored Record.
+ * @return Time in milliseconds, 0 if the clock went back.
+ */
+uint64_t session_store_elapsed(const StoredSession* stored) {
+    uint64_t now = current_time();
+
+    return now > stored->started ? now - stored->started : 0;
+}
+
+/**
+ * @brief Keeps the game of the record for the player to resume it.
+ * @param stored Record.
+ * @return void
+ */
+void session_store_detach(StoredSession* stored) {
+    __atomic_store_n(&stored->lock, LOCK(RECORD_DETACHED, 0), __ATOMIC_RELEASE);
+
+    return;
+}
+
+/**
+ * @brief Frees the record of the game that is over.
+ * @param stored Record.
+ * @return void
+ */
+void session_store_release(StoredSession* stored) {
+    stored->token = 0;
+    __atomic_store_n(&stored->lock, LOCK(RECORD_FREE, 0), __ATOMIC_RELEASE);
+
+    return;
+}
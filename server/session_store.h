@@ -0,0 +1,51 @@
+/*! @file session_store.h
+File with the declaration of the session store. The store is a file of fixed-size records mapped into the
+memory of all processes of the server. A record keeps the counters of a game and its board, and the game
+plays on the board in the record, so the state survives the process that served it. A record is found by
+its resume token in O(1): the token holds the index of the record. A restarted server maps the same file
+and resumes the games at once.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef SESSION_STORE_H
+#define SESSION_STORE_H
+
+#include <stdint.h>
+
+#include "../engine/engine.h"
+#include "../shared/shared.h"
+
+/**
+ * @struct StoredSession
+ * @brief Structure for a record of the store. The game board of the record follows it.
+ *
+ * @param lock State of the record and the process that owns it, changed atomically.
+ * @param token Resume token of the game.
+ * @param seed Seed of the board of the game.
+ * @param started Start time of the game in milliseconds since the epoch.
+ * @param moves Number of moves played.
+ * @param number_of_ships Number of ships left on the board.
+ * @param number_of_moves Number of missed moves.
+ * @param name Name of the player.
+ */
+typedef struct {
+    uint64_t lock;
+    uint64_t token;
+    uint64_t seed;
+    uint64_t started;
+    uint32_t moves;
+    int32_t number_of_ships;
+    int32_t number_of_moves;
+    char name[BUF_MESSAGE_SIZE];
+} StoredSession;
+
+void session_store_init(const char* path, int capacity, const GameRules* rules, bool recover);
+StoredSession* session_store_claim(const GameContext* game, const char* name, uint64_t seed);
+StoredSession* session_store_resume(uint64_t token);
+GameBoard* session_store_board(StoredSession* stored);
+void session_store_update(StoredSession* stored, const GameContext* game, uint32_t moves);
+uint64_t session_store_elapsed(const StoredSession* stored);
+void session_store_detach(StoredSession* stored);
+void session_store_release(StoredSession* stored);
+
+#endif
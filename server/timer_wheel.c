@@ -0,0 +1,233 @@
+/*! @file timer_wheel.c
+File with the implementation of the hierarchical timer wheel. The times are in milliseconds of the
+monotonic clock and are rounded up to ticks of TIMER_TICK_MS milliseconds, so a timer never expires early.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "timer_wheel.h"
+
+#include <time.h>
+
+#define SLOT_MASK (TIMER_SLOTS - 1)
+
+/**
+ * @brief Returns the monotonic time for the timers.
+ * @return Time in milliseconds.
+ */
+uint64_t timer_now(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000 + (uint64_t)now.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Makes the list empty.
+ * @param head Head of the list.
+ * @return void
+ */
+static void list_init(TimerNode* head) {
+    head->prev = head;
+    head->next = head;
+
+    return;
+}
+
+/**
+ * @brief Appends the node to the list.
+ * @param head Head of the list.
+ * @param node Node.
+ * @return void
+ */
+static void list_append(TimerNode* head, TimerNode* node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+
+    return;
+}
+
+/**
+ * @brief Removes the node from its list.
+ * @param node Node.
+ * @return void
+ */
+static void list_remove(TimerNode* node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = NULL;
+    node->next = NULL;
+
+    return;
+}
+
+/**
+ * @brief Moves all nodes of the list to the other list.
+ * @param from Head of the list the nodes are taken from, it becomes empty.
+ * @param to Head of the empty list.
+ * @return void
+ */
+static void list_move(TimerNode* from, TimerNode* to) {
+    list_init(to);
+
+    if (from->next != from) {
+        to->next = from->next;
+        to->prev = from->prev;
+        to->next->prev = to;
+        to->prev->next = to;
+        list_init(from);
+    }
+
+    return;
+}
+
+/**
+ * @brief Initializes the wheel with no timers.
+ * @param wheel Timer wheel.
+ * @param now Current time in milliseconds.
+ * @return void
+ */
+void timer_wheel_init(TimerWheel* wheel, uint64_t now) {
+    for (int level = 0; level < TIMER_LEVELS; ++level) {
+        for (int slot = 0; slot < TIMER_SLOTS; ++slot) {
+            list_init(&wheel->slots[level][slot]);
+        }
+    }
+
+    wheel->tick = now / TIMER_TICK_MS;
+    wheel->count = 0;
+
+    return;
+}
+
+/**
+ * @brief Initializes the timer as not armed.
+ * @param timer Timer.
+ * @return void
+ */
+void timer_init(TimerNode* timer) {
+    timer->prev = NULL;
+    timer->next = NULL;
+    timer->expires = 0;
+
+    return;
+}
+
+/**
+ * @brief Links the timer into the slot of its tick. A tick that has passed is placed into the next slot
+ * to process, a tick beyond the range of the wheel into the last slot of the highest level.
+ * @param wheel Timer wheel.
+ * @param timer Timer.
+ * @return void
+ */
+static void place_timer(TimerWheel* wheel, TimerNode* timer) {
+    uint64_t expires = timer->expires < wheel->tick ? wheel->tick : timer->expires;
+    uint64_t delta = expires - wheel->tick;
+    int level = 0;
+
+    while (level < TIMER_LEVELS - 1 && delta >= (1ULL << (TIMER_SLOT_BITS * (level + 1)))) {
+        level++;
+    }
+
+    if (delta >= (1ULL << (TIMER_SLOT_BITS * TIMER_LEVELS))) {
+        expires = wheel->tick + (1ULL << (TIMER_SLOT_BITS * TIMER_LEVELS)) - 1;
+    }
+
+    list_append(&wheel->slots[level][(expires >> (TIMER_SLOT_BITS * level)) & SLOT_MASK], timer);
+
+    return;
+}
+
+/**
+ * @brief Arms the timer, an armed timer is moved to the new deadline.
+ * @param wheel Timer wheel.
+ * @param timer Timer.
+ * @param deadline Time of the expiration in milliseconds.
+ * @return void
+ */
+void timer_arm(TimerWheel* wheel, TimerNode* timer, uint64_t deadline) {
+    timer_cancel(wheel, timer);
+
+    timer->expires = (deadline + TIMER_TICK_MS - 1) / TIMER_TICK_MS;
+    place_timer(wheel, timer);
+    wheel->count++;
+
+    return;
+}
+
+/**
+ * @brief Cancels the timer. Nothing happens if the timer is not armed.
+ * @param wheel Timer wheel.
+ * @param timer Timer.
+ * @return void
+ */
+void timer_cancel(TimerWheel* wheel, TimerNode* timer) {
+    if (timer->next != NULL) {
+        list_remove(timer);
+        wheel->count--;
+    }
+
+    return;
+}
+
+/**
+ * @brief Moves the timers of the slot of the level to the lower levels.
+ * @param wheel Timer wheel.
+ * @param level Level of the slot.
+ * @return Index of the slot, 0 if the level wrapped around as well.
+ */
+static int cascade(TimerWheel* wheel, int level) {
+    int slot = (int)((wheel->tick >> (TIMER_SLOT_BITS * level)) & SLOT_MASK);
+    TimerNode list;
+
+    list_move(&wheel->slots[level][slot], &list);
+
+    while (list.next != &list) {
+        TimerNode* timer = list.next;
+        list_remove(timer);
+        place_timer(wheel, timer);
+    }
+
+    return slot;
+}
+
+/**
+ * @brief Expires all timers up to the current time. The timers of a slot are moved to a separate list
+ * first and the wheel moves on to the next tick before the callbacks, so the callback can arm and cancel
+ * timers, and a timer armed again with a deadline that has passed expires on the next tick.
+ * @param wheel Timer wheel.
+ * @param now Current time in milliseconds.
+ * @param expire Function called for every expired timer.
+ * @param context Context of the function.
+ * @return void
+ */
+void timer_wheel_advance(TimerWheel* wheel, uint64_t now, TimerCallback expire, void* context) {
+    uint64_t target = now / TIMER_TICK_MS;
+
+    if (wheel->count == 0) {
+        wheel->tick = target + 1;
+        return;
+    }
+
+    while (wheel->tick <= target) {
+        int slot = (int)(wheel->tick & SLOT_MASK);
+
+        for (int level = 1; slot == 0 && level < TIMER_LEVELS; ++level) {
+            slot = cascade(wheel, level);
+        }
+
+        TimerNode list;
+        list_move(&wheel->slots[0][wheel->tick & SLOT_MASK], &list);
+        wheel->tick++;
+
+        while (list.next != &list) {
+            TimerNode* timer = list.next;
+            list_remove(timer);
+            wheel->count--;
+            expire(timer, context);
+        }
+    }
+
+    return;
+}
@@ -0,0 +1,62 @@
+/*! @file timer_wheel.h
+File with the declaration of the hierarchical timer wheel. The timers are nodes embedded into the objects
+they belong to, so arming and cancelling a timer only links and unlinks the node and never allocates.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+#include "../shared/shared.h"
+
+#define TIMER_TICK_MS 10
+#define TIMER_LEVELS 4
+#define TIMER_SLOT_BITS 6
+#define TIMER_SLOTS (1 << TIMER_SLOT_BITS)
+
+/**
+ * @struct TimerNode
+ * @brief Structure for a timer. The node is in the list of a slot of the wheel while the timer is armed.
+ *
+ * @param prev Previous node of the list.
+ * @param next Next node of the list, NULL if the timer is not armed.
+ * @param expires Tick the timer expires at.
+ */
+typedef struct TimerNode {
+    struct TimerNode* prev;
+    struct TimerNode* next;
+    uint64_t expires;
+} TimerNode;
+
+/**
+ * @struct TimerWheel
+ * @brief Structure for the timer wheel. Every level has TIMER_SLOTS slots, and a slot of a level covers
+ * all slots of the level below it. A timer is placed into the lowest level that reaches its tick, and the
+ * timers of a slot of a higher level are moved down when the lower level wraps around.
+ *
+ * @param slots Lists of the timers of the slots, the heads of the lists are not timers.
+ * @param tick Next tick to process.
+ * @param count Number of armed timers.
+ */
+typedef struct {
+    TimerNode slots[TIMER_LEVELS][TIMER_SLOTS];
+    uint64_t tick;
+    int count;
+} TimerWheel;
+
+/**
+ * @brief Function called for every expired timer. The timer is not armed when the function is called, so
+ * the function can arm it again. The context is the one given to timer_wheel_advance.
+ */
+typedef void (*TimerCallback)(TimerNode* timer, void* context);
+
+void timer_wheel_init(TimerWheel* wheel, uint64_t now);
+void timer_init(TimerNode* timer);
+void timer_arm(TimerWheel* wheel, TimerNode* timer, uint64_t deadline);
+void timer_cancel(TimerWheel* wheel, TimerNode* timer);
+void timer_wheel_advance(TimerWheel* wheel, uint64_t now, TimerCallback expire, void* context);
+uint64_t timer_now(void);
+
+#endif
@@ -0,0 +1,211 @@
+/*! @file trace.c
+File with the implementation of the tracing of the sessions. The ticks of the trace clock are converted
+to microseconds with the rate measured at the start of the server. The signal handler only sets a flag,
+the spans are written by the loop of the process when it handles the flag.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifdef TRACE
+
+#include "trace.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "logger.h"
+#include "session_pool.h"
+
+#define CALIBRATION_NS 20000000
+
+/**
+ * @brief Names of the kinds of the spans.
+ */
+static const char* kind_names[TRACE_KIND_COUNT] = {
+    [TRACE_RECV] = "recv",
+    [TRACE_PROCESS] = "process_input",
+    [TRACE_MOVE] = "process_player_move",
+    [TRACE_STATUS] = "check_game_status",
+    [TRACE_SEND] = "send",
+};
+
+/**
+ * @brief Ticks of the trace clock per microsecond.
+ */
+static double ticks_per_microsecond = 1000.0;
+
+/**
+ * @brief Ticks of the trace clock at the start of the server, the time stamps of the trace start there.
+ */
+static uint64_t first_tick;
+
+/**
+ * @brief Set by the signal handler when the spans must be written.
+ */
+static volatile sig_atomic_t dump_requested;
+
+/**
+ * @brief Returns the monotonic time.
+ * @return Time in nanoseconds.
+ */
+static uint64_t monotonic_time(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec;
+}
+
+/**
+ * @brief Returns the time of the trace clock: the time stamp counter on x86-64, the monotonic time in
+ * nanoseconds otherwise.
+ * @return Ticks of the trace clock.
+ */
+uint64_t trace_clock(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return monotonic_time();
+#endif
+}
+
+/**
+ * @brief Requests the spans to be written.
+ * @param signal Signal number.
+ * @return void
+ */
+static void request_dump(int signal) {
+    (void)signal;
+    dump_requested = 1;
+
+    return;
+}
+
+/**
+ * @brief Measures the rate of the trace clock and writes the spans on SIGUSR1. Must be called before the
+ * workers are created.
+ * @return void
+ */
+void trace_init(void) {
+    struct timespec interval = {.tv_sec = 0, .tv_nsec = CALIBRATION_NS};
+    uint64_t start_time = monotonic_time();
+
+    first_tick = trace_clock();
+    nanosleep(&interval, NULL);
+
+    uint64_t ticks = trace_clock() - first_tick;
+    ticks_per_microsecond = (double)ticks * 1000.0 / (double)(monotonic_time() - start_time);
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = request_dump;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    CHECK_LESS_THAN_ZERO(sigaction(SIGUSR1, &action, NULL), "SIGACTION ERROR");
+
+    return;
+}
+
+/**
+ * @brief Writes the text as the contents of a JSON string: the quotes and the backslashes are escaped, the
+ * control characters are written as the unicode escapes.
+ * @param file Trace file.
+ * @param text Text.
+ * @return void
+ */
+static void write_json_text(FILE* file, const char* text) {
+    for (const unsigned char* character = (const unsigned char*)text; *character != '\0'; ++character) {
+        if (*character == '"' || *character == '\\') {
+            fprintf(file, "\\%c", *character);
+        } else if (*character < 0x20) {
+            fprintf(file, "\\u%04x", *character);
+        } else {
+            fputc(*character, file);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Writes the spans of the session as the events of one thread of the trace.
+ * @param file Trace file.
+ * @param session Session.
+ * @param index Index of the slot of the session, used as the thread of the trace.
+ * @param first true if no events were written yet.
+ * @return Number of written spans.
+ */
+static int write_session(FILE* file, const Session* session, int index, bool first) {
+    const TraceRing* ring = &session->trace;
+    uint64_t begin = ring->count > TRACE_RING_SIZE ? ring->count - TRACE_RING_SIZE : 0;
+    int pid = (int)getpid();
+
+    fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,", first ? "" : ",", pid,
+            index);
+    fprintf(file, "\"args\":{\"name\":\"session %d ", index);
+    write_json_text(file, session->name);
+    fprintf(file, "\"}}");
+
+    for (uint64_t position = begin; position < ring->count; ++position) {
+        const TraceSpan* span = &ring->spans[position % TRACE_RING_SIZE];
+        double start = (double)(span->start - first_tick) / ticks_per_microsecond;
+
+        fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                kind_names[span->kind], pid, index, start, (double)span->duration / ticks_per_microsecond);
+    }
+
+    return (int)(ring->count - begin);
+}
+
+/**
+ * @brief Writes the spans of all sessions of the session pool of the process to trace-<pid>.json if they
+ * were requested. The sessions without spans are skipped.
+ * @return void
+ */
+void trace_dump_if_requested(void) {
+    if (!dump_requested) {
+        return;
+    }
+
+    dump_requested = 0;
+
+    char path[LOG_TEXT_SIZE];
+    snprintf(path, sizeof(path), "trace-%d.json", (int)getpid());
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        perror("TRACE FILE ERROR");
+        return;
+    }
+
+    int spans = 0;
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+
+    for (int i = 0; i < session_pool.capacity; ++i) {
+        const Session* session = session_pool_session(&session_pool, i);
+
+        if (session->trace.count > 0) {
+            spans += write_session(file, session, i, spans == 0 ? true : false);
+        }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+
+    LogRecord* record = log_begin(LOG_EVENT_TRACE_WRITTEN);
+    if (record != NULL) {
+        log_text(record, path);
+        record->arguments[0] = spans;
+        log_commit();
+    }
+
+    return;
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*! @file trace.h
+File with the declaration of the tracing of the sessions. The tracing is compiled in with the TRACE flag
+(make server_compile TRACE=1), without it the macros expand to nothing. Every session keeps the last spans
+of its moves in a ring: receiving, processing of the input, the move, the check of the game status, and
+sending. On SIGUSR1 every process writes the spans of its sessions in the Chrome trace event format.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#ifdef TRACE
+
+#define TRACE_RING_SIZE 256
+
+/**
+ * @brief Enumeration for the kinds of the spans.
+ */
+typedef enum {
+    TRACE_RECV,    /**< Receiving from the socket, includes the wait in the blocking mode */
+    TRACE_PROCESS, /**< Processing of the received frames, includes the spans of the moves */
+    TRACE_MOVE,    /**< Playing of one move */
+    TRACE_STATUS,  /**< Check of the game status after the move */
+    TRACE_SEND,    /**< Sending to the socket */
+    TRACE_KIND_COUNT
+} TraceKind;
+
+/**
+ * @struct TraceSpan
+ * @brief Structure for one span.
+ *
+ * @param start Start of the span in ticks of the trace clock.
+ * @param duration Duration of the span in ticks of the trace clock.
+ * @param kind Kind of the span.
+ */
+typedef struct {
+    uint64_t start;
+    uint32_t duration;
+    uint32_t kind;
+} TraceSpan;
+
+/**
+ * @struct TraceRing
+ * @brief Structure for the last spans of a session. A new span overwrites the oldest one.
+ *
+ * @param spans Spans of the ring.
+ * @param count Number of spans recorded since the start of the session.
+ */
+typedef struct {
+    TraceSpan spans[TRACE_RING_SIZE];
+    uint64_t count;
+} TraceRing;
+
+/**
+ * @brief Returns the time of the trace clock: the time stamp counter on x86-64, the monotonic time in
+ * nanoseconds otherwise.
+ * @return Ticks of the trace clock.
+ */
+uint64_t trace_clock(void);
+
+/**
+ * @brief Records the span in the ring.
+ * @param ring Ring of the session.
+ * @param kind Kind of the span.
+ * @param start Start of the span in ticks of the trace clock.
+ * @return void
+ */
+static inline void trace_record(TraceRing* ring, TraceKind kind, uint64_t start) {
+    TraceSpan* span = &ring->spans[ring->count++ % TRACE_RING_SIZE];
+
+    span->start = start;
+    span->duration = (uint32_t)(trace_clock() - start);
+    span->kind = kind;
+
+    return;
+}
+
+void trace_init(void);
+void trace_dump_if_requested(void);
+
+#define TRACE_BEGIN(start) uint64_t start = trace_clock()
+#define TRACE_END(ring, kind, start) trace_record((ring), (kind), (start))
+#define TRACE_RESET(ring) ((ring)->count = 0)
+#define TRACE_INIT() trace_init()
+#define TRACE_DUMP_IF_REQUESTED() trace_dump_if_requested()
+
+#else
+
+#define TRACE_BEGIN(start)
+#define TRACE_END(ring, kind, start)
+#define TRACE_RESET(ring)
+#define TRACE_INIT()
+#define TRACE_DUMP_IF_REQUESTED()
+
+#endif
+
+#endif
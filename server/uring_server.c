@@ -0,0 +1,946 @@
+/*! @file uring_server.c
+File with the implementation of the io_uring server mode. A single process serves all players with one
+io_uring instance, created with the system calls directly. The connections are accepted by one multishot
+accept per listener, every connection has one multishot receive that takes its buffers from a ring of provided
+buffers, and the answers of all sessions are queued during one pass over the completions and submitted
+with one system call, which also waits for the next completions. While there are armed timers, a timeout
+request wakes the loop up every tick.
+When the kernel does not support io_uring or the provided buffers, the server falls back to epoll. The
+multishot requests fall back to single requests if the kernel rejects them. The receive requests cannot
+take passed descriptors, so the players of the local socket are served on the socket and their offers of
+a shared-memory channel are refused.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "uring_server.h"
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "metrics.h"
+#include "server.h"
+#include "session.h"
+#include "session_pool.h"
+#include "timer_wheel.h"
+#include "trace.h"
+
+#define URING_ENTRIES 4096
+#define BUFFER_GROUP 0
+#define BUFFER_COUNT 4096
+#define BUFFER_SIZE SESSION_BUFFER_SIZE
+#define NO_BUFFER -1
+
+/**
+ * @brief Enumeration for the requests of the ring. The request is stored in the low byte of the user
+ * data, the file descriptor in the other bytes.
+ */
+typedef enum {
+    REQUEST_ACCEPT, /**< Accepting the connections on the server socket */
+    REQUEST_RECV,   /**< Receiving from the client socket */
+    REQUEST_SEND,   /**< Sending the output of the session */
+    REQUEST_TIMEOUT, /**< Waking up for the next tick of the timers */
+    REQUEST_CANCEL   /**< Cancelling the accept request when the server drains */
+} UringRequest;
+
+/**
+ * @struct Uring
+ * @brief Structure for the io_uring instance and its mapped queues.
+ *
+ * @param fd File descriptor of the instance.
+ * @param sq_head Head of the submission queue, moved by the kernel.
+ * @param sq_tail Tail of the submission queue.
+ * @param sq_mask Mask of the indices of the submission queue.
+ * @param sqes Submission queue entries.
+ * @param sq_local_tail Tail of the entries filled but not published yet.
+ * @param queued Number of entries that were not submitted yet.
+ * @param cq_head Head of the completion queue.
+ * @param cq_tail Tail of the completion queue, moved by the kernel.
+ * @param cq_mask Mask of the indices of the completion queue.
+ * @param cqes Completion queue entries.
+ * @param buffers Ring of the provided buffers.
+ * @param buffer_memory Memory of the provided buffers.
+ * @param buffer_tail Tail of the ring of the provided buffers.
+ */
+typedef struct {
+    int fd;
+    unsigned* sq_head;
+    unsigned* sq_tail;
+    unsigned sq_mask;
+    struct io_uring_sqe* sqes;
+    unsigned sq_local_tail;
+    unsigned queued;
+    unsigned* cq_head;
+    unsigned* cq_tail;
+    unsigned cq_mask;
+    struct io_uring_cqe* cqes;
+    struct io_uring_buf_ring* buffers;
+    char* buffer_memory;
+    uint16_t buffer_tail;
+} Uring;
+
+/**
+ * @struct Connection
+ * @brief Structure for the state of a client socket in the ring. The received buffers that do not fit into
+ * the input of the session yet are kept in a list in the order of their arrival.
+ *
+ * @param session Session of the connection, NULL if the file descriptor is not a connection.
+ * @param pending_head First received buffer that was not copied completely, NO_BUFFER if there is none.
+ * @param pending_tail Last received buffer.
+ * @param pending_offset Number of copied bytes of the first buffer.
+ * @param receiving true while the receive request is active.
+ * @param sending true while the send request is active. The output is only appended to meanwhile.
+ * @param paused true if the receive request was stopped because the input is full and buffers are pending.
+ * @param starved true if the receive request ended because there were no free buffers.
+ * @param closing true if the connection was shut down and waits for its requests to complete.
+ */
+typedef struct {
+    Session* session;
+    int pending_head;
+    int pending_tail;
+    unsigned pending_offset;
+    bool receiving;
+    bool sending;
+    bool paused;
+    bool starved;
+    bool closing;
+} Connection;
+
+/**
+ * @brief Table of the connections indexed by the file descriptor of the client socket.
+ */
+static Connection* connections;
+
+/**
+ * @brief Number of entries in the table of the connections.
+ */
+static int connections_capacity;
+
+/**
+ * @brief Next received buffer of the list of every buffer.
+ */
+static int buffer_next[BUFFER_COUNT];
+
+/**
+ * @brief Number of received bytes of every buffer.
+ */
+static unsigned buffer_length[BUFFER_COUNT];
+
+/**
+ * @brief Number of connections whose receive request waits for free buffers.
+ */
+static int starved_connections;
+
+/**
+ * @brief true if buffers were given back to the kernel since the starved connections were restarted.
+ */
+static bool buffers_recycled;
+
+/**
+ * @brief true while the kernel accepts the multishot accept and receive requests.
+ */
+static bool multishot_accept = true, multishot_recv = true;
+
+/**
+ * @brief true until the server drains, the accept requests are queued again while it is true.
+ */
+static bool accepting = true;
+
+/**
+ * @brief Number of the active accept requests, one per listener.
+ */
+static int armed_accepts;
+
+/**
+ * @brief Timers of the idle timeouts of the sessions.
+ */
+static TimerWheel timers;
+
+/**
+ * @brief true while the timeout request of the next tick is active.
+ */
+static bool timeout_armed;
+
+/**
+ * @brief Interval of the timeout request, it must stay valid until the request is submitted.
+ */
+static struct __kernel_timespec tick_interval = {.tv_sec = 0, .tv_nsec = TIMER_TICK_MS * 1000000LL};
+
+/**
+ * @brief Enters the ring: submits the queued entries and waits for the completions. SIGQUIT interrupts
+ * the wait.
+ * @param ring Ring.
+ * @param wait Number of completions to wait for.
+ * @return Result of the system call.
+ */
+static int uring_enter(Uring* ring, unsigned wait) {
+    __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+    int submitted = (int)syscall(__NR_io_uring_enter, ring->fd, ring->queued, wait,
+                                 wait > 0 ? IORING_ENTER_GETEVENTS : 0, wait > 0 ? &drain_wait_mask : NULL,
+                                 _NSIG / 8);
+    if (submitted > 0) {
+        ring->queued -= (unsigned)submitted;
+    }
+
+    return submitted;
+}
+
+/**
+ * @brief Takes a free entry of the submission queue. The queued entries are submitted if the queue is full.
+ * @param ring Ring.
+ * @param request Request of the entry.
+ * @param fd File descriptor of the request.
+ * @return Cleared entry.
+ */
+static struct io_uring_sqe* uring_get_sqe(Uring* ring, UringRequest request, int fd) {
+    while (ring->sq_local_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE) > ring->sq_mask) {
+        if (uring_enter(ring, 0) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            perror("IO_URING_ENTER ERROR");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    struct io_uring_sqe* sqe = &ring->sqes[ring->sq_local_tail & ring->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->fd = fd;
+    sqe->user_data = ((uint64_t)fd << 8) | request;
+
+    ring->sq_local_tail++;
+    ring->queued++;
+
+    return sqe;
+}
+
+/**
+ * @brief Maps the queues of the ring.
+ * @param ring Ring.
+ * @param params Parameters returned by the kernel.
+ * @return true on success, false otherwise.
+ */
+static bool uring_map(Uring* ring, const struct io_uring_params* params) {
+    size_t sq_size = params->sq_off.array + params->sq_entries * sizeof(unsigned);
+    size_t cq_size = params->cq_off.cqes + params->cq_entries * sizeof(struct io_uring_cqe);
+    bool single_mmap = (params->features & IORING_FEAT_SINGLE_MMAP) ? true : false;
+
+    if (single_mmap && cq_size > sq_size) {
+        sq_size = cq_size;
+    }
+
+    char* sq = mmap(NULL, sq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                    IORING_OFF_SQ_RING);
+    if (sq == MAP_FAILED) {
+        return false;
+    }
+
+    char* cq = single_mmap ? sq
+                           : mmap(NULL, cq_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd,
+                                  IORING_OFF_CQ_RING);
+    if (cq == MAP_FAILED) {
+        return false;
+    }
+
+    ring->sqes = mmap(NULL, params->sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+    if (ring->sqes == MAP_FAILED) {
+        return false;
+    }
+
+    ring->sq_head = (unsigned*)(sq + params->sq_off.head);
+    ring->sq_tail = (unsigned*)(sq + params->sq_off.tail);
+    ring->sq_mask = *(unsigned*)(sq + params->sq_off.ring_mask);
+    ring->sq_local_tail = *ring->sq_tail;
+    ring->queued = 0;
+
+    unsigned* array = (unsigned*)(sq + params->sq_off.array);
+    for (unsigned i = 0; i < params->sq_entries; ++i) {
+        array[i] = i;
+    }
+
+    ring->cq_head = (unsigned*)(cq + params->cq_off.head);
+    ring->cq_tail = (unsigned*)(cq + params->cq_off.tail);
+    ring->cq_mask = *(unsigned*)(cq + params->cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(cq + params->cq_off.cqes);
+
+    return true;
+}
+
+/**
+ * @brief Gives the buffer back to the kernel.
+ * @param ring Ring.
+ * @param buffer Index of the buffer.
+ * @return void
+ */
+static void recycle_buffer(Uring* ring, int buffer) {
+    struct io_uring_buf* entry = &ring->buffers->bufs[ring->buffer_tail & (BUFFER_COUNT - 1)];
+
+    entry->addr = (uint64_t)(uintptr_t)(ring->buffer_memory + (size_t)buffer * BUFFER_SIZE);
+    entry->len = BUFFER_SIZE;
+    entry->bid = (uint16_t)buffer;
+
+    ring->buffer_tail++;
+    __atomic_store_n(&ring->buffers->tail, ring->buffer_tail, __ATOMIC_RELEASE);
+
+    buffers_recycled = true;
+
+    return;
+}
+
+/**
+ * @brief Registers the ring of the provided buffers and gives all buffers to the kernel.
+ * @param ring Ring.
+ * @return true on success, false if the kernel does not support the provided buffer rings.
+ */
+static bool uring_register_buffers(Uring* ring) {
+    size_t ring_size = BUFFER_COUNT * sizeof(struct io_uring_buf);
+
+    ring->buffers = mmap(NULL, ring_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    ring->buffer_memory = mmap(NULL, (size_t)BUFFER_COUNT * BUFFER_SIZE, PROT_READ | PROT_WRITE,
+                               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (ring->buffers == MAP_FAILED || ring->buffer_memory == MAP_FAILED) {
+        return false;
+    }
+
+    struct io_uring_buf_reg registration;
+    memset(&registration, 0, sizeof(registration));
+    registration.ring_addr = (uint64_t)(uintptr_t)ring->buffers;
+    registration.ring_entries = BUFFER_COUNT;
+    registration.bgid = BUFFER_GROUP;
+
+    if (syscall(__NR_io_uring_register, ring->fd, IORING_REGISTER_PBUF_RING, &registration, 1) < 0) {
+        return false;
+    }
+
+    ring->buffer_tail = 0;
+    for (int buffer = 0; buffer < BUFFER_COUNT; ++buffer) {
+        recycle_buffer(ring, buffer);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Creates the ring. The ring is used by one thread, so the kernel is told that first, which is
+ * retried without the flags on the kernels that do not know them.
+ * @param ring Ring.
+ * @return true on success, false if io_uring is not available.
+ */
+static bool uring_init(Uring* ring) {
+    struct io_uring_params params;
+    unsigned flags[] = {IORING_SETUP_CQSIZE | IORING_SETUP_SINGLE_ISSUER | IORING_SETUP_COOP_TASKRUN,
+                        IORING_SETUP_CQSIZE};
+
+    ring->fd = -1;
+
+    for (int i = 0; i < (int)(sizeof(flags) / sizeof(flags[0])) && ring->fd < 0; ++i) {
+        memset(&params, 0, sizeof(params));
+        params.flags = flags[i];
+        params.cq_entries = URING_ENTRIES * 4;
+
+        ring->fd = (int)syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    }
+
+    if (ring->fd < 0) {
+        return false;
+    }
+
+    if ((params.features & IORING_FEAT_NODROP) == 0 || !uring_map(ring, &params) ||
+        !uring_register_buffers(ring)) {
+        close(ring->fd);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Queues the accept request of the listener.
+ * @param ring Ring.
+ * @param listener Server socket or listener of the local socket.
+ * @return void
+ */
+static void queue_accept(Uring* ring, int listener) {
+    struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_ACCEPT, listener);
+
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = multishot_accept ? IORING_ACCEPT_MULTISHOT : 0;
+
+    armed_accepts++;
+
+    return;
+}
+
+/**
+ * @brief Cancels the accept request of the listener. The request completes with -ECANCELED.
+ * @param ring Ring.
+ * @param listener Server socket or listener of the local socket.
+ * @return void
+ */
+static void queue_accept_cancel(Uring* ring, int listener) {
+    struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_CANCEL, listener);
+
+    sqe->opcode = IORING_OP_ASYNC_CANCEL;
+    sqe->fd = -1;
+    sqe->addr = ((uint64_t)listener << 8) | REQUEST_ACCEPT;
+
+    return;
+}
+
+/**
+ * @brief Queues the receive request of the connection. The kernel picks a provided buffer when the data
+ * arrives.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void queue_recv(Uring* ring, int fd) {
+    struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_RECV, fd);
+
+    sqe->opcode = IORING_OP_RECV;
+    sqe->flags = IOSQE_BUFFER_SELECT;
+    sqe->buf_group = BUFFER_GROUP;
+    sqe->ioprio = multishot_recv ? IORING_RECV_MULTISHOT : 0;
+
+    connections[fd].receiving = true;
+
+    return;
+}
+
+/**
+ * @brief Stops receiving into the connection while its input is full and buffers are pending, so one
+ * client that does not read its answers cannot take all provided buffers. The multishot receive request
+ * is cancelled and completes with -ECANCELED, a single request is just not queued again.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void pause_recv(Uring* ring, int fd) {
+    Connection* connection = &connections[fd];
+
+    if (connection->paused) {
+        return;
+    }
+
+    connection->paused = true;
+
+    if (connection->receiving && multishot_recv) {
+        struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_CANCEL, fd);
+
+        sqe->opcode = IORING_OP_ASYNC_CANCEL;
+        sqe->fd = -1;
+        sqe->addr = ((uint64_t)fd << 8) | REQUEST_RECV;
+    }
+
+    return;
+}
+
+/**
+ * @brief Queues the send request of the output of the session. The output of a spectator with queued events
+ * is gathered into one message with the shared events.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void queue_send(Uring* ring, int fd) {
+    Session* session = connections[fd].session;
+    struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_SEND, fd);
+
+    if (broadcast_has_output(session)) {
+        sqe->opcode = IORING_OP_SENDMSG;
+        sqe->addr = (uint64_t)(uintptr_t)broadcast_message(session);
+        sqe->len = 1;
+    } else {
+        sqe->opcode = IORING_OP_SEND;
+        sqe->addr = (uint64_t)(uintptr_t)session->output;
+        sqe->len = (uint32_t)session->output_length;
+    }
+
+    sqe->msg_flags = MSG_NOSIGNAL;
+
+    connections[fd].sending = true;
+
+    return;
+}
+
+/**
+ * @brief Queues the timeout request that completes after one tick of the timers.
+ * @param ring Ring.
+ * @return void
+ */
+static void queue_timeout(Uring* ring) {
+    struct io_uring_sqe* sqe = uring_get_sqe(ring, REQUEST_TIMEOUT, 0);
+
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->addr = (uint64_t)(uintptr_t)&tick_interval;
+    sqe->len = 1;
+
+    timeout_armed = true;
+
+    return;
+}
+
+/**
+ * @brief Closes the connection. The socket is shut down first, so the active requests complete, and the
+ * socket is closed and the session is released when there are no active requests.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void close_connection(Uring* ring, int fd) {
+    Connection* connection = &connections[fd];
+
+    if (!connection->closing) {
+        connection->closing = true;
+        timer_cancel(&timers, &connection->session->timer);
+        shutdown(fd, SHUT_RDWR);
+    }
+
+    if (connection->receiving || connection->sending) {
+        return;
+    }
+
+    while (connection->pending_head != NO_BUFFER) {
+        int buffer = connection->pending_head;
+        connection->pending_head = buffer_next[buffer];
+        recycle_buffer(ring, buffer);
+    }
+
+    if (connection->starved) {
+        starved_connections--;
+    }
+
+    close(fd);
+    session_finish(connection->session);
+    session_pool_release(&session_pool, connection->session);
+    connection->session = NULL;
+
+    return;
+}
+
+/**
+ * @brief Copies the received buffers into the input of the session while there is space, and gives the
+ * copied buffers back to the kernel.
+ * @param ring Ring.
+ * @param connection Connection.
+ * @return void
+ */
+static void fill_input(Uring* ring, Connection* connection) {
+    while (connection->pending_head != NO_BUFFER) {
+        int buffer = connection->pending_head;
+        const char* data = ring->buffer_memory + (size_t)buffer * BUFFER_SIZE + connection->pending_offset;
+        size_t size = buffer_length[buffer] - connection->pending_offset;
+        size_t copied = session_append_input(connection->session, data, size);
+
+        if (copied < size) {
+            connection->pending_offset += (unsigned)copied;
+            return;
+        }
+
+        connection->pending_head = buffer_next[buffer];
+        connection->pending_offset = 0;
+        recycle_buffer(ring, buffer);
+    }
+
+    return;
+}
+
+/**
+ * @brief Processes the received frames of the connection and queues the answers. The processing stops
+ * when the input is incomplete or when the output waits for the active send request.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void pump_connection(Uring* ring, int fd) {
+    Connection* connection = &connections[fd];
+    Session* session = connection->session;
+
+    if (connection->closing) {
+        return;
+    }
+
+    do {
+        fill_input(ring, connection);
+    } while (session_process_input(session) > 0);
+
+    if (!connection->sending && session_has_output(session)) {
+        queue_send(ring, fd);
+    }
+
+    if (session->state == SESSION_FINISHED && !connection->sending) {
+        close_connection(ring, fd);
+        return;
+    }
+
+    if (connection->pending_head != NO_BUFFER) {
+        pause_recv(ring, fd);
+    } else if (!connection->receiving && !connection->starved) {
+        connection->paused = false;
+        queue_recv(ring, fd);
+    }
+
+    uint64_t deadline = session_deadline(session);
+    if (deadline == 0) {
+        timer_cancel(&timers, &session->timer);
+    } else {
+        timer_arm(&timers, &session->timer, deadline);
+    }
+
+    return;
+}
+
+/**
+ * @brief Finishes the session of the expired timer. The answer is sent at once if the socket takes it,
+ * and the connection is closed.
+ * @param timer Timer of the session.
+ * @param context Ring.
+ * @return void
+ */
+static void expire_connection(TimerNode* timer, void* context) {
+    Session* session = (Session*)((char*)timer - offsetof(Session, timer));
+    Connection* connection = &connections[session->socket];
+
+    session_expire(session);
+
+    if (!connection->sending && session_has_output(session)) {
+        send(session->socket, session->output, session->output_length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    close_connection((Uring*)context, session->socket);
+
+    return;
+}
+
+/**
+ * @brief Ends the connection of the session that plays no game when the server drains. The answer is sent
+ * at once if the socket takes it, and the connection is closed. A connection with an active send request is
+ * closed by the completion of the request.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @return void
+ */
+static void drain_connection(Uring* ring, int fd) {
+    Connection* connection = &connections[fd];
+    Session* session = connection->session;
+
+    if (connection->closing || connection->sending || !session_drain(session)) {
+        return;
+    }
+
+    if (session_has_output(session)) {
+        send(fd, session->output, session->output_length, MSG_DONTWAIT | MSG_NOSIGNAL);
+    }
+
+    close_connection(ring, fd);
+
+    return;
+}
+
+/**
+ * @brief Handles the completion of the accept request. The connection gets a session from the session
+ * pool and a receive request. The connection is refused if all sessions are in use.
+ * @param ring Ring.
+ * @param listener Server socket or listener of the local socket.
+ * @param cqe Completion.
+ * @return void
+ */
+static void handle_accept(Uring* ring, int listener, const struct io_uring_cqe* cqe) {
+    if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+        armed_accepts--;
+
+        if (cqe->res == -EINVAL && multishot_accept) {
+            multishot_accept = false;
+        }
+
+        if (accepting) {
+            queue_accept(ring, listener);
+        }
+    }
+
+    int client_socket = cqe->res;
+    if (client_socket < 0) {
+        return;
+    }
+
+    metrics_add(METRIC_CONNECTIONS_ACCEPTED, 1);
+
+    if (client_socket >= connections_capacity) {
+        metrics_add(METRIC_CONNECTIONS_CLOSED, 1);
+        close(client_socket);
+        return;
+    }
+
+    Session* session = session_pool_acquire(&session_pool);
+    if (session == NULL) {
+        refuse_client(client_socket);
+        return;
+    }
+
+    session_init(session, client_socket);
+
+    Connection* connection = &connections[client_socket];
+    memset(connection, 0, sizeof(*connection));
+    connection->session = session;
+    connection->pending_head = NO_BUFFER;
+    connection->pending_tail = NO_BUFFER;
+
+    if (draining) {
+        drain_connection(ring, client_socket);
+        return;
+    }
+
+    queue_recv(ring, client_socket);
+
+    uint64_t deadline = session_deadline(session);
+    if (deadline != 0) {
+        timer_arm(&timers, &session->timer, deadline);
+    }
+
+    return;
+}
+
+/**
+ * @brief Handles the completion of the receive request. The received buffer is appended to the list of
+ * the connection, and the frames are processed. The receive request is queued again by the processing
+ * unless the connection is paused or starved.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @param cqe Completion.
+ * @return void
+ */
+static void handle_recv(Uring* ring, int fd, const struct io_uring_cqe* cqe) {
+    Connection* connection = &connections[fd];
+
+    if ((cqe->flags & IORING_CQE_F_MORE) == 0) {
+        connection->receiving = false;
+    }
+
+    if (cqe->flags & IORING_CQE_F_BUFFER) {
+        int buffer = (int)(cqe->flags >> IORING_CQE_BUFFER_SHIFT);
+
+        if (cqe->res <= 0 || connection->closing) {
+            recycle_buffer(ring, buffer);
+        } else {
+            buffer_length[buffer] = (unsigned)cqe->res;
+            buffer_next[buffer] = NO_BUFFER;
+
+            if (connection->pending_head == NO_BUFFER) {
+                connection->pending_head = buffer;
+            } else {
+                buffer_next[connection->pending_tail] = buffer;
+            }
+
+            connection->pending_tail = buffer;
+        }
+    }
+
+    if (connection->closing) {
+        close_connection(ring, fd);
+        return;
+    }
+
+    if (cqe->res == -EINVAL && multishot_recv) {
+        multishot_recv = false;
+    } else if (cqe->res == -ENOBUFS) {
+        if (connection->pending_head == NO_BUFFER) {
+            connection->starved = true;
+            starved_connections++;
+        }
+        return;
+    } else if (cqe->res <= 0 && cqe->res != -ECANCELED) {
+        close_connection(ring, fd);
+        return;
+    }
+
+    pump_connection(ring, fd);
+
+    return;
+}
+
+/**
+ * @brief Handles the completion of the send request. The sent bytes are removed from the output, and the
+ * rest of the output is sent by the next request.
+ * @param ring Ring.
+ * @param fd Client socket.
+ * @param cqe Completion.
+ * @return void
+ */
+static void handle_send(Uring* ring, int fd, const struct io_uring_cqe* cqe) {
+    Connection* connection = &connections[fd];
+    connection->sending = false;
+
+    if (cqe->res < 0 || connection->closing) {
+        close_connection(ring, fd);
+        return;
+    }
+
+    session_consume_output(connection->session, (size_t)cqe->res);
+    pump_connection(ring, fd);
+
+    return;
+}
+
+/**
+ * @brief Restarts the receive requests that ended because there were no free buffers. It is only called
+ * after buffers were given back, otherwise every restarted request would fail again at once.
+ * @param ring Ring.
+ * @return void
+ */
+static void restart_starved_connections(Uring* ring) {
+    for (int fd = 0; fd < connections_capacity && starved_connections > 0; ++fd) {
+        Connection* connection = &connections[fd];
+
+        if (connection->session != NULL && connection->starved) {
+            connection->starved = false;
+            starved_connections--;
+
+            if (!connection->closing) {
+                queue_recv(ring, fd);
+            }
+        }
+    }
+
+    buffers_recycled = false;
+
+    return;
+}
+
+/**
+ * @brief Handles all available completions.
+ * @param ring Ring.
+ * @return void
+ */
+static void handle_completions(Uring* ring) {
+    unsigned head = *ring->cq_head;
+    unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+
+    for (; head != tail; ++head) {
+        const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+        int fd = (int)(cqe->user_data >> 8);
+
+        switch ((UringRequest)(cqe->user_data & 0xFF)) {
+            case REQUEST_ACCEPT:
+                handle_accept(ring, fd, cqe);
+                break;
+            case REQUEST_RECV:
+                handle_recv(ring, fd, cqe);
+                break;
+            case REQUEST_TIMEOUT:
+                timeout_armed = false;
+                break;
+            case REQUEST_CANCEL:
+                break;
+            default:
+                handle_send(ring, fd, cqe);
+                break;
+        }
+    }
+
+    __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+
+    return;
+}
+
+/**
+ * @brief Queues the new output of the spectators after the completions of the players were handled, so a
+ * spectator never delays the moves of the player.
+ * @param ring Ring.
+ * @return void
+ */
+static void serve_spectators(Uring* ring) {
+    Session* session;
+
+    while ((session = broadcast_next_pending()) != NULL) {
+        pump_connection(ring, session->socket);
+    }
+
+    return;
+}
+
+/**
+ * @brief Runs the io_uring server. Every pass handles all completions and then submits all queued
+ * requests with one system call that waits for the next completion. When the server drains, the accept
+ * requests are cancelled, and the function returns after their completions and the last session, so no
+ * connection is accepted into a ring that is closed.
+ * @param server_socket Server socket.
+ * @return false if io_uring is not available, true after the server was drained.
+ */
+bool run_uring_server(int server_socket) {
+    Uring ring;
+
+    if (!uring_init(&ring)) {
+        perror("IO_URING ERROR, using epoll");
+        return false;
+    }
+
+    struct rlimit limit;
+    CHECK_LESS_THAN_ZERO(getrlimit(RLIMIT_NOFILE, &limit), "GETRLIMIT ERROR");
+
+    connections_capacity = (int)limit.rlim_cur;
+    connections = (Connection*)calloc(connections_capacity, sizeof(Connection));
+    if (connections == NULL) {
+        printf("ERROR: not enough memory for the connections\n");
+        exit(EXIT_FAILURE);
+    }
+
+    timer_wheel_init(&timers, timer_now());
+    queue_accept(&ring, server_socket);
+
+    if (local_listener >= 0) {
+        queue_accept(&ring, local_listener);
+    }
+
+    while (accepting || armed_accepts > 0 || session_pool_used(&session_pool) > 0) {
+        TRACE_DUMP_IF_REQUESTED();
+
+        if (timers.count > 0 && !timeout_armed) {
+            queue_timeout(&ring);
+        }
+
+        if (uring_enter(&ring, 1) < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            perror("IO_URING_ENTER ERROR");
+            exit(EXIT_FAILURE);
+        }
+
+        handle_completions(&ring);
+        timer_wheel_advance(&timers, timer_now(), expire_connection, &ring);
+
+        if (starved_connections > 0 && buffers_recycled) {
+            restart_starved_connections(&ring);
+        }
+
+        if (draining && accepting) {
+            queue_accept_cancel(&ring, server_socket);
+            if (local_listener >= 0) {
+                queue_accept_cancel(&ring, local_listener);
+            }
+
+            stop_accepting(server_socket);
+            accepting = false;
+
+            for (int fd = 0; fd < connections_capacity; ++fd) {
+                if (connections[fd].session != NULL) {
+                    drain_connection(&ring, fd);
+                }
+            }
+        }
+
+        serve_spectators(&ring);
+    }
+
+    close(ring.fd);
+    free(connections);
+
+    return true;
+}
@@ -0,0 +1,13 @@
+/*! @file uring_server.h
+File with the declaration of the io_uring server mode.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef URING_SERVER_H
+#define URING_SERVER_H
+
+#include "../shared/shared.h"
+
+bool run_uring_server(int server_socket);
+
+#endif
@@ -0,0 +1,157 @@
+/*! @file workers.c
+File with the implementation of the worker processes. The main process creates the workers and restarts
+them if they exit. Every worker is pinned to its own CPU, serves its own server socket with SO_REUSEPORT,
+opened by the main process, and serves the clients in the configured mode, so the accept and the move
+throughput grow with the number of cores.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "workers.h"
+
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "server.h"
+
+int worker_id;
+
+/**
+ * @brief CPUs the server is allowed to run on. The workers are distributed over these CPUs.
+ */
+static cpu_set_t available_cpus;
+
+/**
+ * @brief Pins the current process to the CPU of the worker. The workers are distributed over the
+ * available CPUs in a round-robin manner.
+ * @param id Index of the worker.
+ * @return void
+ */
+static void pin_to_cpu(int id) {
+    int target = id % CPU_COUNT(&available_cpus);
+
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &available_cpus)) {
+            continue;
+        }
+
+        if (target-- == 0) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(cpu, &cpus);
+
+            if (sched_setaffinity(0, sizeof(cpus), &cpus) < 0) {
+                perror("SCHED_SETAFFINITY ERROR");
+            }
+
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Starts the worker process. The worker is pinned to its CPU and serves the clients of its server
+ * socket, the sockets of the other workers are closed in the worker.
+ * @param id Index of the worker.
+ * @param sockets Server sockets of the workers.
+ * @param number_of_workers Number of workers.
+ * @return Process ID of the worker.
+ */
+static pid_t start_worker(int id, const int* sockets, int number_of_workers) {
+    pid_t pid = fork();
+    CHECK_LESS_THAN_ZERO(pid, "FORK ERROR");
+
+    if (pid == 0) {
+        for (int i = 0; i < number_of_workers; ++i) {
+            if (i != id) {
+                close(sockets[i]);
+            }
+        }
+
+        worker_id = id;
+        pin_to_cpu(id);
+        serve(sockets[id]);
+        logger_release();
+        exit(EXIT_SUCCESS);
+    }
+
+    return pid;
+}
+
+/**
+ * @brief Runs the worker processes. Creates the workers and restarts every worker that exits. The main
+ * process keeps the server sockets, so a restarted worker serves the same socket and its queue of
+ * connections. On SIGQUIT the workers are told to drain, and the function returns when all of them have
+ * exited.
+ * @param number_of_workers Number of workers.
+ * @param sockets Server sockets of the workers.
+ * @return void
+ */
+void run_workers(int number_of_workers, const int* sockets) {
+    CHECK_LESS_THAN_ZERO(sched_getaffinity(0, sizeof(available_cpus), &available_cpus),
+                         "SCHED_GETAFFINITY ERROR");
+
+    pid_t* workers = (pid_t*)malloc(number_of_workers * sizeof(pid_t));
+    if (workers == NULL) {
+        printf("ERROR: not enough memory for the workers\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for (int i = 0; i < number_of_workers; ++i) {
+        workers[i] = start_worker(i, sockets, number_of_workers);
+    }
+
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGCHLD);
+    sigaddset(&signals, SIGQUIT);
+
+    int running = number_of_workers;
+
+    while (running > 0) {
+        if (sigwaitinfo(&signals, NULL) == SIGQUIT && !draining) {
+            draining = 1;
+
+            for (int i = 0; i < number_of_workers; ++i) {
+                kill(workers[i], SIGQUIT);
+            }
+        }
+
+        int status;
+        pid_t pid;
+
+        while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+            for (int i = 0; i < number_of_workers; ++i) {
+                if (workers[i] != pid) {
+                    continue;
+                }
+
+                if (draining) {
+                    running--;
+                    break;
+                }
+
+                LogRecord* record = log_begin(LOG_EVENT_WORKER_RESTARTED);
+                if (record != NULL) {
+                    record->arguments[0] = i;
+                    log_commit();
+                }
+
+                workers[i] = start_worker(i, sockets, number_of_workers);
+                break;
+            }
+        }
+    }
+
+    free(workers);
+
+    return;
+}
@@ -0,0 +1,17 @@
+/*! @file workers.h
+File with the declaration of the worker processes. Every worker has its own server socket and owns its
+sessions, so the workers do not share any state.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef WORKERS_H
+#define WORKERS_H
+
+/**
+ * @brief Index of the current worker. The index is 0 when the server runs without workers.
+ */
+extern int worker_id;
+
+void run_workers(int number_of_workers, const int* sockets);
+
+#endif
@@ -0,0 +1,443 @@
+/*! @file channel.c
+File with the implementation of the shared-memory channel of a local client. The positions of the rings are
+published with release stores and read with acquire loads. A side that is about to sleep sets its mark and
+checks the ring again after a full fence, and the other side checks the mark after a full fence that
+follows its update of the ring, so one of them always sees the other and no wakeup is lost. The server
+checks every position written by the client, because the memory is shared with another process.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "channel.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "descriptors.h"
+#include "protocol.h"
+
+#define CHANNEL_SPIN_COUNT 1024
+#define CHANNEL_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL)
+
+/**
+ * @brief Channel used by the blocking helpers of the protocol, NULL if the frames go through the socket.
+ */
+static Channel* registered_channel;
+
+/**
+ * @brief Wakes up the peer if it sleeps on the ring.
+ * @param channel Channel.
+ * @param waiting Mark of the peer on the ring.
+ * @return void
+ */
+static void wake_peer(Channel* channel, uint32_t* waiting) {
+    if (__atomic_load_n(waiting, __ATOMIC_RELAXED) == 0) {
+        return;
+    }
+
+    uint64_t one = 1;
+    __atomic_store_n(waiting, 0, __ATOMIC_RELAXED);
+    if (write(channel->peer_wakeup, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+        channel->closed = true;
+    }
+
+    return;
+}
+
+/**
+ * @brief Sets the mark of a side that is about to sleep, so the peer wakes it up after its next update of
+ * the ring.
+ * @param waiting Mark of the side on the ring.
+ * @return void
+ */
+static void mark_waiting(uint32_t* waiting) {
+    __atomic_store_n(waiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    return;
+}
+
+/**
+ * @brief Maps the memory of the channel and sets the rings of the side.
+ * @param channel Channel.
+ * @param memory_fd Memfd of the channel.
+ * @param client true for the side of the client, false for the side of the server.
+ * @return true if the memory was mapped, false otherwise.
+ */
+static bool map_channel(Channel* channel, int memory_fd, bool client) {
+    void* memory = mmap(NULL, sizeof(ChannelMemory), PROT_READ | PROT_WRITE, MAP_SHARED, memory_fd, 0);
+    if (memory == MAP_FAILED) {
+        channel->memory = NULL;
+        return false;
+    }
+
+    channel->memory = (ChannelMemory*)memory;
+    channel->input = client ? &channel->memory->to_client : &channel->memory->to_server;
+    channel->output = client ? &channel->memory->to_server : &channel->memory->to_client;
+    channel->closed = false;
+
+    return true;
+}
+
+/**
+ * @brief Creates the channel of the client and offers it to the server with the channel frame. The size of
+ * the memfd is sealed, so the server can map it without being killed by SIGBUS. The server answers with the
+ * transport frame, on the socket if it refused the channel and in the channel otherwise.
+ * @param channel Channel.
+ * @param socket Socket of the connection to the local socket of the server.
+ * @return true if the channel frame was sent, false otherwise.
+ */
+bool channel_offer(Channel* channel, int socket) {
+    int descriptors[CHANNEL_DESCRIPTORS];
+    char frame[FRAME_HEADER_SIZE];
+    bool offered = false;
+
+    channel->memory = NULL;
+    descriptors[0] = memfd_create("battleship-channel", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    descriptors[1] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    descriptors[2] = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+
+    if (descriptors[0] >= 0 && descriptors[1] >= 0 && descriptors[2] >= 0 &&
+        ftruncate(descriptors[0], sizeof(ChannelMemory)) == 0 &&
+        fcntl(descriptors[0], F_ADD_SEALS, CHANNEL_SEALS) == 0 && map_channel(channel, descriptors[0], true)) {
+        channel->peer_wakeup = descriptors[1];
+        channel->wakeup = descriptors[2];
+        channel->socket = socket;
+
+        size_t size = encode_empty(frame, OP_CHANNEL);
+        offered = send_descriptors(socket, frame, size, descriptors, CHANNEL_DESCRIPTORS) == 0 ? true : false;
+    }
+
+    if (!offered && channel->memory != NULL) {
+        munmap(channel->memory, sizeof(ChannelMemory));
+        channel->memory = NULL;
+    }
+
+    for (int i = 0; i < CHANNEL_DESCRIPTORS; ++i) {
+        if (descriptors[i] >= 0 && (i == 0 || !offered)) {
+            close(descriptors[i]);
+        }
+    }
+
+    return offered;
+}
+
+/**
+ * @brief Attaches the server to the channel offered by the client. The memfd must have the size of the
+ * channel and seals that keep the size, otherwise the client could shrink it under the mapping of the
+ * server. The eventfds are made non-blocking, so the client cannot block the server. The descriptors
+ * are closed if the channel cannot be attached.
+ * @param channel Channel.
+ * @param socket Socket of the client.
+ * @param descriptors Memfd of the channel, eventfd of the server, and eventfd of the client.
+ * @return true if the channel was attached, false otherwise.
+ */
+bool channel_attach(Channel* channel, int socket, const int* descriptors) {
+    struct stat status;
+    int seals = fcntl(descriptors[0], F_GET_SEALS);
+    bool attached = seals >= 0 && (seals & CHANNEL_SEALS) == CHANNEL_SEALS &&
+                    fstat(descriptors[0], &status) == 0 && S_ISREG(status.st_mode) &&
+                    status.st_size == (off_t)sizeof(ChannelMemory) &&
+                    fcntl(descriptors[1], F_SETFL, O_NONBLOCK) == 0 &&
+                    fcntl(descriptors[2], F_SETFL, O_NONBLOCK) == 0 &&
+                    map_channel(channel, descriptors[0], false);
+
+    close(descriptors[0]);
+
+    if (!attached) {
+        close(descriptors[1]);
+        close(descriptors[2]);
+        return false;
+    }
+
+    channel->wakeup = descriptors[1];
+    channel->peer_wakeup = descriptors[2];
+    channel->socket = socket;
+
+    return true;
+}
+
+/**
+ * @brief Unmaps the memory of the channel and closes its eventfds. The socket is closed by the owner of
+ * the connection.
+ * @param channel Channel.
+ * @return void
+ */
+void channel_close(Channel* channel) {
+    if (channel->memory == NULL) {
+        return;
+    }
+
+    if (registered_channel == channel) {
+        registered_channel = NULL;
+    }
+
+    munmap(channel->memory, sizeof(ChannelMemory));
+    close(channel->wakeup);
+    close(channel->peer_wakeup);
+    channel->memory = NULL;
+
+    return;
+}
+
+/**
+ * @brief Takes the available bytes of the input ring. When the ring is empty, the side marks that it
+ * waits, so the peer wakes it up after adding bytes.
+ * @param channel Channel.
+ * @param buffer Destination.
+ * @param size Size of the destination.
+ * @return Number of taken bytes, 0 if the ring is empty and the peer is gone, -1 with errno EAGAIN if the
+ * ring is empty, -1 with errno EPROTO if the peer broke the ring.
+ */
+ssize_t channel_read(Channel* channel, char* buffer, size_t size) {
+    ChannelRing* ring = channel->input;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+    if (tail == head && size > 0) {
+        mark_waiting(&ring->consumer_waiting);
+        tail = __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE);
+
+        if (tail == head && channel->closed) {
+            return 0;
+        }
+
+        if (tail == head) {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        __atomic_store_n(&ring->consumer_waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    if (tail - head > CHANNEL_RING_SIZE) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    size_t available = (size_t)(tail - head);
+    size_t taken = available < size ? available : size;
+    size_t offset = (size_t)(head % CHANNEL_RING_SIZE);
+    size_t first = CHANNEL_RING_SIZE - offset < taken ? CHANNEL_RING_SIZE - offset : taken;
+
+    memcpy(buffer, ring->data + offset, first);
+    memcpy(buffer + first, ring->data, taken - first);
+
+    __atomic_store_n(&ring->head, head + taken, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    wake_peer(channel, &ring->producer_waiting);
+
+    return (ssize_t)taken;
+}
+
+/**
+ * @brief Adds the bytes of the vector to the output ring, as many as fit. When the ring is full, the side
+ * marks that it waits, so the peer wakes it up after taking bytes.
+ * @param channel Channel.
+ * @param vector Parts of the bytes.
+ * @param count Number of the parts.
+ * @return Number of added bytes, -1 with errno EAGAIN if the ring is full, -1 with errno EPIPE if the peer
+ * is gone, -1 with errno EPROTO if the peer broke the ring.
+ */
+ssize_t channel_write(Channel* channel, const struct iovec* vector, int count) {
+    ChannelRing* ring = channel->output;
+    uint64_t tail = __atomic_load_n(&ring->tail, __ATOMIC_RELAXED);
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+    if (channel->closed) {
+        errno = EPIPE;
+        return -1;
+    }
+
+    if (tail - head == CHANNEL_RING_SIZE) {
+        mark_waiting(&ring->producer_waiting);
+        head = __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE);
+
+        if (tail - head == CHANNEL_RING_SIZE) {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        __atomic_store_n(&ring->producer_waiting, 0, __ATOMIC_RELAXED);
+    }
+
+    if (tail - head > CHANNEL_RING_SIZE) {
+        errno = EPROTO;
+        return -1;
+    }
+
+    size_t space = CHANNEL_RING_SIZE - (size_t)(tail - head);
+    size_t added = 0;
+
+    for (int i = 0; i < count && added < space; ++i) {
+        const char* data = (const char*)vector[i].iov_base;
+        size_t length = vector[i].iov_len < space - added ? vector[i].iov_len : space - added;
+        size_t offset = (size_t)((tail + added) % CHANNEL_RING_SIZE);
+        size_t first = CHANNEL_RING_SIZE - offset < length ? CHANNEL_RING_SIZE - offset : length;
+
+        memcpy(ring->data + offset, data, first);
+        memcpy(ring->data, data + first, length - first);
+        added += length;
+    }
+
+    __atomic_store_n(&ring->tail, tail + added, __ATOMIC_RELEASE);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+    wake_peer(channel, &ring->consumer_waiting);
+
+    return (ssize_t)added;
+}
+
+/**
+ * @brief Checks if the input ring has bytes. When it is empty, the side marks that it waits, so it can
+ * sleep on its eventfd afterwards without missing the next bytes.
+ * @param channel Channel.
+ * @return true if the ring has bytes, false if it is empty.
+ */
+bool channel_readable(Channel* channel) {
+    ChannelRing* ring = channel->input;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != head) {
+        return true;
+    }
+
+    mark_waiting(&ring->consumer_waiting);
+
+    return __atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != head ? true : false;
+}
+
+/**
+ * @brief Handles the wakeup of a side that slept on the eventfd and the socket. The counter of the eventfd
+ * is cleared, and a ready socket means that the peer is gone: after the channel frame nothing else is sent
+ * on the socket.
+ * @param channel Channel.
+ * @param socket_ready true if the socket was ready.
+ * @return void
+ */
+void channel_woken(Channel* channel, bool socket_ready) {
+    uint64_t counter;
+
+    if (read(channel->wakeup, &counter, sizeof(counter)) < 0 && errno != EAGAIN) {
+        channel->closed = true;
+    }
+
+    if (socket_ready) {
+        channel->closed = true;
+    }
+
+    return;
+}
+
+/**
+ * @brief Sleeps until the peer wakes the side up or is gone. The side must have marked that it waits.
+ * @param channel Channel.
+ * @return true if the side was woken up, false if the peer is gone.
+ */
+bool channel_wait(Channel* channel) {
+    struct pollfd poll_fds[2] = {{.fd = channel->wakeup, .events = POLLIN},
+                                 {.fd = channel->socket, .events = 0}};
+
+    while (!channel->closed) {
+        if (poll(poll_fds, 2, -1) > 0) {
+            channel_woken(channel, poll_fds[1].revents != 0 ? true : false);
+            return !channel->closed;
+        }
+
+        if (errno != EINTR) {
+            channel->closed = true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Registers the channel for the blocking helpers of the protocol, which then read and write the
+ * frames of its socket through the channel.
+ * @param channel Channel, NULL to use the socket again.
+ * @return void
+ */
+void channel_register(Channel* channel) {
+    registered_channel = channel;
+
+    return;
+}
+
+/**
+ * @brief Returns the channel registered for the socket.
+ * @param socket Socket.
+ * @return Channel, NULL if the frames of the socket do not go through a channel.
+ */
+Channel* channel_of(int socket) {
+    return registered_channel != NULL && registered_channel->socket == socket ? registered_channel : NULL;
+}
+
+/**
+ * @brief Receives at least one byte, like a blocking recv. The side spins for a short time before it
+ * sleeps, because the answer of the server usually comes within microseconds.
+ * @param channel Channel.
+ * @param buffer Destination.
+ * @param size Size of the destination.
+ * @return Number of received bytes, 0 if the peer is gone, -1 on error.
+ */
+ssize_t channel_receive(Channel* channel, char* buffer, size_t size) {
+    ChannelRing* ring = channel->input;
+    uint64_t head = __atomic_load_n(&ring->head, __ATOMIC_RELAXED);
+
+    for (int spin = 0; spin < CHANNEL_SPIN_COUNT; ++spin) {
+        if (__atomic_load_n(&ring->tail, __ATOMIC_ACQUIRE) != head) {
+            break;
+        }
+
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#endif
+    }
+
+    while (true) {
+        ssize_t received = channel_read(channel, buffer, size);
+        if (received >= 0 || errno != EAGAIN) {
+            return received;
+        }
+
+        if (!channel_wait(channel)) {
+            received = channel_read(channel, buffer, size);
+            return received < 0 && errno == EAGAIN ? 0 : received;
+        }
+    }
+}
+
+/**
+ * @brief Sends all bytes, like send_all on a blocking socket.
+ * @param channel Channel.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ * @return 0 on success, -1 if the peer is gone or on error.
+ */
+int channel_send_all(Channel* channel, const char* data, size_t length) {
+    while (length > 0) {
+        struct iovec vector = {.iov_base = (void*)data, .iov_len = length};
+        ssize_t sent = channel_write(channel, &vector, 1);
+
+        if (sent < 0) {
+            if (errno != EAGAIN || !channel_wait(channel)) {
+                return -1;
+            }
+
+            continue;
+        }
+
+        data += sent;
+        length -= sent;
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+/*! @file channel.h
+File with the declaration of the shared-memory channel of a local client. The client connects to the local
+socket of the server, maps a memfd with two single-producer single-consumer rings, one per direction, and
+passes the memfd and two eventfds to the server with the channel frame. From then on the frames of both
+sides go through the rings instead of the socket, which stays open only to tell that the peer is gone. A
+side that finds its ring empty, or the ring of the peer full, marks that it waits and sleeps on its
+eventfd; the other side writes to that eventfd only when the mark is set, so a busy channel moves the
+frames without system calls.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef CHANNEL_H
+#define CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+
+#include "shared.h"
+
+#define CHANNEL_RING_SIZE 8192
+#define CHANNEL_DESCRIPTORS 3
+#define CHANNEL_CACHE_LINE_SIZE 64
+
+/**
+ * @struct ChannelRing
+ * @brief Structure for a ring of bytes with one producer and one consumer. The positions only grow, the
+ * byte of a position is at the position modulo CHANNEL_RING_SIZE.
+ *
+ * @param head Number of bytes taken by the consumer.
+ * @param consumer_waiting Set by the consumer that sleeps until the producer adds bytes.
+ * @param tail Number of bytes added by the producer.
+ * @param producer_waiting Set by the producer that sleeps until the consumer frees space.
+ * @param data Bytes of the ring.
+ */
+typedef struct {
+    _Alignas(CHANNEL_CACHE_LINE_SIZE) uint64_t head;
+    uint32_t consumer_waiting;
+    _Alignas(CHANNEL_CACHE_LINE_SIZE) uint64_t tail;
+    uint32_t producer_waiting;
+    _Alignas(CHANNEL_CACHE_LINE_SIZE) char data[CHANNEL_RING_SIZE];
+} ChannelRing;
+
+/**
+ * @struct ChannelMemory
+ * @brief Structure for the memory shared by the client and the server.
+ *
+ * @param to_server Ring of the frames of the client.
+ * @param to_client Ring of the frames of the server.
+ */
+typedef struct {
+    ChannelRing to_server;
+    ChannelRing to_client;
+} ChannelMemory;
+
+/**
+ * @struct Channel
+ * @brief Structure for one side of a channel.
+ *
+ * @param memory Mapped memory of the channel, NULL if there is no channel.
+ * @param input Ring the side consumes.
+ * @param output Ring the side produces.
+ * @param wakeup Eventfd the side sleeps on.
+ * @param peer_wakeup Eventfd the peer sleeps on.
+ * @param socket Socket of the connection, closed by the peer when it is gone.
+ * @param closed true if the peer is gone.
+ */
+typedef struct {
+    ChannelMemory* memory;
+    ChannelRing* input;
+    ChannelRing* output;
+    int wakeup;
+    int peer_wakeup;
+    int socket;
+    bool closed;
+} Channel;
+
+bool channel_offer(Channel* channel, int socket);
+bool channel_attach(Channel* channel, int socket, const int* descriptors);
+void channel_close(Channel* channel);
+ssize_t channel_read(Channel* channel, char* buffer, size_t size);
+ssize_t channel_write(Channel* channel, const struct iovec* vector, int count);
+bool channel_readable(Channel* channel);
+void channel_woken(Channel* channel, bool socket_ready);
+bool channel_wait(Channel* channel);
+void channel_register(Channel* channel);
+Channel* channel_of(int socket);
+ssize_t channel_receive(Channel* channel, char* buffer, size_t size);
+int channel_send_all(Channel* channel, const char* data, size_t length);
+
+#endif
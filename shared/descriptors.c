@@ -0,0 +1,122 @@
+/*! @file descriptors.c
+File with the implementation of the passing of file descriptors over a UNIX socket.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#define _GNU_SOURCE
+
+#include "descriptors.h"
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * @brief Buffer of the control message with the descriptors, aligned for its header.
+ */
+typedef union {
+    char buffer[CMSG_SPACE(sizeof(int) * MAX_PASSED_DESCRIPTORS)];
+    struct cmsghdr align;
+} DescriptorControl;
+
+/**
+ * @brief Function to send the descriptors with the data in one message.
+ *
+ * @param socket Connected UNIX socket.
+ * @param data Data of the message, at least one byte.
+ * @param size Size of the data.
+ * @param descriptors Descriptors to pass.
+ * @param count Number of the descriptors, at most MAX_PASSED_DESCRIPTORS.
+ * @return 0 if the whole message was sent, -1 otherwise.
+ */
+int send_descriptors(int socket, const void* data, size_t size, const int* descriptors, int count) {
+    struct iovec vector = {.iov_base = (void*)data, .iov_len = size};
+    DescriptorControl control;
+
+    memset(&control, 0, sizeof(control));
+
+    struct msghdr message = {
+        .msg_iov = &vector,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = CMSG_SPACE(sizeof(int) * count),
+    };
+
+    struct cmsghdr* header = CMSG_FIRSTHDR(&message);
+    header->cmsg_level = SOL_SOCKET;
+    header->cmsg_type = SCM_RIGHTS;
+    header->cmsg_len = CMSG_LEN(sizeof(int) * count);
+    memcpy(CMSG_DATA(header), descriptors, sizeof(int) * count);
+
+    ssize_t sent;
+    do {
+        sent = sendmsg(socket, &message, MSG_NOSIGNAL);
+    } while (sent < 0 && errno == EINTR);
+
+    return sent == (ssize_t)size ? 0 : -1;
+}
+
+/**
+ * @brief Function to receive the data and the passed descriptors of one message. The descriptors are
+ * received with close-on-exec. A message with more descriptors than the capacity is an error, and its
+ * descriptors are closed.
+ *
+ * @param socket Connected UNIX socket.
+ * @param data Buffer of the data.
+ * @param size Size of the buffer.
+ * @param descriptors Received descriptors.
+ * @param capacity Maximum number of the descriptors, at most MAX_PASSED_DESCRIPTORS.
+ * @param count Number of the received descriptors, 0 if the message carried none.
+ * @param flags Flags of recvmsg.
+ * @return Number of the received bytes, 0 if the connection was closed, -1 on error.
+ */
+ssize_t receive_descriptors(int socket, void* data, size_t size, int* descriptors, int capacity, int* count,
+                            int flags) {
+    struct iovec vector = {.iov_base = data, .iov_len = size};
+    DescriptorControl control;
+
+    struct msghdr message = {
+        .msg_iov = &vector,
+        .msg_iovlen = 1,
+        .msg_control = control.buffer,
+        .msg_controllen = CMSG_SPACE(sizeof(int) * capacity),
+    };
+
+    *count = 0;
+
+    ssize_t received = recvmsg(socket, &message, flags | MSG_CMSG_CLOEXEC);
+    if (received < 0) {
+        return received;
+    }
+
+    for (struct cmsghdr* header = CMSG_FIRSTHDR(&message); header != NULL;
+         header = CMSG_NXTHDR(&message, header)) {
+        if (header->cmsg_level != SOL_SOCKET || header->cmsg_type != SCM_RIGHTS) {
+            continue;
+        }
+
+        int passed = (int)((header->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+        int* passed_descriptors = (int*)CMSG_DATA(header);
+
+        for (int i = 0; i < passed; ++i) {
+            if (*count < capacity) {
+                descriptors[(*count)++] = passed_descriptors[i];
+            } else {
+                close(passed_descriptors[i]);
+            }
+        }
+    }
+
+    if (message.msg_flags & MSG_CTRUNC) {
+        for (int i = 0; i < *count; ++i) {
+            close(descriptors[i]);
+        }
+
+        *count = 0;
+        errno = EMSGSIZE;
+        return -1;
+    }
+
+    return received;
+}
@@ -0,0 +1,21 @@
+/*! @file descriptors.h
+File with the declaration of the passing of file descriptors over a UNIX socket. The descriptors travel in
+the SCM_RIGHTS control message of one message with a few bytes of data, so the receiver can tell the
+message from the rest of the stream. Used by the handoff of the server sockets and by the shared-memory
+channels of the local clients.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef DESCRIPTORS_H
+#define DESCRIPTORS_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#define MAX_PASSED_DESCRIPTORS 253
+
+int send_descriptors(int socket, const void* data, size_t size, const int* descriptors, int count);
+ssize_t receive_descriptors(int socket, void* data, size_t size, int* descriptors, int capacity, int* count,
+                            int flags);
+
+#endif
@@ -0,0 +1,159 @@
+/*! @file journal_format.h
+File with the format of the game journal, shared by the server that writes it and the analyzer that reads
+it. The journal is a sequence of segment files of the same size. Every segment starts with a header and is
+followed by records aligned to JOURNAL_ALIGNMENT bytes; a record with the length 0 ends the segment, and a
+record with the type JOURNAL_SKIP is stepped over. The records of one session are in the order they were
+played, and a later segment has later records. The numbers are in the byte order of the server.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef JOURNAL_FORMAT_H
+#define JOURNAL_FORMAT_H
+
+#include <stdint.h>
+
+#define JOURNAL_MAGIC 0x4c4e524a
+#define JOURNAL_VERSION 4
+#define JOURNAL_ALIGNMENT 8
+#define JOURNAL_NAME_SIZE 16
+#define JOURNAL_ALIGN(size) (((size) + JOURNAL_ALIGNMENT - 1) & ~(size_t)(JOURNAL_ALIGNMENT - 1))
+#define JOURNAL_MAX_RECORD_SIZE (UINT16_MAX & ~(JOURNAL_ALIGNMENT - 1))
+
+/**
+ * @brief Enumeration for the type of a record of the journal.
+ */
+typedef enum {
+    JOURNAL_SKIP,      /**< The record was not written completely, its writer stopped or was killed */
+    JOURNAL_START,     /**< The game was started, JournalStart */
+    JOURNAL_MOVE,      /**< The move was played, JournalMove */
+    JOURNAL_END        /**< The session was finished, JournalEnd */
+} JournalType;
+
+/**
+ * @brief Enumeration for the reason the session was finished.
+ */
+typedef enum {
+    JOURNAL_END_GAME_OVER, /**< The game was won or lost */
+    JOURNAL_END_TIMEOUT,   /**< The player was idle for too long, the game is lost */
+    JOURNAL_END_CLOSED     /**< The connection was closed before the end of the game */
+} JournalEndReason;
+
+/**
+ * @struct JournalSegmentHeader
+ * @brief Structure for the header at the beginning of every segment.
+ *
+ * @param magic JOURNAL_MAGIC.
+ * @param version JOURNAL_VERSION.
+ * @param header_size Size of the header, the first record follows it.
+ * @param segment Number of the segment, the segments of a run are numbered from 0.
+ * @param run Start time of the server in seconds since the epoch, the same for all segments of a run.
+ * @param size Size of the segment file.
+ */
+typedef struct {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size;
+    uint32_t segment;
+    uint32_t reserved;
+    uint64_t run;
+    uint64_t size;
+} JournalSegmentHeader;
+
+/**
+ * @struct JournalRecord
+ * @brief Structure for the header of every record. The length is written when the place of the record is
+ * taken and the type is written last, so a record with the type JOURNAL_SKIP was not written completely.
+ *
+ * @param length Size of the record with its header and padding.
+ * @param type Type of the record.
+ * @param worker Index of the worker that played the session.
+ * @param session Number of the session, unique within the run and never 0.
+ */
+typedef struct {
+    uint16_t length;
+    uint8_t type;
+    uint8_t worker;
+    uint32_t session;
+} JournalRecord;
+
+/**
+ * @struct JournalStart
+ * @brief Structure for the record of the start of a game. It is followed by the cells of the board with a
+ * ship or a shot, 32 bits each: the cell y * field_size + x with the column x and the row y, and its
+ * CellState in the bits from MARKED_CELL_STATE_SHIFT. A resumed game starts with the shots and the counters
+ * it had, a new game without shots. If the cells do not fit into JOURNAL_MAX_RECORD_SIZE, the record has
+ * none of them, and the board of a new game with a seed is placed again from the seed.
+ *
+ * @param header Header of the record.
+ * @param seed Seed of the board.
+ * @param time Start time of the game in milliseconds since the epoch.
+ * @param field_size Size of the game board.
+ * @param number_of_ships Number of ships on the game board.
+ * @param number_of_moves Number of missed moves that ends the game.
+ * @param protocol Wire protocol of the player.
+ * @param ships_left Number of ships left on the board.
+ * @param missed Number of missed moves.
+ * @param moves Number of moves played before.
+ * @param cells Number of the cells that follow the record.
+ * @param name Name of the player.
+ */
+typedef struct {
+    JournalRecord header;
+    uint64_t seed;
+    uint64_t time;
+    uint16_t field_size;
+    uint16_t number_of_ships;
+    uint16_t number_of_moves;
+    uint16_t protocol;
+    uint16_t ships_left;
+    uint16_t missed;
+    uint32_t moves;
+    uint32_t cells;
+    uint32_t reserved;
+    char name[JOURNAL_NAME_SIZE];
+} JournalStart;
+
+/**
+ * @struct JournalMove
+ * @brief Structure for the record of a move.
+ *
+ * @param header Header of the record.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ */
+typedef struct {
+    JournalRecord header;
+    uint16_t x;
+    uint16_t y;
+    uint8_t result;
+    uint8_t status;
+    uint16_t reserved;
+} JournalMove;
+
+/**
+ * @struct JournalEnd
+ * @brief Structure for the record of the end of a session.
+ *
+ * @param header Header of the record.
+ * @param field_size Size of the game board, repeated so the statistics need no other record.
+ * @param status Final status of the game, NEXT if the connection was closed.
+ * @param reason Reason the session was finished.
+ * @param ships_left Number of ships left on the board.
+ * @param missed Number of missed moves.
+ * @param moves Number of moves played.
+ * @param duration Duration of the game in milliseconds.
+ */
+typedef struct {
+    JournalRecord header;
+    uint16_t field_size;
+    uint8_t status;
+    uint8_t reason;
+    uint16_t ships_left;
+    uint16_t missed;
+    uint32_t moves;
+    uint32_t duration;
+} JournalEnd;
+
+#endif
@@ -0,0 +1,896 @@
+/*! @file protocol.c
+File with the implementation of the wire protocol of the battleship game.
+The encoders write complete frames into the provided buffer and return their size. The decoder works on
+any amount of received bytes: it returns 0 until the whole frame is available, so the caller can keep
+the bytes and try again after the next read.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "protocol.h"
+
+#include <ctype.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "channel.h"
+
+/**
+ * @brief Messages of the move results in the legacy protocol, indexed by MoveResult.
+ */
+static const char* move_result_messages[] = {"Miss", "Hit", "Already hit", "Already missed", "Invalid move"};
+
+/**
+ * @brief Function to write a 16-bit value in network byte order.
+ *
+ * @param buffer Destination.
+ * @param value Value.
+ * @return void
+ */
+static inline void write_u16(char* buffer, uint16_t value) {
+    buffer[0] = (char)(value >> 8);
+    buffer[1] = (char)value;
+}
+
+/**
+ * @brief Function to write a 32-bit value in network byte order.
+ *
+ * @param buffer Destination.
+ * @param value Value.
+ * @return void
+ */
+static inline void write_u32(char* buffer, uint32_t value) {
+    write_u16(buffer, (uint16_t)(value >> 16));
+    write_u16(buffer + 2, (uint16_t)value);
+}
+
+/**
+ * @brief Function to write a 64-bit value in network byte order.
+ *
+ * @param buffer Destination.
+ * @param value Value.
+ * @return void
+ */
+static inline void write_u64(char* buffer, uint64_t value) {
+    write_u32(buffer, (uint32_t)(value >> 32));
+    write_u32(buffer + 4, (uint32_t)value);
+}
+
+/**
+ * @brief Function to read a 16-bit value in network byte order.
+ *
+ * @param data Source.
+ * @return Value.
+ */
+static inline uint16_t read_u16(const uint8_t* data) {
+    return (uint16_t)(data[0] << 8 | data[1]);
+}
+
+/**
+ * @brief Function to read a 32-bit value in network byte order.
+ *
+ * @param data Source.
+ * @return Value.
+ */
+static inline uint32_t read_u32(const uint8_t* data) {
+    return (uint32_t)read_u16(data) << 16 | read_u16(data + 2);
+}
+
+/**
+ * @brief Function to read a 64-bit value in network byte order.
+ *
+ * @param data Source.
+ * @return Value.
+ */
+static inline uint64_t read_u64(const uint8_t* data) {
+    return (uint64_t)read_u32(data) << 32 | read_u32(data + 4);
+}
+
+/**
+ * @brief Function to write the header of the frame.
+ *
+ * @param buffer Destination.
+ * @param opcode Opcode of the frame.
+ * @param length Length of the payload.
+ * @return Size of the header.
+ */
+static size_t encode_header(char* buffer, Opcode opcode, uint16_t length) {
+    buffer[0] = (char)opcode;
+    write_u16(buffer + 1, length);
+
+    return FRAME_HEADER_SIZE;
+}
+
+/**
+ * @brief Function to decode the frame at the beginning of the data.
+ *
+ * @param data Received bytes.
+ * @param length Number of received bytes.
+ * @param frame Decoded frame.
+ * @return Size of the frame, 0 if the frame is not complete yet, -1 if the frame is invalid.
+ */
+int decode_frame(const char* data, size_t length, Frame* frame) {
+    if (length < FRAME_HEADER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t* bytes = (const uint8_t*)data;
+    uint16_t payload_length = read_u16(bytes + 1);
+
+    if (payload_length > MAX_FRAME_PAYLOAD) {
+        return -1;
+    }
+
+    if (length < FRAME_HEADER_SIZE + (size_t)payload_length) {
+        return 0;
+    }
+
+    frame->opcode = bytes[0];
+    frame->length = payload_length;
+    frame->payload = bytes + FRAME_HEADER_SIZE;
+
+    return FRAME_HEADER_SIZE + payload_length;
+}
+
+/**
+ * @brief Function to encode the frame with the version and a name, padded to BUF_MESSAGE_SIZE bytes.
+ *
+ * @param buffer Destination of BUF_MESSAGE_SIZE bytes.
+ * @param opcode Opcode of the frame.
+ * @param name Name.
+ * @return Size of the frame.
+ */
+static size_t encode_name(char* buffer, Opcode opcode, const char* name) {
+    size_t size = encode_header(buffer, opcode, 1 + HELLO_NAME_SIZE);
+
+    buffer[size++] = PROTOCOL_VERSION;
+    memset(buffer + size, 0, HELLO_NAME_SIZE);
+    strncpy(buffer + size, name, HELLO_NAME_SIZE - 1);
+
+    return size + HELLO_NAME_SIZE;
+}
+
+/**
+ * @brief Function to encode the hello frame. The frame is padded to BUF_MESSAGE_SIZE bytes, so a server
+ * that speaks only the legacy protocol reads it as one name frame and answers in the legacy protocol.
+ *
+ * @param buffer Destination of BUF_MESSAGE_SIZE bytes.
+ * @param name Name of the player.
+ * @return Size of the frame.
+ */
+size_t encode_hello(char* buffer, const char* name) {
+    return encode_name(buffer, OP_HELLO, name);
+}
+
+/**
+ * @brief Function to encode the watch frame. Like the hello frame, it is padded to BUF_MESSAGE_SIZE bytes.
+ *
+ * @param buffer Destination of BUF_MESSAGE_SIZE bytes.
+ * @param name Name of the player whose game to watch.
+ * @return Size of the frame.
+ */
+size_t encode_watch(char* buffer, const char* name) {
+    return encode_name(buffer, OP_WATCH, name);
+}
+
+/**
+ * @brief Function to encode the resume frame. Like the hello frame, it is padded to BUF_MESSAGE_SIZE bytes.
+ *
+ * @param buffer Destination of BUF_MESSAGE_SIZE bytes.
+ * @param token Resume token of the game.
+ * @return Size of the frame.
+ */
+size_t encode_resume(char* buffer, uint64_t token) {
+    size_t size = encode_header(buffer, OP_RESUME, RESUME_SIZE);
+
+    memset(buffer + size, 0, RESUME_SIZE);
+    buffer[size] = PROTOCOL_VERSION;
+    write_u64(buffer + size + 1, token);
+
+    return size + RESUME_SIZE;
+}
+
+/**
+ * @brief Function to encode the parameters of the game. The resume token is only sent to the clients of
+ * TOKEN_PROTOCOL_VERSION or later, the older clients expect the frame without it.
+ *
+ * @param buffer Destination.
+ * @param field_size Size of the game board.
+ * @param number_of_ships Number of ships.
+ * @param number_of_moves Number of missed moves that ends the game.
+ * @param token Resume token of the game, 0 to send the frame without the token.
+ * @return Size of the frame.
+ */
+size_t encode_params(char* buffer, int field_size, int number_of_ships, int number_of_moves, uint64_t token) {
+    size_t length = token != 0 ? PARAMS_TOKEN_SIZE : PARAMS_SIZE;
+    size_t size = encode_header(buffer, OP_PARAMS, (uint16_t)length);
+
+    buffer[size] = PROTOCOL_VERSION;
+    write_u16(buffer + size + 1, (uint16_t)field_size);
+    write_u32(buffer + size + 3, (uint32_t)number_of_ships);
+    write_u32(buffer + size + 7, (uint32_t)number_of_moves);
+
+    if (token != 0) {
+        write_u64(buffer + size + PARAMS_SIZE, token);
+    }
+
+    return size + length;
+}
+
+/**
+ * @brief Function to get the size of a bitmask of the cells in the state frame.
+ *
+ * @param field_size Size of the game board.
+ * @return Size of the bitmask, 0 if the bitmasks of the board do not fit into a frame.
+ */
+static size_t state_mask_size(int field_size) {
+    size_t mask_size = ((size_t)field_size * field_size + 7) / 8;
+
+    return 8 + 2 * mask_size <= MAX_FRAME_PAYLOAD ? mask_size : 0;
+}
+
+/**
+ * @brief Function to encode the state of the resumed game: the counters followed by two bitmasks of the
+ * cells, the shots and the hits. The bit y * field_size + x of a bitmask is the cell with the column x and
+ * the row y. The bitmasks of a board too large for a frame are left out, and the client starts with a
+ * board without shots.
+ *
+ * @param buffer Destination of MAX_FRAME_SIZE bytes.
+ * @param ships_left Number of ships left on the board.
+ * @param missed Number of missed moves.
+ * @param board Game board.
+ * @return Size of the frame.
+ */
+size_t encode_state(char* buffer, int ships_left, int missed, const GameBoard* board) {
+    int field_size = board->field_size;
+    size_t mask_size = state_mask_size(field_size);
+    size_t size = encode_header(buffer, OP_STATE, (uint16_t)(8 + 2 * mask_size));
+    char* shots = buffer + size + 8;
+    char* hits = shots + mask_size;
+
+    write_u32(buffer + size, (uint32_t)ships_left);
+    write_u32(buffer + size + 4, (uint32_t)missed);
+    memset(shots, 0, 2 * mask_size);
+
+    for (int y = 0; y < field_size && mask_size != 0; ++y) {
+        for (int x = 0; x < field_size; ++x) {
+            int cell = y * field_size + x;
+            CellState state = board_get_cell(board, x, y);
+
+            if (state == CELL_MISS || state == CELL_HIT) {
+                shots[cell / 8] |= (char)(1 << (cell % 8));
+            }
+
+            if (state == CELL_HIT) {
+                hits[cell / 8] |= (char)(1 << (cell % 8));
+            }
+        }
+    }
+
+    return size + 8 + 2 * mask_size;
+}
+
+/**
+ * @brief Function to encode the move.
+ *
+ * @param buffer Destination.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return Size of the frame.
+ */
+size_t encode_move(char* buffer, int x, int y) {
+    size_t size = encode_header(buffer, OP_MOVE, 4);
+
+    write_u16(buffer + size, (uint16_t)x);
+    write_u16(buffer + size + 2, (uint16_t)y);
+
+    return size + 4;
+}
+
+/**
+ * @brief Function to encode the result of the move.
+ *
+ * @param buffer Destination.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @return Size of the frame.
+ */
+size_t encode_result(char* buffer, MoveResult result, GameStatus status) {
+    size_t size = encode_header(buffer, OP_RESULT, 2);
+
+    buffer[size] = (char)result;
+    buffer[size + 1] = (char)status;
+
+    return size + 2;
+}
+
+/**
+ * @brief Function to encode the batch of moves. The server answers the batch with one frame of results.
+ *
+ * @param buffer Destination.
+ * @param moves Moves.
+ * @param count Number of moves, at most MAX_BATCH_MOVES.
+ * @return Size of the frame.
+ */
+size_t encode_move_batch(char* buffer, const Move* moves, int count) {
+    size_t size = encode_header(buffer, OP_MOVE_BATCH, (uint16_t)(count * 4));
+
+    for (int i = 0; i < count; ++i) {
+        write_u16(buffer + size, (uint16_t)moves[i].x);
+        write_u16(buffer + size + 2, (uint16_t)moves[i].y);
+        size += 4;
+    }
+
+    return size;
+}
+
+/**
+ * @brief Function to encode the results of the batch of moves. The moves after the end of the game are not
+ * processed, so there can be fewer results than moves.
+ *
+ * @param buffer Destination of at least MAX_RESULT_BATCH_SIZE bytes.
+ * @param results Results of the processed moves.
+ * @param count Number of processed moves.
+ * @param status Status of the game after the last processed move.
+ * @return Size of the frame.
+ */
+size_t encode_result_batch(char* buffer, const MoveResult* results, int count, GameStatus status) {
+    size_t size = encode_header(buffer, OP_RESULT_BATCH, (uint16_t)(2 + count));
+
+    buffer[size++] = (char)status;
+    buffer[size++] = (char)count;
+
+    for (int i = 0; i < count; ++i) {
+        buffer[size++] = (char)results[i];
+    }
+
+    return size;
+}
+
+/**
+ * @brief Function to encode the event of a watched game. The counters fit into 16 bits, like the number of
+ * ships and moves of the game parameters.
+ *
+ * @param buffer Destination.
+ * @param event Move of the game.
+ * @return Size of the frame.
+ */
+size_t encode_event(char* buffer, const GameEvent* event) {
+    size_t size = encode_header(buffer, OP_EVENT, EVENT_SIZE);
+
+    write_u16(buffer + size, (uint16_t)event->x);
+    write_u16(buffer + size + 2, (uint16_t)event->y);
+    buffer[size + 4] = (char)event->result;
+    buffer[size + 5] = (char)event->status;
+    write_u16(buffer + size + 6, (uint16_t)event->ships_left);
+    write_u16(buffer + size + 8, (uint16_t)event->missed);
+
+    return size + EVENT_SIZE;
+}
+
+/**
+ * @brief Function to encode the answer to the channel frame.
+ *
+ * @param buffer Destination of FRAME_HEADER_SIZE + TRANSPORT_SIZE bytes.
+ * @param channel true if the next frames go through the shared-memory channel, false if they stay on the
+ * socket.
+ * @return Size of the frame.
+ */
+size_t encode_transport(char* buffer, bool channel) {
+    size_t size = encode_header(buffer, OP_TRANSPORT, TRANSPORT_SIZE);
+    buffer[size] = channel ? 1 : 0;
+
+    return size + TRANSPORT_SIZE;
+}
+
+/**
+ * @brief Function to encode a frame without payload, like the rematch and the quit frames.
+ *
+ * @param buffer Destination of FRAME_HEADER_SIZE bytes.
+ * @param opcode Opcode of the frame.
+ * @return Size of the frame.
+ */
+size_t encode_empty(char* buffer, Opcode opcode) {
+    return encode_header(buffer, opcode, 0);
+}
+
+/**
+ * @brief Function to decode the frame with the version and a name.
+ *
+ * @param frame Frame.
+ * @param opcode Expected opcode.
+ * @param version Version of the protocol of the client.
+ * @param name Name, at least HELLO_NAME_SIZE bytes.
+ * @return true if the frame is a valid frame of the opcode, false otherwise.
+ */
+static bool decode_name(const Frame* frame, Opcode opcode, int* version, char* name) {
+    if (frame->opcode != opcode || frame->length != 1 + HELLO_NAME_SIZE) {
+        return false;
+    }
+
+    *version = frame->payload[0];
+    memcpy(name, frame->payload + 1, HELLO_NAME_SIZE);
+    name[HELLO_NAME_SIZE - 1] = '\0';
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the hello frame.
+ *
+ * @param frame Frame.
+ * @param version Version of the protocol of the client.
+ * @param name Name of the player, at least HELLO_NAME_SIZE bytes.
+ * @return true if the frame is a valid hello frame, false otherwise.
+ */
+bool decode_hello(const Frame* frame, int* version, char* name) {
+    return decode_name(frame, OP_HELLO, version, name);
+}
+
+/**
+ * @brief Function to decode the watch frame.
+ *
+ * @param frame Frame.
+ * @param version Version of the protocol of the spectator.
+ * @param name Name of the player whose game to watch, at least HELLO_NAME_SIZE bytes.
+ * @return true if the frame is a valid watch frame, false otherwise.
+ */
+bool decode_watch(const Frame* frame, int* version, char* name) {
+    return decode_name(frame, OP_WATCH, version, name);
+}
+
+/**
+ * @brief Function to decode the resume frame.
+ *
+ * @param frame Frame.
+ * @param version Version of the protocol of the client.
+ * @param token Resume token of the game.
+ * @return true if the frame is a valid resume frame, false otherwise.
+ */
+bool decode_resume(const Frame* frame, int* version, uint64_t* token) {
+    if (frame->opcode != OP_RESUME || frame->length != RESUME_SIZE) {
+        return false;
+    }
+
+    *version = frame->payload[0];
+    *token = read_u64(frame->payload + 1);
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the parameters of the game.
+ *
+ * @param frame Frame.
+ * @param version Version of the protocol of the server.
+ * @param field_size Size of the game board.
+ * @param number_of_ships Number of ships.
+ * @param number_of_moves Number of missed moves that ends the game.
+ * @param token Resume token of the game, 0 if the server sent none. May be NULL.
+ * @return true if the frame is a valid parameters frame, false otherwise.
+ */
+bool decode_params(const Frame* frame, int* version, int* field_size, int* number_of_ships,
+                   int* number_of_moves, uint64_t* token) {
+    if (frame->opcode != OP_PARAMS || (frame->length != PARAMS_SIZE && frame->length != PARAMS_TOKEN_SIZE)) {
+        return false;
+    }
+
+    *version = frame->payload[0];
+    *field_size = read_u16(frame->payload + 1);
+    *number_of_ships = (int)read_u32(frame->payload + 3);
+    *number_of_moves = (int)read_u32(frame->payload + 7);
+
+    if (token != NULL) {
+        *token = frame->length == PARAMS_TOKEN_SIZE ? read_u64(frame->payload + PARAMS_SIZE) : 0;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the state of the resumed game. The shots and the hits are marked on the board,
+ * which must be empty and have the size of the game.
+ *
+ * @param frame Frame.
+ * @param ships_left Number of ships left on the board.
+ * @param missed Number of missed moves.
+ * @param board Game board.
+ * @return true if the frame is a valid state frame for the board, false otherwise.
+ */
+bool decode_state(const Frame* frame, int* ships_left, int* missed, GameBoard* board) {
+    int field_size = board->field_size;
+    size_t mask_size = state_mask_size(field_size);
+
+    if (frame->opcode != OP_STATE || frame->length != 8 + 2 * mask_size) {
+        return false;
+    }
+
+    const uint8_t* shots = frame->payload + 8;
+    const uint8_t* hits = shots + mask_size;
+
+    *ships_left = (int)read_u32(frame->payload);
+    *missed = (int)read_u32(frame->payload + 4);
+
+    for (int cell = 0; mask_size != 0 && cell < field_size * field_size; ++cell) {
+        if (hits[cell / 8] & (1 << (cell % 8))) {
+            board_set_ship(board, cell % field_size, cell / field_size);
+        }
+
+        if (shots[cell / 8] & (1 << (cell % 8))) {
+            board_set_shot(board, cell % field_size, cell / field_size);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the move.
+ *
+ * @param frame Frame.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return true if the frame is a valid move frame, false otherwise.
+ */
+bool decode_move(const Frame* frame, int* x, int* y) {
+    if (frame->opcode != OP_MOVE || frame->length != 4) {
+        return false;
+    }
+
+    *x = read_u16(frame->payload);
+    *y = read_u16(frame->payload + 2);
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the result of the move.
+ *
+ * @param frame Frame.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @return true if the frame is a valid result frame, false otherwise.
+ */
+bool decode_result(const Frame* frame, MoveResult* result, GameStatus* status) {
+    if (frame->opcode != OP_RESULT || frame->length != 2 || frame->payload[0] > MOVE_INVALID ||
+        frame->payload[1] > LOSE) {
+        return false;
+    }
+
+    *result = (MoveResult)frame->payload[0];
+    *status = (GameStatus)frame->payload[1];
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the event of a watched game.
+ *
+ * @param frame Frame.
+ * @param event Move of the game.
+ * @return true if the frame is a valid event frame, false otherwise.
+ */
+bool decode_event(const Frame* frame, GameEvent* event) {
+    if (frame->opcode != OP_EVENT || frame->length != EVENT_SIZE || frame->payload[4] > MOVE_INVALID ||
+        frame->payload[5] > LOSE) {
+        return false;
+    }
+
+    event->x = read_u16(frame->payload);
+    event->y = read_u16(frame->payload + 2);
+    event->result = (MoveResult)frame->payload[4];
+    event->status = (GameStatus)frame->payload[5];
+    event->ships_left = read_u16(frame->payload + 6);
+    event->missed = read_u16(frame->payload + 8);
+
+    return true;
+}
+
+/**
+ * @brief Function to decode the batch of moves.
+ *
+ * @param frame Frame.
+ * @param moves Moves, at least MAX_BATCH_MOVES elements.
+ * @return Number of moves, -1 if the frame is not a valid batch of moves.
+ */
+int decode_move_batch(const Frame* frame, Move* moves) {
+    if (frame->opcode != OP_MOVE_BATCH || frame->length == 0 || frame->length % 4 != 0) {
+        return -1;
+    }
+
+    int count = frame->length / 4;
+    for (int i = 0; i < count; ++i) {
+        moves[i].x = read_u16(frame->payload + 4 * i);
+        moves[i].y = read_u16(frame->payload + 4 * i + 2);
+    }
+
+    return count;
+}
+
+/**
+ * @brief Function to decode the results of the batch of moves.
+ *
+ * @param frame Frame.
+ * @param results Results, at least MAX_BATCH_MOVES elements.
+ * @param status Status of the game after the last processed move.
+ * @return Number of results, -1 if the frame is not a valid batch of results.
+ */
+int decode_result_batch(const Frame* frame, MoveResult* results, GameStatus* status) {
+    if (frame->opcode != OP_RESULT_BATCH || frame->length < 2 || frame->payload[0] > LOSE ||
+        frame->payload[1] != frame->length - 2 || frame->payload[1] > MAX_BATCH_MOVES) {
+        return -1;
+    }
+
+    int count = frame->payload[1];
+    for (int i = 0; i < count; ++i) {
+        if (frame->payload[2 + i] > MOVE_INVALID) {
+            return -1;
+        }
+
+        results[i] = (MoveResult)frame->payload[2 + i];
+    }
+
+    *status = (GameStatus)frame->payload[0];
+
+    return count;
+}
+
+/**
+ * @brief Function to decode a frame without payload.
+ *
+ * @param frame Frame.
+ * @param opcode Expected opcode.
+ * @return true if the frame has the opcode and no payload, false otherwise.
+ */
+bool decode_empty(const Frame* frame, Opcode opcode) {
+    return frame->opcode == opcode && frame->length == 0 ? true : false;
+}
+
+/**
+ * @brief Function to decode the answer to the channel frame.
+ *
+ * @param frame Frame.
+ * @param channel true if the next frames go through the shared-memory channel.
+ * @return true if the frame is a valid transport frame, false otherwise.
+ */
+bool decode_transport(const Frame* frame, bool* channel) {
+    if (frame->opcode != OP_TRANSPORT || frame->length != TRANSPORT_SIZE || frame->payload[0] > 1) {
+        return false;
+    }
+
+    *channel = frame->payload[0] == 1 ? true : false;
+
+    return true;
+}
+
+/**
+ * @brief Function to parse the move of the legacy protocol. The move is the letters of the column followed
+ * by the number of the row, for example "B4" or "AB1200". The column has at most MAX_COLUMN_LETTERS
+ * letters, and the number of the row at most 9 digits, so the coordinates never overflow.
+ *
+ * @param move Move.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return true if the move has a valid format, false otherwise.
+ */
+bool parse_move(const char* move, int* x, int* y) {
+    int letters = 0, column = 0;
+
+    while (isupper((unsigned char)move[letters]) && letters < MAX_COLUMN_LETTERS) {
+        column = column * 26 + (move[letters] - 'A' + 1);
+        letters++;
+    }
+
+    size_t digits = strspn(move + letters, "0123456789");
+
+    if (letters == 0 || digits == 0 || digits > 9) {
+        return false;
+    }
+
+    *x = column - 1;
+    *y = atoi(&move[letters]) - 1;
+
+    return true;
+}
+
+/**
+ * @brief Function to write the letters of the column of the legacy protocol.
+ *
+ * @param buffer Destination of at least MAX_COLUMN_LETTERS + 1 bytes.
+ * @param x Column, the columns beyond four letters are written as "?".
+ * @return Number of the letters.
+ */
+int format_column(char* buffer, int x) {
+    char letters[MAX_COLUMN_LETTERS];
+    int count = 0, column = x + 1;
+
+    for (; column > 0 && count < MAX_COLUMN_LETTERS; column = (column - 1) / 26) {
+        letters[count++] = (char)('A' + (column - 1) % 26);
+    }
+
+    if (x < 0 || column > 0) {
+        strcpy(buffer, "?");
+        return 1;
+    }
+
+    for (int i = 0; i < count; ++i) {
+        buffer[i] = letters[count - 1 - i];
+    }
+
+    buffer[count] = '\0';
+
+    return count;
+}
+
+/**
+ * @brief Function to write the move of the legacy protocol, for example "AB1200".
+ *
+ * @param buffer Destination of at least BUF_MESSAGE_SIZE bytes.
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @return Length of the move.
+ */
+int format_move(char* buffer, int x, int y) {
+    int length = format_column(buffer, x);
+
+    return length + snprintf(buffer + length, BUF_MESSAGE_SIZE - length, "%d", y + 1);
+}
+
+/**
+ * @brief Function to get the message of the move result in the legacy protocol.
+ *
+ * @param result Result of the move.
+ * @return Message.
+ */
+const char* move_result_message(MoveResult result) {
+    return move_result_messages[result];
+}
+
+/**
+ * @brief Function to get the move result from the message of the legacy protocol.
+ *
+ * @param message Message.
+ * @return Result of the move, MOVE_INVALID if the message is unknown.
+ */
+MoveResult parse_move_result(const char* message) {
+    for (int i = MOVE_MISS; i < MOVE_INVALID; ++i) {
+        if (strcmp(message, move_result_messages[i]) == 0) {
+            return (MoveResult)i;
+        }
+    }
+
+    return MOVE_INVALID;
+}
+
+/**
+ * @brief Function to initialize the frame reader.
+ *
+ * @param reader Frame reader.
+ * @return void
+ */
+void frame_reader_init(FrameReader* reader) {
+    reader->length = 0;
+    reader->consumed = 0;
+}
+
+/**
+ * @brief Function to receive bytes until the reader has at least the requested number of bytes after the
+ * last returned frame. The bytes of the last returned frame are dropped, so the first unread byte is at
+ * the beginning of the buffer. The bytes of a socket with a registered channel are taken from the channel.
+ *
+ * @param reader Frame reader.
+ * @param socket Socket.
+ * @param size Number of bytes required.
+ * @return Number of unread bytes, 0 if the connection was closed, -1 on error.
+ */
+ssize_t frame_reader_fill(FrameReader* reader, int socket, size_t size) {
+    reader->length -= reader->consumed;
+    memmove(reader->buffer, reader->buffer + reader->consumed, reader->length);
+    reader->consumed = 0;
+
+    Channel* channel = channel_of(socket);
+
+    while (reader->length < size) {
+        char* buffer = reader->buffer + reader->length;
+        size_t space = sizeof(reader->buffer) - reader->length;
+        ssize_t received =
+            channel != NULL ? channel_receive(channel, buffer, space) : recv(socket, buffer, space, 0);
+        if (received < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (received <= 0) {
+            return received;
+        }
+
+        reader->length += received;
+    }
+
+    return (ssize_t)reader->length;
+}
+
+/**
+ * @brief Function to read the next binary frame. The frame is valid until the next call.
+ *
+ * @param reader Frame reader.
+ * @param socket Socket.
+ * @param frame Frame.
+ * @return 1 if a frame was read, 0 if the connection was closed, -1 on error or on an invalid frame.
+ */
+int read_frame(FrameReader* reader, int socket, Frame* frame) {
+    size_t required = FRAME_HEADER_SIZE;
+
+    while (true) {
+        ssize_t available = frame_reader_fill(reader, socket, required);
+        if (available <= 0) {
+            return (int)available;
+        }
+
+        int size = decode_frame(reader->buffer, reader->length, frame);
+        if (size < 0) {
+            return -1;
+        }
+
+        if (size > 0) {
+            reader->consumed = size;
+            return 1;
+        }
+
+        required = reader->length + 1;
+    }
+}
+
+/**
+ * @brief Function to read the next frame of the legacy protocol.
+ *
+ * @param reader Frame reader.
+ * @param socket Socket.
+ * @param message Message of BUF_MESSAGE_SIZE bytes, always terminated with zero.
+ * @return 1 if a message was read, 0 if the connection was closed, -1 on error.
+ */
+int read_message(FrameReader* reader, int socket, char* message) {
+    ssize_t available = frame_reader_fill(reader, socket, BUF_MESSAGE_SIZE);
+    if (available <= 0) {
+        return (int)available;
+    }
+
+    memcpy(message, reader->buffer, BUF_MESSAGE_SIZE);
+    message[BUF_MESSAGE_SIZE - 1] = '\0';
+    reader->consumed = BUF_MESSAGE_SIZE;
+
+    return 1;
+}
+
+/**
+ * @brief Function to send all bytes to a blocking socket, or to the channel registered for the socket.
+ *
+ * @param socket Socket.
+ * @param data Bytes to send.
+ * @param length Number of bytes.
+ * @return 0 on success, -1 on error.
+ */
+int send_all(int socket, const char* data, size_t length) {
+    Channel* channel = channel_of(socket);
+
+    if (channel != NULL) {
+        return channel_send_all(channel, data, length);
+    }
+
+    while (length > 0) {
+        ssize_t sent = send(socket, data, length, MSG_NOSIGNAL);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            return -1;
+        }
+
+        data += sent;
+        length -= sent;
+    }
+
+    return 0;
+}
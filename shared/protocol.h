@@ -0,0 +1,168 @@
+/*! @file protocol.h
+File with the declaration of the wire protocol of the battleship game.
+The binary protocol uses frames with a header of FRAME_HEADER_SIZE bytes: the opcode and the big-endian
+length of the payload. The client starts with the hello frame, which is padded to BUF_MESSAGE_SIZE bytes
+and starts with a byte that is never a part of a name, so the server can tell it from the name frame of
+the legacy ASCII protocol. A server that answers with an ASCII frame does not speak the binary protocol,
+and the client falls back to the legacy protocol. Since TOKEN_PROTOCOL_VERSION the parameters of the game
+carry a resume token, and a client that lost its connection resumes the game with the resume frame instead
+of the hello frame. Since KEEPALIVE_PROTOCOL_VERSION the connection outlives the game: after the end of the
+game the client asks for a new game with the rematch frame or ends the connection with the quit frame.
+A spectator starts with the watch frame, padded like the hello frame, and receives the parameters and the
+state of the game of the player followed by an event frame for every move of the player.
+A client on the local socket of the server may start with the channel frame, which carries the descriptors
+of a shared-memory channel; the transport frame of the server tells whether the next frames of both sides
+go through the channel or stay on the socket.
+The legacy moves name the column with letters like the columns of a spreadsheet: A to Z, then AA to ZZ,
+then AAA, so the same format covers the boards of any size.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+#include "shared.h"
+
+#define PROTOCOL_VERSION 3
+#define TOKEN_PROTOCOL_VERSION 2
+#define KEEPALIVE_PROTOCOL_VERSION 3
+
+#define FRAME_HEADER_SIZE 3
+#define MAX_FRAME_PAYLOAD 256
+#define MAX_FRAME_SIZE (FRAME_HEADER_SIZE + MAX_FRAME_PAYLOAD)
+#define HELLO_NAME_SIZE (BUF_MESSAGE_SIZE - FRAME_HEADER_SIZE - 1)
+#define MAX_BATCH_MOVES (MAX_FRAME_PAYLOAD / 4)
+#define MAX_RESULT_BATCH_SIZE (FRAME_HEADER_SIZE + 2 + MAX_BATCH_MOVES)
+#define PARAMS_SIZE 11
+#define PARAMS_TOKEN_SIZE (PARAMS_SIZE + 8)
+#define RESUME_SIZE (BUF_MESSAGE_SIZE - FRAME_HEADER_SIZE)
+#define EVENT_SIZE 10
+#define TRANSPORT_SIZE 1
+#define MAX_COLUMN_LETTERS 4
+
+/**
+ * @brief Enumeration for the opcode of a binary frame.
+ */
+typedef enum {
+    OP_PARAMS = 0x01,       /**< Server: version, field size, number of ships, number of moves */
+    OP_MOVE = 0x02,         /**< Client: column and row of the shot */
+    OP_RESULT = 0x03,       /**< Server: result of the move and status of the game */
+    OP_MOVE_BATCH = 0x04,   /**< Client: up to MAX_BATCH_MOVES moves */
+    OP_RESULT_BATCH = 0x05, /**< Server: status of the game and the results of the processed moves */
+    OP_STATE = 0x06,        /**< Server: ships left, missed moves, shots and hits of the resumed game */
+    OP_REMATCH = 0x07,      /**< Client: start a new game on the connection, no payload */
+    OP_QUIT = 0x08,         /**< Client: end the connection after the game, no payload */
+    OP_EVENT = 0x09,        /**< Server: move of the watched game with its result and the counters */
+    OP_TRANSPORT = 0x0A,    /**< Server: 1 if the frames go through the shared-memory channel, 0 if not */
+    OP_HELLO = 0xB5,        /**< Client: version and name of the player */
+    OP_RESUME = 0xB6,       /**< Client: version and resume token of the game to continue */
+    OP_WATCH = 0xB7,        /**< Client: version and name of the player whose game to watch */
+    OP_CHANNEL = 0xB8       /**< Client: no payload, the descriptors of the channel in the control message */
+} Opcode;
+
+/**
+ * @struct Frame
+ * @brief Structure for a decoded binary frame. The payload points into the buffer the frame was decoded
+ * from.
+ *
+ * @param opcode Opcode of the frame.
+ * @param length Length of the payload.
+ * @param payload Payload of the frame.
+ */
+typedef struct {
+    uint8_t opcode;
+    uint16_t length;
+    const uint8_t* payload;
+} Frame;
+
+/**
+ * @struct Move
+ * @brief Structure for the coordinates of a shot.
+ *
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ */
+typedef struct {
+    int x;
+    int y;
+} Move;
+
+/**
+ * @struct GameEvent
+ * @brief Structure for a move of a watched game.
+ *
+ * @param x Column of the shot.
+ * @param y Row of the shot.
+ * @param result Result of the move.
+ * @param status Status of the game after the move.
+ * @param ships_left Number of ships left on the board.
+ * @param missed Number of missed moves.
+ */
+typedef struct {
+    int x;
+    int y;
+    MoveResult result;
+    GameStatus status;
+    int ships_left;
+    int missed;
+} GameEvent;
+
+/**
+ * @struct FrameReader
+ * @brief Structure for reading frames from a blocking socket. The bytes after the returned frame are kept
+ * for the next frame, so short and coalesced reads are handled.
+ *
+ * @param buffer Received bytes.
+ * @param length Number of bytes in the buffer.
+ * @param consumed Number of bytes of the last returned frame.
+ */
+typedef struct {
+    char buffer[MAX_FRAME_SIZE * 4];
+    size_t length;
+    size_t consumed;
+} FrameReader;
+
+int decode_frame(const char* data, size_t length, Frame* frame);
+size_t encode_hello(char* buffer, const char* name);
+size_t encode_resume(char* buffer, uint64_t token);
+size_t encode_params(char* buffer, int field_size, int number_of_ships, int number_of_moves, uint64_t token);
+size_t encode_state(char* buffer, int ships_left, int missed, const GameBoard* board);
+size_t encode_move(char* buffer, int x, int y);
+size_t encode_result(char* buffer, MoveResult result, GameStatus status);
+size_t encode_move_batch(char* buffer, const Move* moves, int count);
+size_t encode_result_batch(char* buffer, const MoveResult* results, int count, GameStatus status);
+size_t encode_empty(char* buffer, Opcode opcode);
+size_t encode_watch(char* buffer, const char* name);
+size_t encode_event(char* buffer, const GameEvent* event);
+size_t encode_transport(char* buffer, bool channel);
+bool decode_hello(const Frame* frame, int* version, char* name);
+bool decode_resume(const Frame* frame, int* version, uint64_t* token);
+bool decode_params(const Frame* frame, int* version, int* field_size, int* number_of_ships,
+                   int* number_of_moves, uint64_t* token);
+bool decode_state(const Frame* frame, int* ships_left, int* missed, GameBoard* board);
+bool decode_move(const Frame* frame, int* x, int* y);
+bool decode_result(const Frame* frame, MoveResult* result, GameStatus* status);
+int decode_move_batch(const Frame* frame, Move* moves);
+int decode_result_batch(const Frame* frame, MoveResult* results, GameStatus* status);
+bool decode_empty(const Frame* frame, Opcode opcode);
+bool decode_watch(const Frame* frame, int* version, char* name);
+bool decode_event(const Frame* frame, GameEvent* event);
+bool decode_transport(const Frame* frame, bool* channel);
+
+bool parse_move(const char* move, int* x, int* y);
+int format_column(char* buffer, int x);
+int format_move(char* buffer, int x, int y);
+const char* move_result_message(MoveResult result);
+MoveResult parse_move_result(const char* message);
+
+void frame_reader_init(FrameReader* reader);
+ssize_t frame_reader_fill(FrameReader* reader, int socket, size_t size);
+int read_frame(FrameReader* reader, int socket, Frame* frame);
+int read_message(FrameReader* reader, int socket, char* message);
+int send_all(int socket, const char* data, size_t length);
+
+#endif
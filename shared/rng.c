@@ -0,0 +1,91 @@
+/*! @file rng.c
+File with the implementation of the pseudo-random number generator.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "rng.h"
+
+/**
+ * @brief Function to rotate the word to the left.
+ *
+ * @param value Word.
+ * @param shift Number of bits.
+ * @return Rotated word.
+ */
+static inline uint64_t rotate_left(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+/**
+ * @brief Function to get the next value of splitmix64. Used to spread the seed over the state.
+ *
+ * @param state State of splitmix64.
+ * @return Next value.
+ */
+static uint64_t splitmix64(uint64_t* state) {
+    uint64_t value = (*state += 0x9E3779B97F4A7C15ULL);
+    value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    value = (value ^ (value >> 27)) * 0x94D049BB133111EBULL;
+
+    return value ^ (value >> 31);
+}
+
+/**
+ * @brief Function to seed the generator. Close seeds give unrelated sequences.
+ *
+ * @param rng Generator.
+ * @param seed Seed.
+ * @return void
+ */
+void rng_seed(Rng* rng, uint64_t seed) {
+    for (int i = 0; i < 4; ++i) {
+        rng->state[i] = splitmix64(&seed);
+    }
+
+    return;
+}
+
+/**
+ * @brief Function to get the next 64-bit value of xoshiro256**.
+ *
+ * @param rng Generator.
+ * @return Next value.
+ */
+uint64_t rng_next(Rng* rng) {
+    uint64_t* s = rng->state;
+    uint64_t result = rotate_left(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotate_left(s[3], 45);
+
+    return result;
+}
+
+/**
+ * @brief Function to get a uniform value below the bound. Uses the multiply-shift method, the rare biased
+ * values are rejected.
+ *
+ * @param rng Generator.
+ * @param bound Bound, greater than zero.
+ * @return Value from 0 to bound - 1.
+ */
+uint32_t rng_below(Rng* rng, uint32_t bound) {
+    uint64_t product = (rng_next(rng) >> 32) * bound;
+    uint32_t low = (uint32_t)product;
+
+    if (low < bound) {
+        uint32_t threshold = -bound % bound;
+
+        while (low < threshold) {
+            product = (rng_next(rng) >> 32) * bound;
+            low = (uint32_t)product;
+        }
+    }
+
+    return (uint32_t)(product >> 32);
+}
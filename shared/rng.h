@@ -0,0 +1,27 @@
+/*! @file rng.h
+File with the declaration of the pseudo-random number generator. The generator is xoshiro256** seeded with
+splitmix64. Its state is a small structure owned by the caller, so every game has its own generator and
+no global state is shared.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * @struct Rng
+ * @brief Structure for the state of the generator.
+ *
+ * @param state State of xoshiro256**.
+ */
+typedef struct {
+    uint64_t state[4];
+} Rng;
+
+void rng_seed(Rng* rng, uint64_t seed);
+uint64_t rng_next(Rng* rng);
+uint32_t rng_below(Rng* rng, uint32_t bound);
+
+#endif
@@ -2,7 +2,10 @@
 File containing shared functions and structures for the battleship game.
 The shared functions include parsing configuration options and creating and destroying the game board.
 The shared structures include the configuration options and the game board.
-The game board is a 2D array of characters, where each cell represents a square on the board.
+The game board is stored as two bitmasks in one block of memory: the ships and the shots. The checks of
+the cells are bit operations, and the counters of the ships are popcounts. When the bitmasks of a large
+board would take more memory, the board keeps only the blocks of 8x8 cells with a ship or a shot in a hash
+table sized for the number of ships and moves of the game, and the same operations work on the blocks.
 The game board is used by both the client and the server to keep track of the game state.
 @author Gavrish A.A.
 @date 13.04.2024 */
@@ -47,35 +50,578 @@ void parse_string(void* value, const char* str) {
 }
 
 /**
- * @brief Function to create the game board. The game board is a 2D array of characters.
- * Each cell represents a square on the board, and the initial value is '*'.
+ * @brief Number of bits in a word of a bitmask of the game board.
+ */
+#define BITS_PER_WORD 64
+
+/**
+ * @brief Number of columns and rows of a block of a sparse game board.
+ */
+#define BLOCK_SIZE 8
+
+/**
+ * @brief Multiplier of the hash of the block number, 2^64 divided by the golden ratio.
+ */
+#define BLOCK_HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+
+/**
+ * @struct BoardBlock
+ * @brief Structure for a slot of the hash table of a sparse game board. The bit (y % 8) * 8 + x % 8 of the
+ * masks is the cell with the column x and the row y.
+ *
+ * @param key Number of the block plus one, 0 for an empty slot.
+ * @param ships Ships of the block.
+ * @param shots Shots of the block.
+ */
+typedef struct {
+    uint64_t key;
+    uint64_t ships;
+    uint64_t shots;
+} BoardBlock;
+
+/**
+ * @brief Function to check if the game board keeps only the marked blocks.
+ *
+ * @param board Game board.
+ * @return true if the board is sparse, false if it is dense.
+ */
+static inline bool is_sparse(const GameBoard* board) {
+    return board->blocks != 0 ? true : false;
+}
+
+/**
+ * @brief Function to get the row of the ships bitmask.
+ *
+ * @param board Game board.
+ * @param y Index of the row.
+ * @return Pointer to the first word of the row.
+ */
+static inline uint64_t* ships_row(const GameBoard* board, int y) {
+    return (uint64_t*)board->bits + (size_t)y * board->words_per_row;
+}
+
+/**
+ * @brief Function to get the row of the shots bitmask.
+ *
+ * @param board Game board.
+ * @param y Index of the row.
+ * @return Pointer to the first word of the row.
+ */
+static inline uint64_t* shots_row(const GameBoard* board, int y) {
+    return ships_row(board, board->field_size + y);
+}
+
+/**
+ * @brief Function to check the bit of the row.
+ *
+ * @param row Row of a bitmask.
+ * @param x Index of the bit.
+ * @return true if the bit is set, false otherwise.
+ */
+static inline bool test_bit(const uint64_t* row, int x) {
+    return (row[x / BITS_PER_WORD] >> (x % BITS_PER_WORD)) & 1 ? true : false;
+}
+
+/**
+ * @brief Function to get the slots of the hash table of a sparse game board.
+ *
+ * @param board Game board.
+ * @return Pointer to the first slot.
+ */
+static inline BoardBlock* board_blocks(const GameBoard* board) {
+    return (BoardBlock*)board->bits;
+}
+
+/**
+ * @brief Function to get the number of the block of the cell.
+ *
+ * @param board Game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return Number of the block.
+ */
+static inline uint64_t block_number(const GameBoard* board, int x, int y) {
+    uint64_t blocks_per_row = (board->field_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+    return (uint64_t)(y / BLOCK_SIZE) * blocks_per_row + x / BLOCK_SIZE;
+}
+
+/**
+ * @brief Function to get the bit of the cell in the masks of its block.
+ *
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return Mask with the bit of the cell.
+ */
+static inline uint64_t block_bit(int x, int y) {
+    return (uint64_t)1 << ((y % BLOCK_SIZE) * BLOCK_SIZE + x % BLOCK_SIZE);
+}
+
+/**
+ * @brief Function to find the slot of the block, or the empty slot where the block would be stored.
+ * The table is never full, see game_board_size, so the search always ends.
+ *
+ * @param board Sparse game board.
+ * @param number Number of the block.
+ * @return Slot of the block, its key is 0 if the block is not stored.
+ */
+static BoardBlock* find_block(const GameBoard* board, uint64_t number) {
+    BoardBlock* blocks = board_blocks(board);
+    uint64_t key = number + 1;
+    uint32_t mask = (uint32_t)board->blocks - 1;
+    uint32_t slot = (uint32_t)((key * BLOCK_HASH_MULTIPLIER) >> 32) & mask;
+
+    while (blocks[slot].key != key && blocks[slot].key != 0) {
+        slot = (slot + 1) & mask;
+    }
+
+    return &blocks[slot];
+}
+
+/**
+ * @brief Function to get the block of the cell to mark it. A new block is stored if there is room for it,
+ * so the table keeps at least one empty slot.
+ *
+ * @param board Sparse game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return Block of the cell, NULL if the table is full.
+ */
+static BoardBlock* mark_block(GameBoard* board, int x, int y) {
+    uint64_t number = block_number(board, x, y);
+    BoardBlock* block = find_block(board, number);
+
+    if (block->key == 0) {
+        if (board->blocks_used == board->blocks - 1) {
+            return NULL;
+        }
+
+        block->key = number + 1;
+        board->blocks_used++;
+    }
+
+    return block;
+}
+
+/**
+ * @brief Function to get the number of bytes occupied by a dense game board.
+ *
+ * @param field_size Size of the game board.
+ * @return Size of the game board in bytes.
+ */
+static size_t dense_board_size(int field_size) {
+    size_t words_per_row = (field_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    return sizeof(GameBoard) + 2 * (size_t)field_size * words_per_row * sizeof(uint64_t);
+}
+
+/**
+ * @brief Function to get the number of slots of the hash table of a sparse game board. Every marked cell
+ * takes at most one block, and the table is kept at most half full.
+ *
+ * @param max_marked Maximum number of cells with a ship or a shot.
+ * @return Number of slots, a power of two.
+ */
+static int sparse_board_blocks(int max_marked) {
+    int blocks = 2;
+
+    while (blocks < 2 * max_marked) {
+        blocks *= 2;
+    }
+
+    return blocks;
+}
+
+/**
+ * @brief Function to get the number of bytes occupied by the game board. The board is sparse if that takes
+ * less memory than the bitmasks of the whole board.
+ *
+ * @param field_size Size of the game board.
+ * @param max_marked Maximum number of cells with a ship or a shot: the number of ships and the number of
+ * missed moves that ends the game. 0 or less for a dense board.
+ * @return Size of the game board in bytes.
+ */
+size_t game_board_size(int field_size, int max_marked) {
+    size_t dense = dense_board_size(field_size);
+
+    if (max_marked <= 0 || (size_t)max_marked > dense / sizeof(BoardBlock)) {
+        return dense;
+    }
+
+    size_t sparse = sizeof(GameBoard) + (size_t)sparse_board_blocks(max_marked) * sizeof(BoardBlock);
+
+    return sparse < dense ? sparse : dense;
+}
+
+/**
+ * @brief Function to get the number of bytes occupied by the initialized game board.
+ *
+ * @param board Game board.
+ * @return Size of the game board in bytes.
+ */
+size_t board_memory_size(const GameBoard* board) {
+    if (is_sparse(board)) {
+        return sizeof(GameBoard) + (size_t)board->blocks * sizeof(BoardBlock);
+    }
+
+    return dense_board_size(board->field_size);
+}
+
+/**
+ * @brief Function to initialize the game board in the provided memory. The memory must have at least
+ * game_board_size(field_size, max_marked) bytes. Initially there are no ships and no shots.
+ *
+ * @param memory Memory for the game board.
+ * @param field_size Size of the game board.
+ * @param max_marked Maximum number of cells with a ship or a shot, 0 or less for a dense board.
+ * @return Pointer to the game board.
+ */
+GameBoard* init_game_board(void* memory, int field_size, int max_marked) {
+    GameBoard* board = (GameBoard*)memory;
+    bool sparse = game_board_size(field_size, max_marked) < dense_board_size(field_size) ? true : false;
+
+    board->field_size = field_size;
+    board->words_per_row = sparse ? 0 : (field_size + BITS_PER_WORD - 1) / BITS_PER_WORD;
+    board->blocks = sparse ? sparse_board_blocks(max_marked) : 0;
+    clear_game_board(board);
+
+    return board;
+}
+
+/**
+ * @brief Function to remove all ships and shots from the game board, so the memory of the board can be
+ * reused for a new game.
+ *
+ * @param board Game board.
+ * @return void
+ */
+void clear_game_board(GameBoard* board) {
+    board->blocks_used = 0;
+    memset(board->bits, 0, board_memory_size(board) - sizeof(GameBoard));
+}
+
+/**
+ * @brief Function to create the game board. The game board is allocated as one block of memory, and
+ * initially there are no ships and no shots, so every cell is empty ('*').
  * The game board is used by both the client and the server to keep track of the game state.
- * The game board is dynamically allocated based on the field size.
  *
- * @param playing_field Pointer to the pointer to the game board.
  * @param field_size Size of the game board.
+ * @param max_marked Maximum number of cells with a ship or a shot, 0 or less for a dense board.
+ * @return Pointer to the game board.
+ */
+GameBoard* create_game_board(int field_size, int max_marked) {
+    void* memory = malloc(game_board_size(field_size, max_marked));
+    if (memory == NULL) {
+        printf("ERROR: not enough memory for the game board\n");
+        exit(EXIT_FAILURE);
+    }
+
+    return init_game_board(memory, field_size, max_marked);
+}
+
+/**
+ * @brief Function to destroy the game board.
+ *
+ * @param board Game board.
  * @return void
  */
-void create_game_board(char*** playing_field, int field_size) {
-    *playing_field = (char**)malloc(field_size * sizeof(char*));
-    for (int i = 0; i < field_size; ++i) {
-        (*playing_field)[i] = (char*)malloc(field_size * sizeof(char));
-        for (int j = 0; j < field_size; ++j) {
-            (*playing_field)[i][j] = '*';
+void destroy_game_board(GameBoard* board) {
+    free(board);
+}
+
+/**
+ * @brief Function to get the state of the cell of the game board.
+ *
+ * @param board Game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return State of the cell.
+ * @see CellState
+ */
+CellState board_get_cell(const GameBoard* board, int x, int y) {
+    if (is_sparse(board)) {
+        const BoardBlock* block = find_block(board, block_number(board, x, y));
+        uint64_t bit = block_bit(x, y);
+
+        return (CellState)((block->ships & bit ? 1 : 0) | (block->shots & bit ? 2 : 0));
+    }
+
+    int ship = test_bit(ships_row(board, y), x);
+    int shot = test_bit(shots_row(board, y), x);
+
+    return (CellState)(ship | shot << 1);
+}
+
+/**
+ * @brief Function to put the ship on the cell of the game board. A sparse board that is full ignores the
+ * new blocks, which does not happen while the board has no more marked cells than it was made for.
+ *
+ * @param board Game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return void
+ */
+void board_set_ship(GameBoard* board, int x, int y) {
+    if (is_sparse(board)) {
+        BoardBlock* block = mark_block(board, x, y);
+        if (block != NULL) {
+            block->ships |= block_bit(x, y);
         }
+
+        return;
     }
+
+    ships_row(board, y)[x / BITS_PER_WORD] |= (uint64_t)1 << (x % BITS_PER_WORD);
 }
 
 /**
- * @brief Function to destroy the game board.
+ * @brief Function to mark the cell of the game board as shot.
  *
- * @param playing_field Pointer to the pointer to the game board.
- * @param field_size Size of the game board.
+ * @param board Game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
  * @return void
  */
-void destroy_game_board(char*** playing_field, int field_size) {
-    for (int i = 0; i < field_size; ++i) {
-        free((*playing_field)[i]);
+void board_set_shot(GameBoard* board, int x, int y) {
+    if (is_sparse(board)) {
+        BoardBlock* block = mark_block(board, x, y);
+        if (block != NULL) {
+            block->shots |= block_bit(x, y);
+        }
+
+        return;
+    }
+
+    shots_row(board, y)[x / BITS_PER_WORD] |= (uint64_t)1 << (x % BITS_PER_WORD);
+}
+
+/**
+ * @brief Function to check if there is a ship in the rectangle of the sparse game board. The rectangle
+ * covers at most four blocks, and every block is checked with one mask.
+ *
+ * @param board Sparse game board.
+ * @param first_x First column.
+ * @param last_x Last column.
+ * @param first_y First row.
+ * @param last_y Last row.
+ * @return true if there is a ship in the rectangle, false otherwise.
+ */
+static bool sparse_has_ship(const GameBoard* board, int first_x, int last_x, int first_y, int last_y) {
+    for (int block_y = first_y / BLOCK_SIZE; block_y <= last_y / BLOCK_SIZE; ++block_y) {
+        int block_top = block_y * BLOCK_SIZE, block_bottom = block_top + BLOCK_SIZE - 1;
+        int top = first_y > block_top ? first_y : block_top;
+        int bottom = last_y < block_bottom ? last_y : block_bottom;
+
+        for (int block_x = first_x / BLOCK_SIZE; block_x <= last_x / BLOCK_SIZE; ++block_x) {
+            int block_left = block_x * BLOCK_SIZE, block_right = block_left + BLOCK_SIZE - 1;
+            const BoardBlock* block = find_block(board, block_number(board, block_left, top));
+            if (block->ships == 0) {
+                continue;
+            }
+
+            int left = first_x > block_left ? first_x : block_left;
+            int right = last_x < block_right ? last_x : block_right;
+            uint64_t columns = (((uint64_t)2 << (right - left)) - 1) << (left % BLOCK_SIZE);
+
+            for (int row = top; row <= bottom; ++row) {
+                if (block->ships & columns << (row % BLOCK_SIZE) * BLOCK_SIZE) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Function to check if there is a ship on the cell or on one of its neighbours. When the three
+ * columns are in one word, the row is checked with one mask instead of three bit tests.
+ *
+ * @param board Game board.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return true if there is a ship around the cell, false otherwise.
+ */
+bool board_has_ship_around(const GameBoard* board, int x, int y) {
+    int first_x = x > 0 ? x - 1 : x;
+    int last_x = x + 1 < board->field_size ? x + 1 : x;
+    int first_y = y > 0 ? y - 1 : y;
+    int last_y = y + 1 < board->field_size ? y + 1 : y;
+
+    if (is_sparse(board)) {
+        return sparse_has_ship(board, first_x, last_x, first_y, last_y);
+    }
+
+    for (int row = first_y; row <= last_y; ++row) {
+        const uint64_t* ships = ships_row(board, row);
+
+        if (first_x / BITS_PER_WORD == last_x / BITS_PER_WORD) {
+            uint64_t mask = ((uint64_t)2 << (last_x - first_x)) - 1;
+            if ((ships[first_x / BITS_PER_WORD] >> (first_x % BITS_PER_WORD)) & mask) {
+                return true;
+            }
+
+            continue;
+        }
+
+        for (int column = first_x; column <= last_x; ++column) {
+            if (test_bit(ships, column)) {
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Function to count the cells of the game board with the ship bit set and the shot bit equal to
+ * the given one.
+ *
+ * @param board Game board.
+ * @param shot 0 for the ships that were not shot, 1 for the hits.
+ * @return Number of the cells.
+ */
+static int count_ships(const GameBoard* board, int shot) {
+    uint64_t flip = shot ? 0 : ~(uint64_t)0;
+    int count = 0;
+
+    if (is_sparse(board)) {
+        const BoardBlock* blocks = board_blocks(board);
+
+        for (int i = 0; i < board->blocks; ++i) {
+            count += __builtin_popcountll(blocks[i].ships & (blocks[i].shots ^ flip));
+        }
+
+        return count;
+    }
+
+    size_t words = (size_t)board->field_size * board->words_per_row;
+    const uint64_t* ships = ships_row(board, 0);
+    const uint64_t* shots = shots_row(board, 0);
+
+    for (size_t i = 0; i < words; ++i) {
+        count += __builtin_popcountll(ships[i] & (shots[i] ^ flip));
     }
-    free(*playing_field);
-}
\ No newline at end of file
+
+    return count;
+}
+
+/**
+ * @brief Function to count the ships that were not shot.
+ *
+ * @param board Game board.
+ * @return Number of ships left on the game board.
+ */
+int board_count_ships_left(const GameBoard* board) {
+    return count_ships(board, 0);
+}
+
+/**
+ * @brief Function to count the ships that were shot.
+ *
+ * @param board Game board.
+ * @return Number of hits on the game board.
+ */
+int board_count_hits(const GameBoard* board) {
+    return count_ships(board, 1);
+}
+
+/**
+ * @brief Function to add the marked cells of a word of bits to the list.
+ *
+ * @param cells List of the cells.
+ * @param capacity Number of cells the list can hold.
+ * @param count Number of the cells found before, the cells beyond the capacity are only counted.
+ * @param ships Ship bits of the word.
+ * @param shots Shot bits of the word.
+ * @param first_cell Cell of the lowest bit.
+ * @param row_bits Number of the bits of a row in the word, the next bit starts the next row.
+ * @param row_step Difference of the cells of the first bits of two rows.
+ * @return Number of the cells found.
+ */
+static int list_marked_bits(uint32_t* cells, int capacity, int count, uint64_t ships, uint64_t shots,
+                            uint32_t first_cell, int row_bits, uint32_t row_step) {
+    for (uint64_t marked = ships | shots; marked != 0; marked &= marked - 1) {
+        int bit = __builtin_ctzll(marked);
+        uint32_t state = (uint32_t)((ships >> bit) & 1) | (uint32_t)((shots >> bit) & 1) << 1;
+
+        if (count < capacity) {
+            uint32_t cell = first_cell + (uint32_t)(bit / row_bits) * row_step + (uint32_t)(bit % row_bits);
+            cells[count] = cell | state << MARKED_CELL_STATE_SHIFT;
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Function to list the cells of the game board with a ship or a shot, without visiting the empty
+ * parts of the board. Every entry of the list is the cell y * field_size + x with its CellState in the bits
+ * from MARKED_CELL_STATE_SHIFT. The cells of a dense board are listed row by row, the cells of a sparse
+ * board in no particular order.
+ *
+ * @param board Game board.
+ * @param cells List of the cells, NULL if capacity is 0.
+ * @param capacity Number of cells the list can hold.
+ * @return Number of the marked cells, it can be greater than the capacity.
+ */
+int board_marked_cells(const GameBoard* board, uint32_t* cells, int capacity) {
+    uint32_t field_size = (uint32_t)board->field_size;
+    int count = 0;
+
+    if (is_sparse(board)) {
+        const BoardBlock* blocks = board_blocks(board);
+        uint64_t blocks_per_row = (field_size + BLOCK_SIZE - 1) / BLOCK_SIZE;
+
+        for (int i = 0; i < board->blocks; ++i) {
+            if (blocks[i].key == 0) {
+                continue;
+            }
+
+            uint64_t number = blocks[i].key - 1;
+            uint32_t first_cell = (uint32_t)(number / blocks_per_row * BLOCK_SIZE * field_size +
+                                             number % blocks_per_row * BLOCK_SIZE);
+
+            count = list_marked_bits(cells, capacity, count, blocks[i].ships, blocks[i].shots, first_cell,
+                                     BLOCK_SIZE, field_size);
+        }
+
+        return count;
+    }
+
+    for (uint32_t y = 0; y < field_size; ++y) {
+        const uint64_t* ships = ships_row(board, (int)y);
+        const uint64_t* shots = shots_row(board, (int)y);
+
+        for (int word = 0; word < board->words_per_row; ++word) {
+            count = list_marked_bits(cells, capacity, count, ships[word], shots[word],
+                                     y * field_size + (uint32_t)word * BITS_PER_WORD, BITS_PER_WORD, 0);
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Function to get the symbol used to display the state of the cell.
+ *
+ * @param state State of the cell.
+ * @return Symbol of the cell.
+ * @see CellState
+ */
+char board_cell_symbol(CellState state) {
+    switch (state) {
+        case CELL_SHIP:
+            return 'S';
+        case CELL_HIT:
+            return 'X';
+        case CELL_MISS:
+            return '.';
+        default:
+            return '*';
+    }
+}
@@ -8,7 +8,12 @@ The shared structures include the configuration options and the game board.
 #ifndef SHARED_H
 #define SHARED_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #define BUF_MESSAGE_SIZE 15
+#define MARKED_CELL_STATE_SHIFT 30
+#define MARKED_CELL_MASK ((1U << MARKED_CELL_STATE_SHIFT) - 1)
 
 #define CHECK_LESS_THAN_ZERO(val, msg) \
     if ((val) < 0) {                   \
@@ -16,6 +21,63 @@ The shared structures include the configuration options and the game board.
         exit(EXIT_FAILURE);            \
     }
 
+/**
+ * @brief Enumeration for the server mode.
+ * The server can create a process for every client or serve all clients in one event loop.
+ */
+typedef enum {
+    FORK_MODE,  /**< Process per client */
+    EPOLL_MODE, /**< Single-process event loop */
+    URING_MODE  /**< Single-process io_uring loop, falls back to the event loop */
+} ServerMode;
+
+/**
+ * @brief Enumeration for the level of the server log.
+ * Every level also logs the events of the less detailed levels.
+ */
+typedef enum {
+    LOG_ERROR,   /**< Errors only */
+    LOG_WARNING, /**< Refused connections */
+    LOG_INFO,    /**< Connections and results of the games */
+    LOG_DEBUG    /**< Every move */
+} LogLevel;
+
+/**
+ * @brief Enumeration for the wire protocol.
+ * The legacy protocol uses padded ASCII frames of BUF_MESSAGE_SIZE bytes, the binary protocol uses
+ * length-prefixed frames.
+ */
+typedef enum {
+    PROTOCOL_BINARY, /**< Length-prefixed binary frames */
+    PROTOCOL_ASCII   /**< Legacy fixed-size ASCII frames */
+} Protocol;
+
+/**
+ * @brief Enumeration for the order of the shots of the load generator.
+ */
+typedef enum {
+    STRATEGY_SEQUENTIAL, /**< Row by row from the top left corner */
+    STRATEGY_RANDOM,     /**< Random order without repeats */
+    STRATEGY_PARITY,     /**< Cells of one color of the checkerboard first, then the rest in random order */
+    STRATEGY_DENSITY     /**< The cell with the highest ship density of the auto-solver */
+} ShotStrategy;
+
+/**
+ * @brief Enumeration for the format of the report of the load generator.
+ */
+typedef enum {
+    OUTPUT_TEXT, /**< Human-readable text */
+    OUTPUT_JSON  /**< One JSON object */
+} OutputFormat;
+
+/**
+ * @brief Enumeration for the transport of the frames of a client connected to the local socket.
+ */
+typedef enum {
+    TRANSPORT_SOCKET, /**< The frames go through the socket */
+    TRANSPORT_CHANNEL /**< The frames go through the shared-memory channel, the socket if it is refused */
+} Transport;
+
 /**
  * @struct ServerConfig
  * @brief Structure for storing server configuration.
@@ -25,6 +87,22 @@ The shared structures include the configuration options and the game board.
  * @param number_of_ships Number of ships on the game board.
  * @param server_port Port number for the server.
  * @param server_address IP address of the server.
+ * @param server_mode Mode of handling the client connections.
+ * @param number_of_workers Number of worker processes with their own server sockets.
+ * @param max_sessions Maximum number of concurrent sessions of a worker.
+ * @param seed Seed of the boards, 0 for a random seed.
+ * @param prepared_boards Number of boards with the ships placed in advance.
+ * @param metrics_socket Path of the UNIX socket of the metrics, empty to not serve the metrics.
+ * @param log_level Most detailed level of the server log.
+ * @param listen_backlog Maximum number of connections waiting to be accepted.
+ * @param handshake_timeout Seconds to wait for the name of the player, 0 to wait forever.
+ * @param move_timeout Seconds to wait for the next move, 0 to wait forever.
+ * @param game_timeout Maximum duration of a game in seconds, 0 for no limit.
+ * @param journal Prefix of the paths of the journal files, empty to not write the journal.
+ * @param journal_size Size of a journal file in megabytes.
+ * @param session_store Path of the session store file, empty to not resume the games.
+ * @param handoff_socket Path of the UNIX socket that hands the server sockets over to a new server.
+ * @param local_socket Path of the UNIX socket of the clients on the same host, empty to not serve them.
  */
 typedef struct {
     int field_size;
@@ -32,6 +110,22 @@ typedef struct {
     int number_of_ships;
     int server_port;
     char server_address[16];
+    ServerMode server_mode;
+    int number_of_workers;
+    int max_sessions;
+    int seed;
+    int prepared_boards;
+    char metrics_socket[108];
+    LogLevel log_level;
+    int listen_backlog;
+    int handshake_timeout;
+    int move_timeout;
+    int game_timeout;
+    char journal[108];
+    int journal_size;
+    char session_store[108];
+    char handoff_socket[108];
+    char local_socket[108];
 } ServerConfig;
 
 /**
@@ -41,11 +135,35 @@ typedef struct {
  * @param client_name Name of the client.
  * @param server_address IP address of the server.
  * @param server_port Port number for the server.
+ * @param protocol Wire protocol offered to the server.
+ * @param move_script File with the moves to play instead of the prompt, "-" for the standard input.
+ * @param pipeline_depth Maximum number of moves of the script in flight before their results arrive.
+ * @param load_connections Number of concurrent connections of the load generator, 0 for the interactive game.
+ * @param load_games Total number of games played by the load generator.
+ * @param strategy Order of the shots of the load generator.
+ * @param output_format Format of the report of the load generator.
+ * @param resume_token Resume token of the game to continue, 0 to start a new game.
+ * @param auto_games Number of games played by the auto-solver instead of the prompt, 0 for the prompt.
+ * @param watched_player Name of the player whose game to watch instead of playing, empty to play.
+ * @param local_socket Path of the local socket of the server, empty to connect to the address and port.
+ * @param transport Transport of the frames on the local socket.
  */
 typedef struct {
     char client_name[10];
     char server_address[16];
     int server_port;
+    Protocol protocol;
+    char move_script[256];
+    int pipeline_depth;
+    int load_connections;
+    int load_games;
+    ShotStrategy strategy;
+    OutputFormat output_format;
+    uint64_t resume_token;
+    int auto_games;
+    char watched_player[10];
+    char local_socket[108];
+    Transport transport;
 } ClientConfig;
 
 /**
@@ -85,9 +203,67 @@ typedef enum {
     LOSE  /**< Defeat */
 } GameStatus;
 
+/**
+ * @brief Enumeration for the result of a move.
+ * The result is sent to the client as a message in the legacy protocol and as a code in the binary protocol.
+ */
+typedef enum {
+    MOVE_MISS,           /**< The shot missed, "Miss" */
+    MOVE_HIT,            /**< The shot hit a ship, "Hit" */
+    MOVE_ALREADY_HIT,    /**< The ship was already hit, "Already hit" */
+    MOVE_ALREADY_MISSED, /**< The cell was already shot, "Already missed" */
+    MOVE_INVALID         /**< The move is outside of the board or malformed, "Invalid move" */
+} MoveResult;
+
+/**
+ * @brief Enumeration for the state of a cell of the game board.
+ * The first bit of the state is the ship bit of the cell, the second bit is the shot bit of the cell.
+ */
+typedef enum {
+    CELL_EMPTY, /**< Unknown or empty cell, displayed as '*' */
+    CELL_SHIP,  /**< Ship that was not shot, displayed as 'S' */
+    CELL_MISS,  /**< Empty cell that was shot, displayed as '.' */
+    CELL_HIT    /**< Ship that was shot, displayed as 'X' */
+} CellState;
+
+/**
+ * @struct GameBoard
+ * @brief Structure for storing the game board in one contiguous block of memory.
+ * A dense board keeps two bitmasks: the ships and the shots. Every bitmask has field_size rows of
+ * words_per_row 64-bit words, the bit x of the row y is the cell with the column x and the row y.
+ * The ships are stored first, the shots are stored right after them.
+ * A sparse board keeps only the blocks of 8x8 cells with a ship or a shot, in an open-addressing hash
+ * table of blocks slots, so its size depends on the number of marked cells instead of the field size.
+ *
+ * @param field_size Size of the game board.
+ * @param words_per_row Number of 64-bit words in a row of a bitmask, 0 for a sparse board.
+ * @param blocks Number of slots of the hash table of a sparse board, 0 for a dense board.
+ * @param blocks_used Number of stored blocks of a sparse board.
+ * @param bits Ships bitmask followed by the shots bitmask, or the slots of the hash table.
+ */
+typedef struct {
+    int field_size;
+    int words_per_row;
+    int blocks;
+    int blocks_used;
+    uint64_t bits[];
+} GameBoard;
+
 void parse_int(void* value, const char* str);
 void parse_string(void* value, const char* str);
-void create_game_board(char*** playing_field, int field_size);
-void destroy_game_board(char*** playing_field, int field_size);
+size_t game_board_size(int field_size, int max_marked);
+size_t board_memory_size(const GameBoard* board);
+GameBoard* init_game_board(void* memory, int field_size, int max_marked);
+void clear_game_board(GameBoard* board);
+GameBoard* create_game_board(int field_size, int max_marked);
+void destroy_game_board(GameBoard* board);
+CellState board_get_cell(const GameBoard* board, int x, int y);
+void board_set_ship(GameBoard* board, int x, int y);
+void board_set_shot(GameBoard* board, int x, int y);
+bool board_has_ship_around(const GameBoard* board, int x, int y);
+int board_count_ships_left(const GameBoard* board);
+int board_count_hits(const GameBoard* board);
+int board_marked_cells(const GameBoard* board, uint32_t* cells, int capacity);
+char board_cell_symbol(CellState state);
 
 #endif
\ No newline at end of file
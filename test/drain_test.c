@@ -0,0 +1,244 @@
+/*! @file drain_test.c
+File with the tests of the drain of the server. The server is started from LaunchServer in a temporary
+directory for every server mode, and connections are opened that never start a game: one stays idle, the
+other sends its name only after SIGQUIT. Both must receive "Server busy", and the server must exit.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_BINARY "LaunchServer"
+#define WAIT_STEP_MS 10
+#define START_TIMEOUT_MS 3000
+#define ACCEPT_DELAY_MS 200
+#define ANSWER_TIMEOUT_S 3
+#define EXIT_TIMEOUT_MS 3000
+
+/**
+ * @brief Server modes of the tests.
+ */
+static const char* server_modes[] = {"fork", "epoll", "uring"};
+
+/**
+ * @brief Sleeps for the number of milliseconds.
+ * @param milliseconds Time to sleep.
+ * @return void
+ */
+static void sleep_ms(int milliseconds) {
+    struct timespec interval = {.tv_sec = milliseconds / 1000,
+                                .tv_nsec = (long)(milliseconds % 1000) * 1000000};
+    nanosleep(&interval, NULL);
+
+    return;
+}
+
+/**
+ * @brief Returns a free TCP port of the loopback address.
+ * @return Port, 0 if no port was found.
+ */
+static int free_port(void) {
+    struct sockaddr_in address = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t length = sizeof(address);
+    int probe = socket(AF_INET, SOCK_STREAM, 0);
+    int port = 0;
+
+    if (probe >= 0 && bind(probe, (struct sockaddr*)&address, sizeof(address)) == 0 &&
+        getsockname(probe, (struct sockaddr*)&address, &length) == 0) {
+        port = ntohs(address.sin_port);
+    }
+
+    close(probe);
+
+    return port;
+}
+
+/**
+ * @brief Connects to the server on the loopback address, with a timeout for the answers.
+ * @param port Port of the server.
+ * @return Client socket, -1 if the connection failed.
+ */
+static int connect_to_server(int port) {
+    struct sockaddr_in address = {.sin_family = AF_INET, .sin_port = htons((uint16_t)port),
+                                  .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    struct timeval timeout = {.tv_sec = ANSWER_TIMEOUT_S, .tv_usec = 0};
+    int client_socket = socket(AF_INET, SOCK_STREAM, 0);
+
+    if (client_socket < 0) {
+        return -1;
+    }
+
+    setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+    if (connect(client_socket, (struct sockaddr*)&address, sizeof(address)) < 0) {
+        close(client_socket);
+        return -1;
+    }
+
+    return client_socket;
+}
+
+/**
+ * @brief Starts the server in the directory with a configuration of the mode and the port.
+ * @param binary Absolute path of the server binary.
+ * @param directory Working directory of the server.
+ * @param mode Server mode.
+ * @param port Port of the server.
+ * @return Process of the server, -1 if it was not started.
+ */
+static pid_t start_server(const char* binary, const char* directory, const char* mode, int port) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/config.cfg", directory);
+
+    FILE* file = fopen(path, "w");
+    if (file == NULL) {
+        return -1;
+    }
+
+    fprintf(file, "field_size=5\nnumber_of_moves=30\nnumber_of_ships=9\nserver_address=127.0.0.1\n");
+    fprintf(file, "server_port=%d\nserver_mode=%s\nnumber_of_workers=1\nmax_sessions=16\n", port, mode);
+    fclose(file);
+
+    pid_t pid = fork();
+    if (pid == 0) {
+        int null = open("/dev/null", O_WRONLY);
+
+        dup2(null, STDOUT_FILENO);
+        dup2(null, STDERR_FILENO);
+
+        if (chdir(directory) == 0) {
+            execl(binary, binary, (char*)NULL);
+        }
+
+        _exit(EXIT_FAILURE);
+    }
+
+    return pid;
+}
+
+/**
+ * @brief Waits until the server exits.
+ * @param pid Process of the server.
+ * @param timeout Time to wait in milliseconds.
+ * @return true if the server exited with EXIT_SUCCESS, false otherwise.
+ */
+static bool wait_for_exit(pid_t pid, int timeout) {
+    int status;
+
+    for (int waited = 0; waited < timeout; waited += WAIT_STEP_MS) {
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            return WIFEXITED(status) && WEXITSTATUS(status) == EXIT_SUCCESS ? true : false;
+        }
+
+        sleep_ms(WAIT_STEP_MS);
+    }
+
+    return false;
+}
+
+/**
+ * @brief Checks that the connection receives "Server busy".
+ * @param client_socket Client socket.
+ * @return true if the answer is "Server busy", false otherwise.
+ */
+static bool receives_busy(int client_socket) {
+    char answer[BUF_MESSAGE_SIZE + 1] = {0};
+    size_t received = 0;
+
+    while (received < BUF_MESSAGE_SIZE) {
+        ssize_t size = recv(client_socket, answer + received, BUF_MESSAGE_SIZE - received, 0);
+        if (size <= 0) {
+            return false;
+        }
+
+        received += (size_t)size;
+    }
+
+    return strcmp(answer, "Server busy") == 0 ? true : false;
+}
+
+/**
+ * @brief Checks the drain of the server of the mode with an idle connection and a late name.
+ * @param binary Absolute path of the server binary.
+ * @param directory Working directory of the server.
+ * @param mode Server mode.
+ * @return void
+ */
+static void check_drain(const char* binary, const char* directory, const char* mode) {
+    int port = free_port();
+    pid_t pid = start_server(binary, directory, mode, port);
+    int idle = -1, late = -1;
+
+    if (!CHECK(port > 0 && pid > 0)) {
+        return;
+    }
+
+    for (int waited = 0; idle < 0 && waited < START_TIMEOUT_MS; waited += WAIT_STEP_MS) {
+        idle = connect_to_server(port);
+        if (idle < 0) {
+            sleep_ms(WAIT_STEP_MS);
+        }
+    }
+
+    late = connect_to_server(port);
+    sleep_ms(ACCEPT_DELAY_MS);
+
+    if (CHECK(idle >= 0 && late >= 0)) {
+        char name[BUF_MESSAGE_SIZE] = "late";
+
+        kill(pid, SIGQUIT);
+        sleep_ms(ACCEPT_DELAY_MS);
+        send(late, name, BUF_MESSAGE_SIZE, MSG_NOSIGNAL);
+
+        if (!CHECK(receives_busy(idle)) || !CHECK(receives_busy(late))) {
+            fprintf(stderr, "    server mode %s\n", mode);
+        }
+    }
+
+    if (!CHECK(wait_for_exit(pid, EXIT_TIMEOUT_MS))) {
+        fprintf(stderr, "    server mode %s did not exit after the drain\n", mode);
+        kill(pid, SIGKILL);
+        waitpid(pid, NULL, 0);
+    }
+
+    close(idle);
+    close(late);
+
+    return;
+}
+
+/**
+ * @brief Runs the tests of the drain of the server. The server binary must be built in the working
+ * directory.
+ * @return void
+ */
+void test_drain(void) {
+    char binary[PATH_MAX], directory[] = "/tmp/battleship-drain-XXXXXX", path[PATH_MAX];
+
+    if (!CHECK(realpath(SERVER_BINARY, binary) != NULL) || !CHECK(mkdtemp(directory) != NULL)) {
+        return;
+    }
+
+    for (size_t i = 0; i < sizeof(server_modes) / sizeof(server_modes[0]); ++i) {
+        check_drain(binary, directory, server_modes[i]);
+    }
+
+    snprintf(path, sizeof(path), "%s/config.cfg", directory);
+    unlink(path);
+    rmdir(directory);
+
+    return;
+}
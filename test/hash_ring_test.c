@@ -0,0 +1,162 @@
+/*! @file hash_ring_test.c
+File with the unit tests of the consistent hash ring of the router. The lookups of random hashes, of the
+points themselves and of the hashes past the last point are compared with a linear scan of the ring, for
+every combination of the backends that can take connections. A backend that is down or removed must move
+only its own keys.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include <string.h>
+
+#include "../router/hash_ring.h"
+#include "../shared/rng.h"
+
+#define BACKENDS 4
+#define RANDOM_LOOKUPS 2000
+
+/**
+ * @brief Addresses of the backends of the tests.
+ */
+static const char* addresses[BACKENDS] = {"10.0.0.1:8080", "10.0.0.2:8080", "10.0.0.3:8080", "10.0.0.4:9090"};
+
+/**
+ * @brief Finds the backend of the hash by scanning the ring from its first point.
+ * @param ring Ring.
+ * @param hash Hash of the key.
+ * @param usable true for the backends that can take connections.
+ * @return Index of the backend, -1 if no backend can take the connection.
+ */
+static int naive_lookup(const HashRing* ring, uint64_t hash, const bool* usable) {
+    int first = 0;
+
+    while (first < ring->count && ring->points[first].hash < hash) {
+        first++;
+    }
+
+    for (int i = 0; i < ring->count; ++i) {
+        int backend = ring->points[(first + i) % ring->count].backend;
+
+        if (usable[backend]) {
+            return backend;
+        }
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Checks the lookups of the hashes next to every point and past the last point, and of random
+ * hashes, against the linear scan.
+ * @param ring Ring.
+ * @param usable true for the backends that can take connections.
+ * @param rng Random generator of the hashes.
+ * @return void
+ */
+static void check_lookups(const HashRing* ring, const bool* usable, Rng* rng) {
+    bool matching = true;
+
+    for (int i = 0; i < ring->count; ++i) {
+        uint64_t hash = ring->points[i].hash;
+
+        for (uint64_t next = hash - 1; next != hash + 2; ++next) {
+            matching = matching && hash_ring_lookup(ring, next, usable) == naive_lookup(ring, next, usable);
+        }
+    }
+
+    for (int i = 0; i < RANDOM_LOOKUPS; ++i) {
+        uint64_t hash = rng_next(rng);
+        matching = matching && hash_ring_lookup(ring, hash, usable) == naive_lookup(ring, hash, usable);
+    }
+
+    CHECK(matching);
+    CHECK(hash_ring_lookup(ring, 0, usable) == naive_lookup(ring, 0, usable));
+    CHECK(hash_ring_lookup(ring, UINT64_MAX, usable) == naive_lookup(ring, 0, usable));
+
+    return;
+}
+
+/**
+ * @brief Checks that the keys of a backend that cannot take connections, or is not a member of the ring,
+ * move to other backends, and that the keys of the other backends stay where they are.
+ * @param identities Hashes of the addresses of the backends.
+ * @param rng Random generator of the hashes.
+ * @return void
+ */
+static void check_moved_keys(const uint64_t* identities, Rng* rng) {
+    bool all[BACKENDS] = {true, true, true, true}, without[BACKENDS] = {true, false, true, true};
+    HashRing full = {NULL, 0}, reduced = {NULL, 0};
+    bool stable = true;
+
+    CHECK(hash_ring_build(&full, identities, all, BACKENDS));
+    CHECK(hash_ring_build(&reduced, identities, without, BACKENDS));
+    CHECK(reduced.count == (BACKENDS - 1) * RING_POINTS_PER_BACKEND);
+
+    for (int i = 0; i < RANDOM_LOOKUPS; ++i) {
+        uint64_t hash = rng_next(rng);
+        int owner = hash_ring_lookup(&full, hash, all);
+        int skipped = hash_ring_lookup(&full, hash, without);
+        int removed = hash_ring_lookup(&reduced, hash, all);
+
+        stable = stable && skipped == removed && skipped != 1 && (owner == 1 || skipped == owner);
+    }
+
+    CHECK(stable);
+
+    hash_ring_free(&full);
+    hash_ring_free(&reduced);
+
+    return;
+}
+
+/**
+ * @brief Runs the unit tests of the hash ring.
+ * @return void
+ */
+void test_hash_ring(void) {
+    uint64_t identities[BACKENDS];
+    bool members[BACKENDS] = {true, true, true, true}, usable[BACKENDS];
+    HashRing ring = {NULL, 0};
+    Rng rng;
+
+    rng_seed(&rng, 1);
+
+    for (int backend = 0; backend < BACKENDS; ++backend) {
+        identities[backend] = hash_key(addresses[backend], strlen(addresses[backend]));
+    }
+
+    CHECK(hash_key("p1", 2) != hash_key("p2", 2));
+    CHECK(hash_ring_build(&ring, identities, members, BACKENDS));
+    CHECK(ring.count == BACKENDS * RING_POINTS_PER_BACKEND);
+
+    bool sorted = true;
+    for (int i = 1; i < ring.count; ++i) {
+        sorted = sorted && ring.points[i - 1].hash <= ring.points[i].hash;
+    }
+    CHECK(sorted);
+
+    for (int mask = 0; mask < (1 << BACKENDS); ++mask) {
+        for (int backend = 0; backend < BACKENDS; ++backend) {
+            usable[backend] = (mask >> backend & 1) ? true : false;
+        }
+
+        check_lookups(&ring, usable, &rng);
+        CHECK((hash_ring_lookup(&ring, rng_next(&rng), usable) == -1) == (mask == 0));
+    }
+
+    check_moved_keys(identities, &rng);
+
+    for (int backend = 0; backend < BACKENDS; ++backend) {
+        members[backend] = false;
+        usable[backend] = true;
+    }
+
+    CHECK(hash_ring_build(&ring, identities, members, BACKENDS));
+    CHECK(ring.count == 0);
+    CHECK(hash_ring_lookup(&ring, rng_next(&rng), usable) == -1);
+
+    hash_ring_free(&ring);
+
+    return;
+}
@@ -0,0 +1,170 @@
+/*! @file protocol_test.c
+File with the unit tests of the wire protocol. The frames are decoded from every truncated prefix of their
+bytes and from headers that announce payloads larger than MAX_FRAME_PAYLOAD, and the legacy moves are
+parsed from truncated texts and from columns and rows with too many letters and digits.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "../shared/protocol.h"
+
+/**
+ * @struct ParsedMove
+ * @brief Structure for a legacy move and its expected coordinates.
+ *
+ * @param text Text of the move.
+ * @param valid true if the move has a valid format.
+ * @param x Expected column of the shot.
+ * @param y Expected row of the shot.
+ */
+typedef struct {
+    const char* text;
+    bool valid;
+    int x;
+    int y;
+} ParsedMove;
+
+/**
+ * @brief Legacy moves: the valid ones at the boundaries of the column letters and of the row digits, and the
+ * truncated and oversized ones.
+ */
+static const ParsedMove parsed_moves[] = {
+    {"A1", true, 0, 0},
+    {"B4", true, 1, 3},
+    {"Z26", true, 25, 25},
+    {"AA27", true, 26, 26},
+    {"AB1200", true, 27, 1199},
+    {"NTO9999", true, 9998, 9998},
+    {"ZZZZ1", true, 475253, 0},
+    {"A999999999", true, 0, 999999998},
+    {"", false, 0, 0},
+    {"A", false, 0, 0},
+    {"ZZZZ", false, 0, 0},
+    {"7", false, 0, 0},
+    {"a1", false, 0, 0},
+    {"1A", false, 0, 0},
+    {"AAAAA1", false, 0, 0},
+    {"A1000000000", false, 0, 0},
+};
+
+/**
+ * @brief Checks that every truncated prefix of the frame is incomplete and that the whole frame, alone or
+ * followed by the bytes of the next frame, is decoded.
+ * @param data Bytes of the frame followed by at least one more byte.
+ * @param size Size of the frame.
+ * @param frame Decoded frame.
+ * @return void
+ */
+static void check_truncated(const char* data, size_t size, Frame* frame) {
+    bool incomplete = true;
+
+    for (size_t length = 0; length < size; ++length) {
+        incomplete = incomplete && decode_frame(data, length, frame) == 0;
+    }
+
+    CHECK(incomplete);
+    CHECK(decode_frame(data, size + 1, frame) == (int)size);
+    CHECK(decode_frame(data, size, frame) == (int)size);
+    CHECK(frame->length == size - FRAME_HEADER_SIZE);
+    CHECK(frame->payload == (const uint8_t*)data + FRAME_HEADER_SIZE);
+
+    return;
+}
+
+/**
+ * @brief Checks the frames with truncated bytes and with oversized payloads.
+ * @return void
+ */
+static void check_frames(void) {
+    char buffer[MAX_FRAME_SIZE + 1] = {0};
+    Move moves[MAX_BATCH_MOVES], decoded[MAX_BATCH_MOVES];
+    Frame frame;
+    int x = 0, y = 0;
+
+    size_t size = encode_move(buffer, 1234, 9998);
+    check_truncated(buffer, size, &frame);
+    CHECK(decode_move(&frame, &x, &y) && x == 1234 && y == 9998);
+
+    for (int i = 0; i < MAX_BATCH_MOVES; ++i) {
+        moves[i].x = i;
+        moves[i].y = MAX_BATCH_MOVES - i;
+    }
+
+    size = encode_move_batch(buffer, moves, MAX_BATCH_MOVES);
+    CHECK(size == MAX_FRAME_SIZE);
+    check_truncated(buffer, size, &frame);
+    CHECK(decode_move_batch(&frame, decoded) == MAX_BATCH_MOVES);
+    CHECK(memcmp(moves, decoded, sizeof(moves)) == 0);
+
+    buffer[0] = (char)OP_MOVE;
+    buffer[1] = (char)((MAX_FRAME_PAYLOAD + 1) >> 8);
+    buffer[2] = (char)((MAX_FRAME_PAYLOAD + 1) & 0xFF);
+    CHECK(decode_frame(buffer, FRAME_HEADER_SIZE, &frame) == -1);
+    CHECK(decode_frame(buffer, sizeof(buffer), &frame) == -1);
+
+    buffer[1] = (char)0xFF;
+    buffer[2] = (char)0xFF;
+    CHECK(decode_frame(buffer, FRAME_HEADER_SIZE, &frame) == -1);
+
+    frame.opcode = OP_MOVE;
+    frame.payload = (const uint8_t*)buffer;
+    frame.length = 3;
+    CHECK(!decode_move(&frame, &x, &y));
+    frame.length = 5;
+    CHECK(!decode_move(&frame, &x, &y));
+
+    frame.opcode = OP_MOVE_BATCH;
+    frame.length = 0;
+    CHECK(decode_move_batch(&frame, decoded) == -1);
+    frame.length = 6;
+    CHECK(decode_move_batch(&frame, decoded) == -1);
+
+    return;
+}
+
+/**
+ * @brief Checks the parsing of the legacy moves, and that the formatted moves parse back.
+ * @return void
+ */
+static void check_moves(void) {
+    char text[BUF_MESSAGE_SIZE];
+    bool round_trip = true;
+    int x = 0, y = 0;
+
+    for (size_t i = 0; i < sizeof(parsed_moves) / sizeof(parsed_moves[0]); ++i) {
+        const ParsedMove* move = &parsed_moves[i];
+        bool valid = parse_move(move->text, &x, &y);
+
+        if (!CHECK(valid == move->valid)) {
+            fprintf(stderr, "    move \"%s\"\n", move->text);
+        } else if (valid) {
+            CHECK(x == move->x && y == move->y);
+        }
+    }
+
+    for (int column = 0; column < 10000; column += column < 800 ? 1 : 97) {
+        int row = 9998 - column % 9999;
+
+        format_move(text, column, row);
+        round_trip = round_trip && parse_move(text, &x, &y) && x == column && y == row;
+    }
+
+    CHECK(round_trip);
+
+    return;
+}
+
+/**
+ * @brief Runs the unit tests of the wire protocol.
+ * @return void
+ */
+void test_protocol(void) {
+    check_frames();
+    check_moves();
+
+    return;
+}
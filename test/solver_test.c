@@ -0,0 +1,152 @@
+/*! @file solver_test.c
+File with the unit tests of the auto-solver. Random shots leave random candidates on boards whose sizes
+are at and around the word boundaries of the bitboards. The bit-sliced counts of every candidate must
+match a naive count of its 3x3 neighbourhood, and the picked shot must be a candidate with the fewest
+candidates around it.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include "../client/solver.h"
+
+#define SUM_PLANES 2
+#define COUNT_PLANES 4
+#define MAX_NEIGHBOURHOOD 9
+#define ROUNDS 8
+
+/**
+ * @brief Sizes of the game board: one word, the word boundaries and the largest board of the solver.
+ */
+static const int field_sizes[] = {1, 2, 3, 5, 63, 64, 65, 127, 128, 129, 200, SOLVER_MAX_FIELD_SIZE};
+
+/**
+ * @brief Returns true if the cell is on the board and is a candidate.
+ * @param solver Solver.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return true if the cell is a candidate, false otherwise.
+ */
+static bool is_candidate(const Solver* solver, int x, int y) {
+    if (x < 0 || y < 0 || x >= solver->field_size || y >= solver->field_size) {
+        return false;
+    }
+
+    return (solver->candidates[y * solver->words_per_row + x / 64] >> (x % 64) & 1) ? true : false;
+}
+
+/**
+ * @brief Counts the candidates of the 3x3 neighbourhood of the cell one by one.
+ * @param solver Solver.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return Number of the candidates.
+ */
+static int naive_count(const Solver* solver, int x, int y) {
+    int count = 0;
+
+    for (int dy = -1; dy <= 1; ++dy) {
+        for (int dx = -1; dx <= 1; ++dx) {
+            count += is_candidate(solver, x + dx, y + dy) ? 1 : 0;
+        }
+    }
+
+    return count;
+}
+
+/**
+ * @brief Reads the bit-sliced count of the cell from the count planes left by solver_next.
+ * @param solver Solver.
+ * @param x Column of the cell.
+ * @param y Row of the cell.
+ * @return Number of the candidates of the neighbourhood.
+ */
+static int sliced_count(const Solver* solver, int x, int y) {
+    size_t plane_words = (size_t)solver->field_size * solver->words_per_row;
+    size_t index = (size_t)y * solver->words_per_row + x / 64;
+    int count = 0;
+
+    for (int plane = 0; plane < COUNT_PLANES; ++plane) {
+        uint64_t word = solver->planes[(SUM_PLANES + plane) * plane_words + index];
+        count |= (int)(word >> (x % 64) & 1) << plane;
+    }
+
+    return count;
+}
+
+/**
+ * @brief Checks the counts and the pick of the solver on one board.
+ * @param solver Solver with the shots marked.
+ * @param rng Random generator of the pick.
+ * @return void
+ */
+static void check_counts(Solver* solver, Rng* rng) {
+    int x = -1, y = -1, fewest = MAX_NEIGHBOURHOOD + 1;
+    bool picked = solver_next(solver, rng, &x, &y);
+    bool counts_match = true;
+
+    for (int cell_y = 0; cell_y < solver->field_size; ++cell_y) {
+        for (int cell_x = 0; cell_x < solver->field_size; ++cell_x) {
+            if (!is_candidate(solver, cell_x, cell_y)) {
+                continue;
+            }
+
+            int count = naive_count(solver, cell_x, cell_y);
+            counts_match = counts_match && sliced_count(solver, cell_x, cell_y) == count;
+            fewest = count < fewest ? count : fewest;
+        }
+    }
+
+    CHECK(counts_match);
+    CHECK(picked == (fewest <= MAX_NEIGHBOURHOOD));
+
+    if (picked) {
+        CHECK(is_candidate(solver, x, y));
+        CHECK(naive_count(solver, x, y) == fewest);
+    }
+
+    return;
+}
+
+/**
+ * @brief Runs the unit tests of the auto-solver.
+ * @return void
+ */
+void test_solver(void) {
+    Rng rng;
+    Solver too_large;
+
+    rng_seed(&rng, 1);
+
+    for (size_t size = 0; size < sizeof(field_sizes) / sizeof(field_sizes[0]); ++size) {
+        int field_size = field_sizes[size], cells = field_size * field_size;
+        Solver solver;
+
+        if (!CHECK(solver_init(&solver, field_size))) {
+            continue;
+        }
+
+        check_counts(&solver, &rng);
+
+        for (int round = 0; round < ROUNDS; ++round) {
+            int shots = (int)rng_below(&rng, (uint32_t)cells) + 1;
+
+            solver_reset(&solver);
+
+            for (int shot = 0; shot < shots; ++shot) {
+                int cell = (int)rng_below(&rng, (uint32_t)cells);
+                MoveResult result = rng_below(&rng, 8) == 0 ? MOVE_HIT : MOVE_MISS;
+
+                solver_mark(&solver, cell % field_size, cell / field_size, result);
+            }
+
+            check_counts(&solver, &rng);
+        }
+
+        solver_free(&solver);
+    }
+
+    CHECK(!solver_init(&too_large, SOLVER_MAX_FIELD_SIZE + 1));
+
+    return;
+}
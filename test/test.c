@@ -0,0 +1,80 @@
+/*! @file test.c
+File with the runner of the unit tests. The suites run one after another, and the process exits with a
+failure if any check failed.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * @struct TestSuite
+ * @brief Structure for a suite of the unit tests.
+ *
+ * @param name Name of the suite.
+ * @param run Function that runs the checks of the suite.
+ */
+typedef struct {
+    const char* name;
+    void (*run)(void);
+} TestSuite;
+
+/**
+ * @brief Suites of the unit tests.
+ */
+static const TestSuite suites[] = {
+    {"timer_wheel", test_timer_wheel},
+    {"solver", test_solver},
+    {"hash_ring", test_hash_ring},
+    {"protocol", test_protocol},
+    {"drain", test_drain},
+};
+
+/**
+ * @brief Number of the checks made so far.
+ */
+static int checks;
+
+/**
+ * @brief Number of the failed checks so far.
+ */
+static int failures;
+
+/**
+ * @brief Counts the check and reports it if it failed.
+ * @param passed true if the checked condition holds.
+ * @param condition Text of the condition.
+ * @param file File of the check.
+ * @param line Line of the check.
+ * @return true if the check passed, false otherwise.
+ */
+bool test_check(bool passed, const char* condition, const char* file, int line) {
+    checks++;
+
+    if (!passed) {
+        failures++;
+        fprintf(stderr, "%s:%d: CHECK FAILED: %s\n", file, line, condition);
+    }
+
+    return passed;
+}
+
+/**
+ * @brief Main function of the unit tests. Runs every suite and prints the number of its checks and failures.
+ * @return EXIT_SUCCESS if all checks passed, EXIT_FAILURE otherwise.
+ */
+int main(void) {
+    for (size_t i = 0; i < sizeof(suites) / sizeof(suites[0]); ++i) {
+        int checks_before = checks, failures_before = failures;
+
+        suites[i].run();
+        printf("%-12s %6d checks, %d failed\n", suites[i].name, checks - checks_before,
+               failures - failures_before);
+    }
+
+    printf("%d checks, %d failed\n", checks, failures);
+
+    return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
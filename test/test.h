@@ -0,0 +1,23 @@
+/*! @file test.h
+File with the declaration of the unit tests. Every module under test has a suite that calls the module
+directly and checks its results with the CHECK macro; a failed check is reported with its file and line
+and the run goes on, so one run reports all failed checks.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#ifndef TEST_H
+#define TEST_H
+
+#include "../shared/shared.h"
+
+#define CHECK(condition) test_check((condition) ? true : false, #condition, __FILE__, __LINE__)
+
+bool test_check(bool passed, const char* condition, const char* file, int line);
+
+void test_timer_wheel(void);
+void test_solver(void);
+void test_hash_ring(void);
+void test_protocol(void);
+void test_drain(void);
+
+#endif
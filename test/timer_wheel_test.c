@@ -0,0 +1,206 @@
+/*! @file timer_wheel_test.c
+File with the unit tests of the timer wheel. The timers are armed at the boundaries of the levels of the
+wheel and beyond its range, from starting ticks next to the wrap of a level, and must expire on their tick,
+neither earlier nor later. The callbacks arm the timers again, with deadlines that have passed and with
+the next tick.
+@author Gavrish A.A.
+@date 16.10.2026 */
+
+#include "test.h"
+
+#include "../server/timer_wheel.h"
+
+#define RANGE_TICKS (1ULL << (TIMER_SLOT_BITS * TIMER_LEVELS))
+
+/**
+ * @struct Expiry
+ * @brief Structure for the context of the callback of the tests.
+ *
+ * @param wheel Timer wheel of the timer.
+ * @param fired Number of the expirations.
+ * @param rearms Number of the expirations left that arm the timer again.
+ * @param deadline Deadline of the timer armed again, 0 for the next tick after the expired one.
+ */
+typedef struct {
+    TimerWheel* wheel;
+    int fired;
+    int rearms;
+    uint64_t deadline;
+} Expiry;
+
+/**
+ * @brief Starting ticks of the wheel: aligned, and one tick before the wraps of the first two levels.
+ */
+static const uint64_t start_ticks[] = {
+    0, 100, (1ULL << TIMER_SLOT_BITS) - 1, (1ULL << (2 * TIMER_SLOT_BITS)) - 1,
+};
+
+/**
+ * @brief Delays of the timers in ticks: around the boundaries of the levels and beyond the range.
+ */
+static const uint64_t delays[] = {
+    0, 1, 63, 64, 65, 4095, 4096, 4097, 262143, 262144, 262145,
+    RANGE_TICKS - 1, RANGE_TICKS, RANGE_TICKS + 100,
+};
+
+/**
+ * @brief Counts the expiration and arms the timer again while the rearms last.
+ * @param timer Expired timer.
+ * @param context Expiry.
+ * @return void
+ */
+static void count_expiry(TimerNode* timer, void* context) {
+    Expiry* expiry = (Expiry*)context;
+
+    expiry->fired++;
+
+    if (expiry->rearms > 0) {
+        expiry->rearms--;
+        timer_arm(expiry->wheel, timer,
+                  expiry->deadline > 0 ? expiry->deadline : (timer->expires + 1) * TIMER_TICK_MS);
+    }
+
+    return;
+}
+
+/**
+ * @brief Checks that a timer armed with the delay from the starting tick expires on its tick.
+ * @param start Starting tick of the wheel.
+ * @param delay Delay of the timer in ticks.
+ * @return void
+ */
+static void check_expires_on_tick(uint64_t start, uint64_t delay) {
+    TimerWheel wheel;
+    TimerNode timer;
+    Expiry expiry = {&wheel, 0, 0, 0};
+    uint64_t expires = start + delay;
+
+    timer_wheel_init(&wheel, start * TIMER_TICK_MS);
+    timer_init(&timer);
+    timer_arm(&wheel, &timer, expires * TIMER_TICK_MS);
+
+    if (expires > start) {
+        timer_wheel_advance(&wheel, expires * TIMER_TICK_MS - 1, count_expiry, &expiry);
+        CHECK(expiry.fired == 0);
+    }
+
+    timer_wheel_advance(&wheel, expires * TIMER_TICK_MS, count_expiry, &expiry);
+    CHECK(expiry.fired == 1);
+    CHECK(wheel.count == 0);
+    CHECK(timer.next == NULL);
+
+    return;
+}
+
+/**
+ * @brief Checks that the deadlines are rounded up to ticks, so a timer never expires early.
+ * @return void
+ */
+static void check_rounding(void) {
+    TimerWheel wheel;
+    TimerNode timer;
+    Expiry expiry = {&wheel, 0, 0, 0};
+
+    timer_wheel_init(&wheel, 1000);
+    timer_init(&timer);
+    timer_arm(&wheel, &timer, 1025);
+
+    timer_wheel_advance(&wheel, 1029, count_expiry, &expiry);
+    CHECK(expiry.fired == 0);
+
+    timer_wheel_advance(&wheel, 1030, count_expiry, &expiry);
+    CHECK(expiry.fired == 1);
+
+    return;
+}
+
+/**
+ * @brief Checks that a cancelled timer never expires and that arming an armed timer moves it.
+ * @return void
+ */
+static void check_cancel_and_move(void) {
+    TimerWheel wheel;
+    TimerNode first, second;
+    Expiry expiry = {&wheel, 0, 0, 0};
+
+    timer_wheel_init(&wheel, 0);
+    timer_init(&first);
+    timer_init(&second);
+
+    timer_arm(&wheel, &first, 500);
+    timer_arm(&wheel, &second, 100000);
+    timer_arm(&wheel, &second, 200);
+    CHECK(wheel.count == 2);
+
+    timer_cancel(&wheel, &first);
+    timer_cancel(&wheel, &first);
+    CHECK(wheel.count == 1);
+
+    timer_wheel_advance(&wheel, 190, count_expiry, &expiry);
+    CHECK(expiry.fired == 0);
+
+    timer_wheel_advance(&wheel, 200000, count_expiry, &expiry);
+    CHECK(expiry.fired == 1);
+    CHECK(wheel.count == 0);
+
+    return;
+}
+
+/**
+ * @brief Checks the timers armed again from the callback: a deadline that has passed expires on the next
+ * tick, and a timer armed for the next tick on every expiration expires on every tick.
+ * @return void
+ */
+static void check_rearm_from_callback(void) {
+    TimerWheel wheel;
+    TimerNode timer;
+    Expiry expiry = {&wheel, 0, 1, 1};
+
+    timer_wheel_init(&wheel, 0);
+    timer_init(&timer);
+    timer_arm(&wheel, &timer, 50);
+
+    timer_wheel_advance(&wheel, 50, count_expiry, &expiry);
+    CHECK(expiry.fired == 1);
+    CHECK(wheel.count == 1);
+
+    timer_wheel_advance(&wheel, 60, count_expiry, &expiry);
+    CHECK(expiry.fired == 2);
+    CHECK(wheel.count == 0);
+
+    expiry.fired = 0;
+    expiry.rearms = 1;
+    timer_arm(&wheel, &timer, 100);
+
+    timer_wheel_advance(&wheel, 200, count_expiry, &expiry);
+    CHECK(expiry.fired == 2);
+
+    expiry.fired = 0;
+    expiry.rearms = 1000;
+    expiry.deadline = 0;
+    timer_arm(&wheel, &timer, 1000);
+
+    timer_wheel_advance(&wheel, 1000 + 199 * TIMER_TICK_MS, count_expiry, &expiry);
+    CHECK(expiry.fired == 200);
+    CHECK(wheel.count == 1);
+
+    return;
+}
+
+/**
+ * @brief Runs the unit tests of the timer wheel.
+ * @return void
+ */
+void test_timer_wheel(void) {
+    for (size_t start = 0; start < sizeof(start_ticks) / sizeof(start_ticks[0]); ++start) {
+        for (size_t delay = 0; delay < sizeof(delays) / sizeof(delays[0]); ++delay) {
+            check_expires_on_tick(start_ticks[start], delays[delay]);
+        }
+    }
+
+    check_rounding();
+    check_cancel_and_move();
+    check_rearm_from_callback();
+
+    return;
+}